@@ -13,8 +13,6 @@
 #include <ddraw.h>
 #include <stdio.h>
 
-extern HRESULT Int2Str(_Out_writes_bytes_(nDestLen) LPTSTR pszDest, UINT nDestLen, DWORD i);
-
 namespace
 {
     using LPDIRECTDRAWCREATEEX = HRESULT(WINAPI*)(GUID FAR* lpGuid, LPVOID* lplpDD, REFIID  iid, IUnknown FAR* pUnkOuter);
@@ -36,7 +34,6 @@ namespace
 #define DDVALDEF(name,val)      {name, FIELD_OFFSET(DDCAPS,val), 0}
 #define DDHEXDEF(name,val)      {name, FIELD_OFFSET(DDCAPS,val), 0xFFFFFFFF}
 #define ROPDEF(name,dwRops,rop) DDCAPDEF(name,dwRops[((rop>>16)&0xFF)/32],static_cast<DWORD>((1<<((rop>>16)&0xFF)%32)))
-#define MAKEMODE(xres,yres,bpp) (((DWORD)xres << 20) | ((DWORD)yres << 8) | bpp)
 
 
     //-----------------------------------------------------------------------------
@@ -637,7 +634,8 @@ namespace
         if (!g_directDrawCreateEx)
             return E_FAIL;
 
-        if (SUCCEEDED(g_directDrawCreateEx(pGUID, (VOID**)&g_pDD, IID_IDirectDraw7, nullptr)))
+        TRACESCOPE trace("DirectDrawCreateEx");
+        if (SUCCEEDED(StatsCall(API_DIRECTDRAWCREATEEX, g_directDrawCreateEx, pGUID, (VOID**)&g_pDD, IID_IDirectDraw7, nullptr)))
         {
             g_pDDGUID = pGUID;
             return S_OK;
@@ -691,48 +689,28 @@ namespace
                 dwFreeTexMem = 0;
             }
 
-            if (pPrintInfo)
+            EmitColumn(pPrintInfo, 0, "Type", 24);
+            EmitColumn(pPrintInfo, 1, "Total", 10);
+            EmitColumn(pPrintInfo, 2, "Free", 10);
+
+            const struct { const CHAR* strName; DWORD dwTotal; DWORD dwFree; } mem[] =
             {
-                PrintValueLine("dwTotalVidMem", dwTotalVidMem, pPrintInfo);
-                PrintValueLine("dwFreeVidMem", dwFreeVidMem, pPrintInfo);
-                PrintValueLine("dwTotalLocMem", dwTotalLocMem, pPrintInfo);
-                PrintValueLine("dwFreeLocMem", dwFreeLocMem, pPrintInfo);
-                PrintValueLine("dwTotalAGPMem", dwTotalAGPMem, pPrintInfo);
-                PrintValueLine("dwFreeAGPMem", dwFreeAGPMem, pPrintInfo);
-                PrintValueLine("dwTotalTexMem", dwTotalTexMem, pPrintInfo);
-                PrintValueLine("dwFreeTexMem", dwFreeTexMem, pPrintInfo);
-            }
-            else
+                { "Video", dwTotalVidMem, dwFreeVidMem },
+                { "Video (local)", dwTotalLocMem, dwFreeLocMem },
+                { "Video (non-local)", dwTotalAGPMem, dwFreeAGPMem },
+                { "Texture", dwTotalTexMem, dwFreeTexMem },
+            };
+
+            for (size_t i = 0; i < std::size(mem); ++i)
             {
-                CHAR strBuff[64];
-
-                LVAddColumn(g_hwndLV, 0, "Type", 24);
-                LVAddColumn(g_hwndLV, 1, "Total", 10);
-                LVAddColumn(g_hwndLV, 2, "Free", 10);
-
-                LVAddText(g_hwndLV, 0, "Video");
-                Int2Str(strBuff, 64, dwTotalVidMem);
-                LVAddText(g_hwndLV, 1, "%s", strBuff);
-                Int2Str(strBuff, 64, dwFreeVidMem);
-                LVAddText(g_hwndLV, 2, "%s", strBuff);
-
-                LVAddText(g_hwndLV, 0, "Video (local)");
-                Int2Str(strBuff, 64, dwTotalLocMem);
-                LVAddText(g_hwndLV, 1, "%s", strBuff);
-                Int2Str(strBuff, 64, dwFreeLocMem);
-                LVAddText(g_hwndLV, 2, "%s", strBuff);
-
-                LVAddText(g_hwndLV, 0, "Video (non-local)");
-                Int2Str(strBuff, 64, dwTotalAGPMem);
-                LVAddText(g_hwndLV, 1, "%s", strBuff);
-                Int2Str(strBuff, 64, dwFreeAGPMem);
-                LVAddText(g_hwndLV, 2, "%s", strBuff);
-
-                LVAddText(g_hwndLV, 0, "Texture");
-                Int2Str(strBuff, 64, dwTotalTexMem);
-                LVAddText(g_hwndLV, 1, "%s", strBuff);
-                Int2Str(strBuff, 64, dwFreeTexMem);
-                LVAddText(g_hwndLV, 2, "%s", strBuff);
+                const ROWCELL cells[3] =
+                {
+                    { CELL_TEXT, mem[i].strName, 0 },
+                    { CELL_UINT, nullptr, mem[i].dwTotal },
+                    { CELL_UINT, nullptr, mem[i].dwFree },
+                };
+                if (FAILED(EmitRow(pPrintInfo, 3, cells)))
+                    return E_FAIL;
             }
         }
 
@@ -750,12 +728,14 @@ namespace
             DDCAPS ddcaps = {};
             ddcaps.dwSize = sizeof(ddcaps);
 
+            TRACESCOPE trace("GetCaps");
+            LONGLONG qpcStart = TraceNow();
             HRESULT hr;
             if (lParam1 == DDCREATE_EMULATIONONLY)
                 hr = g_pDD->GetCaps(nullptr, &ddcaps);
             else
                 hr = g_pDD->GetCaps(&ddcaps, nullptr);
-            if (FAILED(hr))
+            if (FAILED(StatsAdd(API_DDGETCAPS, qpcStart, hr)))
             {
                 ddcaps = {};
             }
@@ -792,11 +772,8 @@ namespace
             return E_FAIL;
 
         // Add columns
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Codes", 24);
-            LVAddColumn(g_hwndLV, 1, "", 24);
-        }
+        EmitColumn(pPrintInfo, 0, "Codes", 24);
+        EmitColumn(pPrintInfo, 1, "", 24);
 
         // Assume all FourCC values are ascii strings
         for (DWORD dwCount = 0; dwCount < dwNumOfCodes; dwCount++)
@@ -804,21 +781,10 @@ namespace
             CHAR strText[5] = {};
             memcpy(strText, &FourCC[dwCount], 4);
 
-            if (!pPrintInfo)
-            {
-                LVAddText(g_hwndLV, 0, "%s", strText);
-            }
-            else
+            if (FAILED(EmitNoteRow(pPrintInfo, strText)))
             {
-                int xCode = (pPrintInfo->dwCurrIndent * DEF_TAB_SIZE * pPrintInfo->dwCharWidth);
-                int yLine = (pPrintInfo->dwCurrLine * pPrintInfo->dwLineHeight);
-
-                // Print Code
-                if (FAILED(PrintLine(xCode, yLine, strText, 4, pPrintInfo)))
-                    return E_FAIL;
-
-                if (FAILED(PrintNextLine(pPrintInfo)))
-                    return E_FAIL;
+                GlobalFree(FourCC);
+                return E_FAIL;
             }
         }
 
@@ -829,44 +795,10 @@ namespace
 
 
     //-----------------------------------------------------------------------------
-    HRESULT CALLBACK EnumDisplayModesCallback(DDSURFACEDESC2* pddsd, VOID*)
-    {
-        if (pddsd->ddsCaps.dwCaps & DDSCAPS_STANDARDVGAMODE)
-        {
-            LVAddText(g_hwndLV, 0, "%dx%dx%d (StandardVGA)",
-                pddsd->dwWidth, pddsd->dwHeight,
-                pddsd->ddpfPixelFormat.dwRGBBitCount);
-        }
-        else if (pddsd->ddsCaps.dwCaps & DDSCAPS_MODEX)
-        {
-            LVAddText(g_hwndLV, 0, "%dx%dx%d (ModeX)",
-                pddsd->dwWidth, pddsd->dwHeight,
-                pddsd->ddpfPixelFormat.dwRGBBitCount);
-        }
-        else
-        {
-            LVAddText(g_hwndLV, 0, "%dx%dx%d ",
-                pddsd->dwWidth, pddsd->dwHeight,
-                pddsd->ddpfPixelFormat.dwRGBBitCount);
-        }
-
-        return DDENUMRET_OK;
-    }
-
-
-    //-----------------------------------------------------------------------------
-    HRESULT CALLBACK EnumDisplayModesCallbackPrint(DDSURFACEDESC2* pddsd, VOID* Context)
+    HRESULT CALLBACK EnumDisplayModesCallback(DDSURFACEDESC2* pddsd, VOID* Context)
     {
         TCHAR szBuff[80];
-        DWORD cchLen;
         auto lpInfo = reinterpret_cast<PRINTCBINFO*>(Context);
-        int xMode, yLine;
-
-        if (!lpInfo)
-            return E_FAIL;
-
-        xMode = (lpInfo->dwCurrIndent * DEF_TAB_SIZE * lpInfo->dwCharWidth);
-        yLine = (lpInfo->dwCurrLine * lpInfo->dwLineHeight);
 
         if (pddsd->ddsCaps.dwCaps & DDSCAPS_STANDARDVGAMODE)
         {
@@ -880,12 +812,9 @@ namespace
         {
             sprintf_s(szBuff, sizeof(szBuff), TEXT("%ux%ux%u "), pddsd->dwWidth, pddsd->dwHeight, pddsd->ddpfPixelFormat.dwRGBBitCount);
         }
-        // Print Mode Info
-        cchLen = static_cast<DWORD>(_tcslen(szBuff));
-        if (FAILED(PrintLine(xMode, yLine, szBuff, cchLen, lpInfo)))
-            return DDENUMRET_CANCEL;
-        // Advance to next line
-        if (FAILED(PrintNextLine(lpInfo)))
+
+        // Context is the PRINTCBINFO, or nullptr for the ListView
+        if (FAILED(EmitNoteRow(lpInfo, szBuff)))
             return DDENUMRET_CANCEL;
 
         return DDENUMRET_OK;
@@ -896,14 +825,10 @@ namespace
     HRESULT DDDisplayVideoModes(LPARAM lParam1, LPARAM /*lParam2*/,
         _In_opt_ PRINTCBINFO* pPrintInfo)
     {
-        DWORD          mode;
         DDSURFACEDESC2 ddsd;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Mode", 24);
-            LVAddColumn(g_hwndLV, 1, "", 24);
-        }
+        EmitColumn(pPrintInfo, 0, "Mode", 24);
+        EmitColumn(pPrintInfo, 1, "", 24);
 
         // lParam1 is the GUID for the driver we should open
         // lParam2 is not used
@@ -915,18 +840,13 @@ namespace
             HRESULT hr = g_pDD->GetDisplayMode(&ddsd);
             if (SUCCEEDED(hr))
             {
-                mode = MAKEMODE(ddsd.dwWidth, ddsd.dwHeight, ddsd.ddpfPixelFormat.dwRGBBitCount);
-
                 // Get Mode with ModeX
+                TRACESCOPE trace("EnumDisplayModes");
                 g_pDD->SetCooperativeLevel(g_hwndMain, DDSCL_FULLSCREEN | DDSCL_EXCLUSIVE |
                     DDSCL_ALLOWMODEX | DDSCL_NOWINDOWCHANGES);
 
-                if (pPrintInfo)
-                    g_pDD->EnumDisplayModes(DDEDM_STANDARDVGAMODES, nullptr, (VOID*)pPrintInfo,
-                        EnumDisplayModesCallbackPrint);
-                else
-                    g_pDD->EnumDisplayModes(DDEDM_STANDARDVGAMODES, nullptr, UIntToPtr(mode),
-                        EnumDisplayModesCallback);
+                g_pDD->EnumDisplayModes(DDEDM_STANDARDVGAMODES, nullptr, (VOID*)pPrintInfo,
+                    EnumDisplayModesCallback);
 
                 g_pDD->SetCooperativeLevel(g_hwndMain, DDSCL_NORMAL);
             }
@@ -940,14 +860,14 @@ namespace
     BOOL CALLBACK DDEnumCallBack(_In_ GUID* pid, _In_z_ LPSTR lpDriverDesc,
         _In_opt_ LPSTR lpDriverName, _In_opt_ VOID* lpContext, _In_opt_ HMONITOR)
     {
-        HTREEITEM hParent = (HTREEITEM)lpContext;
+        HCAPNODE hParent = (HCAPNODE)lpContext;
         TCHAR szText[256];
 
         if (pid != (GUID*)-2)
             if (HIWORD(pid) != 0)
             {
                 GUID temp = *pid;
-                pid = (GUID*)LocalAlloc(LPTR, sizeof(GUID));
+                pid = static_cast<GUID*>(TVAlloc(sizeof(GUID)));
                 if (pid)
                     *pid = temp;
             }
@@ -971,6 +891,11 @@ namespace
 //-----------------------------------------------------------------------------
 VOID DD_Init()
 {
+    // DirectDraw is not mocked, so it is left out with mock devices. It is
+    // shown unrecorded while recording.
+    if (MockIsActive() && !MockIsRecording())
+        return;
+
     g_hInstDDraw = LoadLibraryEx("ddraw.dll", nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
     if (g_hInstDDraw)
     {
@@ -983,15 +908,16 @@ VOID DD_Init()
 //-----------------------------------------------------------------------------
 // Name: DD_FillTree()
 //-----------------------------------------------------------------------------
-VOID DD_FillTree(HWND hwndTV)
+VOID DD_FillTree()
 {
     if (!g_directDrawEnumerateEx)
         return;
 
-    HTREEITEM hTree;
+    TRACESCOPE trace("DD_FillTree");
+    HCAPNODE hTree;
 
     // Add DirectDraw devices
-    hTree = TVAddNode(TVI_ROOT, "DirectDraw Devices", TRUE, IDI_DIRECTX,
+    hTree = TVAddNode(nullptr, "DirectDraw Devices", TRUE, IDI_DIRECTX,
         nullptr, 0, 0);
 
     // Add Display Driver node(s) and capability nodes to treeview
@@ -1003,7 +929,7 @@ VOID DD_FillTree(HWND hwndTV)
     // Hardware Emulation Layer (HEL) not supported on Windows 8,
     // so we no longer show it
 
-    TreeView_Expand(hwndTV, hTree, TVE_EXPAND);
+    TVExpandNode(hTree);
 }
 
 
@@ -0,0 +1,1652 @@
+//-----------------------------------------------------------------------------
+// Name: dxcache.cpp
+//
+// Desc: DirectX Capabilities Viewer Snapshot Cache
+//
+//       Probing creates devices for every adapter and runtime, which takes
+//       seconds, but the results only change when a driver or runtime does.
+//       After a full probe the tree and every node's rows are saved; while
+//       the cache key still matches, the next launch rebuilds the tree from
+//       the file without creating any devices.
+//
+//       The key is built from the adapter identities and driver versions
+//       (DXGI_GetCacheKey, DXG_GetCacheKey), plus the timestamps of the
+//       runtime DLLs and of dxview itself.
+//
+//       Snapshot file layout, all sections DWORD aligned:
+//
+//       CACHEHEADER
+//       key                     cbKey bytes, padded
+//       CACHENODE[cNodes]       preorder, children follow their parent
+//       rows                    DWORD records, see CacheEmitRow()
+//       strings                 NUL terminated, each distinct string once
+//
+//       The file is mapped and used in place: node text and row strings
+//       point into the view, nothing is parsed into separate allocations.
+//
+//       The cache keeps lazy nodes lazy: such a node is saved with its expand
+//       callback and lParams instead of its children, so a cold start doesn't
+//       run the Direct3D 9 render format sweep, and the children are probed
+//       when the node is opened. A snapshot saved for --snapshot has to stand
+//       on its own, so there every lazy node is expanded.
+//
+//       CacheDiffSnapshots() compares two snapshots, typically of different
+//       machines or drivers, and reports the nodes and rows that were added
+//       or removed and the values that changed. CacheWalkSnapshot() hands
+//       the contents of a snapshot to other tools, see dxfleet.cpp.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+extern DWORD g_dwViewState;
+extern DWORD g_dwView9Ex;
+
+VOID DXG_ExpandRenderFormats(HCAPNODE hParent, LPARAM lParam1, LPARAM lParam2, LPARAM lParam3);
+VOID DXG_ExpandMultiSample(HCAPNODE hParent, LPARAM lParam1, LPARAM lParam2, LPARAM lParam3);
+
+namespace
+{
+    constexpr DWORD c_dwCacheMagic = 0x43585644; // "DVXC"
+    constexpr DWORD c_dwCacheVersion = 3;
+
+    // Rows are captured once per view setting (IDM_VIEWALL, 9Ex caps)
+    constexpr UINT c_cVariants = 4;
+
+    // View All with 9Ex caps, where unsupported caps still have a row
+    constexpr UINT c_fullVariant = 3;
+
+    constexpr UINT c_maxCacheCells = 64;
+    constexpr UINT c_maxCacheDepth = 32;
+
+    constexpr DWORD NODE_KIDS = 0x1;
+    constexpr DWORD NODE_EXPANDED = 0x2;
+    constexpr DWORD NODE_ROWS = 0x4;
+    constexpr DWORD NODE_LAZY = 0x8;
+
+    // Expand callbacks a lazy node can be saved with, by index
+    const EXPANDCALLBACK c_fnExpandCallbacks[] =
+    {
+        DXG_ExpandRenderFormats,
+        DXG_ExpandMultiSample,
+    };
+
+    // Row record kinds, in the low byte of the record's first DWORD
+    enum : BYTE
+    {
+        REC_END = 0,
+        REC_COLUMN = 1,
+        REC_ROW = 2,
+    };
+
+    struct CACHEHEADER
+    {
+        DWORD   dwMagic;
+        DWORD   dwVersion;
+        DWORD   cbKey;
+        DWORD   cRoots;
+        DWORD   cNodes;
+        DWORD   ibNodes;
+        DWORD   ibRows;
+        DWORD   cbRows;
+        DWORD   ibStrings;
+        DWORD   cbStrings;
+    };
+
+    struct CACHENODE
+    {
+        DWORD   ibText;                 // String table offset
+        DWORD   iImage;
+        DWORD   dwFlags;                // NODE_*
+        DWORD   cChildren;
+        union
+        {
+            DWORD   idwRows[c_cVariants];   // DWORD index into the rows, if NODE_ROWS
+            DWORD   dwExpand[4];            // c_fnExpandCallbacks index and lParam1..3, if NODE_LAZY
+        };
+    };
+
+    const CHAR* const c_szRuntimeFiles[] =
+    {
+        "dxgi.dll",
+        "d3d9.dll",
+        "d3d10.dll",
+        "d3d10_1.dll",
+        "d3d11.dll",
+        "d3d12.dll",
+        "d3d10warp.dll",
+        "D3D12Core.dll",
+    };
+
+    // Taken from next to dxview when deployed with it: the WARP package and
+    // the Agility SDK (see D3D12SDKPath)
+    const CHAR* const c_szAppLocalFiles[] =
+    {
+        "d3d10warp.dll",
+        "D3D12\\D3D12Core.dll",
+    };
+
+    // Growable byte buffer
+    struct CACHEBLOB
+    {
+        BYTE*   pb;
+        size_t  cb;
+        size_t  cbAlloc;
+        BOOL    fFailed;
+    };
+
+    // String table under construction. Slots hold offset + 1, 0 is empty.
+    struct STRINGTABLE
+    {
+        CACHEBLOB   text;
+        DWORD*      pSlots;
+        DWORD       cSlots;
+        DWORD       cUsed;
+    };
+
+    struct CACHEBUILD
+    {
+        CACHEBLOB   nodes;
+        CACHEBLOB   rows;
+        STRINGTABLE strings;
+        DWORD       cNodes;
+        BOOL        fExpandLazy;    // Save the children of lazy nodes rather than the nodes
+    };
+
+    // Capture target of one node variant
+    struct CACHECAPTURE
+    {
+        CACHEBLOB*      pRows;
+        STRINGTABLE*    pStrings;
+    };
+
+    // A mapped snapshot
+    struct CACHEVIEW
+    {
+        const BYTE*         pBase;
+        const CACHENODE*    pNodes;
+        DWORD               cNodes;
+        const DWORD*        pRows;
+        DWORD               cdwRows;
+        const CHAR*         pStrings;
+        DWORD               cbStrings;
+    };
+
+    CACHEBLOB   g_key = {};         // Built by CacheKeyAdd
+    BOOL        g_fKeyDone = FALSE;
+    CACHEVIEW   g_view = {};        // Loaded snapshot, cached nodes replay rows from it
+
+
+    //-----------------------------------------------------------------------------
+    VOID BlobWrite(CACHEBLOB* pBlob, const void* pData, size_t cbData)
+    {
+        if (pBlob->fFailed)
+            return;
+
+        if (pBlob->cb + cbData > pBlob->cbAlloc)
+        {
+            size_t cbAlloc = (pBlob->cbAlloc) ? pBlob->cbAlloc * 2 : 256;
+            while (cbAlloc < pBlob->cb + cbData)
+                cbAlloc *= 2;
+
+            auto pb = new (std::nothrow) BYTE[cbAlloc];
+            if (!pb)
+            {
+                pBlob->fFailed = TRUE;
+                return;
+            }
+
+            if (pBlob->cb)
+                memcpy(pb, pBlob->pb, pBlob->cb);
+            delete[] pBlob->pb;
+
+            pBlob->pb = pb;
+            pBlob->cbAlloc = cbAlloc;
+        }
+
+        memcpy(pBlob->pb + pBlob->cb, pData, cbData);
+        pBlob->cb += cbData;
+    }
+
+
+    VOID BlobDword(CACHEBLOB* pBlob, DWORD dw)
+    {
+        BlobWrite(pBlob, &dw, sizeof(dw));
+    }
+
+
+    VOID BlobFree(CACHEBLOB* pBlob)
+    {
+        delete[] pBlob->pb;
+        *pBlob = {};
+    }
+
+
+    //-----------------------------------------------------------------------------
+    DWORD HashString(const CHAR* str)
+    {
+        DWORD dwHash = 2166136261u;
+        for (; *str; ++str)
+            dwHash = (dwHash ^ static_cast<BYTE>(*str)) * 16777619u;
+        return dwHash;
+    }
+
+
+    BOOL GrowStrings(STRINGTABLE* pTable)
+    {
+        DWORD cSlots = (pTable->cSlots) ? pTable->cSlots * 2 : 1024;
+        auto pSlots = new (std::nothrow) DWORD[cSlots];
+        if (!pSlots)
+            return FALSE;
+
+        memset(pSlots, 0, cSlots * sizeof(DWORD));
+        for (DWORD i = 0; i < pTable->cSlots; ++i)
+        {
+            DWORD dwSlot = pTable->pSlots[i];
+            if (!dwSlot)
+                continue;
+
+            auto str = reinterpret_cast<const CHAR*>(pTable->text.pb) + dwSlot - 1;
+            DWORD j = HashString(str) & (cSlots - 1);
+            while (pSlots[j])
+                j = (j + 1) & (cSlots - 1);
+            pSlots[j] = dwSlot;
+        }
+
+        delete[] pTable->pSlots;
+        pTable->pSlots = pSlots;
+        pTable->cSlots = cSlots;
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: AddString()
+    // Desc: Returns the string table offset of str, adding it if it's new
+    //-----------------------------------------------------------------------------
+    DWORD AddString(STRINGTABLE* pTable, const CHAR* str)
+    {
+        if (!str)
+            str = "";
+
+        if (pTable->cUsed * 2 >= pTable->cSlots && !GrowStrings(pTable))
+        {
+            pTable->text.fFailed = TRUE;
+            return 0;
+        }
+
+        DWORD i = HashString(str) & (pTable->cSlots - 1);
+        for (; pTable->pSlots[i]; i = (i + 1) & (pTable->cSlots - 1))
+        {
+            DWORD ib = pTable->pSlots[i] - 1;
+            if (strcmp(reinterpret_cast<const CHAR*>(pTable->text.pb) + ib, str) == 0)
+                return ib;
+        }
+
+        auto ib = static_cast<DWORD>(pTable->text.cb);
+        BlobWrite(&pTable->text, str, strlen(str) + 1);
+        if (pTable->text.fFailed)
+            return 0;
+
+        pTable->pSlots[i] = ib + 1;
+        pTable->cUsed++;
+        return ib;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Capture backend: encodes rows into a CACHECAPTURE
+    //-----------------------------------------------------------------------------
+    HRESULT CacheEmitColumn(void* pContext, int iCol, const CHAR* strName, int width)
+    {
+        auto pCapture = static_cast<CACHECAPTURE*>(pContext);
+
+        BlobDword(pCapture->pRows, REC_COLUMN);
+        BlobDword(pCapture->pRows, static_cast<DWORD>(iCol));
+        BlobDword(pCapture->pRows, static_cast<DWORD>(width));
+        BlobDword(pCapture->pRows, AddString(pCapture->pStrings, strName));
+
+        return (pCapture->pRows->fFailed || pCapture->pStrings->text.fFailed) ? E_OUTOFMEMORY : S_OK;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: CacheEmitRow()
+    // Desc: A row is a DWORD of REC_ROW | cCells << 8, the cell types (2 bits
+    //       each), a bitset of the CELL_BOOL values, then one DWORD for each
+    //       other cell: its value, or string table offset for CELL_TEXT.
+    //       Format support tables are mostly CELL_BOOL, so they pack well.
+    //-----------------------------------------------------------------------------
+    HRESULT CacheEmitRow(void* pContext, UINT cCells, const ROWCELL* pCells)
+    {
+        auto pCapture = static_cast<CACHECAPTURE*>(pContext);
+        CACHEBLOB* pRows = pCapture->pRows;
+
+        if (cCells > c_maxCacheCells)
+            cCells = c_maxCacheCells;
+
+        DWORD dwTypes[c_maxCacheCells / 16] = {};
+        DWORD dwBools[c_maxCacheCells / 32] = {};
+        UINT cBools = 0;
+        for (UINT i = 0; i < cCells; ++i)
+        {
+            dwTypes[i / 16] |= (static_cast<DWORD>(pCells[i].type) & 0x3) << ((i % 16) * 2);
+            if (pCells[i].type == CELL_BOOL)
+            {
+                if (pCells[i].dwValue)
+                    dwBools[cBools / 32] |= 1u << (cBools % 32);
+                ++cBools;
+            }
+        }
+
+        BlobDword(pRows, REC_ROW | (cCells << 8));
+        BlobWrite(pRows, dwTypes, ((cCells + 15) / 16) * sizeof(DWORD));
+        BlobWrite(pRows, dwBools, ((cBools + 31) / 32) * sizeof(DWORD));
+        for (UINT i = 0; i < cCells; ++i)
+        {
+            if (pCells[i].type == CELL_TEXT)
+                BlobDword(pRows, AddString(pCapture->pStrings, pCells[i].str));
+            else if (pCells[i].type != CELL_BOOL)
+                BlobDword(pRows, pCells[i].dwValue);
+        }
+
+        return (pRows->fFailed || pCapture->pStrings->text.fFailed) ? E_OUTOFMEMORY : S_OK;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: CaptureRows()
+    // Desc: Runs a node's display callback into the rows being built
+    //-----------------------------------------------------------------------------
+    VOID CaptureRows(HCAPNODE hNode, CACHEBLOB* pRows, STRINGTABLE* pStrings)
+    {
+        CACHECAPTURE capture = { pRows, pStrings };
+        ROWEMITTER emitter = { CacheEmitColumn, CacheEmitRow, &capture };
+
+        PRINTCBINFO pci = {};
+        pci.hCurrTree = hNode;
+        pci.pEmitter = &emitter;
+
+        // Each variant holds what the ListView shows in its view state
+        pci.fAvailOnly = (g_dwViewState != IDM_VIEWALL);
+
+        // A failing callback still shows the rows it emitted, so keep them
+        const NODEINFO* pni = &hNode->ni;
+        if (pni->bUseLParam3)
+            (void)((DISPLAYCALLBACKEX)(pni->fnDisplayCallback))(pni->lParam1, pni->lParam2, pni->lParam3, &pci);
+        else
+            (void)pni->fnDisplayCallback(pni->lParam1, pni->lParam2, &pci);
+
+        BlobDword(pRows, REC_END);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: SaveLazyNode()
+    // Desc: Describes a lazy node by its expand callback and lParams, if they
+    //       can be saved. Returns FALSE if the node must be expanded instead.
+    //-----------------------------------------------------------------------------
+    BOOL SaveLazyNode(const CACHEBUILD* pBuild, HCAPNODE hNode, CACHENODE* pNode)
+    {
+        const NODEINFO* pni = &hNode->ni;
+        if (pBuild->fExpandLazy || !pni->fnExpandCallback)
+            return FALSE;
+
+        const LPARAM lParams[3] = { pni->lParam1, pni->lParam2, pni->lParam3 };
+        for (UINT i = 0; i < 3; ++i)
+        {
+            pNode->dwExpand[i + 1] = static_cast<DWORD>(lParams[i]);
+            if (static_cast<LPARAM>(pNode->dwExpand[i + 1]) != lParams[i])
+                return FALSE;
+        }
+
+        for (UINT i = 0; i < std::size(c_fnExpandCallbacks); ++i)
+        {
+            if (c_fnExpandCallbacks[i] == pni->fnExpandCallback)
+            {
+                pNode->dwExpand[0] = i;
+                pNode->dwFlags |= NODE_LAZY;
+                return TRUE;
+            }
+        }
+
+        return FALSE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: BuildNode()
+    // Desc: Adds a node, its rows for each view setting, then its children
+    //-----------------------------------------------------------------------------
+    BOOL BuildNode(CACHEBUILD* pBuild, HCAPNODE hNode)
+    {
+        CACHENODE node = {};
+        if (!SaveLazyNode(pBuild, hNode, &node))
+        {
+            node = {};
+            TVExpandLazyNode(hNode);
+        }
+
+        node.ibText = AddString(&pBuild->strings, hNode->strText);
+        node.iImage = static_cast<DWORD>(hNode->iImage);
+        if (hNode->fKids)
+            node.dwFlags |= NODE_KIDS;
+        if (hNode->fExpanded)
+            node.dwFlags |= NODE_EXPANDED;
+
+        for (HCAPNODE hChild = hNode->pFirstChild; hChild; hChild = hChild->pNext)
+        {
+            if (!hChild->fNoSnapshot)
+                node.cChildren++;
+        }
+
+        BOOL fOK = TRUE;
+        if (hNode->ni.fnDisplayCallback)
+        {
+            node.dwFlags |= NODE_ROWS;
+
+            DWORD dwViewState = g_dwViewState;
+            DWORD dwView9Ex = g_dwView9Ex;
+
+            size_t cbVariant[c_cVariants] = {};
+            for (UINT v = 0; v < c_cVariants && fOK; ++v)
+            {
+                g_dwViewState = (v & 1) ? IDM_VIEWALL : IDM_VIEWAVAIL;
+                g_dwView9Ex = (v & 2) ? 1 : 0;
+
+                size_t ibStart = pBuild->rows.cb;
+                CaptureRows(hNode, &pBuild->rows, &pBuild->strings);
+                fOK = !pBuild->rows.fFailed;
+
+                node.idwRows[v] = static_cast<DWORD>(ibStart / sizeof(DWORD));
+                cbVariant[v] = pBuild->rows.cb - ibStart;
+
+                // Most nodes don't depend on the view, store those rows once
+                for (UINT u = 0; u < v && fOK; ++u)
+                {
+                    size_t ibSame = node.idwRows[u] * sizeof(DWORD);
+                    if (cbVariant[u] == cbVariant[v]
+                        && memcmp(pBuild->rows.pb + ibSame, pBuild->rows.pb + ibStart, cbVariant[v]) == 0)
+                    {
+                        node.idwRows[v] = node.idwRows[u];
+                        pBuild->rows.cb = ibStart;
+                        break;
+                    }
+                }
+            }
+
+            g_dwViewState = dwViewState;
+            g_dwView9Ex = dwView9Ex;
+        }
+
+        BlobWrite(&pBuild->nodes, &node, sizeof(node));
+        pBuild->cNodes++;
+
+        for (HCAPNODE hChild = hNode->pFirstChild; hChild && fOK; hChild = hChild->pNext)
+        {
+            if (!hChild->fNoSnapshot)
+                fOK = BuildNode(pBuild, hChild);
+        }
+
+        return fOK && !pBuild->nodes.fFailed && !pBuild->strings.text.fFailed;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    const CHAR* ViewString(const CACHEVIEW& view, DWORD ib)
+    {
+        // The table ends with a NUL, so any offset inside it is a valid string
+        return (ib < view.cbStrings) ? view.pStrings + ib : nullptr;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: ReplayRows()
+    // Desc: Emits the rows starting at DWORD idwRows. With fEmit FALSE this only
+    //       checks that they are well formed.
+    //-----------------------------------------------------------------------------
+    HRESULT ReplayRows(const CACHEVIEW& view, DWORD idwRows, PRINTCBINFO* pInfo, BOOL fEmit)
+    {
+        const DWORD* pdw = view.pRows;
+        DWORD cdw = view.cdwRows;
+        DWORD i = idwRows;
+
+        for (;;)
+        {
+            if (i >= cdw)
+                return E_FAIL;
+
+            DWORD dwRecord = pdw[i++];
+            UINT count = dwRecord >> 8;
+
+            switch (dwRecord & 0xff)
+            {
+            case REC_END:
+                return S_OK;
+
+            case REC_COLUMN:
+            {
+                if (cdw - i < 3)
+                    return E_FAIL;
+
+                const CHAR* strName = ViewString(view, pdw[i + 2]);
+                if (!strName)
+                    return E_FAIL;
+
+                if (fEmit)
+                    (void)EmitColumn(pInfo, static_cast<int>(pdw[i]), strName, static_cast<int>(pdw[i + 1]));
+                i += 3;
+                break;
+            }
+
+            case REC_ROW:
+            {
+                if (count > c_maxCacheCells)
+                    return E_FAIL;
+
+                UINT cTypes = (count + 15) / 16;
+                if (cdw - i < cTypes)
+                    return E_FAIL;
+
+                const DWORD* pTypes = pdw + i;
+                i += cTypes;
+
+                UINT cBools = 0;
+                for (UINT c = 0; c < count; ++c)
+                {
+                    if (((pTypes[c / 16] >> ((c % 16) * 2)) & 0x3) == CELL_BOOL)
+                        ++cBools;
+                }
+
+                UINT cBoolWords = (cBools + 31) / 32;
+                if (cdw - i < cBoolWords + (count - cBools))
+                    return E_FAIL;
+
+                const DWORD* pBools = pdw + i;
+                i += cBoolWords;
+
+                ROWCELL cells[c_maxCacheCells];
+                UINT iBool = 0;
+                for (UINT c = 0; c < count; ++c)
+                {
+                    cells[c].type = static_cast<ROWCELLTYPE>((pTypes[c / 16] >> ((c % 16) * 2)) & 0x3);
+                    cells[c].str = nullptr;
+                    cells[c].dwValue = 0;
+
+                    if (cells[c].type == CELL_BOOL)
+                    {
+                        cells[c].dwValue = (pBools[iBool / 32] >> (iBool % 32)) & 0x1;
+                        ++iBool;
+                    }
+                    else if (cells[c].type == CELL_TEXT)
+                    {
+                        cells[c].str = ViewString(view, pdw[i++]);
+                        if (!cells[c].str)
+                            return E_FAIL;
+                    }
+                    else
+                    {
+                        cells[c].dwValue = pdw[i++];
+                    }
+                }
+
+                if (fEmit)
+                {
+                    HRESULT hr = EmitRow(pInfo, count, cells);
+                    if (FAILED(hr))
+                        return hr;
+                }
+                break;
+            }
+
+            default:
+                return E_FAIL;
+            }
+        }
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: CacheDisplayNode()
+    // Desc: Display callback of cached nodes. lParam1 is the node's CACHENODE.
+    //-----------------------------------------------------------------------------
+    HRESULT CacheDisplayNode(LPARAM lParam1, LPARAM /*lParam2*/, LPARAM /*lParam3*/, PRINTCBINFO* pPrintInfo)
+    {
+        if (!g_view.pBase)
+            return E_FAIL;
+
+        // The ListView shows the rows of its view state; exports get all of
+        // them unless they ask for the filtered ones
+        auto pNode = reinterpret_cast<const CACHENODE*>(lParam1);
+        const BOOL fAll = (pPrintInfo) ? !pPrintInfo->fAvailOnly : (g_dwViewState == IDM_VIEWALL);
+        UINT v = ((fAll) ? 1u : 0u) | ((g_dwView9Ex) ? 2u : 0u);
+
+        return ReplayRows(g_view, pNode->idwRows[v], pPrintInfo, TRUE);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: ReadNode()
+    // Desc: Reads the node at *piNode and its children. The nodes are walked
+    //       twice: first with fBuild FALSE to validate all of them, then to add
+    //       them to the tree.
+    //-----------------------------------------------------------------------------
+    BOOL ReadNode(const CACHEVIEW& view, DWORD* piNode, HCAPNODE hParent, BOOL fBuild, UINT depth)
+    {
+        if (depth > c_maxCacheDepth || *piNode >= view.cNodes)
+            return FALSE;
+
+        const CACHENODE* pNode = &view.pNodes[(*piNode)++];
+        const CHAR* strText = ViewString(view, pNode->ibText);
+        auto iImage = static_cast<int>(pNode->iImage);
+
+        HCAPNODE hNode = nullptr;
+        if (!fBuild)
+        {
+            if (!strText || iImage < IDI_FIRSTIMAGE || iImage > IDI_LASTIMAGE
+                || pNode->cChildren > view.cNodes - *piNode)
+                return FALSE;
+
+            if ((pNode->dwFlags & NODE_LAZY)
+                && ((pNode->dwFlags & NODE_ROWS) || pNode->cChildren
+                    || pNode->dwExpand[0] >= std::size(c_fnExpandCallbacks)))
+                return FALSE;
+
+            for (UINT v = 0; v < c_cVariants && (pNode->dwFlags & NODE_ROWS); ++v)
+            {
+                if (FAILED(ReplayRows(view, pNode->idwRows[v], nullptr, FALSE)))
+                    return FALSE;
+            }
+        }
+        else
+        {
+            BOOL fKids = (pNode->dwFlags & NODE_KIDS) ? TRUE : FALSE;
+            if (pNode->dwFlags & NODE_LAZY)
+                hNode = TVAddLazyNode(hParent, strText, iImage, c_fnExpandCallbacks[pNode->dwExpand[0]],
+                    static_cast<LPARAM>(pNode->dwExpand[1]), static_cast<LPARAM>(pNode->dwExpand[2]), static_cast<LPARAM>(pNode->dwExpand[3]));
+            else if (pNode->dwFlags & NODE_ROWS)
+                hNode = TVAddNodeEx(hParent, strText, fKids, iImage, CacheDisplayNode, reinterpret_cast<LPARAM>(pNode), 0, 0);
+            else
+                hNode = TVAddNode(hParent, strText, fKids, iImage, nullptr, 0, 0);
+
+            if (!hNode)
+                return FALSE;
+        }
+
+        for (DWORD i = 0; i < pNode->cChildren; ++i)
+        {
+            if (!ReadNode(view, piNode, hNode, fBuild, depth + 1))
+                return FALSE;
+        }
+
+        if (hNode && (pNode->dwFlags & NODE_EXPANDED))
+            TVExpandNode(hNode);
+
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: MapSnapshot()
+    // Desc: Maps a snapshot file and checks its header. The view must be
+    //       released with UnmapViewOfFile.
+    //-----------------------------------------------------------------------------
+    BOOL MapSnapshot(LPCSTR szPath, CACHEVIEW* pView, const CACHEHEADER** ppHeader)
+    {
+        HANDLE hFile = CreateFile(szPath, GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (hFile == INVALID_HANDLE_VALUE)
+            return FALSE;
+
+        LARGE_INTEGER fileSize = {};
+        const BYTE* pBase = nullptr;
+        if (GetFileSizeEx(hFile, &fileSize) && fileSize.HighPart == 0
+            && fileSize.LowPart >= sizeof(CACHEHEADER))
+        {
+            HANDLE hMapping = CreateFileMapping(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (hMapping)
+            {
+                // The view keeps the file mapped after the handles are closed
+                pBase = static_cast<const BYTE*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(hMapping);
+            }
+        }
+        CloseHandle(hFile);
+
+        if (!pBase)
+            return FALSE;
+
+        auto pHeader = reinterpret_cast<const CACHEHEADER*>(pBase);
+        DWORD cbFile = fileSize.LowPart;
+
+        BOOL fValid = pHeader->dwMagic == c_dwCacheMagic
+            && pHeader->dwVersion == c_dwCacheVersion
+            && pHeader->cbKey <= cbFile - sizeof(CACHEHEADER)
+            && pHeader->cNodes <= cbFile / sizeof(CACHENODE)
+            && (pHeader->ibNodes % sizeof(DWORD)) == 0 && (pHeader->ibRows % sizeof(DWORD)) == 0
+            && pHeader->ibNodes >= sizeof(CACHEHEADER) + pHeader->cbKey
+            && pHeader->ibNodes <= cbFile && cbFile - pHeader->ibNodes >= pHeader->cNodes * sizeof(CACHENODE)
+            && pHeader->ibRows <= cbFile && cbFile - pHeader->ibRows >= pHeader->cbRows
+            && pHeader->ibStrings <= cbFile && cbFile - pHeader->ibStrings >= pHeader->cbStrings
+            && pHeader->cbStrings > 0 && pBase[pHeader->ibStrings + pHeader->cbStrings - 1] == '\0';
+
+        if (!fValid)
+        {
+            UnmapViewOfFile(pBase);
+            return FALSE;
+        }
+
+        pView->pBase = pBase;
+        pView->pNodes = reinterpret_cast<const CACHENODE*>(pBase + pHeader->ibNodes);
+        pView->cNodes = pHeader->cNodes;
+        pView->pRows = reinterpret_cast<const DWORD*>(pBase + pHeader->ibRows);
+        pView->cdwRows = pHeader->cbRows / sizeof(DWORD);
+        pView->pStrings = reinterpret_cast<const CHAR*>(pBase + pHeader->ibStrings);
+        pView->cbStrings = pHeader->cbStrings;
+
+        *ppHeader = pHeader;
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: ValidateSnapshot()
+    // Desc: Checks all nodes of a mapped snapshot
+    //-----------------------------------------------------------------------------
+    BOOL ValidateSnapshot(const CACHEVIEW& view, const CACHEHEADER* pHeader)
+    {
+        DWORD iNode = 0;
+        BOOL fValid = (pHeader->cRoots > 0);
+        for (DWORD i = 0; i < pHeader->cRoots && fValid; ++i)
+            fValid = ReadNode(view, &iNode, nullptr, FALSE, 0);
+
+        return fValid && iNode == view.cNodes;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: GetCachePath()
+    // Desc: %LOCALAPPDATA%\DxCapsViewer\dxview.cache
+    //-----------------------------------------------------------------------------
+    BOOL GetCachePath(_Out_writes_(cchPath) CHAR* szPath, DWORD cchPath, BOOL fCreateDir)
+    {
+        DWORD cch = GetEnvironmentVariable("LOCALAPPDATA", szPath, cchPath);
+        if (!cch || cch >= cchPath)
+            return FALSE;
+
+        if (strcat_s(szPath, cchPath, "\\DxCapsViewer"))
+            return FALSE;
+
+        if (fCreateDir)
+            (void)CreateDirectory(szPath, nullptr);
+
+        return strcat_s(szPath, cchPath, "\\dxview.cache") == 0;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID CacheKeyAddFile(const CHAR* szPath)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA fad = {};
+        if (!GetFileAttributesEx(szPath, GetFileExInfoStandard, &fad))
+            fad = {};
+
+        CacheKeyAdd(&fad.ftLastWriteTime, sizeof(fad.ftLastWriteTime));
+        CacheKeyAdd(&fad.nFileSizeLow, sizeof(fad.nFileSizeLow));
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: CacheKeyFinish()
+    // Desc: Adds the runtime and dxview versions after the adapter parts
+    //-----------------------------------------------------------------------------
+    BOOL CacheKeyFinish()
+    {
+        if (!g_fKeyDone)
+        {
+            g_fKeyDone = TRUE;
+
+            CHAR szPath[MAX_PATH];
+            DWORD cch = GetModuleFileName(nullptr, szPath, MAX_PATH);
+            if (cch && cch < MAX_PATH)
+            {
+                CacheKeyAddFile(szPath);
+
+                CHAR* pchName = strrchr(szPath, '\\');
+                if (pchName)
+                {
+                    *pchName = 0;
+                    for (size_t i = 0; i < std::size(c_szAppLocalFiles); ++i)
+                    {
+                        CHAR szFile[MAX_PATH];
+                        sprintf_s(szFile, MAX_PATH, "%s\\%s", szPath, c_szAppLocalFiles[i]);
+                        CacheKeyAddFile(szFile);
+                    }
+                }
+            }
+
+            cch = GetSystemDirectory(szPath, MAX_PATH);
+            if (cch && cch < MAX_PATH)
+            {
+                for (size_t i = 0; i < std::size(c_szRuntimeFiles); ++i)
+                {
+                    CHAR szFile[MAX_PATH];
+                    sprintf_s(szFile, MAX_PATH, "%s\\%s", szPath, c_szRuntimeFiles[i]);
+                    CacheKeyAddFile(szFile);
+                }
+            }
+        }
+
+        return !g_key.fFailed && g_key.cb > 0;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: LoadSnapshot()
+    // Desc: Adds the nodes of a snapshot file to the tree. If pKey is set, the
+    //       snapshot must have been saved with that key. Returns FALSE without
+    //       having added any nodes if the file can't be used.
+    //-----------------------------------------------------------------------------
+    BOOL LoadSnapshot(LPCSTR szPath, const CACHEBLOB* pKey)
+    {
+        if (g_view.pBase)
+            return FALSE;
+
+        CACHEVIEW view = {};
+        const CACHEHEADER* pHeader = nullptr;
+        if (!MapSnapshot(szPath, &view, &pHeader))
+            return FALSE;
+
+        BOOL fMatch = !pKey || (pHeader->cbKey == pKey->cb
+            && memcmp(view.pBase + sizeof(CACHEHEADER), pKey->pb, pKey->cb) == 0);
+
+        // Validate all nodes before adding anything to the tree
+        if (!fMatch || !ValidateSnapshot(view, pHeader))
+        {
+            UnmapViewOfFile(view.pBase);
+            return FALSE;
+        }
+
+        g_view = view;
+
+        DWORD iNode = 0;
+        for (DWORD i = 0; i < pHeader->cRoots; ++i)
+            (void)ReadNode(view, &iNode, nullptr, TRUE, 0);
+
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: SaveSnapshot()
+    // Desc: Saves the nodes of the tree and their rows, except those marked
+    //       fNoSnapshot such as the Diagnostics node. Lazy nodes are expanded
+    //       first if fExpandLazy is set. Written to a temporary file first, so
+    //       a failed save never leaves a partial snapshot behind.
+    //-----------------------------------------------------------------------------
+    BOOL SaveSnapshot(LPCSTR szPath, const CACHEBLOB* pKey, BOOL fExpandLazy)
+    {
+        HCAPNODE hRoot = TVGetRoot();
+        if (!hRoot)
+            return FALSE;
+
+        CHAR szTemp[MAX_PATH];
+        if (sprintf_s(szTemp, MAX_PATH, "%s.tmp", szPath) < 0)
+            return FALSE;
+
+        CACHEBUILD build = {};
+        build.fExpandLazy = fExpandLazy;
+        CACHEHEADER header = {};
+        header.dwMagic = c_dwCacheMagic;
+        header.dwVersion = c_dwCacheVersion;
+        header.cbKey = (pKey) ? static_cast<DWORD>(pKey->cb) : 0;
+
+        BOOL fOK = TRUE;
+        for (HCAPNODE hNode = hRoot; hNode && fOK; hNode = hNode->pNext)
+        {
+            if (hNode->fNoSnapshot)
+                continue;
+
+            fOK = BuildNode(&build, hNode);
+            header.cRoots++;
+        }
+
+        auto pSink = (fOK) ? new (std::nothrow) OUTPUTSINK : nullptr;
+        HANDLE hFile = INVALID_HANDLE_VALUE;
+        if (pSink)
+        {
+            hFile = CreateFile(szTemp, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        }
+
+        fOK = (hFile != INVALID_HANDLE_VALUE);
+        if (fOK)
+        {
+            DWORD cbPad = (sizeof(DWORD) - header.cbKey % sizeof(DWORD)) % sizeof(DWORD);
+            header.cNodes = build.cNodes;
+            header.ibNodes = sizeof(CACHEHEADER) + header.cbKey + cbPad;
+            header.ibRows = header.ibNodes + static_cast<DWORD>(build.nodes.cb);
+            header.cbRows = static_cast<DWORD>(build.rows.cb);
+            header.ibStrings = header.ibRows + header.cbRows;
+            header.cbStrings = static_cast<DWORD>(build.strings.text.cb);
+
+            SinkInitFile(pSink, hFile);
+            SinkWrite(pSink, &header, sizeof(header));
+            if (pKey)
+                SinkWrite(pSink, pKey->pb, pKey->cb);
+            SinkFill(pSink, '\0', cbPad);
+            SinkWrite(pSink, build.nodes.pb, build.nodes.cb);
+            SinkWrite(pSink, build.rows.pb, build.rows.cb);
+            SinkWrite(pSink, build.strings.text.pb, build.strings.text.cb);
+
+            fOK = SinkFlush(pSink);
+            CloseHandle(hFile);
+
+            if (!fOK || !MoveFileEx(szTemp, szPath, MOVEFILE_REPLACE_EXISTING))
+            {
+                DeleteFile(szTemp);
+                fOK = FALSE;
+            }
+        }
+
+        delete pSink;
+        BlobFree(&build.nodes);
+        BlobFree(&build.rows);
+        BlobFree(&build.strings.text);
+        delete[] build.strings.pSlots;
+
+        return fOK;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: WalkNode()
+    // Desc: Passes the node at *piNode, its rows and its children to pWalker.
+    //       The snapshot must have been validated.
+    //-----------------------------------------------------------------------------
+    BOOL WalkNode(const CACHEVIEW& view, DWORD* piNode, UINT depth, const SNAPSHOTWALKER* pWalker)
+    {
+        const CACHENODE* pNode = &view.pNodes[(*piNode)++];
+        pWalker->fnNode(pWalker->rows.pContext, depth, ViewString(view, pNode->ibText));
+
+        if (pNode->dwFlags & NODE_ROWS)
+        {
+            PRINTCBINFO pci = {};
+            pci.pEmitter = &pWalker->rows;
+            if (FAILED(ReplayRows(view, pNode->idwRows[c_fullVariant], &pci, TRUE)))
+                return FALSE;
+        }
+
+        for (DWORD i = 0; i < pNode->cChildren; ++i)
+        {
+            if (!WalkNode(view, piNode, depth + 1, pWalker))
+                return FALSE;
+        }
+
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Snapshot diff
+    //
+    // Siblings are paired by their text and rows by their first cell, through
+    // a hash of the new side, so the walk is linear in the size of the two
+    // snapshots. Repeated keys pair up in order. Rows are compared as saved
+    // for c_fullVariant.
+    //-----------------------------------------------------------------------------
+    constexpr DWORD c_noMatch = 0xFFFFFFFF;
+
+    // One mapped and validated snapshot
+    struct DIFFSIDE
+    {
+        CACHEVIEW           view;
+        const CACHEHEADER*  pHeader;
+        DWORD*              pNext;      // Index of each node's next sibling
+    };
+
+    // Rows of one node, decoded from a snapshot
+    struct DIFFROWS
+    {
+        const CHAR*     strColumns[c_maxEmitColumns];
+        ROWEMITTER      listEmitter;
+        ROWLIST         list;
+    };
+
+    struct DIFFREPORT
+    {
+        OUTPUTSINK      sink;
+        BOOL            fJson;
+        BOOL            fFirst;                         // No change written yet
+        const CHAR*     strPath[c_maxCacheDepth + 1];
+        UINT            cPath;
+        DWORD           cChanges;
+    };
+
+
+    //-----------------------------------------------------------------------------
+    // Name: LinkSiblings()
+    // Desc: Sets pNext for the node at iNode and its subtree. Returns the index
+    //       past the subtree, which is the node's next sibling.
+    //-----------------------------------------------------------------------------
+    DWORD LinkSiblings(const CACHEVIEW& view, DWORD iNode, DWORD* pNext)
+    {
+        DWORD iChild = iNode + 1;
+        for (DWORD i = 0; i < view.pNodes[iNode].cChildren; ++i)
+            iChild = LinkSiblings(view, iChild, pNext);
+
+        pNext[iNode] = iChild;
+        return iChild;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID CloseDiffSide(DIFFSIDE* pSide)
+    {
+        if (pSide->view.pBase)
+            UnmapViewOfFile(pSide->view.pBase);
+        delete[] pSide->pNext;
+        *pSide = {};
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: OpenDiffSide()
+    // Desc: Maps a snapshot, validates it and links its siblings
+    //-----------------------------------------------------------------------------
+    BOOL OpenDiffSide(LPCSTR szPath, DIFFSIDE* pSide)
+    {
+        *pSide = {};
+        if (!szPath || !*szPath || !MapSnapshot(szPath, &pSide->view, &pSide->pHeader))
+            return FALSE;
+
+        if (ValidateSnapshot(pSide->view, pSide->pHeader))
+            pSide->pNext = new (std::nothrow) DWORD[pSide->view.cNodes];
+
+        if (!pSide->pNext)
+        {
+            CloseDiffSide(pSide);
+            return FALSE;
+        }
+
+        DWORD iNode = 0;
+        for (DWORD i = 0; i < pSide->pHeader->cRoots; ++i)
+            iNode = LinkSiblings(pSide->view, iNode, pSide->pNext);
+
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: MatchKeys()
+    // Desc: Pairs equal keys of two lists. pMatchA[i] is the index in B of A's
+    //       key i, pMatchB[j] the index in A of B's key j, or c_noMatch.
+    //-----------------------------------------------------------------------------
+    BOOL MatchKeys(const CHAR* const* pKeysA, DWORD cA, const CHAR* const* pKeysB, DWORD cB,
+        DWORD* pMatchA, DWORD* pMatchB)
+    {
+        for (DWORD i = 0; i < cA; ++i)
+            pMatchA[i] = c_noMatch;
+        for (DWORD j = 0; j < cB; ++j)
+            pMatchB[j] = c_noMatch;
+
+        if (!cA || !cB)
+            return TRUE;
+
+        // Open addressing, slots hold index + 1 and 0 is empty. Keys of B are
+        // inserted in order, so repeated keys are found in order as well.
+        DWORD cSlots = 16;
+        while (cSlots < cB * 2)
+            cSlots *= 2;
+
+        auto pSlots = new (std::nothrow) DWORD[cSlots];
+        if (!pSlots)
+            return FALSE;
+        memset(pSlots, 0, cSlots * sizeof(DWORD));
+
+        DWORD mask = cSlots - 1;
+        for (DWORD j = 0; j < cB; ++j)
+        {
+            DWORD iSlot = HashString(pKeysB[j]) & mask;
+            while (pSlots[iSlot])
+                iSlot = (iSlot + 1) & mask;
+            pSlots[iSlot] = j + 1;
+        }
+
+        for (DWORD i = 0; i < cA; ++i)
+        {
+            for (DWORD iSlot = HashString(pKeysA[i]) & mask; pSlots[iSlot]; iSlot = (iSlot + 1) & mask)
+            {
+                DWORD j = pSlots[iSlot] - 1;
+                if (pMatchB[j] == c_noMatch && strcmp(pKeysA[i], pKeysB[j]) == 0)
+                {
+                    pMatchA[i] = j;
+                    pMatchB[j] = i;
+                    break;
+                }
+            }
+        }
+
+        delete[] pSlots;
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    HRESULT DiffEmitColumn(void* pContext, int iCol, const CHAR* strName, int /*width*/)
+    {
+        auto pRows = static_cast<DIFFROWS*>(pContext);
+        if (iCol >= 0 && iCol < static_cast<int>(c_maxEmitColumns))
+            pRows->strColumns[iCol] = strName;
+        return S_OK;
+    }
+
+
+    HRESULT DiffEmitRow(void* pContext, UINT cCells, const ROWCELL* pCells)
+    {
+        auto pRows = static_cast<DIFFROWS*>(pContext);
+        return pRows->listEmitter.fnRow(pRows->listEmitter.pContext, cCells, pCells);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: ReadDiffRows()
+    // Desc: Decodes the rows of a node. pRows must be freed with RowListFree.
+    //-----------------------------------------------------------------------------
+    BOOL ReadDiffRows(const CACHEVIEW& view, const CACHENODE* pNode, DIFFROWS* pRows)
+    {
+        *pRows = {};
+        RowListInit(&pRows->listEmitter, &pRows->list);
+
+        if (!(pNode->dwFlags & NODE_ROWS))
+            return TRUE;
+
+        const ROWEMITTER emitter = { DiffEmitColumn, DiffEmitRow, pRows };
+        PRINTCBINFO pci = {};
+        pci.pEmitter = &emitter;
+
+        return SUCCEEDED(ReplayRows(view, pNode->idwRows[c_fullVariant], &pci, TRUE));
+    }
+
+
+    //-----------------------------------------------------------------------------
+    const CHAR* RowKey(const ROWRECORD* pRecord)
+    {
+        // Rows that don't start with a name pair up in order
+        return (pRecord->cells[0].type == CELL_TEXT && pRecord->cells[0].str) ? pRecord->cells[0].str : "";
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID ReportWrite(DIFFREPORT* pReport, const CHAR* str)
+    {
+        SinkWrite(&pReport->sink, str, strlen(str));
+    }
+
+
+    VOID ReportJsonString(DIFFREPORT* pReport, const CHAR* str)
+    {
+        SinkWriteJsonString(&pReport->sink, str, strlen(str));
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: ReportChange()
+    // Desc: Writes one change of the node at the current path. chOp is '-' for
+    //       removed, '+' for added and '~' for changed. strRow is set for rows,
+    //       strOld and strNew for changed cells, whose strColumn is optional.
+    //-----------------------------------------------------------------------------
+    VOID ReportChange(DIFFREPORT* pReport, CHAR chOp, const CHAR* strRow,
+        const CHAR* strColumn, const CHAR* strOld, const CHAR* strNew)
+    {
+        pReport->cChanges++;
+
+        if (pReport->fJson)
+        {
+            ReportWrite(pReport, (pReport->fFirst) ? "\r\n{\"op\":\"" : ",\r\n{\"op\":\"");
+            pReport->fFirst = FALSE;
+
+            ReportWrite(pReport, (chOp == '-') ? "removed" : (chOp == '+') ? "added" : "changed");
+            ReportWrite(pReport, "\",\"path\":[");
+            for (UINT i = 0; i < pReport->cPath; ++i)
+            {
+                if (i)
+                    ReportWrite(pReport, ",");
+                ReportJsonString(pReport, pReport->strPath[i]);
+            }
+            ReportWrite(pReport, "]");
+
+            if (strRow)
+            {
+                ReportWrite(pReport, ",\"row\":");
+                ReportJsonString(pReport, strRow);
+            }
+
+            if (strColumn)
+            {
+                ReportWrite(pReport, ",\"column\":");
+                ReportJsonString(pReport, strColumn);
+            }
+
+            if (strOld && strNew)
+            {
+                ReportWrite(pReport, ",\"old\":");
+                ReportJsonString(pReport, strOld);
+                ReportWrite(pReport, ",\"new\":");
+                ReportJsonString(pReport, strNew);
+            }
+
+            ReportWrite(pReport, "}");
+            return;
+        }
+
+        const CHAR szOp[3] = { chOp, ' ', '\0' };
+        ReportWrite(pReport, szOp);
+
+        for (UINT i = 0; i < pReport->cPath; ++i)
+        {
+            if (i)
+                ReportWrite(pReport, " > ");
+            ReportWrite(pReport, pReport->strPath[i]);
+        }
+
+        if (strRow)
+        {
+            ReportWrite(pReport, " | ");
+            ReportWrite(pReport, strRow);
+        }
+
+        if (strOld && strNew)
+        {
+            ReportWrite(pReport, " | ");
+            if (strColumn)
+            {
+                ReportWrite(pReport, strColumn);
+                ReportWrite(pReport, ": ");
+            }
+            ReportWrite(pReport, strOld);
+            ReportWrite(pReport, " -> ");
+            ReportWrite(pReport, strNew);
+        }
+
+        ReportWrite(pReport, "\r\n");
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: DiffCells()
+    // Desc: Reports the cells that differ between two rows with the same key
+    //-----------------------------------------------------------------------------
+    VOID DiffCells(DIFFREPORT* pReport, const DIFFROWS& rowsB, const ROWRECORD* pRowA, const ROWRECORD* pRowB)
+    {
+        const ROWCELL empty = { CELL_TEXT, "", 0 };
+        UINT cCells = (pRowA->cCells > pRowB->cCells) ? pRowA->cCells : pRowB->cCells;
+
+        for (UINT i = 0; i < cCells; ++i)
+        {
+            const ROWCELL* pCellA = (i < pRowA->cCells) ? &pRowA->cells[i] : &empty;
+            const ROWCELL* pCellB = (i < pRowB->cCells) ? &pRowB->cells[i] : &empty;
+
+            CHAR szOld[c_cchRowCell];
+            CHAR szNew[c_cchRowCell];
+            const CHAR* strOld = RowCellText(pCellA, szOld);
+            const CHAR* strNew = RowCellText(pCellB, szNew);
+            if (strcmp(strOld, strNew) == 0)
+                continue;
+
+            // Name/value rows have no column names, tables name every column
+            CHAR szColumn[16];
+            const CHAR* strColumn = (i < c_maxEmitColumns) ? rowsB.strColumns[i] : nullptr;
+            if (!strColumn && cCells > 2)
+            {
+                sprintf_s(szColumn, "#%u", i);
+                strColumn = szColumn;
+            }
+
+            ReportChange(pReport, '~', RowKey(pRowB), strColumn, strOld, strNew);
+        }
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: DiffRows()
+    // Desc: Reports the rows of a node that were removed, added or changed
+    //-----------------------------------------------------------------------------
+    BOOL DiffRows(DIFFREPORT* pReport, const DIFFSIDE& a, const CACHENODE* pNodeA,
+        const DIFFSIDE& b, const CACHENODE* pNodeB)
+    {
+        DIFFROWS rowsA;
+        DIFFROWS rowsB;
+        BOOL fOK = ReadDiffRows(a.view, pNodeA, &rowsA);
+        fOK = ReadDiffRows(b.view, pNodeB, &rowsB) && fOK;
+
+        DWORD cA = rowsA.list.cRows;
+        DWORD cB = rowsB.list.cRows;
+        auto ppRows = (fOK) ? new (std::nothrow) const ROWRECORD*[cA + cB + 1] : nullptr;
+        auto ppKeys = (fOK) ? new (std::nothrow) const CHAR*[cA + cB + 1] : nullptr;
+        auto pMatch = (fOK) ? new (std::nothrow) DWORD[cA + cB + 1] : nullptr;
+
+        fOK = (ppRows && ppKeys && pMatch);
+        if (fOK)
+        {
+            DWORD n = 0;
+            for (const ROWRECORD* pRecord = rowsA.list.pFirst; pRecord; pRecord = pRecord->pNext, ++n)
+            {
+                ppRows[n] = pRecord;
+                ppKeys[n] = RowKey(pRecord);
+            }
+            for (const ROWRECORD* pRecord = rowsB.list.pFirst; pRecord; pRecord = pRecord->pNext, ++n)
+            {
+                ppRows[n] = pRecord;
+                ppKeys[n] = RowKey(pRecord);
+            }
+
+            fOK = MatchKeys(ppKeys, cA, ppKeys + cA, cB, pMatch, pMatch + cA);
+        }
+
+        if (fOK)
+        {
+            for (DWORD i = 0; i < cA; ++i)
+            {
+                if (pMatch[i] == c_noMatch)
+                    ReportChange(pReport, '-', ppKeys[i], nullptr, nullptr, nullptr);
+                else
+                    DiffCells(pReport, rowsB, ppRows[i], ppRows[cA + pMatch[i]]);
+            }
+
+            for (DWORD j = 0; j < cB; ++j)
+            {
+                if (pMatch[cA + j] == c_noMatch)
+                    ReportChange(pReport, '+', ppKeys[cA + j], nullptr, nullptr, nullptr);
+            }
+        }
+
+        delete[] ppRows;
+        delete[] ppKeys;
+        delete[] pMatch;
+        RowListFree(&rowsA.list);
+        RowListFree(&rowsB.list);
+
+        return fOK;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: DiffChildren()
+    // Desc: Pairs up the cA siblings starting at iFirstA with the cB starting at
+    //       iFirstB, and reports the differences of each pair
+    //-----------------------------------------------------------------------------
+    BOOL DiffChildren(DIFFREPORT* pReport, const DIFFSIDE& a, DWORD iFirstA, DWORD cA,
+        const DIFFSIDE& b, DWORD iFirstB, DWORD cB)
+    {
+        if (!cA && !cB)
+            return TRUE;
+
+        // Node indices of A then B, followed by the matches of A then B
+        auto pIndex = new (std::nothrow) DWORD[(cA + cB) * 2];
+        auto ppKeys = new (std::nothrow) const CHAR*[cA + cB];
+
+        BOOL fOK = (pIndex && ppKeys);
+        if (fOK)
+        {
+            DWORD iNode = iFirstA;
+            for (DWORD i = 0; i < cA; ++i, iNode = a.pNext[iNode])
+            {
+                pIndex[i] = iNode;
+                ppKeys[i] = ViewString(a.view, a.view.pNodes[iNode].ibText);
+            }
+
+            iNode = iFirstB;
+            for (DWORD j = 0; j < cB; ++j, iNode = b.pNext[iNode])
+            {
+                pIndex[cA + j] = iNode;
+                ppKeys[cA + j] = ViewString(b.view, b.view.pNodes[iNode].ibText);
+            }
+
+            fOK = MatchKeys(ppKeys, cA, ppKeys + cA, cB, pIndex + cA + cB, pIndex + cA + cB + cA);
+        }
+
+        const DWORD* pMatch = (pIndex) ? pIndex + cA + cB : nullptr;
+        UINT iPath = pReport->cPath++;
+
+        for (DWORD i = 0; i < cA && fOK; ++i)
+        {
+            pReport->strPath[iPath] = ppKeys[i];
+            if (pMatch[i] == c_noMatch)
+            {
+                ReportChange(pReport, '-', nullptr, nullptr, nullptr, nullptr);
+                continue;
+            }
+
+            const CACHENODE* pNodeA = &a.view.pNodes[pIndex[i]];
+            const CACHENODE* pNodeB = &b.view.pNodes[pIndex[cA + pMatch[i]]];
+
+            fOK = DiffRows(pReport, a, pNodeA, b, pNodeB)
+                && DiffChildren(pReport, a, pIndex[i] + 1, pNodeA->cChildren,
+                    b, pIndex[cA + pMatch[i]] + 1, pNodeB->cChildren);
+        }
+
+        for (DWORD j = 0; j < cB && fOK; ++j)
+        {
+            if (pMatch[cA + j] == c_noMatch)
+            {
+                pReport->strPath[iPath] = ppKeys[cA + j];
+                ReportChange(pReport, '+', nullptr, nullptr, nullptr, nullptr);
+            }
+        }
+
+        pReport->cPath--;
+
+        delete[] pIndex;
+        delete[] ppKeys;
+
+        return fOK;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: CacheKeyAdd()
+// Desc: Adds data the cached snapshot depends on to the cache key
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+VOID CacheKeyAdd(const void* pData, size_t cbData)
+{
+    BlobWrite(&g_key, pData, cbData);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: CacheLoad()
+// Desc: Adds the cached snapshot to the tree if its key matches. Returns FALSE
+//       if there is no usable snapshot, without having added any nodes.
+//-----------------------------------------------------------------------------
+BOOL CacheLoad()
+{
+    // A recording needs the driver's answers, not a snapshot
+    if (MockIsRecording())
+        return FALSE;
+
+    TRACESCOPE trace("CacheLoad");
+    CHAR szPath[MAX_PATH];
+    if (!CacheKeyFinish() || !GetCachePath(szPath, MAX_PATH, FALSE))
+        return FALSE;
+
+    return LoadSnapshot(szPath, &g_key);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: CacheSave()
+// Desc: Saves all top-level nodes of the tree, and their rows, as the
+//       snapshot for the current cache key
+//-----------------------------------------------------------------------------
+VOID CacheSave()
+{
+    // Part of a recording's tree is answered through the mock objects, so it
+    // must not be reused for the real devices
+    if (MockIsRecording())
+        return;
+
+    TRACESCOPE trace("CacheSave");
+    CHAR szPath[MAX_PATH];
+    if (!CacheKeyFinish() || !GetCachePath(szPath, MAX_PATH, TRUE))
+        return;
+
+    (void)SaveSnapshot(szPath, &g_key, FALSE);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: CacheOpenSnapshot()
+// Desc: Builds the tree from a snapshot saved by CacheSaveSnapshot(),
+//       typically on another machine. Nothing is probed.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+BOOL CacheOpenSnapshot(LPCSTR szPath)
+{
+    if (!szPath || !*szPath)
+        return FALSE;
+
+    return LoadSnapshot(szPath, nullptr);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: CacheSaveSnapshot()
+// Desc: Saves the whole tree as a snapshot for CacheOpenSnapshot()
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+BOOL CacheSaveSnapshot(LPCSTR szPath)
+{
+    if (!szPath || !*szPath)
+        return FALSE;
+
+    return SaveSnapshot(szPath, nullptr, TRUE);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: CacheFree()
+// Desc: Releases the loaded snapshot. Call after the tree is freed.
+//-----------------------------------------------------------------------------
+VOID CacheFree()
+{
+    if (g_view.pBase)
+        UnmapViewOfFile(g_view.pBase);
+    g_view = {};
+
+    BlobFree(&g_key);
+    g_fKeyDone = FALSE;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: CacheWalkSnapshot()
+// Desc: Passes every node of a snapshot file to pWalker in preorder, each
+//       followed by its rows as saved for View All with 9Ex caps. Nothing is
+//       passed if the file isn't a valid snapshot.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+BOOL CacheWalkSnapshot(LPCSTR szPath, const SNAPSHOTWALKER* pWalker)
+{
+    CACHEVIEW view = {};
+    const CACHEHEADER* pHeader = nullptr;
+    if (!szPath || !*szPath || !MapSnapshot(szPath, &view, &pHeader))
+        return FALSE;
+
+    BOOL fOK = ValidateSnapshot(view, pHeader);
+
+    DWORD iNode = 0;
+    for (DWORD i = 0; i < pHeader->cRoots && fOK; ++i)
+        fOK = WalkNode(view, &iNode, 0, pWalker);
+
+    UnmapViewOfFile(view.pBase);
+    return fOK;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: CacheDiffSnapshots()
+// Desc: Writes the differences between two snapshots to szReport, as text or
+//       JSON. Returns S_OK if they match and S_FALSE if anything changed.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT CacheDiffSnapshots(LPCSTR szOld, LPCSTR szNew, LPCSTR szReport, BOOL fJson)
+{
+    if (!szReport || !*szReport)
+        return E_INVALIDARG;
+
+    DIFFSIDE a;
+    DIFFSIDE b;
+    BOOL fOK = OpenDiffSide(szOld, &a);
+    fOK = OpenDiffSide(szNew, &b) && fOK;
+
+    auto pReport = (fOK) ? new (std::nothrow) DIFFREPORT : nullptr;
+    HANDLE hFile = INVALID_HANDLE_VALUE;
+    if (pReport)
+    {
+        hFile = CreateFile(szReport, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    }
+
+    fOK = (hFile != INVALID_HANDLE_VALUE);
+    DWORD cChanges = 0;
+    if (fOK)
+    {
+        SinkInitFile(&pReport->sink, hFile);
+        pReport->fJson = fJson;
+        pReport->fFirst = TRUE;
+        pReport->cPath = 0;
+        pReport->cChanges = 0;
+
+        if (fJson)
+        {
+            ReportWrite(pReport, "{\"version\":1,\"old\":");
+            ReportJsonString(pReport, szOld);
+            ReportWrite(pReport, ",\"new\":");
+            ReportJsonString(pReport, szNew);
+            ReportWrite(pReport, ",\"changes\":[");
+        }
+        else
+        {
+            ReportWrite(pReport, "Old: ");
+            ReportWrite(pReport, szOld);
+            ReportWrite(pReport, "\r\nNew: ");
+            ReportWrite(pReport, szNew);
+            ReportWrite(pReport, "\r\n\r\n");
+        }
+
+        fOK = DiffChildren(pReport, a, 0, a.pHeader->cRoots, b, 0, b.pHeader->cRoots);
+        cChanges = pReport->cChanges;
+
+        if (fJson)
+        {
+            ReportWrite(pReport, "\r\n]}\r\n");
+        }
+        else
+        {
+            CHAR szCount[64];
+            sprintf_s(szCount, "\r\n%lu change(s)\r\n", cChanges);
+            ReportWrite(pReport, szCount);
+        }
+
+        fOK = SinkFlush(&pReport->sink) && fOK;
+        CloseHandle(hFile);
+
+        if (!fOK)
+            DeleteFile(szReport);
+    }
+
+    delete pReport;
+    CloseDiffSide(&a);
+    CloseDiffSide(&b);
+
+    if (!fOK)
+        return E_FAIL;
+
+    return (cChanges) ? S_FALSE : S_OK;
+}
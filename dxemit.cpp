@@ -0,0 +1,583 @@
+//-----------------------------------------------------------------------------
+// Name: dxemit.cpp
+//
+// Desc: DirectX Capabilities Viewer Row Emitter
+//
+//       Display callbacks describe their output once as rows of typed cells.
+//       The rows are rendered by the ListView, the printer/text file, or any
+//       ROWEMITTER (JSON export, RowListInit() for capturing in memory). The
+//       ListView is virtual and shows rows kept by the LVRows*() functions.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+struct ROWCHUNK
+{
+    ROWCHUNK*   pNext;
+    size_t      cb;             // Of data
+    size_t      cbUsed;
+    alignas(8) BYTE data[1];
+};
+
+extern HRESULT Int2Str(_Out_writes_bytes_(nDestLen) LPTSTR pszDest, UINT nDestLen, DWORD i);
+
+extern DWORD g_dwViewState;
+extern DWORD g_dwView9Ex;
+extern const char c_szYes[];
+extern const char c_szNo[];
+extern const char c_szNA[];
+
+namespace
+{
+    //-----------------------------------------------------------------------------
+    HRESULT PrintEmitRow(PRINTCBINFO* pInfo, UINT cCells, const ROWCELL* pCells)
+    {
+        CHAR szBuff[c_cchRowCell];
+
+        switch (cCells)
+        {
+        case 0:
+            return S_OK;
+
+        case 1:
+            return PrintStringLine(RowCellText(&pCells[0], szBuff), pInfo);
+
+        case 2:
+            return PrintStringValueLine(pCells[0].str ? pCells[0].str : "", RowCellText(&pCells[1], szBuff), pInfo);
+
+        default:
+            break;
+        }
+
+        // Tables are laid out using the widths passed to EmitColumn
+        int x = static_cast<int>(pInfo->dwCurrIndent * DEF_TAB_SIZE * pInfo->dwCharWidth);
+        int yLine = static_cast<int>(pInfo->dwCurrLine * pInfo->dwLineHeight);
+        for (UINT i = 0; i < cCells; ++i)
+        {
+            const CHAR* str = RowCellText(&pCells[i], szBuff);
+            if (FAILED(PrintLine(x, yLine, str, strlen(str), pInfo)))
+                return E_FAIL;
+
+            DWORD dwWidth = (i < c_maxEmitColumns && pInfo->dwColWidth[i]) ? pInfo->dwColWidth[i] : c_DefNameLength;
+            x += static_cast<int>(dwWidth * pInfo->dwCharWidth);
+        }
+
+        return PrintNextLine(pInfo);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // In-memory backend
+    //
+    // Records are carved from the chunks of their ROWLIST, the way the tree's
+    // nodes come from a NODEARENA, and go away with it in RowListFree().
+    //-----------------------------------------------------------------------------
+    constexpr size_t c_cbRowChunk = 16 * 1024 - 64;
+    constexpr size_t c_cbRowAlign = 8;
+
+
+    void* RowListAlloc(ROWLIST* pList, size_t cb)
+    {
+        cb = (cb + c_cbRowAlign - 1) & ~(c_cbRowAlign - 1);
+
+        ROWCHUNK* pChunk = pList->pChunks;
+        if (!pChunk || pChunk->cb - pChunk->cbUsed < cb)
+        {
+            size_t cbData = (cb > c_cbRowChunk / 4) ? cb : c_cbRowChunk;
+            auto pb = new (std::nothrow) BYTE[offsetof(ROWCHUNK, data) + cbData];
+            if (!pb)
+                return nullptr;
+
+            pChunk = reinterpret_cast<ROWCHUNK*>(pb);
+            pChunk->cb = cbData;
+            pChunk->cbUsed = 0;
+
+            // A block with a chunk of its own goes behind the one being filled
+            if (cbData == c_cbRowChunk || !pList->pChunks)
+            {
+                pChunk->pNext = pList->pChunks;
+                pList->pChunks = pChunk;
+            }
+            else
+            {
+                pChunk->pNext = pList->pChunks->pNext;
+                pList->pChunks->pNext = pChunk;
+            }
+        }
+
+        void* pv = pChunk->data + pChunk->cbUsed;
+        pChunk->cbUsed += cb;
+        return pv;
+    }
+
+
+    const CHAR* RowListText(ROWLIST* pList, const CHAR* str)
+    {
+        size_t cch = strlen(str) + 1;
+        auto pText = static_cast<CHAR*>(RowListAlloc(pList, cch));
+        if (pText)
+            memcpy(pText, str, cch);
+        return pText;
+    }
+
+
+    HRESULT RowListColumn(void* /*pContext*/, int /*iCol*/, const CHAR* /*strName*/, int /*width*/)
+    {
+        return S_OK;
+    }
+
+
+    HRESULT RowListRow(void* pContext, UINT cCells, const ROWCELL* pCells)
+    {
+        auto pList = static_cast<ROWLIST*>(pContext);
+        if (!cCells)
+            return S_OK;
+
+        size_t cbText = 0;
+        for (UINT i = 0; i < cCells; ++i)
+        {
+            if (pCells[i].type == CELL_TEXT && pCells[i].str)
+                cbText += strlen(pCells[i].str) + 1;
+        }
+
+        size_t cbRecord = sizeof(ROWRECORD) + (cCells - 1) * sizeof(ROWCELL);
+        auto pRecord = static_cast<ROWRECORD*>(RowListAlloc(pList, cbRecord + cbText));
+        if (!pRecord)
+            return E_OUTOFMEMORY;
+
+        pRecord->pNext = nullptr;
+        pRecord->cCells = cCells;
+
+        CHAR* pText = reinterpret_cast<CHAR*>(pRecord) + cbRecord;
+        for (UINT i = 0; i < cCells; ++i)
+        {
+            pRecord->cells[i] = pCells[i];
+            if (pCells[i].type == CELL_TEXT && pCells[i].str)
+            {
+                size_t cch = strlen(pCells[i].str) + 1;
+                memcpy(pText, pCells[i].str, cch);
+                pRecord->cells[i].str = pText;
+                pText += cch;
+            }
+        }
+
+        if (pList->pLast)
+            pList->pLast->pNext = pRecord;
+        else
+            pList->pFirst = pRecord;
+        pList->pLast = pRecord;
+        pList->cRows++;
+
+        return S_OK;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // ListView backend
+    //
+    // The ListView is virtual (LVS_OWNERDATA): the rows of the selected node are
+    // captured here and the control asks for the text of the visible cells
+    // only, see LVRowsCellText(). The rows of each node stay until the view
+    // state changes, so selecting a node again does not run its callback.
+    //-----------------------------------------------------------------------------
+    struct LVKEPTCOLUMN
+    {
+        int         iCol;
+        const CHAR* strName;
+        int         width;
+    };
+
+    struct LVNODEROWS
+    {
+        LVNODEROWS* pNext;
+        HCAPNODE    hNode;
+        ROWLIST     rows;           // Also holds the column names and ppIndex
+        ROWRECORD** ppIndex;        // rows by position, once committed
+        UINT        cIndex;
+        BOOL        fCommitted;
+        BOOL        fKeep;          // FALSE if the columns did not fit
+        UINT        cColumns;
+        LVKEPTCOLUMN    columns[c_maxEmitColumns];
+    };
+
+    LVNODEROWS* s_pLVKept = nullptr;        // Rows of the nodes selected so far
+    LVNODEROWS  s_lvScratch = {};           // Rows of a node that are not kept
+    LVNODEROWS* s_pLVCurrent = nullptr;     // Rows the ListView shows
+    DWORD       s_dwLVViewState = 0;        // View state of the kept rows
+    DWORD       s_dwLVView9Ex = 0;
+
+
+    VOID LVFreeRows(LVNODEROWS* pRows)
+    {
+        RowListFree(&pRows->rows);
+        pRows->ppIndex = nullptr;
+        pRows->cIndex = 0;
+        pRows->fCommitted = FALSE;
+        pRows->fKeep = TRUE;
+        pRows->cColumns = 0;
+    }
+
+
+    LVNODEROWS* LVCurrentRows()
+    {
+        if (!s_pLVCurrent)
+        {
+            LVFreeRows(&s_lvScratch);
+            s_pLVCurrent = &s_lvScratch;
+        }
+        return s_pLVCurrent;
+    }
+
+
+    VOID LVEmitColumn(int iCol, const CHAR* strName, int width)
+    {
+        LVNODEROWS* pRows = LVCurrentRows();
+        const CHAR* strKept = (pRows->cColumns < c_maxEmitColumns) ? RowListText(&pRows->rows, strName) : nullptr;
+        if (strKept)
+        {
+            pRows->columns[pRows->cColumns++] = { iCol, strKept, width };
+        }
+        else
+        {
+            pRows->fKeep = FALSE;
+        }
+
+        LVAddColumn(g_hwndLV, iCol, strName, width);
+    }
+
+
+    HRESULT LVEmitRow(UINT cCells, const ROWCELL* pCells)
+    {
+        return RowListRow(&LVCurrentRows()->rows, cCells, pCells);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: EmitColumn()
+// Desc: Declares a column of the rows that follow
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT EmitColumn(PRINTCBINFO* pInfo, int iCol, const CHAR* strName, int width)
+{
+    if (!pInfo)
+    {
+        LVEmitColumn(iCol, strName, width);
+        return S_OK;
+    }
+
+    if (iCol >= 0 && iCol < static_cast<int>(c_maxEmitColumns))
+        pInfo->dwColWidth[iCol] = static_cast<DWORD>(width);
+
+    if (pInfo->pEmitter)
+        return pInfo->pEmitter->fnColumn(pInfo->pEmitter->pContext, iCol, strName, width);
+
+    return S_OK;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: EmitRow()
+// Desc: Emits one row of cells to the active backend
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT EmitRow(PRINTCBINFO* pInfo, UINT cCells, const ROWCELL* pCells)
+{
+    if (!pInfo)
+        return LVEmitRow(cCells, pCells);
+
+    if (pInfo->pEmitter)
+        return pInfo->pEmitter->fnRow(pInfo->pEmitter->pContext, cCells, pCells);
+
+    return PrintEmitRow(pInfo, cCells, pCells);
+}
+
+
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT EmitTextRow(PRINTCBINFO* pInfo, const CHAR* strName, const CHAR* strValue)
+{
+    const ROWCELL cells[2] = { { CELL_TEXT, strName, 0 }, { CELL_TEXT, strValue, 0 } };
+    return EmitRow(pInfo, 2, cells);
+}
+
+
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT EmitValueRow(PRINTCBINFO* pInfo, const CHAR* strName, DWORD dwValue)
+{
+    const ROWCELL cells[2] = { { CELL_TEXT, strName, 0 }, { CELL_UINT, nullptr, dwValue } };
+    return EmitRow(pInfo, 2, cells);
+}
+
+
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT EmitHexRow(PRINTCBINFO* pInfo, const CHAR* strName, DWORD dwValue)
+{
+    const ROWCELL cells[2] = { { CELL_TEXT, strName, 0 }, { CELL_HEX, nullptr, dwValue } };
+    return EmitRow(pInfo, 2, cells);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: EmitYesNoRow()
+// Desc: Emits a Yes/No row. The ListView leaves out "No" rows in the View
+//       Available state. The print, file and JSON exports keep them unless
+//       the caller sets pInfo->fAvailOnly.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT EmitYesNoRow(PRINTCBINFO* pInfo, const CHAR* strName, BOOL bValue)
+{
+    const BOOL fAvailOnly = (pInfo) ? pInfo->fAvailOnly : (g_dwViewState != IDM_VIEWALL);
+    if (fAvailOnly && !bValue)
+        return S_OK;
+
+    const ROWCELL cells[2] = { { CELL_TEXT, strName, 0 }, { CELL_BOOL, nullptr, (bValue) ? 1u : 0u } };
+    return EmitRow(pInfo, 2, cells);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: EmitLineRow()
+// Desc: Emits a name/value row. Values of c_szNo or c_szNA are only shown in
+//       the View All state, and are typed as such for the backends.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT EmitLineRow(PRINTCBINFO* pInfo, const CHAR* strName, const CHAR* strValue)
+{
+    if (strValue == c_szNA || strValue == c_szNo)
+    {
+        if (g_dwViewState != IDM_VIEWALL)
+            return S_OK;
+
+        if (strValue == c_szNo)
+            return EmitYesNoRow(pInfo, strName, FALSE);
+    }
+    else if (strValue == c_szYes)
+    {
+        return EmitYesNoRow(pInfo, strName, TRUE);
+    }
+
+    return EmitTextRow(pInfo, strName, strValue);
+}
+
+
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT EmitNoteRow(PRINTCBINFO* pInfo, const CHAR* strText)
+{
+    const ROWCELL cell = { CELL_TEXT, strText, 0 };
+    return EmitRow(pInfo, 1, &cell);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: RowListInit()
+// Desc: Sets up an emitter that captures rows into pList
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+VOID RowListInit(ROWEMITTER* pEmitter, ROWLIST* pList)
+{
+    *pList = {};
+
+    pEmitter->fnColumn = RowListColumn;
+    pEmitter->fnRow = RowListRow;
+    pEmitter->pContext = pList;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: RowListReplay()
+// Desc: Emits captured rows to another backend, so a probe can run once and
+//       feed any number of outputs
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT RowListReplay(const ROWLIST* pList, PRINTCBINFO* pInfo)
+{
+    for (const ROWRECORD* pRecord = pList->pFirst; pRecord; pRecord = pRecord->pNext)
+    {
+        HRESULT hr = EmitRow(pInfo, pRecord->cCells, pRecord->cells);
+        if (FAILED(hr))
+            return hr;
+    }
+
+    return S_OK;
+}
+
+
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+VOID RowListFree(ROWLIST* pList)
+{
+    ROWCHUNK* pChunk = pList->pChunks;
+    while (pChunk)
+    {
+        ROWCHUNK* pNext = pChunk->pNext;
+        delete[] reinterpret_cast<BYTE*>(pChunk);
+        pChunk = pNext;
+    }
+
+    *pList = {};
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: RowCellText()
+// Desc: Text form of a cell, as shown in the ListView and printouts
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+const CHAR* RowCellText(const ROWCELL* pCell, CHAR* szBuff)
+{
+    switch (pCell->type)
+    {
+    case CELL_UINT:
+        Int2Str(szBuff, c_cchRowCell, pCell->dwValue);
+        return szBuff;
+
+    case CELL_HEX:
+        sprintf_s(szBuff, c_cchRowCell, "0x%08x", pCell->dwValue);
+        return szBuff;
+
+    case CELL_BOOL:
+        return (pCell->dwValue) ? c_szYes : c_szNo;
+
+    default:
+        return (pCell->str) ? pCell->str : "";
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: LVRowsReset()
+// Desc: Drops the rows shown in the ListView, and those kept for other nodes
+//-----------------------------------------------------------------------------
+VOID LVRowsReset()
+{
+    LVNODEROWS* pRows = s_pLVKept;
+    while (pRows)
+    {
+        LVNODEROWS* pNext = pRows->pNext;
+        RowListFree(&pRows->rows);
+        delete pRows;
+        pRows = pNext;
+    }
+    s_pLVKept = nullptr;
+
+    LVFreeRows(&s_lvScratch);
+    s_pLVCurrent = nullptr;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: LVRowsSelect()
+// Desc: Makes the rows of hNode the ones the ListView shows. Returns TRUE if
+//       rows committed for it before were kept, in which case their columns
+//       are added back and the display callback need not run. Otherwise the
+//       callback's rows are captured until LVRowsCommit().
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+BOOL LVRowsSelect(HCAPNODE hNode)
+{
+    if (s_dwLVViewState != g_dwViewState || s_dwLVView9Ex != g_dwView9Ex)
+    {
+        LVRowsReset();
+        s_dwLVViewState = g_dwViewState;
+        s_dwLVView9Ex = g_dwView9Ex;
+    }
+
+    s_pLVCurrent = nullptr;
+
+    if (!hNode)
+        return FALSE;
+
+    // Nodes that show the state of this run, and those under them, are asked
+    // again each time
+    for (HCAPNODE hUp = hNode; hUp; hUp = hUp->pParent)
+    {
+        if (hUp->fNoSnapshot)
+            return FALSE;
+    }
+
+    LVNODEROWS* pRows = s_pLVKept;
+    while (pRows && pRows->hNode != hNode)
+        pRows = pRows->pNext;
+
+    if (pRows && pRows->fCommitted)
+    {
+        for (UINT i = 0; i < pRows->cColumns; ++i)
+            LVAddColumn(g_hwndLV, pRows->columns[i].iCol, pRows->columns[i].strName, pRows->columns[i].width);
+
+        s_pLVCurrent = pRows;
+        return TRUE;
+    }
+
+    if (pRows)
+    {
+        LVFreeRows(pRows);
+    }
+    else
+    {
+        pRows = new (std::nothrow) LVNODEROWS{};
+        if (!pRows)
+            return FALSE;
+
+        pRows->hNode = hNode;
+        pRows->fKeep = TRUE;
+        pRows->pNext = s_pLVKept;
+        s_pLVKept = pRows;
+    }
+
+    s_pLVCurrent = pRows;
+    return FALSE;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: LVRowsCommit()
+// Desc: Indexes the rows emitted to the ListView since LVRowsSelect(), and
+//       returns the number of items the ListView should show
+//-----------------------------------------------------------------------------
+UINT LVRowsCommit()
+{
+    LVNODEROWS* pRows = LVCurrentRows();
+    if (pRows->fCommitted)
+        return pRows->cIndex;
+
+    UINT cRows = pRows->rows.cRows;
+    pRows->ppIndex = (cRows) ? static_cast<ROWRECORD**>(RowListAlloc(&pRows->rows, cRows * sizeof(ROWRECORD*))) : nullptr;
+    if (cRows && !pRows->ppIndex)
+        return 0;
+
+    pRows->cIndex = 0;
+    for (ROWRECORD* pRecord = pRows->rows.pFirst; pRecord; pRecord = pRecord->pNext)
+        pRows->ppIndex[pRows->cIndex++] = pRecord;
+
+    // Rows whose columns could not all be kept are built again next time
+    pRows->fCommitted = pRows->fKeep;
+    return pRows->cIndex;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: LVRowsCellText()
+// Desc: Text of a ListView cell, for LVN_GETDISPINFO. Cells past the end of
+//       a row are empty.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+const CHAR* LVRowsCellText(int iRow, int iCol, CHAR* szBuff)
+{
+    const LVNODEROWS* pRows = s_pLVCurrent;
+    if (!pRows || iRow < 0 || static_cast<UINT>(iRow) >= pRows->cIndex || iCol < 0)
+        return "";
+
+    const ROWRECORD* pRecord = pRows->ppIndex[iRow];
+    if (static_cast<UINT>(iCol) >= pRecord->cCells)
+        return "";
+
+    return RowCellText(&pRecord->cells[iCol], szBuff);
+}
@@ -0,0 +1,760 @@
+//-----------------------------------------------------------------------------
+// Name: dxfleet.cpp
+//
+// Desc: DirectX Capabilities Viewer fleet aggregation
+//
+//       Rolls a directory of snapshots, typically one per machine, up into a
+//       support matrix: for every group of adapters and every feature, how
+//       many adapters report each value. Text logs (dxview.log) are read
+//       as well, see dxlog.cpp.
+//
+//       Adapters are the nodes with VendorId and DeviceId rows. They are
+//       grouped by "VendorId:DeviceId driver version", and all of them are
+//       counted again in the "*" group. A feature is a row below an adapter,
+//       named by its path from the adapter and the row's name, plus the
+//       column for tables, e.g.
+//
+//          Direct3D 11 > Direct3D 11.1 > 8x MSAA (most required) | R16G16B16A16_FLOAT
+//
+//       Snapshots are read on the thread pool. Each worker counts into its
+//       own table, and the tables are merged once all files are read.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+#include <cstdlib>
+
+namespace
+{
+    constexpr UINT  c_maxFleetWorkers = 64;
+    constexpr UINT  c_maxFleetDepth = 64;
+    constexpr UINT  c_noAdapter = 0xFFFFFFFF;
+    constexpr DWORD c_cbFleetChunk = 64 * 1024;
+    constexpr size_t c_cchFleetKey = 1024;
+
+    const CHAR c_szAllAdapters[] = "*";
+
+    // Number of adapters of a group that report a value for a feature. The
+    // adapter count of the group itself has an empty feature and value.
+    struct FLEETCOUNT
+    {
+        FLEETCOUNT* pNext;          // Hash chain
+        DWORD       dwHash;
+        DWORD       cCount;
+        DWORD       ichFeature;     // Offsets into key
+        DWORD       ichValue;
+        DWORD       cbKey;
+        CHAR        key[1];         // Group, feature and value, each NUL terminated
+    };
+
+    struct FLEETTABLE
+    {
+        FLEETCOUNT**    ppSlots;
+        DWORD           cSlots;
+        DWORD           cCounts;
+        BYTE*           pChunk;     // Counts are carved from chunks, which start with a link to the previous one
+        DWORD           cbChunkUsed;
+        BOOL            fFailed;
+    };
+
+    // Counts of one worker, and the state of the snapshot it is walking
+    struct FLEETWORKER
+    {
+        FLEETTABLE      table;
+        DWORD           cSnapshots;
+        DWORD           cSkipped;
+
+        const CHAR*     strPath[c_maxFleetDepth];
+        const CHAR*     strColumns[c_maxEmitColumns];
+        UINT            depth;          // Of the node whose rows come next
+        UINT            adapterDepth;   // c_noAdapter outside of adapters
+        BOOL            fVendorId;      // Identity rows of the current node
+        BOOL            fDeviceId;
+        DWORD           dwVendorId;
+        DWORD           dwDeviceId;
+        CHAR            strDriver[32];
+        CHAR            strGroup[64];
+    };
+
+    struct FLEETJOB
+    {
+        const CHAR*     szDir;
+        const CHAR*     pNames;         // File names, NUL terminated
+        const DWORD*    pichNames;
+        LONG            cNames;
+        volatile LONG   iNext;          // Next file to read
+        volatile LONG   cWorkers;       // Workers that have started
+        FLEETWORKER*    pWorkers;
+    };
+
+
+    //-----------------------------------------------------------------------------
+    DWORD HashKey(const CHAR* pch, DWORD cb)
+    {
+        DWORD dwHash = 2166136261u;
+        for (DWORD i = 0; i < cb; ++i)
+            dwHash = (dwHash ^ static_cast<BYTE>(pch[i])) * 16777619u;
+        return dwHash;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    BOOL GrowTable(FLEETTABLE* pTable)
+    {
+        DWORD cSlots = (pTable->cSlots) ? pTable->cSlots * 2 : 4096;
+        auto ppSlots = new (std::nothrow) FLEETCOUNT*[cSlots];
+        if (!ppSlots)
+            return FALSE;
+        memset(ppSlots, 0, cSlots * sizeof(FLEETCOUNT*));
+
+        for (DWORD i = 0; i < pTable->cSlots; ++i)
+        {
+            FLEETCOUNT* pCount = pTable->ppSlots[i];
+            while (pCount)
+            {
+                FLEETCOUNT* pNext = pCount->pNext;
+                FLEETCOUNT** ppSlot = &ppSlots[pCount->dwHash & (cSlots - 1)];
+                pCount->pNext = *ppSlot;
+                *ppSlot = pCount;
+                pCount = pNext;
+            }
+        }
+
+        delete[] pTable->ppSlots;
+        pTable->ppSlots = ppSlots;
+        pTable->cSlots = cSlots;
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    FLEETCOUNT* AllocCount(FLEETTABLE* pTable, DWORD cbKey)
+    {
+        DWORD cb = static_cast<DWORD>(sizeof(FLEETCOUNT)) + cbKey;
+        cb = (cb + sizeof(void*) - 1) & ~static_cast<DWORD>(sizeof(void*) - 1);
+        if (cb > c_cbFleetChunk - sizeof(BYTE*))
+            return nullptr;
+
+        if (!pTable->pChunk || pTable->cbChunkUsed + cb > c_cbFleetChunk)
+        {
+            auto pChunk = new (std::nothrow) BYTE[c_cbFleetChunk];
+            if (!pChunk)
+                return nullptr;
+
+            *reinterpret_cast<BYTE**>(pChunk) = pTable->pChunk;
+            pTable->pChunk = pChunk;
+            pTable->cbChunkUsed = sizeof(BYTE*);
+        }
+
+        auto pCount = reinterpret_cast<FLEETCOUNT*>(pTable->pChunk + pTable->cbChunkUsed);
+        pTable->cbChunkUsed += cb;
+        return pCount;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: AddCount()
+    // Desc: Adds cCount to the count of a group, feature and value
+    //-----------------------------------------------------------------------------
+    VOID AddCount(FLEETTABLE* pTable, const CHAR* strGroup, const CHAR* strFeature, const CHAR* strValue, DWORD cCount)
+    {
+        if (pTable->fFailed)
+            return;
+
+        CHAR key[c_cchFleetKey * 3];
+        size_t cchGroup = strlen(strGroup) + 1;
+        size_t cchFeature = strlen(strFeature) + 1;
+        size_t cchValue = strlen(strValue) + 1;
+        if (cchGroup > c_cchFleetKey || cchFeature > c_cchFleetKey || cchValue > c_cchFleetKey)
+            return;
+
+        memcpy(key, strGroup, cchGroup);
+        memcpy(key + cchGroup, strFeature, cchFeature);
+        memcpy(key + cchGroup + cchFeature, strValue, cchValue);
+        auto cbKey = static_cast<DWORD>(cchGroup + cchFeature + cchValue);
+
+        if (pTable->cCounts >= pTable->cSlots && !GrowTable(pTable))
+        {
+            pTable->fFailed = TRUE;
+            return;
+        }
+
+        DWORD dwHash = HashKey(key, cbKey);
+        FLEETCOUNT** ppSlot = &pTable->ppSlots[dwHash & (pTable->cSlots - 1)];
+        for (FLEETCOUNT* pCount = *ppSlot; pCount; pCount = pCount->pNext)
+        {
+            if (pCount->dwHash == dwHash && pCount->cbKey == cbKey && memcmp(pCount->key, key, cbKey) == 0)
+            {
+                pCount->cCount += cCount;
+                return;
+            }
+        }
+
+        FLEETCOUNT* pCount = AllocCount(pTable, cbKey);
+        if (!pCount)
+        {
+            pTable->fFailed = TRUE;
+            return;
+        }
+
+        pCount->dwHash = dwHash;
+        pCount->cCount = cCount;
+        pCount->ichFeature = static_cast<DWORD>(cchGroup);
+        pCount->ichValue = static_cast<DWORD>(cchGroup + cchFeature);
+        pCount->cbKey = cbKey;
+        memcpy(pCount->key, key, cbKey);
+
+        pCount->pNext = *ppSlot;
+        *ppSlot = pCount;
+        pTable->cCounts++;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID FreeTable(FLEETTABLE* pTable)
+    {
+        BYTE* pChunk = pTable->pChunk;
+        while (pChunk)
+        {
+            BYTE* pPrev = *reinterpret_cast<BYTE**>(pChunk);
+            delete[] pChunk;
+            pChunk = pPrev;
+        }
+
+        delete[] pTable->ppSlots;
+        *pTable = {};
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID AppendKey(_Inout_updates_z_(c_cchFleetKey) CHAR* strKey, size_t* pcch, const CHAR* str)
+    {
+        size_t cch = strlen(str);
+        if (*pcch + cch >= c_cchFleetKey)
+            cch = c_cchFleetKey - 1 - *pcch;
+
+        memcpy(strKey + *pcch, str, cch);
+        *pcch += cch;
+        strKey[*pcch] = '\0';
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: EnterAdapter()
+    // Desc: Called when the node whose rows were just read turns out to be an
+    //       adapter, once the walk moves past it
+    //-----------------------------------------------------------------------------
+    VOID EnterAdapter(FLEETWORKER* pWorker)
+    {
+        pWorker->adapterDepth = pWorker->depth;
+        sprintf_s(pWorker->strGroup, "%04X:%04X %s", pWorker->dwVendorId, pWorker->dwDeviceId,
+            (*pWorker->strDriver) ? pWorker->strDriver : "(unknown driver)");
+
+        AddCount(&pWorker->table, pWorker->strGroup, "", "", 1);
+        AddCount(&pWorker->table, c_szAllAdapters, "", "", 1);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID FleetNode(void* pContext, UINT depth, const CHAR* strText)
+    {
+        auto pWorker = static_cast<FLEETWORKER*>(pContext);
+
+        if (pWorker->adapterDepth == c_noAdapter && pWorker->fVendorId && pWorker->fDeviceId)
+            EnterAdapter(pWorker);
+
+        if (pWorker->adapterDepth != c_noAdapter && depth <= pWorker->adapterDepth)
+            pWorker->adapterDepth = c_noAdapter;
+
+        if (depth < c_maxFleetDepth)
+            pWorker->strPath[depth] = strText;
+
+        pWorker->depth = depth;
+        pWorker->fVendorId = FALSE;
+        pWorker->fDeviceId = FALSE;
+        pWorker->strDriver[0] = '\0';
+        memset(pWorker->strColumns, 0, sizeof(pWorker->strColumns));
+    }
+
+
+    //-----------------------------------------------------------------------------
+    HRESULT FleetColumn(void* pContext, int iCol, const CHAR* strName, int /*width*/)
+    {
+        auto pWorker = static_cast<FLEETWORKER*>(pContext);
+        if (iCol >= 0 && iCol < static_cast<int>(c_maxEmitColumns))
+            pWorker->strColumns[iCol] = strName;
+        return S_OK;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: FleetRow()
+    // Desc: Counts every value of a row below an adapter. Outside of adapters
+    //       only looks for the rows that identify one.
+    //-----------------------------------------------------------------------------
+    HRESULT FleetRow(void* pContext, UINT cCells, const ROWCELL* pCells)
+    {
+        auto pWorker = static_cast<FLEETWORKER*>(pContext);
+        if (cCells < 2 || pCells[0].type != CELL_TEXT || !pCells[0].str)
+            return S_OK;
+
+        const CHAR* strName = pCells[0].str;
+
+        if (pWorker->adapterDepth == c_noAdapter)
+        {
+            if (pCells[1].type == CELL_HEX && strcmp(strName, "VendorId") == 0)
+            {
+                pWorker->fVendorId = TRUE;
+                pWorker->dwVendorId = pCells[1].dwValue;
+            }
+            else if (pCells[1].type == CELL_HEX && strcmp(strName, "DeviceId") == 0)
+            {
+                pWorker->fDeviceId = TRUE;
+                pWorker->dwDeviceId = pCells[1].dwValue;
+            }
+            else if (pCells[1].type == CELL_TEXT && pCells[1].str && strcmp(strName, "Driver Version") == 0)
+            {
+                strncpy_s(pWorker->strDriver, pCells[1].str, _TRUNCATE);
+            }
+            return S_OK;
+        }
+
+        if (pWorker->depth >= c_maxFleetDepth)
+            return S_OK;
+
+        CHAR strFeature[c_cchFleetKey] = {};
+        size_t cch = 0;
+        for (UINT i = pWorker->adapterDepth + 1; i <= pWorker->depth; ++i)
+        {
+            if (i > pWorker->adapterDepth + 1)
+                AppendKey(strFeature, &cch, " > ");
+            AppendKey(strFeature, &cch, pWorker->strPath[i]);
+        }
+        AppendKey(strFeature, &cch, " | ");
+        AppendKey(strFeature, &cch, strName);
+        const size_t cchRow = cch;
+
+        for (UINT i = 1; i < cCells; ++i)
+        {
+            // Tables name the column, name/value rows don't need to
+            if (cCells > 2)
+            {
+                CHAR szColumn[16];
+                const CHAR* strColumn = (i < c_maxEmitColumns) ? pWorker->strColumns[i] : nullptr;
+                if (!strColumn)
+                {
+                    sprintf_s(szColumn, "#%u", i);
+                    strColumn = szColumn;
+                }
+
+                cch = cchRow;
+                strFeature[cch] = '\0';
+                AppendKey(strFeature, &cch, " | ");
+                AppendKey(strFeature, &cch, strColumn);
+            }
+
+            CHAR szValue[c_cchRowCell];
+            const CHAR* strValue = RowCellText(&pCells[i], szValue);
+            AddCount(&pWorker->table, pWorker->strGroup, strFeature, strValue, 1);
+            AddCount(&pWorker->table, c_szAllAdapters, strFeature, strValue, 1);
+        }
+
+        return S_OK;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: ReadSnapshots()
+    // Desc: Reads files of the job until there are none left
+    //-----------------------------------------------------------------------------
+    VOID ReadSnapshots(FLEETJOB* pJob, FLEETWORKER* pWorker)
+    {
+        const SNAPSHOTWALKER walker = { FleetNode, { FleetColumn, FleetRow, pWorker } };
+
+        for (;;)
+        {
+            LONG i = InterlockedIncrement(&pJob->iNext) - 1;
+            if (i >= pJob->cNames)
+                break;
+
+            CHAR szPath[MAX_PATH];
+            if (sprintf_s(szPath, "%s\\%s", pJob->szDir, pJob->pNames + pJob->pichNames[i]) < 0)
+            {
+                pWorker->cSkipped++;
+                continue;
+            }
+
+            pWorker->depth = 0;
+            pWorker->adapterDepth = c_noAdapter;
+            pWorker->fVendorId = FALSE;
+            pWorker->fDeviceId = FALSE;
+
+            // Files that aren't valid snapshots or text logs are rejected
+            // before any of their nodes are walked
+            if (CacheWalkSnapshot(szPath, &walker) || LogWalkFile(szPath, &walker))
+            {
+                FleetNode(pWorker, 0, "");     // Ends the last adapter
+                pWorker->cSnapshots++;
+            }
+            else
+            {
+                pWorker->cSkipped++;
+            }
+        }
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID CALLBACK FleetWork(PTP_CALLBACK_INSTANCE /*pInstance*/, PVOID pContext, PTP_WORK /*pWork*/)
+    {
+        auto pJob = static_cast<FLEETJOB*>(pContext);
+        LONG iWorker = InterlockedIncrement(&pJob->cWorkers) - 1;
+        ReadSnapshots(pJob, &pJob->pWorkers[iWorker]);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: ListFiles()
+    // Desc: Collects the names of the files in szDir
+    //-----------------------------------------------------------------------------
+    BOOL ListFiles(LPCSTR szDir, CHAR** ppNames, DWORD** ppichNames, LONG* pcNames)
+    {
+        CHAR szPattern[MAX_PATH];
+        if (sprintf_s(szPattern, "%s\\*", szDir) < 0)
+            return FALSE;
+
+        WIN32_FIND_DATA fd = {};
+        HANDLE hFind = FindFirstFile(szPattern, &fd);
+        if (hFind == INVALID_HANDLE_VALUE)
+            return FALSE;
+
+        CHAR* pNames = nullptr;
+        DWORD* pichNames = nullptr;
+        DWORD cchNames = 0;
+        DWORD cchAlloc = 0;
+        LONG cNames = 0;
+        LONG cAlloc = 0;
+        BOOL fOK = TRUE;
+
+        do
+        {
+            if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                continue;
+
+            auto cch = static_cast<DWORD>(strlen(fd.cFileName) + 1);
+            if (cchNames + cch > cchAlloc)
+            {
+                DWORD cchNew = (cchAlloc) ? cchAlloc * 2 : 64 * 1024;
+                auto pNew = new (std::nothrow) CHAR[cchNew];
+                fOK = (pNew != nullptr);
+                if (!fOK)
+                    break;
+
+                if (cchNames)
+                    memcpy(pNew, pNames, cchNames);
+                delete[] pNames;
+                pNames = pNew;
+                cchAlloc = cchNew;
+            }
+
+            if (cNames == cAlloc)
+            {
+                LONG cNew = (cAlloc) ? cAlloc * 2 : 1024;
+                auto pNew = new (std::nothrow) DWORD[cNew];
+                fOK = (pNew != nullptr);
+                if (!fOK)
+                    break;
+
+                if (cNames)
+                    memcpy(pNew, pichNames, cNames * sizeof(DWORD));
+                delete[] pichNames;
+                pichNames = pNew;
+                cAlloc = cNew;
+            }
+
+            memcpy(pNames + cchNames, fd.cFileName, cch);
+            pichNames[cNames++] = cchNames;
+            cchNames += cch;
+        } while (FindNextFile(hFind, &fd));
+
+        FindClose(hFind);
+
+        if (!fOK)
+        {
+            delete[] pNames;
+            delete[] pichNames;
+            return FALSE;
+        }
+
+        *ppNames = pNames;
+        *ppichNames = pichNames;
+        *pcNames = cNames;
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    int __cdecl CompareCounts(const void* p1, const void* p2)
+    {
+        auto pCount1 = *static_cast<const FLEETCOUNT* const*>(p1);
+        auto pCount2 = *static_cast<const FLEETCOUNT* const*>(p2);
+
+        // The "*" group goes first, the adapter count first in its group
+        int iCmp = strcmp(pCount1->key, pCount2->key);
+        if (!iCmp)
+            iCmp = strcmp(pCount1->key + pCount1->ichFeature, pCount2->key + pCount2->ichFeature);
+        if (!iCmp)
+            iCmp = strcmp(pCount1->key + pCount1->ichValue, pCount2->key + pCount2->ichValue);
+        return iCmp;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID FleetWrite(OUTPUTSINK* pSink, const CHAR* str)
+    {
+        SinkWrite(pSink, str, strlen(str));
+    }
+
+
+    VOID FleetWriteCsv(OUTPUTSINK* pSink, const CHAR* str)
+    {
+        SinkWrite(pSink, "\"", 1);
+        for (const CHAR* pch = str; *pch; ++pch)
+        {
+            if (*pch == '"')
+                SinkWrite(pSink, "\"", 1);
+            SinkWrite(pSink, pch, 1);
+        }
+        SinkWrite(pSink, "\"", 1);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: WriteCsvReport()
+    // Desc: One line per group, feature and value, sorted
+    //-----------------------------------------------------------------------------
+    VOID WriteCsvReport(OUTPUTSINK* pSink, const FLEETCOUNT* const* ppCounts, DWORD cCounts)
+    {
+        FleetWrite(pSink, "Group,Adapters,Feature,Value,Count,Percent\r\n");
+
+        DWORD cAdapters = 0;
+        for (DWORD i = 0; i < cCounts; ++i)
+        {
+            const FLEETCOUNT* pCount = ppCounts[i];
+            const CHAR* strFeature = pCount->key + pCount->ichFeature;
+            if (!*strFeature)
+            {
+                cAdapters = pCount->cCount;
+                continue;
+            }
+
+            CHAR szNumbers[64];
+            FleetWriteCsv(pSink, pCount->key);
+            sprintf_s(szNumbers, ",%lu,", cAdapters);
+            FleetWrite(pSink, szNumbers);
+            FleetWriteCsv(pSink, strFeature);
+            FleetWrite(pSink, ",");
+            FleetWriteCsv(pSink, pCount->key + pCount->ichValue);
+            sprintf_s(szNumbers, ",%lu,%.1f\r\n", pCount->cCount,
+                (cAdapters) ? 100.0 * pCount->cCount / cAdapters : 0.0);
+            FleetWrite(pSink, szNumbers);
+        }
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: WriteJsonReport()
+    // Desc: { "version": 1, "snapshots": n, "skipped": n, "groups": [
+    //          { "group": "...", "adapters": n, "features": [
+    //              { "feature": "...", "values": { "value": count, ... } } ] } ] }
+    //-----------------------------------------------------------------------------
+    VOID WriteJsonReport(OUTPUTSINK* pSink, const FLEETCOUNT* const* ppCounts, DWORD cCounts,
+        DWORD cSnapshots, DWORD cSkipped)
+    {
+        CHAR szNumber[64];
+        sprintf_s(szNumber, "{\"version\":1,\"snapshots\":%lu,\"skipped\":%lu,\"groups\":[", cSnapshots, cSkipped);
+        FleetWrite(pSink, szNumber);
+
+        // pPrev is the last count of the open feature, if any
+        const FLEETCOUNT* pPrev = nullptr;
+        BOOL fGroup = FALSE;
+        for (DWORD i = 0; i < cCounts; ++i)
+        {
+            const FLEETCOUNT* pCount = ppCounts[i];
+            const CHAR* strFeature = pCount->key + pCount->ichFeature;
+            const CHAR* strValue = pCount->key + pCount->ichValue;
+
+            if (!*strFeature)
+            {
+                // Adapter count, sorted first in its group
+                if (pPrev)
+                    FleetWrite(pSink, "}}");
+                FleetWrite(pSink, (fGroup) ? "]},\r\n{\"group\":" : "\r\n{\"group\":");
+                SinkWriteJsonString(pSink, pCount->key, strlen(pCount->key));
+                sprintf_s(szNumber, ",\"adapters\":%lu,\"features\":[", pCount->cCount);
+                FleetWrite(pSink, szNumber);
+                fGroup = TRUE;
+                pPrev = nullptr;
+                continue;
+            }
+
+            if (pPrev && strcmp(pPrev->key + pPrev->ichFeature, strFeature) == 0)
+            {
+                FleetWrite(pSink, ",");
+            }
+            else
+            {
+                FleetWrite(pSink, (pPrev) ? "}},\r\n{\"feature\":" : "\r\n{\"feature\":");
+                SinkWriteJsonString(pSink, strFeature, strlen(strFeature));
+                FleetWrite(pSink, ",\"values\":{");
+            }
+
+            SinkWriteJsonString(pSink, strValue, strlen(strValue));
+            sprintf_s(szNumber, ":%lu", pCount->cCount);
+            FleetWrite(pSink, szNumber);
+            pPrev = pCount;
+        }
+
+        if (pPrev)
+            FleetWrite(pSink, "}}");
+        if (fGroup)
+            FleetWrite(pSink, "]}");
+        FleetWrite(pSink, "\r\n]}\r\n");
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: FleetAggregate()
+// Desc: Reads every snapshot or text log in szDir and writes the support
+//       matrix to szReport, as CSV or JSON. Returns S_FALSE if some files
+//       were neither.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT FleetAggregate(LPCSTR szDir, LPCSTR szReport, BOOL fJson)
+{
+    if (!szDir || !*szDir || !szReport || !*szReport)
+        return E_INVALIDARG;
+
+    FLEETJOB job = {};
+    job.szDir = szDir;
+
+    CHAR* pNames = nullptr;
+    DWORD* pichNames = nullptr;
+    if (!ListFiles(szDir, &pNames, &pichNames, &job.cNames))
+        return E_FAIL;
+
+    job.pNames = pNames;
+    job.pichNames = pichNames;
+
+    SYSTEM_INFO si = {};
+    GetSystemInfo(&si);
+    UINT cWorkers = (si.dwNumberOfProcessors < c_maxFleetWorkers) ? si.dwNumberOfProcessors : c_maxFleetWorkers;
+    if (cWorkers > static_cast<UINT>(job.cNames))
+        cWorkers = static_cast<UINT>(job.cNames);
+    if (!cWorkers)
+        cWorkers = 1;
+
+    job.pWorkers = new (std::nothrow) FLEETWORKER[cWorkers];
+    BOOL fOK = (job.pWorkers != nullptr);
+    if (fOK)
+    {
+        memset(job.pWorkers, 0, cWorkers * sizeof(FLEETWORKER));
+
+        PTP_WORK pWork = CreateThreadpoolWork(FleetWork, &job, nullptr);
+        if (pWork)
+        {
+            for (UINT i = 0; i < cWorkers; ++i)
+                SubmitThreadpoolWork(pWork);
+
+            WaitForThreadpoolWorkCallbacks(pWork, FALSE);
+            CloseThreadpoolWork(pWork);
+        }
+        else
+        {
+            cWorkers = 1;
+            ReadSnapshots(&job, &job.pWorkers[0]);
+        }
+
+        // Merge into the first worker's table
+        FLEETTABLE* pTable = &job.pWorkers[0].table;
+        for (UINT w = 1; w < cWorkers; ++w)
+        {
+            const FLEETTABLE* pOther = &job.pWorkers[w].table;
+            for (DWORD i = 0; i < pOther->cSlots; ++i)
+            {
+                for (const FLEETCOUNT* pCount = pOther->ppSlots[i]; pCount; pCount = pCount->pNext)
+                    AddCount(pTable, pCount->key, pCount->key + pCount->ichFeature, pCount->key + pCount->ichValue, pCount->cCount);
+            }
+
+            fOK = fOK && !pOther->fFailed;
+            job.pWorkers[0].cSnapshots += job.pWorkers[w].cSnapshots;
+            job.pWorkers[0].cSkipped += job.pWorkers[w].cSkipped;
+        }
+        fOK = fOK && !pTable->fFailed;
+    }
+
+    const FLEETCOUNT** ppCounts = nullptr;
+    DWORD cCounts = 0;
+    if (fOK)
+    {
+        const FLEETTABLE* pTable = &job.pWorkers[0].table;
+        ppCounts = new (std::nothrow) const FLEETCOUNT*[pTable->cCounts + 1];
+        fOK = (ppCounts != nullptr);
+        for (DWORD i = 0; i < pTable->cSlots && fOK; ++i)
+        {
+            for (const FLEETCOUNT* pCount = pTable->ppSlots[i]; pCount; pCount = pCount->pNext)
+                ppCounts[cCounts++] = pCount;
+        }
+
+        if (fOK)
+            qsort(ppCounts, cCounts, sizeof(ppCounts[0]), CompareCounts);
+    }
+
+    auto pSink = (fOK) ? new (std::nothrow) OUTPUTSINK : nullptr;
+    HANDLE hFile = INVALID_HANDLE_VALUE;
+    if (pSink)
+    {
+        hFile = CreateFile(szReport, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    }
+
+    fOK = (hFile != INVALID_HANDLE_VALUE);
+    DWORD cSkipped = 0;
+    if (fOK)
+    {
+        cSkipped = job.pWorkers[0].cSkipped;
+
+        SinkInitFile(pSink, hFile);
+        if (fJson)
+            WriteJsonReport(pSink, ppCounts, cCounts, job.pWorkers[0].cSnapshots, cSkipped);
+        else
+            WriteCsvReport(pSink, ppCounts, cCounts);
+
+        fOK = SinkFlush(pSink);
+        CloseHandle(hFile);
+
+        if (!fOK)
+            DeleteFile(szReport);
+    }
+
+    delete pSink;
+    delete[] ppCounts;
+    if (job.pWorkers)
+    {
+        for (UINT w = 0; w < cWorkers; ++w)
+            FreeTable(&job.pWorkers[w].table);
+        delete[] job.pWorkers;
+    }
+    delete[] pNames;
+    delete[] pichNames;
+
+    if (!fOK)
+        return E_FAIL;
+
+    return (cSkipped) ? S_FALSE : S_OK;
+}
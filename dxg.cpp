@@ -25,6 +25,8 @@
 
 #define D3DPTFILTERCAPS_CONVOLUTIONMONO    0x00040000L /* Min and Mag for the convolution mono filter */
 
+IDirect3D9* WINAPI MockDirect3DCreate9(UINT sdkVersion);
+
 namespace
 {
     using LPDIRECT3D9CREATE9 = IDirect3D9 * (WINAPI*)(UINT SDKVersion);
@@ -40,6 +42,45 @@ namespace
     BOOL IsAdapterFmtAvailable(UINT iAdapter, D3DDEVTYPE devType, D3DFORMAT fmtAdapter, BOOL bWindowed);
     HRESULT DXGDisplayCaps(LPARAM lParam1, LPARAM lParam2, _In_opt_ PRINTCBINFO* pInfo);
 
+    // IDirect3D9 queries, counted by StatsAdd()
+    HRESULT GetDeviceCaps9(UINT iAdapter, D3DDEVTYPE devType, D3DCAPS9* pCaps)
+    {
+        LONGLONG qpcStart = TraceNow();
+        HRESULT hr = g_pD3D->GetDeviceCaps(iAdapter, devType, pCaps);
+        return StatsAdd(API_D3D9GETDEVICECAPS, qpcStart, hr);
+    }
+
+    HRESULT CheckDeviceType9(UINT iAdapter, D3DDEVTYPE devType, D3DFORMAT fmtAdapter, D3DFORMAT fmtBackBuffer, BOOL bWindowed)
+    {
+        LONGLONG qpcStart = TraceNow();
+        HRESULT hr = g_pD3D->CheckDeviceType(iAdapter, devType, fmtAdapter, fmtBackBuffer, bWindowed);
+        return StatsAdd(API_D3D9CHECKDEVICETYPE, qpcStart, hr);
+    }
+
+    HRESULT CheckDeviceFormat9(UINT iAdapter, D3DDEVTYPE devType, D3DFORMAT fmtAdapter, DWORD dwUsage,
+        D3DRESOURCETYPE rType, D3DFORMAT fmt)
+    {
+        LONGLONG qpcStart = TraceNow();
+        HRESULT hr = g_pD3D->CheckDeviceFormat(iAdapter, devType, fmtAdapter, dwUsage, rType, fmt);
+        return StatsAdd(API_D3D9CHECKDEVICEFORMAT, qpcStart, hr);
+    }
+
+    HRESULT CheckDeviceMultiSampleType9(UINT iAdapter, D3DDEVTYPE devType, D3DFORMAT fmt, BOOL bWindowed,
+        D3DMULTISAMPLE_TYPE msType, DWORD* pQualityLevels)
+    {
+        LONGLONG qpcStart = TraceNow();
+        HRESULT hr = g_pD3D->CheckDeviceMultiSampleType(iAdapter, devType, fmt, bWindowed, msType, pQualityLevels);
+        return StatsAdd(API_D3D9CHECKDEVICEMULTISAMPLETYPE, qpcStart, hr);
+    }
+
+    HRESULT CheckDepthStencilMatch9(UINT iAdapter, D3DDEVTYPE devType, D3DFORMAT fmtAdapter, D3DFORMAT fmtRender,
+        D3DFORMAT fmtDS)
+    {
+        LONGLONG qpcStart = TraceNow();
+        HRESULT hr = g_pD3D->CheckDepthStencilMatch(iAdapter, devType, fmtAdapter, fmtRender, fmtDS);
+        return StatsAdd(API_D3D9CHECKDEPTHSTENCILMATCH, qpcStart, hr);
+    }
+
 #define CAPSVALDEFex(name,val)           {name, FIELD_OFFSET(D3DCAPS9,val), 0, DXV_9EXCAP}
 #define CAPSVALDEF(name,val)           {name, FIELD_OFFSET(D3DCAPS9,val), 0}
 #define CAPSFLAGDEFex(name,val,flag)     {name, FIELD_OFFSET(D3DCAPS9,val), flag, DXV_9EXCAP}
@@ -51,8 +92,124 @@ namespace
 #define PRIMCAPSVALDEF(name,val)       {name, FIELD_OFFSET(D3DPRIMCAPS9,val), 0}
 #define PRIMCAPSFLAGDEF(name,val,flag) {name, FIELD_OFFSET(D3DPRIMCAPS9,val), flag}
 
-    // NOTE: Remember to update FormatName() when you update this list!!
-    D3DFORMAT AllFormatArray[] =
+    //-----------------------------------------------------------------------------
+    // Name: c_formatNames
+    // Desc: Name of every D3DFORMAT this viewer knows, sorted by value so that
+    //       FormatName() can binary search it. The FOURCC formats sort last.
+    //-----------------------------------------------------------------------------
+    struct FORMATNAME
+    {
+        D3DFORMAT       format;
+        const TCHAR*    name;
+    };
+
+#define D3DFMTNAME(a) { static_cast<D3DFORMAT>(a), TEXT(#a) }
+
+    constexpr FORMATNAME c_formatNames[] =
+    {
+        D3DFMTNAME(D3DFMT_UNKNOWN),
+        D3DFMTNAME(D3DFMT_R8G8B8),
+        D3DFMTNAME(D3DFMT_A8R8G8B8),
+        D3DFMTNAME(D3DFMT_X8R8G8B8),
+        D3DFMTNAME(D3DFMT_R5G6B5),
+        D3DFMTNAME(D3DFMT_X1R5G5B5),
+        D3DFMTNAME(D3DFMT_A1R5G5B5),
+        D3DFMTNAME(D3DFMT_A4R4G4B4),
+        D3DFMTNAME(D3DFMT_R3G3B2),
+        D3DFMTNAME(D3DFMT_A8),
+        D3DFMTNAME(D3DFMT_A8R3G3B2),
+        D3DFMTNAME(D3DFMT_X4R4G4B4),
+        D3DFMTNAME(D3DFMT_A2B10G10R10),
+        D3DFMTNAME(D3DFMT_A8B8G8R8),
+        D3DFMTNAME(D3DFMT_X8B8G8R8),
+        D3DFMTNAME(D3DFMT_G16R16),
+        D3DFMTNAME(D3DFMT_A2R10G10B10),
+        D3DFMTNAME(D3DFMT_A16B16G16R16),
+
+        D3DFMTNAME(D3DFMT_A8P8),
+        D3DFMTNAME(D3DFMT_P8),
+
+        D3DFMTNAME(D3DFMT_L8),
+        D3DFMTNAME(D3DFMT_A8L8),
+        D3DFMTNAME(D3DFMT_A4L4),
+
+        D3DFMTNAME(D3DFMT_V8U8),
+        D3DFMTNAME(D3DFMT_L6V5U5),
+        D3DFMTNAME(D3DFMT_X8L8V8U8),
+        D3DFMTNAME(D3DFMT_Q8W8V8U8),
+        D3DFMTNAME(D3DFMT_V16U16),
+        D3DFMTNAME(D3DFMT_A2W10V10U10),
+
+        D3DFMTNAME(D3DFMT_D16_LOCKABLE),
+        D3DFMTNAME(D3DFMT_D32),
+        D3DFMTNAME(D3DFMT_D15S1),
+        D3DFMTNAME(D3DFMT_D24S8),
+        D3DFMTNAME(D3DFMT_D24X8),
+        D3DFMTNAME(D3DFMT_D24X4S4),
+        D3DFMTNAME(D3DFMT_D16),
+        D3DFMTNAME(D3DFMT_L16),
+        D3DFMTNAME(D3DFMT_D32F_LOCKABLE),
+        D3DFMTNAME(D3DFMT_D24FS8),
+        D3DFMTNAME(D3DFMT_D32_LOCKABLE),
+        D3DFMTNAME(D3DFMT_S8_LOCKABLE),
+
+        D3DFMTNAME(D3DFMT_VERTEXDATA),
+        D3DFMTNAME(D3DFMT_INDEX16),
+        D3DFMTNAME(D3DFMT_INDEX32),
+
+        D3DFMTNAME(D3DFMT_Q16W16V16U16),
+        D3DFMTNAME(D3DFMT_R16F),
+        D3DFMTNAME(D3DFMT_G16R16F),
+        D3DFMTNAME(D3DFMT_A16B16G16R16F),
+        D3DFMTNAME(D3DFMT_R32F),
+        D3DFMTNAME(D3DFMT_G32R32F),
+        D3DFMTNAME(D3DFMT_A32B32G32R32F),
+        D3DFMTNAME(D3DFMT_CxV8U8),
+        D3DFMTNAME(D3DFMT_A1),
+
+        D3DFMTNAME(D3DFMT_MULTI2_ARGB8),
+        D3DFMTNAME(D3DFMT_DXT1),
+        D3DFMTNAME(D3DFMT_DXT2),
+        D3DFMTNAME(D3DFMT_YUY2),
+        D3DFMTNAME(D3DFMT_DXT3),
+        D3DFMTNAME(D3DFMT_DXT4),
+        D3DFMTNAME(D3DFMT_DXT5),
+        D3DFMTNAME(D3DFMT_G8R8_G8B8),
+        D3DFMTNAME(D3DFMT_R8G8_B8G8),
+        D3DFMTNAME(D3DFMT_UYVY),
+    };
+
+#undef D3DFMTNAME
+
+    constexpr bool IsFormatNameSorted()
+    {
+        for (size_t i = 1; i < std::size(c_formatNames); ++i)
+        {
+            if (static_cast<UINT>(c_formatNames[i].format) <= static_cast<UINT>(c_formatNames[i - 1].format))
+                return false;
+        }
+        return true;
+    }
+
+    static_assert(IsFormatNameSorted(), "c_formatNames must be sorted by value without duplicates");
+
+    template<size_t N>
+    constexpr bool HasFormatNames(const D3DFORMAT(&formats)[N])
+    {
+        for (size_t i = 0; i < N; ++i)
+        {
+            bool found = false;
+            for (size_t j = 0; j < std::size(c_formatNames) && !found; ++j)
+                found = (c_formatNames[j].format == formats[i]);
+
+            if (!found)
+                return false;
+        }
+        return true;
+    }
+
+    // Every format swept needs an entry in c_formatNames, checked below
+    constexpr D3DFORMAT AllFormatArray[] =
     {
         D3DFMT_R8G8B8,
         D3DFMT_A8R8G8B8,
@@ -135,7 +292,7 @@ namespace
 
     // A subset of AllFormatArray...it's those D3DFMTs that could possibly be
     // adapter (display) formats.
-    D3DFORMAT AdapterFormatArray[] =
+    constexpr D3DFORMAT AdapterFormatArray[] =
     {
         D3DFMT_A2R10G10B10,
         D3DFMT_X8R8G8B8,
@@ -147,7 +304,7 @@ namespace
 
     // A subset of AllFormatArray...it's those D3DFMTs that could possibly be
     // back buffer formats.
-    D3DFORMAT BBFormatArray[] =
+    constexpr D3DFORMAT BBFormatArray[] =
     {
         D3DFMT_A2R10G10B10,
         D3DFMT_A8R8G8B8,
@@ -160,7 +317,7 @@ namespace
 
     // A subset of AllFormatArray...it's those D3DFMTs that could possibly be
     // depth/stencil formats.
-    D3DFORMAT DSFormatArray[] =
+    constexpr D3DFORMAT DSFormatArray[] =
     {
         D3DFMT_D16_LOCKABLE,
         D3DFMT_D32,
@@ -174,6 +331,10 @@ namespace
     };
     const int NumDSFormats = sizeof(DSFormatArray) / sizeof(DSFormatArray[0]);
 
+    static_assert(HasFormatNames(AllFormatArray) && HasFormatNames(AdapterFormatArray)
+        && HasFormatNames(BBFormatArray) && HasFormatNames(DSFormatArray),
+        "Every format swept needs an entry in c_formatNames");
+
     //-----------------------------------------------------------------------------
     //-----------------------------------------------------------------------------
     CAPDEF DXGGenCaps[] =
@@ -788,87 +949,24 @@ namespace
     //-----------------------------------------------------------------------------
     const TCHAR* FormatName(D3DFORMAT format)
     {
-        switch (format)
+        const auto value = static_cast<UINT>(format);
+
+        size_t iLow = 0;
+        size_t iHigh = std::size(c_formatNames);
+        while (iLow < iHigh)
         {
-        case D3DFMT_UNKNOWN:         return TEXT("D3DFMT_UNKNOWN");
-        case D3DFMT_R8G8B8:          return TEXT("D3DFMT_R8G8B8");
-        case D3DFMT_A8R8G8B8:        return TEXT("D3DFMT_A8R8G8B8");
-        case D3DFMT_X8R8G8B8:        return TEXT("D3DFMT_X8R8G8B8");
-        case D3DFMT_R5G6B5:          return TEXT("D3DFMT_R5G6B5");
-        case D3DFMT_X1R5G5B5:        return TEXT("D3DFMT_X1R5G5B5");
-        case D3DFMT_A1R5G5B5:        return TEXT("D3DFMT_A1R5G5B5");
-        case D3DFMT_A4R4G4B4:        return TEXT("D3DFMT_A4R4G4B4");
-        case D3DFMT_R3G3B2:          return TEXT("D3DFMT_R3G3B2");
-        case D3DFMT_A8:              return TEXT("D3DFMT_A8");
-        case D3DFMT_A8R3G3B2:        return TEXT("D3DFMT_A8R3G3B2");
-        case D3DFMT_X4R4G4B4:        return TEXT("D3DFMT_X4R4G4B4");
-        case D3DFMT_A2B10G10R10:     return TEXT("D3DFMT_A2B10G10R10");
-        case D3DFMT_A8B8G8R8:        return TEXT("D3DFMT_A8B8G8R8");
-        case D3DFMT_X8B8G8R8:        return TEXT("D3DFMT_X8B8G8R8");
-        case D3DFMT_G16R16:          return TEXT("D3DFMT_G16R16");
-        case D3DFMT_A2R10G10B10:     return TEXT("D3DFMT_A2R10G10B10");
-        case D3DFMT_A16B16G16R16:    return TEXT("D3DFMT_A16B16G16R16");
-
-        case D3DFMT_A8P8:            return TEXT("D3DFMT_A8P8");
-        case D3DFMT_P8:              return TEXT("D3DFMT_P8");
-
-        case D3DFMT_L8:              return TEXT("D3DFMT_L8");
-        case D3DFMT_A8L8:            return TEXT("D3DFMT_A8L8");
-        case D3DFMT_A4L4:            return TEXT("D3DFMT_A4L4");
-
-        case D3DFMT_V8U8:            return TEXT("D3DFMT_V8U8");
-        case D3DFMT_L6V5U5:          return TEXT("D3DFMT_L6V5U5");
-        case D3DFMT_X8L8V8U8:        return TEXT("D3DFMT_X8L8V8U8");
-        case D3DFMT_Q8W8V8U8:        return TEXT("D3DFMT_Q8W8V8U8");
-        case D3DFMT_V16U16:          return TEXT("D3DFMT_V16U16");
-        case D3DFMT_A2W10V10U10:     return TEXT("D3DFMT_A2W10V10U10");
-
-        case D3DFMT_UYVY:            return TEXT("D3DFMT_UYVY");
-        case D3DFMT_R8G8_B8G8:       return TEXT("D3DFMT_R8G8_B8G8");
-        case D3DFMT_YUY2:            return TEXT("D3DFMT_YUY2");
-        case D3DFMT_G8R8_G8B8:       return TEXT("D3DFMT_G8R8_G8B8");
-        case D3DFMT_DXT1:            return TEXT("D3DFMT_DXT1");
-        case D3DFMT_DXT2:            return TEXT("D3DFMT_DXT2");
-        case D3DFMT_DXT3:            return TEXT("D3DFMT_DXT3");
-        case D3DFMT_DXT4:            return TEXT("D3DFMT_DXT4");
-        case D3DFMT_DXT5:            return TEXT("D3DFMT_DXT5");
-
-        case D3DFMT_D16_LOCKABLE:    return TEXT("D3DFMT_D16_LOCKABLE");
-        case D3DFMT_D32:             return TEXT("D3DFMT_D32");
-        case D3DFMT_D15S1:           return TEXT("D3DFMT_D15S1");
-        case D3DFMT_D24S8:           return TEXT("D3DFMT_D24S8");
-        case D3DFMT_D24X8:           return TEXT("D3DFMT_D24X8");
-        case D3DFMT_D24X4S4:         return TEXT("D3DFMT_D24X4S4");
-        case D3DFMT_D16:             return TEXT("D3DFMT_D16");
-        case D3DFMT_D32F_LOCKABLE:   return TEXT("D3DFMT_D32F_LOCKABLE");
-        case D3DFMT_D24FS8:          return TEXT("D3DFMT_D24FS8");
-
-        case D3DFMT_L16:             return TEXT("D3DFMT_L16");
-
-        case D3DFMT_VERTEXDATA:      return TEXT("D3DFMT_VERTEXDATA");
-        case D3DFMT_INDEX16:         return TEXT("D3DFMT_INDEX16");
-        case D3DFMT_INDEX32:         return TEXT("D3DFMT_INDEX32");
-
-        case D3DFMT_Q16W16V16U16:    return TEXT("D3DFMT_Q16W16V16U16");
-
-        case D3DFMT_MULTI2_ARGB8:    return TEXT("D3DFMT_MULTI2_ARGB8");
-
-        case D3DFMT_R16F:            return TEXT("D3DFMT_R16F");
-        case D3DFMT_G16R16F:         return TEXT("D3DFMT_G16R16F");
-        case D3DFMT_A16B16G16R16F:   return TEXT("D3DFMT_A16B16G16R16F");
-
-        case D3DFMT_R32F:            return TEXT("D3DFMT_R32F");
-        case D3DFMT_G32R32F:         return TEXT("D3DFMT_G32R32F");
-        case D3DFMT_A32B32G32R32F:   return TEXT("D3DFMT_A32B32G32R32F");
-
-        case D3DFMT_CxV8U8:          return TEXT("D3DFMT_CxV8U8");
-
-        case D3DFMT_D32_LOCKABLE:	 return TEXT("D3DFMT_D32_LOCKABLE");
-        case D3DFMT_S8_LOCKABLE:	 return TEXT("D3DFMT_S8_LOCKABLE");
-        case D3DFMT_A1:				 return TEXT("D3DFMT_A1");
-
-        default:                     return TEXT("Unknown format");
+            size_t iMid = (iLow + iHigh) / 2;
+            const auto midValue = static_cast<UINT>(c_formatNames[iMid].format);
+            if (midValue == value)
+                return c_formatNames[iMid].name;
+
+            if (midValue < value)
+                iLow = iMid + 1;
+            else
+                iHigh = iMid;
         }
+
+        return TEXT("Unknown format");
     }
 
 
@@ -910,11 +1008,8 @@ namespace
         if (!g_pD3D)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", 15);
-            LVAddColumn(g_hwndLV, 1, "Value", 40);
-        }
+        EmitColumn(pPrintInfo, 0, "Name", 15);
+        EmitColumn(pPrintInfo, 1, "Value", 40);
 
         D3DADAPTER_IDENTIFIER9 identifier;
         HRESULT hr = g_pD3D->GetAdapterIdentifier(iAdapter, D3DENUM_WHQL_LEVEL, &identifier);
@@ -931,50 +1026,15 @@ namespace
         sprintf_s(szVersion, sizeof(szVersion), TEXT("0x%08X-%08X"), identifier.DriverVersion.HighPart,
             identifier.DriverVersion.LowPart);
 
-        if (!pPrintInfo)
-        {
-            LVAddText(g_hwndLV, 0, "Driver");
-            LVAddText(g_hwndLV, 1, "%s", identifier.Driver);
-
-            LVAddText(g_hwndLV, 0, "Description");
-            LVAddText(g_hwndLV, 1, "%s", identifier.Description);
-
-            LVAddText(g_hwndLV, 0, "DeviceName");
-            LVAddText(g_hwndLV, 1, "%s", identifier.DeviceName);
-
-            LVAddText(g_hwndLV, 0, "DriverVersion");
-            LVAddText(g_hwndLV, 1, "%s", szVersion);
-
-            LVAddText(g_hwndLV, 0, "VendorId");
-            LVAddText(g_hwndLV, 1, "0x%08x", identifier.VendorId);
-
-            LVAddText(g_hwndLV, 0, "DeviceId");
-            LVAddText(g_hwndLV, 1, "0x%08x", identifier.DeviceId);
-
-            LVAddText(g_hwndLV, 0, "SubSysId");
-            LVAddText(g_hwndLV, 1, "0x%08x", identifier.SubSysId);
-
-            LVAddText(g_hwndLV, 0, "Revision");
-            LVAddText(g_hwndLV, 1, "%d", identifier.Revision);
-
-            LVAddText(g_hwndLV, 0, "DeviceIdentifier");
-            LVAddText(g_hwndLV, 1, szGuid);
-
-            LVAddText(g_hwndLV, 0, "WHQLLevel");
-            LVAddText(g_hwndLV, 1, "%d", identifier.WHQLLevel);
-        }
-        else
-        {
-            PrintStringValueLine("Driver", identifier.Driver, pPrintInfo);
-            PrintStringValueLine("Description", identifier.Description, pPrintInfo);
-            PrintStringValueLine("DriverVersion", szVersion, pPrintInfo);
-            PrintHexValueLine("VendorId", identifier.VendorId, pPrintInfo);
-            PrintHexValueLine("DeviceId", identifier.DeviceId, pPrintInfo);
-            PrintHexValueLine("SubSysId", identifier.SubSysId, pPrintInfo);
-            PrintValueLine("Revision", identifier.Revision, pPrintInfo);
-            PrintStringValueLine("DeviceIdentifier", szGuid, pPrintInfo);
-            PrintValueLine("WHQLLevel", identifier.WHQLLevel, pPrintInfo);
-        }
+        EmitTextRow(pPrintInfo, "Driver", identifier.Driver);
+        EmitTextRow(pPrintInfo, "Description", identifier.Description);
+        EmitTextRow(pPrintInfo, "DriverVersion", szVersion);
+        EmitHexRow(pPrintInfo, "VendorId", identifier.VendorId);
+        EmitHexRow(pPrintInfo, "DeviceId", identifier.DeviceId);
+        EmitHexRow(pPrintInfo, "SubSysId", identifier.SubSysId);
+        EmitValueRow(pPrintInfo, "Revision", identifier.Revision);
+        EmitTextRow(pPrintInfo, "DeviceIdentifier", szGuid);
+        EmitValueRow(pPrintInfo, "WHQLLevel", identifier.WHQLLevel);
         return S_OK;
     }
 
@@ -986,12 +1046,9 @@ namespace
     {
         auto iAdapter = static_cast<UINT>(lParam1);
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Resolution", 10);
-            LVAddColumn(g_hwndLV, 1, "Pixel Format", 15);
-            LVAddColumn(g_hwndLV, 2, "Refresh Rate", 10);
-        }
+        EmitColumn(pPrintInfo, 0, "Resolution", 10);
+        EmitColumn(pPrintInfo, 1, "Pixel Format", 15);
+        EmitColumn(pPrintInfo, 2, "Refresh Rate", 10);
 
         for (INT iFormat = 0; iFormat < NumAdapterFormats; iFormat++)
         {
@@ -1001,43 +1058,18 @@ namespace
             {
                 D3DDISPLAYMODE mode;
                 g_pD3D->EnumAdapterModes(iAdapter, fmt, iMode, &mode);
-                if (!pPrintInfo)
-                {
-                    LVAddText(g_hwndLV, 0, "%d x %d", mode.Width, mode.Height);
-                    LVAddText(g_hwndLV, 1, FormatName(mode.Format));
-                    LVAddText(g_hwndLV, 2, "%d", mode.RefreshRate);
-                }
-                else
+
+                char szRes[32];
+                sprintf_s(szRes, sizeof(szRes), "%u x %u", mode.Width, mode.Height);
+
+                const ROWCELL cells[3] =
                 {
-                    char  szBuff[80];
-                    DWORD cchLen;
-                    int   x1, x2, x3, yLine;
-
-                    // Calculate Name and Value column x offsets
-                    x1 = (pPrintInfo->dwCurrIndent * DEF_TAB_SIZE * pPrintInfo->dwCharWidth);
-                    x2 = x1 + (20 * pPrintInfo->dwCharWidth);
-                    x3 = x2 + (20 * pPrintInfo->dwCharWidth);
-                    yLine = (pPrintInfo->dwCurrLine * pPrintInfo->dwLineHeight);
-
-                    sprintf_s(szBuff, sizeof(szBuff), "%u x %u", mode.Width, mode.Height);
-                    cchLen = static_cast<DWORD>(_tcslen(szBuff));
-                    if (FAILED(PrintLine(x1, yLine, szBuff, cchLen, pPrintInfo)))
-                        return E_FAIL;
-
-                    strcpy_s(szBuff, sizeof(szBuff), FormatName(mode.Format));
-                    cchLen = static_cast<DWORD>(_tcslen(szBuff));
-                    if (FAILED(PrintLine(x2, yLine, szBuff, cchLen, pPrintInfo)))
-                        return E_FAIL;
-
-                    sprintf_s(szBuff, sizeof(szBuff), "%u", mode.RefreshRate);
-                    cchLen = static_cast<DWORD>(_tcslen(szBuff));
-                    if (FAILED(PrintLine(x3, yLine, szBuff, cchLen, pPrintInfo)))
-                        return E_FAIL;
-
-                    // Advance to next line on page
-                    if (FAILED(PrintNextLine(pPrintInfo)))
-                        return E_FAIL;
-                }
+                    { CELL_TEXT, szRes, 0 },
+                    { CELL_TEXT, FormatName(mode.Format), 0 },
+                    { CELL_UINT, nullptr, mode.RefreshRate },
+                };
+                if (FAILED(EmitRow(pPrintInfo, 3, cells)))
+                    return E_FAIL;
             }
         }
         return S_OK;
@@ -1067,33 +1099,24 @@ namespace
     //-----------------------------------------------------------------------------
     HRESULT DXGDisplayMultiSample(LPARAM lParam1, LPARAM lParam2, LPARAM lParam3, _In_opt_ PRINTCBINFO* pPrintInfo)
     {
+        TRACESCOPE trace("CheckDeviceMultiSampleType");
         UINT iAdapter = LOWORD(lParam1);
         auto devType = static_cast<D3DDEVTYPE>(HIWORD(lParam1));
         BOOL bWindowed = (BOOL)LOWORD(lParam2);
         auto msType = static_cast<D3DMULTISAMPLE_TYPE>(HIWORD(lParam2));
         auto fmt = static_cast<D3DFORMAT>(lParam3);
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Quality Levels", 30);
-        }
+        EmitColumn(pPrintInfo, 0, "Quality Levels", 30);
 
         DWORD dwNumQualityLevels;
-        if (SUCCEEDED(g_pD3D->CheckDeviceMultiSampleType(iAdapter, devType, fmt, bWindowed, msType, &dwNumQualityLevels)))
+        if (SUCCEEDED(CheckDeviceMultiSampleType9(iAdapter, devType, fmt, bWindowed, msType, &dwNumQualityLevels)))
         {
             TCHAR str[100];
             if (dwNumQualityLevels == 1)
                 sprintf_s(str, sizeof(str), "%u quality level", dwNumQualityLevels);
             else
                 sprintf_s(str, sizeof(str), "%u quality levels", dwNumQualityLevels);
-            if (!pPrintInfo)
-            {
-                LVAddText(g_hwndLV, 0, str);
-            }
-            else
-            {
-                PrintStringLine(str, pPrintInfo);
-            }
+            EmitNoteRow(pPrintInfo, str);
         }
 
         return S_OK;
@@ -1106,29 +1129,20 @@ namespace
     //-----------------------------------------------------------------------------
     HRESULT DXGDisplayBackBuffer(LPARAM lParam1, LPARAM lParam2, LPARAM lParam3, _In_opt_ PRINTCBINFO* pPrintInfo)
     {
+        TRACESCOPE trace("CheckDeviceType");
         UINT iAdapter = LOWORD(lParam1);
         auto devType = static_cast<D3DDEVTYPE>(HIWORD(lParam1));
         auto fmtAdapter = static_cast<D3DFORMAT>(lParam2);
         auto bWindowed = static_cast<BOOL>(lParam3);
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Back Buffer Formats", 20);
-        }
+        EmitColumn(pPrintInfo, 0, "Back Buffer Formats", 20);
 
         for (int iFmt = 0; iFmt < NumBBFormats; iFmt++)
         {
             D3DFORMAT fmt = BBFormatArray[iFmt];
-            if (SUCCEEDED(g_pD3D->CheckDeviceType(iAdapter, devType, fmtAdapter, fmt, bWindowed)))
+            if (SUCCEEDED(CheckDeviceType9(iAdapter, devType, fmtAdapter, fmt, bWindowed)))
             {
-                if (!pPrintInfo)
-                {
-                    LVAddText(g_hwndLV, 0, "%s", FormatName(fmt));
-                }
-                else
-                {
-                    PrintStringLine(FormatName(fmt), pPrintInfo);
-                }
+                EmitNoteRow(pPrintInfo, FormatName(fmt));
             }
         }
 
@@ -1143,29 +1157,20 @@ namespace
     //-----------------------------------------------------------------------------
     HRESULT DXGDisplayRenderTarget(LPARAM lParam1, LPARAM lParam2, LPARAM /*lParam3*/, _In_opt_ PRINTCBINFO* pPrintInfo)
     {
+        TRACESCOPE trace("CheckDeviceFormat");
         UINT iAdapter = LOWORD(lParam1);
         auto devType = static_cast<D3DDEVTYPE>(HIWORD(lParam1));
         auto fmtAdapter = static_cast<D3DFORMAT>(lParam2);
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Render Target Formats", 20);
-        }
+        EmitColumn(pPrintInfo, 0, "Render Target Formats", 20);
 
         for (int iFmt = 0; iFmt < NumFormats; iFmt++)
         {
             D3DFORMAT fmt = AllFormatArray[iFmt];
-            if (SUCCEEDED(g_pD3D->CheckDeviceFormat(iAdapter, devType, fmtAdapter, D3DUSAGE_RENDERTARGET,
+            if (SUCCEEDED(CheckDeviceFormat9(iAdapter, devType, fmtAdapter, D3DUSAGE_RENDERTARGET,
                 D3DRTYPE_SURFACE, fmt)))
             {
-                if (!pPrintInfo)
-                {
-                    LVAddText(g_hwndLV, 0, "%s", FormatName(fmt));
-                }
-                else
-                {
-                    PrintStringLine(FormatName(fmt), pPrintInfo);
-                }
+                EmitNoteRow(pPrintInfo, FormatName(fmt));
             }
         }
 
@@ -1180,14 +1185,12 @@ namespace
     //-----------------------------------------------------------------------------
     HRESULT DXGDisplayDepthStencil(LPARAM lParam1, LPARAM lParam2, LPARAM /*lParam3*/, _In_opt_ PRINTCBINFO* pPrintInfo)
     {
+        TRACESCOPE trace("CheckDeviceFormat");
         UINT iAdapter = LOWORD(lParam1);
         auto devType = static_cast<D3DDEVTYPE>(HIWORD(lParam1));
         auto fmtAdapter = static_cast<D3DFORMAT>(lParam2);
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Depth/Stencil Formats", 20);
-        }
+        EmitColumn(pPrintInfo, 0, "Depth/Stencil Formats", 20);
 
         for (int iFmt = 0; iFmt < NumDSFormats; iFmt++)
         {
@@ -1196,17 +1199,10 @@ namespace
             if (!g_is9Ex && ((fmt == D3DFMT_D32_LOCKABLE) || (fmt == D3DFMT_S8_LOCKABLE)))
                 continue;
 
-            if (SUCCEEDED(g_pD3D->CheckDeviceFormat(iAdapter, devType, fmtAdapter, D3DUSAGE_DEPTHSTENCIL,
+            if (SUCCEEDED(CheckDeviceFormat9(iAdapter, devType, fmtAdapter, D3DUSAGE_DEPTHSTENCIL,
                 D3DRTYPE_SURFACE, fmt)))
             {
-                if (!pPrintInfo)
-                {
-                    LVAddText(g_hwndLV, 0, "%s", FormatName(fmt));
-                }
-                else
-                {
-                    PrintStringLine(FormatName(fmt), pPrintInfo);
-                }
+                EmitNoteRow(pPrintInfo, FormatName(fmt));
             }
         }
 
@@ -1221,32 +1217,23 @@ namespace
     //-----------------------------------------------------------------------------
     HRESULT DXGCheckDSQualityLevels(LPARAM lParam1, LPARAM lParam2, LPARAM lParam3, _In_opt_ PRINTCBINFO* pPrintInfo)
     {
+        TRACESCOPE trace("CheckDeviceMultiSampleType");
         UINT iAdapter = LOWORD(lParam1);
         auto devType = static_cast<D3DDEVTYPE>(HIWORD(lParam1));
         auto fmtDS = static_cast<D3DFORMAT>(lParam2);
         auto msType = static_cast<D3DMULTISAMPLE_TYPE>(lParam3);
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Quality Levels", 20);
-        }
+        EmitColumn(pPrintInfo, 0, "Quality Levels", 20);
 
         DWORD dwNumQualityLevels;
-        if (SUCCEEDED(g_pD3D->CheckDeviceMultiSampleType(iAdapter, devType, fmtDS, FALSE, msType, &dwNumQualityLevels)))
+        if (SUCCEEDED(CheckDeviceMultiSampleType9(iAdapter, devType, fmtDS, FALSE, msType, &dwNumQualityLevels)))
         {
             TCHAR str[100];
             if (dwNumQualityLevels == 1)
                 sprintf_s(str, sizeof(str), "%u quality level", dwNumQualityLevels);
             else
                 sprintf_s(str, sizeof(str), "%u quality levels", dwNumQualityLevels);
-            if (!pPrintInfo)
-            {
-                LVAddText(g_hwndLV, 0, str);
-            }
-            else
-            {
-                PrintStringLine(str, pPrintInfo);
-            }
+            EmitNoteRow(pPrintInfo, str);
         }
 
         return S_OK;
@@ -1260,14 +1247,12 @@ namespace
     //-----------------------------------------------------------------------------
     HRESULT DXGDisplayPlainSurface(LPARAM lParam1, LPARAM lParam2, LPARAM /*lParam3*/, _In_opt_ PRINTCBINFO* pPrintInfo)
     {
+        TRACESCOPE trace("CheckDeviceFormat");
         UINT iAdapter = LOWORD(lParam1);
         auto devType = static_cast<D3DDEVTYPE>(HIWORD(lParam1));
         D3DFORMAT fmtAdapter = static_cast<D3DFORMAT>(lParam2);
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Plain Surface Formats", 20);
-        }
+        EmitColumn(pPrintInfo, 0, "Plain Surface Formats", 20);
 
         for (int iFmt = 0; iFmt < NumFormats; iFmt++)
         {
@@ -1276,17 +1261,10 @@ namespace
             if (!g_is9Ex && ((fmt == D3DFMT_A1) || (fmt == D3DFMT_D32_LOCKABLE) || (fmt == D3DFMT_S8_LOCKABLE)))
                 continue;
 
-            if (SUCCEEDED(g_pD3D->CheckDeviceFormat(iAdapter, devType, fmtAdapter, 0,
+            if (SUCCEEDED(CheckDeviceFormat9(iAdapter, devType, fmtAdapter, 0,
                 D3DRTYPE_SURFACE, fmt)))
             {
-                if (!pPrintInfo)
-                {
-                    LVAddText(g_hwndLV, 0, "%s", FormatName(fmt));
-                }
-                else
-                {
-                    PrintStringLine(FormatName(fmt), pPrintInfo);
-                }
+                EmitNoteRow(pPrintInfo, FormatName(fmt));
             }
         }
 
@@ -1301,61 +1279,58 @@ namespace
     //-----------------------------------------------------------------------------
     HRESULT DXGDisplayResource(LPARAM lParam1, LPARAM lParam2, LPARAM lParam3, _In_opt_ PRINTCBINFO* pPrintInfo)
     {
+        TRACESCOPE trace("CheckDeviceFormat");
         UINT iAdapter = LOWORD(lParam1);
         auto devType = static_cast<D3DDEVTYPE>(HIWORD(lParam1));
         auto fmtAdapter = static_cast<D3DFORMAT>(lParam2);
         auto RType = static_cast<D3DRESOURCETYPE>(lParam3);
-        const TCHAR* pstr;
         HRESULT hr;
         UINT col = 0;
 
         D3DCAPS9 Caps;
-        g_pD3D->GetDeviceCaps(iAdapter, devType, &Caps);
+        GetDeviceCaps9(iAdapter, devType, &Caps);
 
-        if (!pPrintInfo)
+        switch (RType)
+        {
+        case D3DRTYPE_SURFACE:
+            EmitColumn(pPrintInfo, col++, "Surface Formats", 20);
+            break;
+        case D3DRTYPE_VOLUME:
+            EmitColumn(pPrintInfo, col++, "Volume Formats", 20);
+            break;
+        case D3DRTYPE_TEXTURE:
+            EmitColumn(pPrintInfo, col++, "Texture Formats", 20);
+            break;
+        case D3DRTYPE_VOLUMETEXTURE:
+            EmitColumn(pPrintInfo, col++, "Volume Texture Formats", 20);
+            break;
+        case D3DRTYPE_CUBETEXTURE:
+            EmitColumn(pPrintInfo, col++, "Cube Texture Formats", 20);
+            break;
+        default:
+            return E_FAIL;
+        }
+        EmitColumn(pPrintInfo, col++, "0 (Plain)", 22);
+        if (RType != D3DRTYPE_VOLUMETEXTURE)
+            EmitColumn(pPrintInfo, col++, "D3DUSAGE_RENDERTARGET", 22);
+        //        EmitColumn(pPrintInfo,  col++, "D3DUSAGE_DEPTHSTENCIL", 22);
+        if (RType != D3DRTYPE_SURFACE)
         {
-            switch (RType)
-            {
-            case D3DRTYPE_SURFACE:
-                LVAddColumn(g_hwndLV, col++, "Surface Formats", 20);
-                break;
-            case D3DRTYPE_VOLUME:
-                LVAddColumn(g_hwndLV, col++, "Volume Formats", 20);
-                break;
-            case D3DRTYPE_TEXTURE:
-                LVAddColumn(g_hwndLV, col++, "Texture Formats", 20);
-                break;
-            case D3DRTYPE_VOLUMETEXTURE:
-                LVAddColumn(g_hwndLV, col++, "Volume Texture Formats", 20);
-                break;
-            case D3DRTYPE_CUBETEXTURE:
-                LVAddColumn(g_hwndLV, col++, "Cube Texture Formats", 20);
-                break;
-            default:
-                return E_FAIL;
-            }
-            LVAddColumn(g_hwndLV, col++, "0 (Plain)", 22);
             if (RType != D3DRTYPE_VOLUMETEXTURE)
-                LVAddColumn(g_hwndLV, col++, "D3DUSAGE_RENDERTARGET", 22);
-            //        LVAddColumn(g_hwndLV,  col++, "D3DUSAGE_DEPTHSTENCIL", 22);
-            if (RType != D3DRTYPE_SURFACE)
             {
-                if (RType != D3DRTYPE_VOLUMETEXTURE)
+                EmitColumn(pPrintInfo, col++, "D3DUSAGE_AUTOGENMIPMAP", 22);
+                if (RType != D3DRTYPE_CUBETEXTURE)
                 {
-                    LVAddColumn(g_hwndLV, col++, "D3DUSAGE_AUTOGENMIPMAP", 22);
-                    if (RType != D3DRTYPE_CUBETEXTURE)
-                    {
-                        LVAddColumn(g_hwndLV, col++, "D3DUSAGE_DMAP", 22);
-                    }
+                    EmitColumn(pPrintInfo, col++, "D3DUSAGE_DMAP", 22);
                 }
-                LVAddColumn(g_hwndLV, col++, "D3DUSAGE_QUERY_LEGACYBUMPMAP", 22);
-                LVAddColumn(g_hwndLV, col++, "D3DUSAGE_QUERY_SRGBREAD", 18);
-                LVAddColumn(g_hwndLV, col++, "D3DUSAGE_QUERY_FILTER", 15);
-                LVAddColumn(g_hwndLV, col++, "D3DUSAGE_QUERY_SRGBWRITE", 18);
-                LVAddColumn(g_hwndLV, col++, "D3DUSAGE_QUERY_POSTPIXELSHADER_BLENDING", 18);
-                LVAddColumn(g_hwndLV, col++, "D3DUSAGE_QUERY_VERTEXTEXTURE", 18);
-                LVAddColumn(g_hwndLV, col++, "D3DUSAGE_QUERY_WRAPANDMIP", 18);
             }
+            EmitColumn(pPrintInfo, col++, "D3DUSAGE_QUERY_LEGACYBUMPMAP", 22);
+            EmitColumn(pPrintInfo, col++, "D3DUSAGE_QUERY_SRGBREAD", 18);
+            EmitColumn(pPrintInfo, col++, "D3DUSAGE_QUERY_FILTER", 15);
+            EmitColumn(pPrintInfo, col++, "D3DUSAGE_QUERY_SRGBWRITE", 18);
+            EmitColumn(pPrintInfo, col++, "D3DUSAGE_QUERY_POSTPIXELSHADER_BLENDING", 18);
+            EmitColumn(pPrintInfo, col++, "D3DUSAGE_QUERY_VERTEXTEXTURE", 18);
+            EmitColumn(pPrintInfo, col++, "D3DUSAGE_QUERY_WRAPANDMIP", 18);
         }
         const DWORD usageArray[] =
         {
@@ -1423,7 +1398,7 @@ namespace
                 {
                     continue;
                 }
-                if (SUCCEEDED(g_pD3D->CheckDeviceFormat(iAdapter, devType, fmtAdapter,
+                if (SUCCEEDED(CheckDeviceFormat9(iAdapter, devType, fmtAdapter,
                     usageArray[iUsage], RType, fmt)))
                 {
                     bFoundSuccess = TRUE;
@@ -1432,12 +1407,11 @@ namespace
             }
             if (bFoundSuccess)
             {
-                col = 0;
+                ROWCELL cells[numUsages + 1] = {};
+
                 // Add list item for this format
-                if (!pPrintInfo)
-                    LVAddText(g_hwndLV, col++, "%s", FormatName(fmt));
-                else
-                    PrintStringLine(FormatName(fmt), pPrintInfo);
+                col = 0;
+                cells[col++] = { CELL_TEXT, FormatName(fmt), 0 };
 
                 // Show which usages it is compatible with
                 for (UINT iUsage = 0; iUsage < numUsages; iUsage++)
@@ -1483,20 +1457,14 @@ namespace
                     }
                     if (SUCCEEDED(hr))
                     {
-                        hr = g_pD3D->CheckDeviceFormat(iAdapter, devType, fmtAdapter,
+                        hr = CheckDeviceFormat9(iAdapter, devType, fmtAdapter,
                             usageArray[iUsage], RType, fmt);
                     }
-                    if (hr == D3DOK_NOAUTOGEN)
-                        pstr = TEXT("No");
-                    else if (SUCCEEDED(hr))
-                        pstr = TEXT("Yes");
-                    else
-                        pstr = TEXT("No");
-                    if (!pPrintInfo)
-                        LVAddText(g_hwndLV, col++, pstr);
-                    else
-                        PrintStringLine(pstr, pPrintInfo);
+                    BOOL bUsage = (hr != D3DOK_NOAUTOGEN && SUCCEEDED(hr));
+                    cells[col++] = { CELL_BOOL, nullptr, static_cast<DWORD>(bUsage) };
                 }
+
+                EmitRow(pPrintInfo, col, cells);
             }
         }
 
@@ -1540,7 +1508,7 @@ namespace
         for (int iFmtBackBuffer = 0; iFmtBackBuffer < NumBBFormats; iFmtBackBuffer++)
         {
             D3DFORMAT fmtBackBuffer = BBFormatArray[iFmtBackBuffer];
-            if (SUCCEEDED(g_pD3D->CheckDeviceType(iAdapter, devType, fmtAdapter, fmtBackBuffer, bWindowed)))
+            if (SUCCEEDED(CheckDeviceType9(iAdapter, devType, fmtAdapter, fmtBackBuffer, bWindowed)))
             {
                 return TRUE;
             }
@@ -1550,6 +1518,82 @@ namespace
 }
 
 
+//-----------------------------------------------------------------------------
+// Name: DXG_ExpandMultiSample()
+// Desc: Expand callback of each render format under "Render Format
+//       Compatibility"
+//       lParam1 is the iAdapter and device type
+//       lParam2 is the adapter fmt and bWindowed
+//       lParam3 is the render format
+//-----------------------------------------------------------------------------
+VOID DXG_ExpandMultiSample(HCAPNODE hParent, LPARAM lParam1, LPARAM lParam2, LPARAM lParam3)
+{
+    TRACESCOPE trace("CheckDeviceMultiSampleType");
+    UINT iAdapter = LOWORD(lParam1);
+    auto devType = static_cast<D3DDEVTYPE>(HIWORD(lParam1));
+    auto fmtAdapter = static_cast<D3DFORMAT>(LOWORD(lParam2));
+    BOOL bWindowed = (BOOL)HIWORD(lParam2);
+    auto fmtRender = static_cast<D3DFORMAT>(lParam3);
+
+    for (D3DMULTISAMPLE_TYPE msType = D3DMULTISAMPLE_NONE; msType <= D3DMULTISAMPLE_16_SAMPLES; msType = (D3DMULTISAMPLE_TYPE)((UINT)msType + 1))
+    {
+        if (SUCCEEDED(CheckDeviceMultiSampleType9(iAdapter, devType, fmtRender, bWindowed, msType, nullptr)))
+        {
+            HCAPNODE hTree9 = TVAddNodeEx(hParent, MultiSampleTypeName(msType), TRUE, IDI_CAPS, DXGDisplayMultiSample, MAKELPARAM(iAdapter, (UINT)devType), MAKELPARAM(bWindowed, (UINT)msType), (LPARAM)fmtRender);
+            HCAPNODE hTree10 = TVAddNode(hTree9, "Compatible Depth/Stencil Formats", TRUE, IDI_CAPS, nullptr, 0, 0);
+            D3DFORMAT DSFmt;
+            for (int iFmt = 0; iFmt < NumDSFormats; iFmt++)
+            {
+                DSFmt = DSFormatArray[iFmt];
+                if (SUCCEEDED(CheckDeviceFormat9(iAdapter, devType, fmtAdapter, D3DUSAGE_DEPTHSTENCIL,
+                    D3DRTYPE_SURFACE, DSFmt)))
+                {
+                    if (SUCCEEDED(CheckDepthStencilMatch9(iAdapter, devType, fmtAdapter, fmtRender, DSFmt)))
+                    {
+                        if (SUCCEEDED(CheckDeviceMultiSampleType9(iAdapter, devType, DSFmt, bWindowed, msType, nullptr)))
+                        {
+                            (void)TVAddNodeEx(hTree10, FormatName(DSFmt), FALSE, IDI_CAPS, DXGCheckDSQualityLevels, MAKELPARAM(iAdapter, (UINT)devType), (LPARAM)DSFmt, (LPARAM)msType);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: DXG_ExpandRenderFormats()
+// Desc: Expand callback of "Render Format Compatibility"
+//       lParam1 is the iAdapter and device type
+//       lParam2 is the adapter fmt and bWindowed
+//       lParam3 is unused
+//-----------------------------------------------------------------------------
+VOID DXG_ExpandRenderFormats(HCAPNODE hParent, LPARAM lParam1, LPARAM lParam2, LPARAM /*lParam3*/)
+{
+    TRACESCOPE trace("CheckDeviceFormat");
+    UINT iAdapter = LOWORD(lParam1);
+    auto devType = static_cast<D3DDEVTYPE>(HIWORD(lParam1));
+    auto fmtAdapter = static_cast<D3DFORMAT>(LOWORD(lParam2));
+    BOOL bWindowed = (BOOL)HIWORD(lParam2);
+
+    if (!g_pD3D)
+        return;
+
+    D3DFORMAT fmtRender;
+    for (int iFmtRender = 0; iFmtRender < NumFormats; iFmtRender++)
+    {
+        fmtRender = AllFormatArray[iFmtRender];
+        if (SUCCEEDED(CheckDeviceFormat9(iAdapter, devType, fmtAdapter, D3DUSAGE_RENDERTARGET, D3DRTYPE_SURFACE, fmtRender))
+            || (IsBBFmt(fmtRender) && SUCCEEDED(CheckDeviceType9(iAdapter, devType, fmtAdapter, fmtRender, bWindowed))))
+        {
+            // The multisample/depth-stencil sweep is the expensive part, so defer it again per render format
+            (void)TVAddLazyNode(hParent, FormatName(fmtRender), IDI_CAPS, DXG_ExpandMultiSample, lParam1, lParam2, (LPARAM)fmtRender);
+        }
+    }
+}
+
+
 //-----------------------------------------------------------------------------
 // Name: DXG_Init()
 //-----------------------------------------------------------------------------
@@ -1557,6 +1601,13 @@ VOID DXG_Init()
 {
     g_is9Ex = FALSE;
 
+    // Mock devices stand in for Direct3D 9, see dxmock.cpp
+    if (MockIsActive())
+    {
+        g_pD3D = MockDirect3DCreate9(D3D_SDK_VERSION);
+        return;
+    }
+
     g_hInstD3D = LoadLibraryEx("d3d9.dll", nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
     if (g_hInstD3D)
     {
@@ -1574,10 +1625,37 @@ VOID DXG_Init()
 }
 
 
+//-----------------------------------------------------------------------------
+// Name: DXG_GetCacheKey()
+// Desc: Adds the Direct3D 9 adapters, driver versions and display modes to
+//       the snapshot cache key
+//-----------------------------------------------------------------------------
+VOID DXG_GetCacheKey()
+{
+    CacheKeyAdd(&g_is9Ex, sizeof(g_is9Ex));
+
+    UINT cAdapters = (g_pD3D) ? g_pD3D->GetAdapterCount() : 0;
+    CacheKeyAdd(&cAdapters, sizeof(cAdapters));
+
+    for (UINT iAdapter = 0; iAdapter < cAdapters; ++iAdapter)
+    {
+        D3DADAPTER_IDENTIFIER9 identifier = {};
+        if (FAILED(g_pD3D->GetAdapterIdentifier(iAdapter, 0, &identifier)))
+            identifier = {};
+        CacheKeyAdd(&identifier, sizeof(identifier));
+
+        D3DDISPLAYMODE mode = {};
+        if (FAILED(g_pD3D->GetAdapterDisplayMode(iAdapter, &mode)))
+            mode = {};
+        CacheKeyAdd(&mode, sizeof(mode));
+    }
+}
+
+
 //-----------------------------------------------------------------------------
 // Name: DXG_FillTree()
 //-----------------------------------------------------------------------------
-VOID DXG_FillTree(HWND hwndTV)
+VOID DXG_FillTree()
 {
     HRESULT hr;
     D3DDEVTYPE deviceTypeArray[] = { D3DDEVTYPE_HAL, D3DDEVTYPE_SW, D3DDEVTYPE_REF };
@@ -1592,7 +1670,8 @@ VOID DXG_FillTree(HWND hwndTV)
     if (!g_pD3D)
         return;
 
-    HTREEITEM hTree = TVAddNode(TVI_ROOT, "Direct3D9 Devices", TRUE, IDI_DIRECTX,
+    TRACESCOPE trace("DXG_FillTree");
+    HCAPNODE hTree = TVAddNode(nullptr, "Direct3D9 Devices", TRUE, IDI_DIRECTX,
         nullptr, 0, 0);
 
     UINT numAdapters = g_pD3D->GetAdapterCount();
@@ -1601,11 +1680,11 @@ VOID DXG_FillTree(HWND hwndTV)
         D3DADAPTER_IDENTIFIER9 identifier;
         if (SUCCEEDED(g_pD3D->GetAdapterIdentifier(iAdapter, 0, &identifier)))
         {
-            HTREEITEM hTree2 = TVAddNode(hTree, identifier.Description, TRUE, IDI_CAPS,
+            HCAPNODE hTree2 = TVAddNode(hTree, identifier.Description, TRUE, IDI_CAPS,
                 DXGDisplayAdapterInfo, iAdapter, 0);
             (void)TVAddNode(hTree2, "Display Modes", FALSE, IDI_CAPS,
                 DXGDisplayModes, iAdapter, 0);
-            HTREEITEM hTree3 = TVAddNode(hTree2, "D3D Device Types", TRUE, IDI_CAPS,
+            HCAPNODE hTree3 = TVAddNode(hTree2, "D3D Device Types", TRUE, IDI_CAPS,
                 nullptr, 0, 0);
 
             for (iDevice = 0; iDevice < numDeviceTypes; iDevice++)
@@ -1619,18 +1698,19 @@ VOID DXG_FillTree(HWND hwndTV)
                     continue;
 
                 // Add caps for each device
-                hr = g_pD3D->GetDeviceCaps(iAdapter, devType, &caps);
+                TRACESCOPE traceDevice("D3D9 device type", deviceNameArray[iDevice]);
+                hr = GetDeviceCaps9(iAdapter, devType, &caps);
                 if (FAILED(hr))
                     memset(&caps, 0, sizeof(caps));
-                pCapsCopy = new (std::nothrow) D3DCAPS9;
+                pCapsCopy = static_cast<D3DCAPS9*>(TVAlloc(sizeof(D3DCAPS9)));
                 if (!pCapsCopy)
                     continue;
                 *pCapsCopy = caps;
-                HTREEITEM hTree4 = TVAddNode(hTree3, deviceNameArray[iDevice], TRUE, IDI_CAPS, nullptr, 0, 0);
+                HCAPNODE hTree4 = TVAddNode(hTree3, deviceNameArray[iDevice], TRUE, IDI_CAPS, nullptr, 0, 0);
                 AddCapsToTV(hTree4, DXGCapDefs, (LPARAM)pCapsCopy);
 
                 // List adapter formats for each device
-                HTREEITEM hTree5 = TVAddNode(hTree4, "Adapter Formats", TRUE, IDI_CAPS, nullptr, 0, 0);
+                HCAPNODE hTree5 = TVAddNode(hTree4, "Adapter Formats", TRUE, IDI_CAPS, nullptr, 0, 0);
                 D3DFORMAT fmtAdapter;
                 for (int iFmtAdapter = 0; iFmtAdapter < NumAdapterFormats; iFmtAdapter++)
                 {
@@ -1642,7 +1722,7 @@ VOID DXG_FillTree(HWND hwndTV)
 
                         TCHAR sz[100];
                         sprintf_s(sz, sizeof(sz), "%s %s", FormatName(fmtAdapter), bWindowed ? "(Windowed)" : "(Fullscreen)");
-                        HTREEITEM hTree6 = TVAddNode(hTree5, sz, TRUE, IDI_CAPS, nullptr, 0, 0);
+                        HCAPNODE hTree6 = TVAddNode(hTree5, sz, TRUE, IDI_CAPS, nullptr, 0, 0);
                         TVAddNodeEx(hTree6, "Back Buffer Formats", FALSE, IDI_CAPS, DXGDisplayBackBuffer, MAKELPARAM(iAdapter, (UINT)devType), (LPARAM)fmtAdapter, (LPARAM)bWindowed);
                         TVAddNodeEx(hTree6, "Render Target Formats", FALSE, IDI_CAPS, DXGDisplayRenderTarget, MAKELPARAM(iAdapter, (UINT)devType), (LPARAM)fmtAdapter, (LPARAM)0);
                         TVAddNodeEx(hTree6, "Depth/Stencil Formats", FALSE, IDI_CAPS, DXGDisplayDepthStencil, MAKELPARAM(iAdapter, (UINT)devType), (LPARAM)fmtAdapter, (LPARAM)0);
@@ -1650,48 +1730,14 @@ VOID DXG_FillTree(HWND hwndTV)
                         TVAddNodeEx(hTree6, "Texture Formats", FALSE, IDI_CAPS, DXGDisplayResource, MAKELPARAM(iAdapter, (UINT)devType), (LPARAM)fmtAdapter, (LPARAM)D3DRTYPE_TEXTURE);
                         TVAddNodeEx(hTree6, "Cube Texture Formats", FALSE, IDI_CAPS, DXGDisplayResource, MAKELPARAM(iAdapter, (UINT)devType), (LPARAM)fmtAdapter, (LPARAM)D3DRTYPE_CUBETEXTURE);
                         TVAddNodeEx(hTree6, "Volume Texture Formats", FALSE, IDI_CAPS, DXGDisplayResource, MAKELPARAM(iAdapter, (UINT)devType), (LPARAM)fmtAdapter, (LPARAM)D3DRTYPE_VOLUMETEXTURE);
-                        HTREEITEM hTree7 = TVAddNode(hTree6, "Render Format Compatibility", TRUE, IDI_CAPS, nullptr, 0, 0);
-                        D3DFORMAT fmtRender;
-                        for (int iFmtRender = 0; iFmtRender < NumFormats; iFmtRender++)
-                        {
-                            fmtRender = AllFormatArray[iFmtRender];
-                            if (SUCCEEDED(g_pD3D->CheckDeviceFormat(iAdapter, devType, fmtAdapter, D3DUSAGE_RENDERTARGET, D3DRTYPE_SURFACE, fmtRender))
-                                || (IsBBFmt(fmtRender) && SUCCEEDED(g_pD3D->CheckDeviceType(iAdapter, devType, fmtAdapter, fmtRender, bWindowed))))
-                            {
-                                HTREEITEM hTree8 = TVAddNode(hTree7, FormatName(fmtRender), TRUE, IDI_CAPS, nullptr, 0, 0);
-                                for (D3DMULTISAMPLE_TYPE msType = D3DMULTISAMPLE_NONE; msType <= D3DMULTISAMPLE_16_SAMPLES; msType = (D3DMULTISAMPLE_TYPE)((UINT)msType + 1))
-                                {
-                                    if (SUCCEEDED(g_pD3D->CheckDeviceMultiSampleType(iAdapter, devType, fmtRender, bWindowed, msType, nullptr)))
-                                    {
-                                        HTREEITEM hTree9 = TVAddNodeEx(hTree8, MultiSampleTypeName(msType), TRUE, IDI_CAPS, DXGDisplayMultiSample, MAKELPARAM(iAdapter, (UINT)devType), MAKELPARAM(bWindowed, (UINT)msType), (LPARAM)fmtRender);
-                                        HTREEITEM hTree10 = TVAddNode(hTree9, "Compatible Depth/Stencil Formats", TRUE, IDI_CAPS, nullptr, 0, 0);
-                                        D3DFORMAT DSFmt;
-                                        for (int iFmt = 0; iFmt < NumDSFormats; iFmt++)
-                                        {
-                                            DSFmt = DSFormatArray[iFmt];
-                                            if (SUCCEEDED(g_pD3D->CheckDeviceFormat(iAdapter, devType, fmtAdapter, D3DUSAGE_DEPTHSTENCIL,
-                                                D3DRTYPE_SURFACE, DSFmt)))
-                                            {
-                                                if (SUCCEEDED(g_pD3D->CheckDepthStencilMatch(iAdapter, devType, fmtAdapter, fmtRender, DSFmt)))
-                                                {
-                                                    if (SUCCEEDED(g_pD3D->CheckDeviceMultiSampleType(iAdapter, devType, DSFmt, bWindowed, msType, nullptr)))
-                                                    {
-                                                        (void)TVAddNodeEx(hTree10, FormatName(DSFmt), FALSE, IDI_CAPS, DXGCheckDSQualityLevels, MAKELPARAM(iAdapter, (UINT)devType), (LPARAM)DSFmt, (LPARAM)msType);
-                                                    }
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        }
+                        (void)TVAddLazyNode(hTree6, "Render Format Compatibility", IDI_CAPS, DXG_ExpandRenderFormats, MAKELPARAM(iAdapter, (UINT)devType), MAKELPARAM((UINT)fmtAdapter, bWindowed), 0);
                     }
                 }
             }
         }
     }
 
-    TreeView_Expand(hwndTV, hTree, TVE_EXPAND);
+    TVExpandNode(hTree);
 }
 
 
@@ -22,6 +22,8 @@
 #include <d3d10_1.h>
 #include <d3d11_4.h>
 
+#include "dxtables.h"
+
 // Define for some debug output
 //#define EXTRA_DEBUG
 
@@ -36,22 +38,7 @@ extern "C"
 
 //-----------------------------------------------------------------------------
 
-// This mask is only needed for Direct3D 10.x/11 where some devices had 'holes' in the feature support.
-enum FLMASK : uint32_t
-{
-    FLMASK_9_1 = 0x1,
-    FLMASK_9_2 = 0x2,
-    FLMASK_9_3 = 0x4,
-    FLMASK_10_0 = 0x8,
-    FLMASK_10_1 = 0x10,
-    FLMASK_11_0 = 0x20,
-    FLMASK_11_1 = 0x40,
-    FLMASK_12_0 = 0x80,
-    FLMASK_12_1 = 0x100,
-};
-
 #if !defined(NTDDI_WIN10_FE) && !defined(USING_D3D12_AGILITY_SDK)
-#define D3D_FEATURE_LEVEL_12_2 static_cast<D3D_FEATURE_LEVEL>(0xc200)
 #define D3D_SHADER_MODEL_6_7 static_cast<D3D_SHADER_MODEL>(0x67)
 #pragma warning(disable : 4063 4702)
 #endif
@@ -114,6 +101,7 @@ namespace
     IDXGIFactory3* g_DXGIFactory3 = nullptr;
     IDXGIFactory4* g_DXGIFactory4 = nullptr;
     IDXGIFactory5* g_DXGIFactory5 = nullptr;
+    IDXGIFactory1* g_DXGIFactoryRecord = nullptr;   // Stands in for g_DXGIFactory1 while recording
     HMODULE g_dxgi = nullptr;
 
     LPD3D10CREATEDEVICE g_D3D10CreateDevice = nullptr;
@@ -134,8 +122,17 @@ extern const char c_szYes[];
 extern const char c_szNo[];
 extern const char c_szNA[];
 
-const char c_szOptYes[] = "Optional (Yes)";
-const char c_szOptNo[] = "Optional (No)";
+HRESULT WINAPI MockCreateDXGIFactory1(REFIID riid, void** ppFactory);
+HRESULT WINAPI MockD3D11CreateDevice(IDXGIAdapter* pAdapter, D3D_DRIVER_TYPE driverType, HMODULE hSoftware,
+    UINT flags, const D3D_FEATURE_LEVEL* pFeatureLevels, UINT featureLevels, UINT sdkVersion,
+    ID3D11Device** ppDevice, D3D_FEATURE_LEVEL* pFeatureLevel, ID3D11DeviceContext** ppImmediateContext);
+HRESULT WINAPI MockD3D10CreateDevice1(IDXGIAdapter* pAdapter, D3D10_DRIVER_TYPE driverType, HMODULE hSoftware,
+    UINT flags, D3D10_FEATURE_LEVEL1 featureLevel, UINT sdkVersion, ID3D10Device1** ppDevice);
+HRESULT WINAPI MockD3D10CreateDevice(IDXGIAdapter* pAdapter, D3D10_DRIVER_TYPE driverType, HMODULE hSoftware,
+    UINT flags, UINT32 sdkVersion, ID3D10Device** ppDevice);
+
+extern const char c_szOptYes[] = "Optional (Yes)";
+extern const char c_szOptNo[] = "Optional (No)";
 
 namespace
 {
@@ -281,25 +278,6 @@ namespace
         DXGI_FORMAT_B4G4R4A4_UNORM,
     };
 
-    BOOL g_sampCount10[D3D10_MAX_MULTISAMPLE_SAMPLE_COUNT];
-    BOOL g_sampCount10_1[D3D10_MAX_MULTISAMPLE_SAMPLE_COUNT];
-    BOOL g_sampCount11[D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT];
-    BOOL g_sampCount11_1[D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT];
-
-    const D3D_FEATURE_LEVEL g_featureLevels[] =
-    {
-        D3D_FEATURE_LEVEL_12_2,
-        D3D_FEATURE_LEVEL_12_1,
-        D3D_FEATURE_LEVEL_12_0,
-        D3D_FEATURE_LEVEL_11_1,
-        D3D_FEATURE_LEVEL_11_0,
-        D3D_FEATURE_LEVEL_10_1,
-        D3D_FEATURE_LEVEL_10_0,
-        D3D_FEATURE_LEVEL_9_3,
-        D3D_FEATURE_LEVEL_9_2,
-        D3D_FEATURE_LEVEL_9_1
-    };
-
     D3D_FEATURE_LEVEL GetD3D12FeatureLevel(_In_ ID3D12Device* device)
     {
         D3D12_FEATURE_DATA_FEATURE_LEVELS flData = {};
@@ -403,7 +381,9 @@ namespace
     T GetD3D11Options(_In_ ID3D11Device* device)
     {
         T opts = {};
-        if (FAILED(device->CheckFeatureSupport(feature, &opts, sizeof(T))))
+        LONGLONG qpcStart = TraceNow();
+        HRESULT hr = device->CheckFeatureSupport(feature, &opts, sizeof(T));
+        if (FAILED(StatsAdd(API_CHECKFEATURESUPPORT, qpcStart, hr)))
         {
             memset(&opts, 0, sizeof(T));
         }
@@ -414,7 +394,9 @@ namespace
     T GetD3D12Options(_In_ ID3D12Device* device)
     {
         T opts = {};
-        if (FAILED(device->CheckFeatureSupport(feature, &opts, sizeof(T))))
+        LONGLONG qpcStart = TraceNow();
+        HRESULT hr = device->CheckFeatureSupport(feature, &opts, sizeof(T));
+        if (FAILED(StatsAdd(API_CHECKFEATURESUPPORT, qpcStart, hr)))
         {
             memset(&opts, 0, sizeof(T));
         }
@@ -424,134 +406,6 @@ namespace
     //-----------------------------------------------------------------------------
 #define ENUMNAME(a) case a: return TEXT(#a)
 
-    const TCHAR* FormatName(DXGI_FORMAT format)
-    {
-        switch (format)
-        {
-            ENUMNAME(DXGI_FORMAT_R32G32B32A32_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_R32G32B32A32_FLOAT);
-            ENUMNAME(DXGI_FORMAT_R32G32B32A32_UINT);
-            ENUMNAME(DXGI_FORMAT_R32G32B32A32_SINT);
-            ENUMNAME(DXGI_FORMAT_R32G32B32_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_R32G32B32_FLOAT);
-            ENUMNAME(DXGI_FORMAT_R32G32B32_UINT);
-            ENUMNAME(DXGI_FORMAT_R32G32B32_SINT);
-            ENUMNAME(DXGI_FORMAT_R16G16B16A16_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_R16G16B16A16_FLOAT);
-            ENUMNAME(DXGI_FORMAT_R16G16B16A16_UNORM);
-            ENUMNAME(DXGI_FORMAT_R16G16B16A16_UINT);
-            ENUMNAME(DXGI_FORMAT_R16G16B16A16_SNORM);
-            ENUMNAME(DXGI_FORMAT_R16G16B16A16_SINT);
-            ENUMNAME(DXGI_FORMAT_R32G32_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_R32G32_FLOAT);
-            ENUMNAME(DXGI_FORMAT_R32G32_UINT);
-            ENUMNAME(DXGI_FORMAT_R32G32_SINT);
-            ENUMNAME(DXGI_FORMAT_R32G8X24_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_D32_FLOAT_S8X24_UINT);
-            ENUMNAME(DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_X32_TYPELESS_G8X24_UINT);
-            ENUMNAME(DXGI_FORMAT_R10G10B10A2_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_R10G10B10A2_UNORM);
-            ENUMNAME(DXGI_FORMAT_R10G10B10A2_UINT);
-            ENUMNAME(DXGI_FORMAT_R11G11B10_FLOAT);
-            ENUMNAME(DXGI_FORMAT_R8G8B8A8_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_R8G8B8A8_UNORM);
-            ENUMNAME(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB);
-            ENUMNAME(DXGI_FORMAT_R8G8B8A8_UINT);
-            ENUMNAME(DXGI_FORMAT_R8G8B8A8_SNORM);
-            ENUMNAME(DXGI_FORMAT_R8G8B8A8_SINT);
-            ENUMNAME(DXGI_FORMAT_R16G16_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_R16G16_FLOAT);
-            ENUMNAME(DXGI_FORMAT_R16G16_UNORM);
-            ENUMNAME(DXGI_FORMAT_R16G16_UINT);
-            ENUMNAME(DXGI_FORMAT_R16G16_SNORM);
-            ENUMNAME(DXGI_FORMAT_R16G16_SINT);
-            ENUMNAME(DXGI_FORMAT_R32_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_D32_FLOAT);
-            ENUMNAME(DXGI_FORMAT_R32_FLOAT);
-            ENUMNAME(DXGI_FORMAT_R32_UINT);
-            ENUMNAME(DXGI_FORMAT_R32_SINT);
-            ENUMNAME(DXGI_FORMAT_R24G8_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_D24_UNORM_S8_UINT);
-            ENUMNAME(DXGI_FORMAT_R24_UNORM_X8_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_X24_TYPELESS_G8_UINT);
-            ENUMNAME(DXGI_FORMAT_R8G8_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_R8G8_UNORM);
-            ENUMNAME(DXGI_FORMAT_R8G8_UINT);
-            ENUMNAME(DXGI_FORMAT_R8G8_SNORM);
-            ENUMNAME(DXGI_FORMAT_R8G8_SINT);
-            ENUMNAME(DXGI_FORMAT_R16_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_R16_FLOAT);
-            ENUMNAME(DXGI_FORMAT_D16_UNORM);
-            ENUMNAME(DXGI_FORMAT_R16_UNORM);
-            ENUMNAME(DXGI_FORMAT_R16_UINT);
-            ENUMNAME(DXGI_FORMAT_R16_SNORM);
-            ENUMNAME(DXGI_FORMAT_R16_SINT);
-            ENUMNAME(DXGI_FORMAT_R8_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_R8_UNORM);
-            ENUMNAME(DXGI_FORMAT_R8_UINT);
-            ENUMNAME(DXGI_FORMAT_R8_SNORM);
-            ENUMNAME(DXGI_FORMAT_R8_SINT);
-            ENUMNAME(DXGI_FORMAT_A8_UNORM);
-            ENUMNAME(DXGI_FORMAT_R1_UNORM);
-            ENUMNAME(DXGI_FORMAT_R9G9B9E5_SHAREDEXP);
-            ENUMNAME(DXGI_FORMAT_R8G8_B8G8_UNORM);
-            ENUMNAME(DXGI_FORMAT_G8R8_G8B8_UNORM);
-            ENUMNAME(DXGI_FORMAT_BC1_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_BC1_UNORM);
-            ENUMNAME(DXGI_FORMAT_BC1_UNORM_SRGB);
-            ENUMNAME(DXGI_FORMAT_BC2_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_BC2_UNORM);
-            ENUMNAME(DXGI_FORMAT_BC2_UNORM_SRGB);
-            ENUMNAME(DXGI_FORMAT_BC3_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_BC3_UNORM);
-            ENUMNAME(DXGI_FORMAT_BC3_UNORM_SRGB);
-            ENUMNAME(DXGI_FORMAT_BC4_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_BC4_UNORM);
-            ENUMNAME(DXGI_FORMAT_BC4_SNORM);
-            ENUMNAME(DXGI_FORMAT_BC5_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_BC5_UNORM);
-            ENUMNAME(DXGI_FORMAT_BC5_SNORM);
-            ENUMNAME(DXGI_FORMAT_B5G6R5_UNORM);
-            ENUMNAME(DXGI_FORMAT_B5G5R5A1_UNORM);
-            ENUMNAME(DXGI_FORMAT_B8G8R8A8_UNORM);
-            ENUMNAME(DXGI_FORMAT_B8G8R8X8_UNORM);
-            ENUMNAME(DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM);
-            ENUMNAME(DXGI_FORMAT_B8G8R8A8_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_B8G8R8A8_UNORM_SRGB);
-            ENUMNAME(DXGI_FORMAT_B8G8R8X8_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_B8G8R8X8_UNORM_SRGB);
-            ENUMNAME(DXGI_FORMAT_BC6H_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_BC6H_UF16);
-            ENUMNAME(DXGI_FORMAT_BC6H_SF16);
-            ENUMNAME(DXGI_FORMAT_BC7_TYPELESS);
-            ENUMNAME(DXGI_FORMAT_BC7_UNORM);
-            ENUMNAME(DXGI_FORMAT_BC7_UNORM_SRGB);
-            ENUMNAME(DXGI_FORMAT_AYUV);
-            ENUMNAME(DXGI_FORMAT_Y410);
-            ENUMNAME(DXGI_FORMAT_Y416);
-            ENUMNAME(DXGI_FORMAT_NV12);
-            ENUMNAME(DXGI_FORMAT_P010);
-            ENUMNAME(DXGI_FORMAT_P016);
-            ENUMNAME(DXGI_FORMAT_420_OPAQUE);
-            ENUMNAME(DXGI_FORMAT_YUY2);
-            ENUMNAME(DXGI_FORMAT_Y210);
-            ENUMNAME(DXGI_FORMAT_Y216);
-            ENUMNAME(DXGI_FORMAT_NV11);
-            ENUMNAME(DXGI_FORMAT_AI44);
-            ENUMNAME(DXGI_FORMAT_IA44);
-            ENUMNAME(DXGI_FORMAT_P8);
-            ENUMNAME(DXGI_FORMAT_A8P8);
-            ENUMNAME(DXGI_FORMAT_B4G4R4A4_UNORM);
-            ENUMNAME(DXGI_FORMAT_P208);
-            ENUMNAME(DXGI_FORMAT_V208);
-            ENUMNAME(DXGI_FORMAT_V408);
-
-        default:
-            return TEXT("DXGI_FORMAT_UNKNOWN");
-        }
-    }
-
     const TCHAR* FLName(D3D10_FEATURE_LEVEL1 lvl)
     {
         switch (lvl)
@@ -600,6 +454,23 @@ namespace
             return (UINT)(float(Rate.Numerator) / float(Rate.Denominator));
     }
 
+    //-----------------------------------------------------------------------------
+    // Name: EmitDriverVersion()
+    // Desc: The user-mode driver version, as used in the snapshot cache key
+    //-----------------------------------------------------------------------------
+    VOID EmitDriverVersion(IDXGIAdapter* pAdapter, PRINTCBINFO* pPrintInfo)
+    {
+        LARGE_INTEGER umdVersion = {};
+        if (FAILED(pAdapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umdVersion)))
+            return;
+
+        char szVersion[32];
+        sprintf_s(szVersion, "%u.%u.%u.%u",
+            HIWORD(umdVersion.HighPart), LOWORD(umdVersion.HighPart),
+            HIWORD(umdVersion.LowPart), LOWORD(umdVersion.LowPart));
+        EmitTextRow(pPrintInfo, "Driver Version", szVersion);
+    }
+
     //-----------------------------------------------------------------------------
     HRESULT DXGIAdapterInfo(LPARAM /*lParam1*/, LPARAM lParam2, PRINTCBINFO* pPrintInfo)
     {
@@ -607,11 +478,8 @@ namespace
         if (!pAdapter)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-            LVAddColumn(g_hwndLV, 1, "Value", 50);
-        }
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 1, "Value", 50);
 
         DXGI_ADAPTER_DESC desc;
         HRESULT hr = pAdapter->GetDesc(&desc);
@@ -626,43 +494,15 @@ namespace
 
         wcstombs_s(nullptr, szDesc, desc.Description, 128);
 
-        if (!pPrintInfo)
-        {
-            LVAddText(g_hwndLV, 0, "Description");
-            LVAddText(g_hwndLV, 1, "%s", szDesc);
-
-            LVAddText(g_hwndLV, 0, "VendorId");
-            LVAddText(g_hwndLV, 1, "0x%08x", desc.VendorId);
-
-            LVAddText(g_hwndLV, 0, "DeviceId");
-            LVAddText(g_hwndLV, 1, "0x%08x", desc.DeviceId);
-
-            LVAddText(g_hwndLV, 0, "SubSysId");
-            LVAddText(g_hwndLV, 1, "0x%08x", desc.SubSysId);
-
-            LVAddText(g_hwndLV, 0, "Revision");
-            LVAddText(g_hwndLV, 1, "%d", desc.Revision);
-
-            LVAddText(g_hwndLV, 0, "DedicatedVideoMemory (MB)");
-            LVAddText(g_hwndLV, 1, "%d", dvm);
-
-            LVAddText(g_hwndLV, 0, "DedicatedSystemMemory (MB)");
-            LVAddText(g_hwndLV, 1, "%d", dsm);
-
-            LVAddText(g_hwndLV, 0, "SharedSystemMemory (MB)");
-            LVAddText(g_hwndLV, 1, "%d", ssm);
-        }
-        else
-        {
-            PrintStringValueLine("Description", szDesc, pPrintInfo);
-            PrintHexValueLine("VendorId", desc.VendorId, pPrintInfo);
-            PrintHexValueLine("DeviceId", desc.DeviceId, pPrintInfo);
-            PrintHexValueLine("SubSysId", desc.SubSysId, pPrintInfo);
-            PrintValueLine("Revision", desc.Revision, pPrintInfo);
-            PrintValueLine("DedicatedVideoMemory (MB)", dvm, pPrintInfo);
-            PrintValueLine("DedicatedSystemMemory (MB)", dsm, pPrintInfo);
-            PrintValueLine("SharedSystemMemory (MB)", ssm, pPrintInfo);
-        }
+        EmitTextRow(pPrintInfo, "Description", szDesc);
+        EmitHexRow(pPrintInfo, "VendorId", desc.VendorId);
+        EmitHexRow(pPrintInfo, "DeviceId", desc.DeviceId);
+        EmitHexRow(pPrintInfo, "SubSysId", desc.SubSysId);
+        EmitValueRow(pPrintInfo, "Revision", desc.Revision);
+        EmitDriverVersion(pAdapter, pPrintInfo);
+        EmitValueRow(pPrintInfo, "DedicatedVideoMemory (MB)", dvm);
+        EmitValueRow(pPrintInfo, "DedicatedSystemMemory (MB)", dsm);
+        EmitValueRow(pPrintInfo, "SharedSystemMemory (MB)", ssm);
 
         return S_OK;
     }
@@ -673,11 +513,8 @@ namespace
         if (!pAdapter)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-            LVAddColumn(g_hwndLV, 1, "Value", 50);
-        }
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 1, "Value", 50);
 
         DXGI_ADAPTER_DESC1 desc;
         HRESULT hr = pAdapter->GetDesc1(&desc);
@@ -692,47 +529,16 @@ namespace
 
         wcstombs_s(nullptr, szDesc, desc.Description, 128);
 
-        if (!pPrintInfo)
-        {
-            LVAddText(g_hwndLV, 0, "Description");
-            LVAddText(g_hwndLV, 1, "%s", szDesc);
-
-            LVAddText(g_hwndLV, 0, "VendorId");
-            LVAddText(g_hwndLV, 1, "0x%08x", desc.VendorId);
-
-            LVAddText(g_hwndLV, 0, "DeviceId");
-            LVAddText(g_hwndLV, 1, "0x%08x", desc.DeviceId);
-
-            LVAddText(g_hwndLV, 0, "SubSysId");
-            LVAddText(g_hwndLV, 1, "0x%08x", desc.SubSysId);
-
-            LVAddText(g_hwndLV, 0, "Revision");
-            LVAddText(g_hwndLV, 1, "%d", desc.Revision);
-
-            LVAddText(g_hwndLV, 0, "DedicatedVideoMemory (MB)");
-            LVAddText(g_hwndLV, 1, "%d", dvm);
-
-            LVAddText(g_hwndLV, 0, "DedicatedSystemMemory (MB)");
-            LVAddText(g_hwndLV, 1, "%d", dsm);
-
-            LVAddText(g_hwndLV, 0, "SharedSystemMemory (MB)");
-            LVAddText(g_hwndLV, 1, "%d", ssm);
-
-            LVAddText(g_hwndLV, 0, "Remote");
-            LVAddText(g_hwndLV, 1, (desc.Flags & DXGI_ADAPTER_FLAG_REMOTE) ? c_szYes : c_szNo);
-        }
-        else
-        {
-            PrintStringValueLine("Description", szDesc, pPrintInfo);
-            PrintHexValueLine("VendorId", desc.VendorId, pPrintInfo);
-            PrintHexValueLine("DeviceId", desc.DeviceId, pPrintInfo);
-            PrintHexValueLine("SubSysId", desc.SubSysId, pPrintInfo);
-            PrintValueLine("Revision", desc.Revision, pPrintInfo);
-            PrintValueLine("DedicatedVideoMemory (MB)", dvm, pPrintInfo);
-            PrintValueLine("DedicatedSystemMemory (MB)", dsm, pPrintInfo);
-            PrintValueLine("SharedSystemMemory (MB)", ssm, pPrintInfo);
-            PrintStringValueLine("Remote", (desc.Flags & DXGI_ADAPTER_FLAG_REMOTE) ? c_szYes : c_szNo, pPrintInfo);
-        }
+        EmitTextRow(pPrintInfo, "Description", szDesc);
+        EmitHexRow(pPrintInfo, "VendorId", desc.VendorId);
+        EmitHexRow(pPrintInfo, "DeviceId", desc.DeviceId);
+        EmitHexRow(pPrintInfo, "SubSysId", desc.SubSysId);
+        EmitValueRow(pPrintInfo, "Revision", desc.Revision);
+        EmitDriverVersion(pAdapter, pPrintInfo);
+        EmitValueRow(pPrintInfo, "DedicatedVideoMemory (MB)", dvm);
+        EmitValueRow(pPrintInfo, "DedicatedSystemMemory (MB)", dsm);
+        EmitValueRow(pPrintInfo, "SharedSystemMemory (MB)", ssm);
+        EmitTextRow(pPrintInfo, "Remote", (desc.Flags & DXGI_ADAPTER_FLAG_REMOTE) ? c_szYes : c_szNo);
 
         return S_OK;
     }
@@ -743,11 +549,8 @@ namespace
         if (!pAdapter)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-            LVAddColumn(g_hwndLV, 1, "Value", 50);
-        }
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 1, "Value", 50);
 
         DXGI_ADAPTER_DESC2 desc;
         HRESULT hr = pAdapter->GetDesc2(&desc);
@@ -785,55 +588,18 @@ namespace
         default:                                             cpg = "Unknown"; break;
         }
 
-        if (!pPrintInfo)
-        {
-            LVAddText(g_hwndLV, 0, "Description");
-            LVAddText(g_hwndLV, 1, "%s", szDesc);
-
-            LVAddText(g_hwndLV, 0, "VendorId");
-            LVAddText(g_hwndLV, 1, "0x%08x", desc.VendorId);
-
-            LVAddText(g_hwndLV, 0, "DeviceId");
-            LVAddText(g_hwndLV, 1, "0x%08x", desc.DeviceId);
-
-            LVAddText(g_hwndLV, 0, "SubSysId");
-            LVAddText(g_hwndLV, 1, "0x%08x", desc.SubSysId);
-
-            LVAddText(g_hwndLV, 0, "Revision");
-            LVAddText(g_hwndLV, 1, "%d", desc.Revision);
-
-            LVAddText(g_hwndLV, 0, "DedicatedVideoMemory (MB)");
-            LVAddText(g_hwndLV, 1, "%d", dvm);
-
-            LVAddText(g_hwndLV, 0, "DedicatedSystemMemory (MB)");
-            LVAddText(g_hwndLV, 1, "%d", dsm);
-
-            LVAddText(g_hwndLV, 0, "SharedSystemMemory (MB)");
-            LVAddText(g_hwndLV, 1, "%d", ssm);
-
-            LVAddText(g_hwndLV, 0, "Remote");
-            LVAddText(g_hwndLV, 1, (desc.Flags & DXGI_ADAPTER_FLAG_REMOTE) ? c_szYes : c_szNo);
-
-            LVAddText(g_hwndLV, 0, "Graphics Preemption Granularity");
-            LVAddText(g_hwndLV, 1, gpg);
-
-            LVAddText(g_hwndLV, 0, "Compute Preemption Granularity");
-            LVAddText(g_hwndLV, 1, cpg);
-        }
-        else
-        {
-            PrintStringValueLine("Description", szDesc, pPrintInfo);
-            PrintHexValueLine("VendorId", desc.VendorId, pPrintInfo);
-            PrintHexValueLine("DeviceId", desc.DeviceId, pPrintInfo);
-            PrintHexValueLine("SubSysId", desc.SubSysId, pPrintInfo);
-            PrintValueLine("Revision", desc.Revision, pPrintInfo);
-            PrintValueLine("DedicatedVideoMemory (MB)", dvm, pPrintInfo);
-            PrintValueLine("DedicatedSystemMemory (MB)", dsm, pPrintInfo);
-            PrintValueLine("SharedSystemMemory (MB)", ssm, pPrintInfo);
-            PrintStringValueLine("Remote", (desc.Flags & DXGI_ADAPTER_FLAG_REMOTE) ? c_szYes : c_szNo, pPrintInfo);
-            PrintStringValueLine("Graphics Preemption Granularity", gpg, pPrintInfo);
-            PrintStringValueLine("Compute Preemption Granularity", cpg, pPrintInfo);
-        }
+        EmitTextRow(pPrintInfo, "Description", szDesc);
+        EmitHexRow(pPrintInfo, "VendorId", desc.VendorId);
+        EmitHexRow(pPrintInfo, "DeviceId", desc.DeviceId);
+        EmitHexRow(pPrintInfo, "SubSysId", desc.SubSysId);
+        EmitValueRow(pPrintInfo, "Revision", desc.Revision);
+        EmitDriverVersion(pAdapter, pPrintInfo);
+        EmitValueRow(pPrintInfo, "DedicatedVideoMemory (MB)", dvm);
+        EmitValueRow(pPrintInfo, "DedicatedSystemMemory (MB)", dsm);
+        EmitValueRow(pPrintInfo, "SharedSystemMemory (MB)", ssm);
+        EmitTextRow(pPrintInfo, "Remote", (desc.Flags & DXGI_ADAPTER_FLAG_REMOTE) ? c_szYes : c_szNo);
+        EmitTextRow(pPrintInfo, "Graphics Preemption Granularity", gpg);
+        EmitTextRow(pPrintInfo, "Compute Preemption Granularity", cpg);
 
         return S_OK;
     }
@@ -845,11 +611,8 @@ namespace
         if (!pOutput)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-            LVAddColumn(g_hwndLV, 1, "Value", 40);
-        }
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 1, "Value", 40);
 
         DXGI_OUTPUT_DESC desc;
         HRESULT hr = pOutput->GetDesc(&desc);
@@ -860,23 +623,9 @@ namespace
 
         wcstombs_s(nullptr, szDevName, desc.DeviceName, 32);
 
-        if (!pPrintInfo)
-        {
-            LVAddText(g_hwndLV, 0, "DeviceName");
-            LVAddText(g_hwndLV, 1, "%s", szDevName);
-
-            LVAddText(g_hwndLV, 0, "AttachedToDesktop");
-            LVAddText(g_hwndLV, 1, desc.AttachedToDesktop ? c_szYes : c_szNo);
-
-            LVAddText(g_hwndLV, 0, "Rotation");
-            LVAddText(g_hwndLV, 1, szRotation[desc.Rotation]);
-        }
-        else
-        {
-            PrintStringValueLine("DeviceName", szDevName, pPrintInfo);
-            PrintStringValueLine("AttachedToDesktop", desc.AttachedToDesktop ? c_szYes : c_szNo, pPrintInfo);
-            PrintStringValueLine("Rotation", szRotation[desc.Rotation], pPrintInfo);
-        }
+        EmitTextRow(pPrintInfo, "DeviceName", szDevName);
+        EmitTextRow(pPrintInfo, "AttachedToDesktop", desc.AttachedToDesktop ? c_szYes : c_szNo);
+        EmitTextRow(pPrintInfo, "Rotation", szRotation[desc.Rotation]);
 
         return S_OK;
     }
@@ -888,12 +637,9 @@ namespace
         if (!pOutput)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Resolution", 14);
-            LVAddColumn(g_hwndLV, 1, "Pixel Format", 40);
-            LVAddColumn(g_hwndLV, 2, "Refresh Rate", 10);
-        }
+        EmitColumn(pPrintInfo, 0, "Resolution", 14);
+        EmitColumn(pPrintInfo, 1, "Pixel Format", 40);
+        EmitColumn(pPrintInfo, 2, "Refresh Rate", 10);
 
         for (UINT iFormat = 0; iFormat < NumAdapterFormats; ++iFormat)
         {
@@ -927,41 +673,20 @@ namespace
                     for (UINT iMode = 0; iMode < num; ++iMode)
                     {
                         const DXGI_MODE_DESC* pDesc = &pDescs[iMode];
-                        if (!pPrintInfo)
+
+                        char szRes[32];
+                        sprintf_s(szRes, sizeof(szRes), "%u x %u", pDesc->Width, pDesc->Height);
+
+                        const ROWCELL cells[3] =
                         {
-                            LVAddText(g_hwndLV, 0, "%d x %d", pDesc->Width, pDesc->Height);
-                            LVAddText(g_hwndLV, 1, FormatName(pDesc->Format));
-                            LVAddText(g_hwndLV, 2, "%d", RefreshRate(pDesc->RefreshRate));
-                        }
-                        else
+                            { CELL_TEXT, szRes, 0 },
+                            { CELL_TEXT, FormatName(pDesc->Format), 0 },
+                            { CELL_UINT, nullptr, RefreshRate(pDesc->RefreshRate) },
+                        };
+                        if (FAILED(EmitRow(pPrintInfo, 3, cells)))
                         {
-                            char  szBuff[80];
-                            DWORD cchLen;
-
-                            // Calculate Name and Value column x offsets
-                            int x1 = (pPrintInfo->dwCurrIndent * DEF_TAB_SIZE * pPrintInfo->dwCharWidth);
-                            int x2 = x1 + (30 * pPrintInfo->dwCharWidth);
-                            int x3 = x2 + (20 * pPrintInfo->dwCharWidth);
-                            int yLine = (pPrintInfo->dwCurrLine * pPrintInfo->dwLineHeight);
-
-                            sprintf_s(szBuff, sizeof(szBuff), "%u x %u", pDesc->Width, pDesc->Height);
-                            cchLen = static_cast<DWORD>(_tcslen(szBuff));
-                            if (FAILED(PrintLine(x1, yLine, szBuff, cchLen, pPrintInfo)))
-                                return E_FAIL;
-
-                            strcpy_s(szBuff, sizeof(szBuff), FormatName(pDesc->Format));
-                            cchLen = static_cast<DWORD>(_tcslen(szBuff));
-                            if (FAILED(PrintLine(x2, yLine, szBuff, cchLen, pPrintInfo)))
-                                return E_FAIL;
-
-                            sprintf_s(szBuff, sizeof(szBuff), "%u", RefreshRate(pDesc->RefreshRate));
-                            cchLen = static_cast<DWORD>(_tcslen(szBuff));
-                            if (FAILED(PrintLine(x3, yLine, szBuff, cchLen, pPrintInfo)))
-                                return E_FAIL;
-
-                            // Advance to next line on page
-                            if (FAILED(PrintNextLine(pPrintInfo)))
-                                return E_FAIL;
+                            delete[] pDescs;
+                            return E_FAIL;
                         }
                     }
                 }
@@ -973,60 +698,20 @@ namespace
         return S_OK;
     }
 
-    //-----------------------------------------------------------------------------
-#define LVYESNO(a,b) \
-        if ( g_dwViewState == IDM_VIEWALL || (b) ) \
-        { \
-            LVAddText( g_hwndLV, 0, a ); \
-            LVAddText( g_hwndLV, 1, (b) ? c_szYes : c_szNo ); \
-        }
-
-#define PRINTYESNO(a,b) \
-        PrintStringValueLine( a, (b) ? c_szYes : c_szNo, pPrintInfo );
-
-#define LVLINE(a,b) \
-        if ( g_dwViewState == IDM_VIEWALL || (b != c_szNA && b != c_szNo) ) \
-        { \
-            LVAddText( g_hwndLV, 0, a ); \
-            LVAddText( g_hwndLV, 1, b ); \
-        }
-
-#define PRINTLINE(a,b) \
-        if ( g_dwViewState == IDM_VIEWALL || (b != c_szNA && b != c_szNo) ) \
-        { \
-            PrintStringValueLine( a, b, pPrintInfo ); \
-        }
-
-#define XTOSTRING(a) #a TOSTRING(a)
-#define TOSTRING(a) #a
-
-#define XTOSTRING2(a) #a TOSTRING2(a)
-#define TOSTRING2(a) "( " #a " )"
-
     //-----------------------------------------------------------------------------
     HRESULT DXGIFeatures(LPARAM /*lParam1*/, LPARAM /*lParam2*/, PRINTCBINFO* pPrintInfo)
     {
         if (g_DXGIFactory5)
         {
-            if (!pPrintInfo)
-            {
-                LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-                LVAddColumn(g_hwndLV, 1, "Value", 60);
-            }
+            EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+            EmitColumn(pPrintInfo, 1, "Value", 60);
 
             BOOL allowTearing = FALSE;
             HRESULT hr = g_DXGIFactory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(BOOL));
             if (FAILED(hr))
                 allowTearing = FALSE;
 
-            if (!pPrintInfo)
-            {
-                LVYESNO("Allow tearing", allowTearing);
-            }
-            else
-            {
-                PRINTYESNO("Allow tearing", allowTearing);
-            }
+            EmitYesNoRow(pPrintInfo, "Allow tearing", allowTearing);
         }
 
         return S_OK;
@@ -1052,162 +737,487 @@ namespace
 
 
     //-----------------------------------------------------------------------------
-    void CheckExtendedFormats(ID3D10Device* pDevice, BOOL& ext, BOOL& x2)
+    // The IUnknown of a device. All of its interfaces (ID3D11Device and
+    // ID3D11Device1, ID3D10Device1 and ID3D10Device) share it, so tables keyed
+    // on it are built once per device rather than once per interface.
+    //-----------------------------------------------------------------------------
+    const void* DeviceIdentity(IUnknown* pDevice)
     {
-        ext = x2 = FALSE;
+        IUnknown* pUnknown = nullptr;
+        if (FAILED(pDevice->QueryInterface(IID_PPV_ARGS(&pUnknown))))
+            return pDevice;
 
-        // DXGI 1.1 required for extended formats
-        if (!g_DXGIFactory1)
-            return;
+        // The device holds its own reference for as long as it is alive
+        pUnknown->Release();
+        return pUnknown;
+    }
 
-        UINT fmtSupport = 0;
-        HRESULT hr = pDevice->CheckFormatSupport(DXGI_FORMAT_B8G8R8A8_UNORM, &fmtSupport);
-        if (FAILED(hr))
-            fmtSupport = 0;
 
-        if (fmtSupport & D3D10_FORMAT_SUPPORT_RENDER_TARGET)
-            ext = TRUE;
+    //-----------------------------------------------------------------------------
+    // Format support of a device. Every format FormatName() knows is checked
+    // once, on first use, and all nodes of the device look up the result.
+    // Like the MSAA tables below, the list is guarded by a lock so that
+    // lookups stay safe while adapters are probed on the thread pool.
+    //-----------------------------------------------------------------------------
+    struct FORMATSUPPORT
+    {
+        FORMATSUPPORT*  pNext;
+        const void*     pDevice;
+        UINT            support1[c_cFormatSupport];
+        UINT            support2[c_cFormatSupport];
+    };
 
-        hr = pDevice->CheckFormatSupport(DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM, &fmtSupport);
-        if (FAILED(hr))
-            fmtSupport = 0;
+    FORMATSUPPORT* g_pFormatSupport = nullptr;
+    SRWLOCK g_FormatSupportLock = SRWLOCK_INIT;
 
-        if (fmtSupport & D3D10_FORMAT_SUPPORT_DISPLAY)
-            x2 = TRUE;
+    const FORMATSUPPORT* FindFormatSupport(const void* pIdentity)
+    {
+        const FORMATSUPPORT* pFound = nullptr;
+
+        AcquireSRWLockShared(&g_FormatSupportLock);
+        for (const FORMATSUPPORT* pTable = g_pFormatSupport; pTable; pTable = pTable->pNext)
+        {
+            if (pTable->pDevice == pIdentity)
+            {
+                pFound = pTable;
+                break;
+            }
+        }
+        ReleaseSRWLockShared(&g_FormatSupportLock);
+
+        return pFound;
     }
 
-    void CheckExtendedFormats(ID3D11Device* pDevice, BOOL& ext, BOOL& x2, BOOL& bpp565)
+    // Publishes a filled table. If another thread checked the same device
+    // meanwhile, its table is kept and pTable is freed.
+    const FORMATSUPPORT* AddFormatSupport(FORMATSUPPORT* pTable)
     {
-        ext = x2 = bpp565 = FALSE;
+        const FORMATSUPPORT* pFound = nullptr;
 
-        UINT fmtSupport = 0;
-        HRESULT hr = pDevice->CheckFormatSupport(DXGI_FORMAT_B8G8R8A8_UNORM, &fmtSupport);
-        if (FAILED(hr))
-            fmtSupport = 0;
+        AcquireSRWLockExclusive(&g_FormatSupportLock);
+        for (const FORMATSUPPORT* pOther = g_pFormatSupport; pOther; pOther = pOther->pNext)
+        {
+            if (pOther->pDevice == pTable->pDevice)
+            {
+                pFound = pOther;
+                break;
+            }
+        }
 
-        if (fmtSupport & D3D11_FORMAT_SUPPORT_RENDER_TARGET)
-            ext = TRUE;
+        if (!pFound)
+        {
+            pTable->pNext = g_pFormatSupport;
+            g_pFormatSupport = pTable;
+            pFound = pTable;
+        }
+        ReleaseSRWLockExclusive(&g_FormatSupportLock);
 
-        fmtSupport = 0;
-        hr = pDevice->CheckFormatSupport(DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM, &fmtSupport);
-        if (FAILED(hr))
-            fmtSupport = 0;
+        if (pFound != pTable)
+            delete pTable;
 
-        if (fmtSupport & D3D11_FORMAT_SUPPORT_DISPLAY)
-            x2 = TRUE;
+        return pFound;
+    }
 
-        // DXGI 1.2 is required for 16bpp support
-        if (g_DXGIFactory2)
+    BOOL IsKnownFormat(UINT fmt)
+    {
+        return GetFormatDesc(static_cast<DXGI_FORMAT>(fmt)) != nullptr;
+    }
+
+    const FORMATSUPPORT* GetFormatSupport(ID3D10Device* pDevice)
+    {
+        const void* pIdentity = DeviceIdentity(pDevice);
+        const FORMATSUPPORT* pFound = FindFormatSupport(pIdentity);
+        if (pFound)
+            return pFound;
+
+        auto pTable = new (std::nothrow) FORMATSUPPORT{};
+        if (!pTable)
+            return nullptr;
+
+        pTable->pDevice = pIdentity;
+
+        TRACESCOPE trace("CheckFormatSupport");
+        for (UINT fmt = 1; fmt < c_cFormatSupport; ++fmt)
         {
-            fmtSupport = 0;
-            hr = pDevice->CheckFormatSupport(DXGI_FORMAT_B5G6R5_UNORM, &fmtSupport);
-            if (FAILED(hr))
-                fmtSupport = 0;
+            if (!IsKnownFormat(fmt))
+                continue;
 
-            if (fmtSupport & D3D11_FORMAT_SUPPORT_TEXTURE2D)
-                bpp565 = TRUE;
+            LONGLONG qpcStart = TraceNow();
+            HRESULT hr = pDevice->CheckFormatSupport(static_cast<DXGI_FORMAT>(fmt), &pTable->support1[fmt]);
+            if (FAILED(StatsAdd(API_CHECKFORMATSUPPORT, qpcStart, hr)))
+                pTable->support1[fmt] = 0;
         }
-    }
 
+        return AddFormatSupport(pTable);
+    }
 
-    //-----------------------------------------------------------------------------
-    void CheckD3D11Ops(ID3D11Device* pDevice, bool& logicOps, bool& cbPartial, bool& cbOffsetting)
+    const FORMATSUPPORT* GetFormatSupport(ID3D11Device* pDevice)
     {
-        auto opts = GetD3D11Options<D3D11_FEATURE_D3D11_OPTIONS, D3D11_FEATURE_DATA_D3D11_OPTIONS>(pDevice);
+        const void* pIdentity = DeviceIdentity(pDevice);
+        const FORMATSUPPORT* pFound = FindFormatSupport(pIdentity);
+        if (pFound)
+            return pFound;
 
-        logicOps = (opts.OutputMergerLogicOp) ? true : false;
-        cbPartial = (opts.ConstantBufferPartialUpdate) ? true : false;
-        cbOffsetting = (opts.ConstantBufferOffsetting) ? true : false;
-    }
+        auto pTable = new (std::nothrow) FORMATSUPPORT{};
+        if (!pTable)
+            return nullptr;
 
+        pTable->pDevice = pIdentity;
 
-    //-----------------------------------------------------------------------------
-    void CheckD3D11Ops1(ID3D11Device* pDevice, D3D11_TILED_RESOURCES_TIER& tiled, bool& minmaxfilter, bool& mapdefaultbuff)
-    {
-        auto opts = GetD3D11Options<D3D11_FEATURE_D3D11_OPTIONS1, D3D11_FEATURE_DATA_D3D11_OPTIONS1>(pDevice);
+        TRACESCOPE trace("CheckFormatSupport");
+        for (UINT fmt = 1; fmt < c_cFormatSupport; ++fmt)
+        {
+            if (!IsKnownFormat(fmt))
+                continue;
 
-        tiled = opts.TiledResourcesTier;
-        minmaxfilter = (opts.MinMaxFiltering) ? true : false;
-        mapdefaultbuff = (opts.MapOnDefaultBuffers) ? true : false;
-    }
+            LONGLONG qpcStart = TraceNow();
+            HRESULT hr = pDevice->CheckFormatSupport(static_cast<DXGI_FORMAT>(fmt), &pTable->support1[fmt]);
+            if (FAILED(StatsAdd(API_CHECKFORMATSUPPORT, qpcStart, hr)))
+                pTable->support1[fmt] = 0;
+
+            D3D11_FEATURE_DATA_FORMAT_SUPPORT2 cfs2 = {};
+            cfs2.InFormat = static_cast<DXGI_FORMAT>(fmt);
+            qpcStart = TraceNow();
+            hr = pDevice->CheckFeatureSupport(D3D11_FEATURE_FORMAT_SUPPORT2, &cfs2, sizeof(cfs2));
+            if (SUCCEEDED(StatsAdd(API_CHECKFEATURESUPPORT, qpcStart, hr)))
+                pTable->support2[fmt] = cfs2.OutFormatSupport2;
+        }
 
+        return AddFormatSupport(pTable);
+    }
 
-    //-----------------------------------------------------------------------------
-    void CheckD3D11Ops2(ID3D11Device* pDevice, D3D11_TILED_RESOURCES_TIER& tiled, D3D11_CONSERVATIVE_RASTERIZATION_TIER& crast,
-        bool& rovs, bool& pssref)
+    const FORMATSUPPORT* GetFormatSupport(ID3D12Device* pDevice)
     {
-        auto opts = GetD3D11Options<D3D11_FEATURE_D3D11_OPTIONS2, D3D11_FEATURE_DATA_D3D11_OPTIONS2>(pDevice);
+        const void* pIdentity = DeviceIdentity(pDevice);
+        const FORMATSUPPORT* pFound = FindFormatSupport(pIdentity);
+        if (pFound)
+            return pFound;
 
-        crast = opts.ConservativeRasterizationTier;
-        tiled = opts.TiledResourcesTier;
-        rovs = (opts.ROVsSupported) ? true : false;
-        pssref = (opts.PSSpecifiedStencilRefSupported) ? true : false;
+        auto pTable = new (std::nothrow) FORMATSUPPORT{};
+        if (!pTable)
+            return nullptr;
+
+        pTable->pDevice = pIdentity;
+
+        TRACESCOPE trace("CheckFormatSupport");
+        for (UINT fmt = 1; fmt < c_cFormatSupport; ++fmt)
+        {
+            if (!IsKnownFormat(fmt))
+                continue;
+
+            D3D12_FEATURE_DATA_FORMAT_SUPPORT fmtSupport = {
+                static_cast<DXGI_FORMAT>(fmt), D3D12_FORMAT_SUPPORT1_NONE, D3D12_FORMAT_SUPPORT2_NONE,
+            };
+            LONGLONG qpcStart = TraceNow();
+            HRESULT hr = pDevice->CheckFeatureSupport(D3D12_FEATURE_FORMAT_SUPPORT,
+                &fmtSupport, sizeof(D3D12_FEATURE_DATA_FORMAT_SUPPORT));
+            if (SUCCEEDED(StatsAdd(API_CHECKFEATURESUPPORT, qpcStart, hr)))
+            {
+                pTable->support1[fmt] = static_cast<UINT>(fmtSupport.Support1);
+                pTable->support2[fmt] = static_cast<UINT>(fmtSupport.Support2);
+            }
+        }
+
+        return AddFormatSupport(pTable);
     }
 
+    // D3D10_FORMAT_SUPPORT, D3D11_FORMAT_SUPPORT or D3D12_FORMAT_SUPPORT1 bits
+    template<class T>
+    UINT FormatSupport1(T* pDevice, DXGI_FORMAT fmt)
+    {
+        const FORMATSUPPORT* pTable = GetFormatSupport(pDevice);
+        return (pTable && static_cast<UINT>(fmt) < c_cFormatSupport) ? pTable->support1[fmt] : 0;
+    }
 
-    //-----------------------------------------------------------------------------
-    void CheckD3D9Ops(ID3D11Device* pDevice, bool& nonpow2, bool& shadows)
+    // D3D11_FORMAT_SUPPORT2 or D3D12_FORMAT_SUPPORT2 bits
+    template<class T>
+    UINT FormatSupport2(T* pDevice, DXGI_FORMAT fmt)
     {
-        auto d3d9opts = GetD3D11Options<D3D11_FEATURE_D3D9_OPTIONS, D3D11_FEATURE_DATA_D3D9_OPTIONS>(pDevice);
-        nonpow2 = (d3d9opts.FullNonPow2TextureSupport) ? true : false;
+        const FORMATSUPPORT* pTable = GetFormatSupport(pDevice);
+        return (pTable && static_cast<UINT>(fmt) < c_cFormatSupport) ? pTable->support2[fmt] : 0;
+    }
 
-        auto d3d9shadows = GetD3D11Options<D3D11_FEATURE_D3D9_SHADOW_SUPPORT, D3D11_FEATURE_DATA_D3D9_SHADOW_SUPPORT>(pDevice);
-        shadows = (d3d9shadows.SupportsDepthAsTextureWithLessEqualComparisonFilter) ? true : false;
+    VOID FreeFormatSupport()
+    {
+        AcquireSRWLockExclusive(&g_FormatSupportLock);
+        while (g_pFormatSupport)
+        {
+            FORMATSUPPORT* pNext = g_pFormatSupport->pNext;
+            delete g_pFormatSupport;
+            g_pFormatSupport = pNext;
+        }
+        ReleaseSRWLockExclusive(&g_FormatSupportLock);
     }
 
 
     //-----------------------------------------------------------------------------
-    void CheckD3D9Ops1(ID3D11Device* pDevice, bool& nonpow2, bool& shadows, bool& instancing, bool& cubemapRT)
+    // MSAA quality levels of a device, by format and sample count. Every format
+    // of g_cfsMSAA_11 (which covers the 10.x lists) is checked the first time
+    // a node of the device needs them. The list is guarded by a lock so that
+    // lookups stay safe while adapters are probed on the thread pool.
+    //-----------------------------------------------------------------------------
+    struct MSAASUPPORT
     {
-        auto d3d9opts = GetD3D11Options<D3D11_FEATURE_D3D9_OPTIONS1, D3D11_FEATURE_DATA_D3D9_OPTIONS1>(pDevice);
+        MSAASUPPORT*    pNext;
+        const void*     pDevice;
+        UINT            quality[c_cFormatSupport][D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT];
+    };
 
-        nonpow2 = (d3d9opts.FullNonPow2TextureSupported) ? true : false;
+    MSAASUPPORT* g_pMSAASupport = nullptr;
+    SRWLOCK g_MSAALock = SRWLOCK_INIT;
 
-        shadows = (d3d9opts.DepthAsTextureWithLessEqualComparisonFilterSupported) ? true : false;
+    const MSAASUPPORT* FindMSAASupport(const void* pDevice)
+    {
+        const MSAASUPPORT* pFound = nullptr;
 
-        instancing = (d3d9opts.SimpleInstancingSupported) ? true : false;
+        AcquireSRWLockShared(&g_MSAALock);
+        for (const MSAASUPPORT* pTable = g_pMSAASupport; pTable; pTable = pTable->pNext)
+        {
+            if (pTable->pDevice == pDevice)
+            {
+                pFound = pTable;
+                break;
+            }
+        }
+        ReleaseSRWLockShared(&g_MSAALock);
 
-        cubemapRT = (d3d9opts.TextureCubeFaceRenderTargetWithNonCubeDepthStencilSupported) ? true : false;
+        return pFound;
     }
 
-    //-----------------------------------------------------------------------------
-#define D3D_FL_LPARAM3_D3D10( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 0 )
-#define D3D_FL_LPARAM3_D3D10_1( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 1 )
-#define D3D_FL_LPARAM3_D3D11( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 2 )
-#define D3D_FL_LPARAM3_D3D11_1( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 3 )
-#define D3D_FL_LPARAM3_D3D11_2( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 4 )
-#define D3D_FL_LPARAM3_D3D11_3( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 5 )
-#define D3D_FL_LPARAM3_D3D12( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 10 )
-
-    HRESULT D3D_FeatureLevel(LPARAM lParam1, LPARAM lParam2, LPARAM lParam3, PRINTCBINFO* pPrintInfo)
+    // Works for ID3D10Device and ID3D11Device, which share CheckMultisampleQualityLevels
+    template<class T>
+    const MSAASUPPORT* GetMSAASupport(T* pDevice)
     {
-        auto fl = static_cast<D3D_FEATURE_LEVEL>(lParam1);
-        if (lParam2 == 0)
-            return S_OK;
+        const void* pIdentity = DeviceIdentity(pDevice);
+        const MSAASUPPORT* pFound = FindMSAASupport(pIdentity);
+        if (pFound)
+            return pFound;
 
-        ID3D10Device* pD3D10 = nullptr;
-        ID3D10Device1* pD3D10_1 = nullptr;
-        ID3D11Device* pD3D11 = nullptr;
-        ID3D11Device1* pD3D11_1 = nullptr;
-        ID3D11Device2* pD3D11_2 = nullptr;
-        ID3D11Device3* pD3D11_3 = nullptr;
-        ID3D12Device* pD3D12 = nullptr;
+        auto pTable = new (std::nothrow) MSAASUPPORT{};
+        if (!pTable)
+            return nullptr;
 
-        auto d3dVer = static_cast<unsigned int>(lParam3 & 0xff);
-        auto d3dType = static_cast<D3D_DRIVER_TYPE>((lParam3 & 0xff00) >> 8);
+        pTable->pDevice = pIdentity;
 
-        if (d3dVer == 10)
+        TRACESCOPE trace("CheckMultisampleQualityLevels");
+        for (UINT i = 0; i < std::size(g_cfsMSAA_11); ++i)
         {
-            pD3D12 = reinterpret_cast<ID3D12Device*>(lParam2);
+            DXGI_FORMAT fmt = g_cfsMSAA_11[i];
+
+            for (UINT samples = 2; samples <= D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
+            {
+                UINT quality;
+                LONGLONG qpcStart = TraceNow();
+                HRESULT hr = pDevice->CheckMultisampleQualityLevels(fmt, samples, &quality);
+                if (SUCCEEDED(StatsAdd(API_CHECKMULTISAMPLEQUALITYLEVELS, qpcStart, hr)))
+                    pTable->quality[fmt][samples - 1] = quality;
+            }
         }
-        else if (d3dVer == 5)
+
+        // The table is complete before other threads can see it. If another
+        // thread swept the same device meanwhile, keep the first table.
+        AcquireSRWLockExclusive(&g_MSAALock);
+        for (const MSAASUPPORT* pOther = g_pMSAASupport; pOther; pOther = pOther->pNext)
         {
-            pD3D11_3 = reinterpret_cast<ID3D11Device3*>(lParam2);
+            if (pOther->pDevice == pIdentity)
+            {
+                pFound = pOther;
+                break;
+            }
         }
-        else
-        {
-            if (fl > D3D_FEATURE_LEVEL_11_1)
-                fl = D3D_FEATURE_LEVEL_11_1;
+
+        if (!pFound)
+        {
+            pTable->pNext = g_pMSAASupport;
+            g_pMSAASupport = pTable;
+            pFound = pTable;
+        }
+        ReleaseSRWLockExclusive(&g_MSAALock);
+
+        if (pFound != pTable)
+            delete pTable;
+
+        return pFound;
+    }
+
+    template<class T>
+    UINT MSAAQuality(T* pDevice, DXGI_FORMAT fmt, UINT samples)
+    {
+        const MSAASUPPORT* pTable = GetMSAASupport(pDevice);
+        if (!pTable || static_cast<UINT>(fmt) >= c_cFormatSupport
+            || samples < 1 || samples > D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT)
+            return 0;
+
+        return pTable->quality[fmt][samples - 1];
+    }
+
+    // Bit (samples - 1) is set if any of the formats supports that sample count
+    template<size_t N>
+    DWORD MSAASampleCounts(const MSAASUPPORT* pTable, const DXGI_FORMAT(&formats)[N])
+    {
+        DWORD mask = 0x1;   // sample count of 1 is always required
+
+        for (UINT samples = 2; samples <= D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
+        {
+            for (size_t i = 0; i < N; ++i)
+            {
+                if (pTable->quality[formats[i]][samples - 1] > 0)
+                {
+                    mask |= 1u << (samples - 1);
+                    break;
+                }
+            }
+        }
+
+        return mask;
+    }
+
+    VOID FreeMSAASupport()
+    {
+        AcquireSRWLockExclusive(&g_MSAALock);
+        while (g_pMSAASupport)
+        {
+            MSAASUPPORT* pNext = g_pMSAASupport->pNext;
+            delete g_pMSAASupport;
+            g_pMSAASupport = pNext;
+        }
+        ReleaseSRWLockExclusive(&g_MSAALock);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    void CheckExtendedFormats(ID3D10Device* pDevice, BOOL& ext, BOOL& x2)
+    {
+        ext = x2 = FALSE;
+
+        // DXGI 1.1 required for extended formats
+        if (!g_DXGIFactory1)
+            return;
+
+        if (FormatSupport1(pDevice, DXGI_FORMAT_B8G8R8A8_UNORM) & D3D10_FORMAT_SUPPORT_RENDER_TARGET)
+            ext = TRUE;
+
+        if (FormatSupport1(pDevice, DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM) & D3D10_FORMAT_SUPPORT_DISPLAY)
+            x2 = TRUE;
+    }
+
+    void CheckExtendedFormats(ID3D11Device* pDevice, BOOL& ext, BOOL& x2, BOOL& bpp565)
+    {
+        ext = x2 = bpp565 = FALSE;
+
+        if (FormatSupport1(pDevice, DXGI_FORMAT_B8G8R8A8_UNORM) & D3D11_FORMAT_SUPPORT_RENDER_TARGET)
+            ext = TRUE;
+
+        if (FormatSupport1(pDevice, DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM) & D3D11_FORMAT_SUPPORT_DISPLAY)
+            x2 = TRUE;
+
+        // DXGI 1.2 is required for 16bpp support
+        if (g_DXGIFactory2)
+        {
+            if (FormatSupport1(pDevice, DXGI_FORMAT_B5G6R5_UNORM) & D3D11_FORMAT_SUPPORT_TEXTURE2D)
+                bpp565 = TRUE;
+        }
+    }
+
+
+    //-----------------------------------------------------------------------------
+    void CheckD3D11Ops(ID3D11Device* pDevice, bool& logicOps, bool& cbPartial, bool& cbOffsetting)
+    {
+        auto opts = GetD3D11Options<D3D11_FEATURE_D3D11_OPTIONS, D3D11_FEATURE_DATA_D3D11_OPTIONS>(pDevice);
+
+        logicOps = (opts.OutputMergerLogicOp) ? true : false;
+        cbPartial = (opts.ConstantBufferPartialUpdate) ? true : false;
+        cbOffsetting = (opts.ConstantBufferOffsetting) ? true : false;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    void CheckD3D11Ops1(ID3D11Device* pDevice, D3D11_TILED_RESOURCES_TIER& tiled, bool& minmaxfilter, bool& mapdefaultbuff)
+    {
+        auto opts = GetD3D11Options<D3D11_FEATURE_D3D11_OPTIONS1, D3D11_FEATURE_DATA_D3D11_OPTIONS1>(pDevice);
+
+        tiled = opts.TiledResourcesTier;
+        minmaxfilter = (opts.MinMaxFiltering) ? true : false;
+        mapdefaultbuff = (opts.MapOnDefaultBuffers) ? true : false;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    void CheckD3D11Ops2(ID3D11Device* pDevice, D3D11_TILED_RESOURCES_TIER& tiled, D3D11_CONSERVATIVE_RASTERIZATION_TIER& crast,
+        bool& rovs, bool& pssref)
+    {
+        auto opts = GetD3D11Options<D3D11_FEATURE_D3D11_OPTIONS2, D3D11_FEATURE_DATA_D3D11_OPTIONS2>(pDevice);
+
+        crast = opts.ConservativeRasterizationTier;
+        tiled = opts.TiledResourcesTier;
+        rovs = (opts.ROVsSupported) ? true : false;
+        pssref = (opts.PSSpecifiedStencilRefSupported) ? true : false;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    void CheckD3D9Ops(ID3D11Device* pDevice, bool& nonpow2, bool& shadows)
+    {
+        auto d3d9opts = GetD3D11Options<D3D11_FEATURE_D3D9_OPTIONS, D3D11_FEATURE_DATA_D3D9_OPTIONS>(pDevice);
+        nonpow2 = (d3d9opts.FullNonPow2TextureSupport) ? true : false;
+
+        auto d3d9shadows = GetD3D11Options<D3D11_FEATURE_D3D9_SHADOW_SUPPORT, D3D11_FEATURE_DATA_D3D9_SHADOW_SUPPORT>(pDevice);
+        shadows = (d3d9shadows.SupportsDepthAsTextureWithLessEqualComparisonFilter) ? true : false;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    void CheckD3D9Ops1(ID3D11Device* pDevice, bool& nonpow2, bool& shadows, bool& instancing, bool& cubemapRT)
+    {
+        auto d3d9opts = GetD3D11Options<D3D11_FEATURE_D3D9_OPTIONS1, D3D11_FEATURE_DATA_D3D9_OPTIONS1>(pDevice);
+
+        nonpow2 = (d3d9opts.FullNonPow2TextureSupported) ? true : false;
+
+        shadows = (d3d9opts.DepthAsTextureWithLessEqualComparisonFilterSupported) ? true : false;
+
+        instancing = (d3d9opts.SimpleInstancingSupported) ? true : false;
+
+        cubemapRT = (d3d9opts.TextureCubeFaceRenderTargetWithNonCubeDepthStencilSupported) ? true : false;
+    }
+
+    //-----------------------------------------------------------------------------
+#define D3D_FL_LPARAM3_D3D10( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 0 )
+#define D3D_FL_LPARAM3_D3D10_1( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 1 )
+#define D3D_FL_LPARAM3_D3D11( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 2 )
+#define D3D_FL_LPARAM3_D3D11_1( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 3 )
+#define D3D_FL_LPARAM3_D3D11_2( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 4 )
+#define D3D_FL_LPARAM3_D3D11_3( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 5 )
+#define D3D_FL_LPARAM3_D3D12( d3dType ) ( ( (d3dType & 0xff) << 8 ) | 10 )
+
+    HRESULT D3D_FeatureLevel(LPARAM lParam1, LPARAM lParam2, LPARAM lParam3, PRINTCBINFO* pPrintInfo)
+    {
+        auto fl = static_cast<D3D_FEATURE_LEVEL>(lParam1);
+        if (lParam2 == 0)
+            return S_OK;
+
+        ID3D10Device* pD3D10 = nullptr;
+        ID3D10Device1* pD3D10_1 = nullptr;
+        ID3D11Device* pD3D11 = nullptr;
+        ID3D11Device1* pD3D11_1 = nullptr;
+        ID3D11Device2* pD3D11_2 = nullptr;
+        ID3D11Device3* pD3D11_3 = nullptr;
+        ID3D12Device* pD3D12 = nullptr;
+
+        auto d3dVer = static_cast<unsigned int>(lParam3 & 0xff);
+        auto d3dType = static_cast<D3D_DRIVER_TYPE>((lParam3 & 0xff00) >> 8);
+
+        if (d3dVer == 10)
+        {
+            pD3D12 = reinterpret_cast<ID3D12Device*>(lParam2);
+        }
+        else if (d3dVer == 5)
+        {
+            pD3D11_3 = reinterpret_cast<ID3D11Device3*>(lParam2);
+        }
+        else
+        {
+            if (fl > D3D_FEATURE_LEVEL_11_1)
+                fl = D3D_FEATURE_LEVEL_11_1;
 
             if (d3dVer == 4)
             {
@@ -1246,32 +1256,27 @@ namespace
             }
         }
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-            LVAddColumn(g_hwndLV, 1, "Value", 60);
-        }
-
-        const char* shaderModel = nullptr;
-        const char* computeShader = c_szNo;
-        const char* maxTexDim = nullptr;
-        const char* maxCubeDim = nullptr;
-        const char* maxVolDim = nullptr;
-        const char* maxTexRepeat = nullptr;
-        const char* maxAnisotropy = nullptr;
-        const char* maxPrimCount = "4294967296";
-        const char* maxInputSlots = nullptr;
-        const char* mrt = nullptr;
-        const char* extFormats = nullptr;
-        const char* x2_10BitFormat = nullptr;
-        const char* logic_ops = c_szNo;
-        const char* cb_partial = c_szNA;
-        const char* cb_offsetting = c_szNA;
-        const char* uavSlots = nullptr;
-        const char* uavEveryStage = nullptr;
-        const char* uavOnlyRender = nullptr;
-        const char* nonpow2 = nullptr;
-        const char* bpp16 = c_szNo;
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 1, "Value", 60);
+
+        const FLDESC* pDesc = FindFLDesc(fl);
+        if (!pDesc)
+            return E_FAIL;
+
+        const FLLIMITS* pLimits = pDesc->pLimits;
+        const char* shaderModel = pDesc->shaderModel;
+        const char* computeShader = pDesc->computeShader;
+        const char* extFormats = pDesc->extFormats;
+        const char* x2_10BitFormat = pDesc->x2_10BitFormat;
+        const char* logic_ops = pDesc->logic_ops;
+        const char* cb_partial = pDesc->cb_partial;
+        const char* cb_offsetting = pDesc->cb_offsetting;
+        const char* uavSlots = pDesc->uavSlots;
+        const char* uavEveryStage = pDesc->uavEveryStage;
+        const char* uavOnlyRender = pDesc->uavOnlyRender;
+        const char* nonpow2 = pDesc->nonpow2;
+        const char* bpp16 = pDesc->bpp16;
+        const char* instancing = pDesc->instancing;
         const char* shadows = nullptr;
         const char* cubeRT = nullptr;
         const char* tiled_rsc = nullptr;
@@ -1281,13 +1286,11 @@ namespace
         const char* consrv_rast = nullptr;
         const char* rast_ordered_views = nullptr;
         const char* ps_stencil_ref = nullptr;
-        const char* instancing = nullptr;
         const char* vrs = nullptr;
         const char* meshShaders = nullptr;
         const char* dxr = nullptr;
 
-        BOOL _10level9 = FALSE;
-
+        // Optional features and tiers reported by the device
         switch (fl)
         {
         case D3D_FEATURE_LEVEL_12_2:
@@ -1374,28 +1377,9 @@ namespace
                     break;
                 }
             }
-            extFormats = c_szYes;
-            x2_10BitFormat = c_szYes;
-            logic_ops = c_szYes;
-            cb_partial = c_szYes;
-            cb_offsetting = c_szYes;
-            uavEveryStage = c_szYes;
-            uavOnlyRender = "16";
-            nonpow2 = "Full";
-            bpp16 = c_szYes;
-            instancing = c_szYes;
 
             if (pD3D12)
             {
-                maxTexDim = XTOSTRING(D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION);
-                maxCubeDim = XTOSTRING(D3D12_REQ_TEXTURECUBE_DIMENSION);
-                maxVolDim = XTOSTRING(D3D12_REQ_TEXTURE3D_U_V_OR_W_DIMENSION);
-                maxTexRepeat = XTOSTRING(D3D12_REQ_FILTERING_HW_ADDRESSABLE_RESOURCE_DIMENSION);
-                maxAnisotropy = XTOSTRING(D3D12_REQ_MAXANISOTROPY);
-                maxInputSlots = XTOSTRING(D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT);
-                mrt = XTOSTRING(D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT);
-                uavSlots = XTOSTRING(D3D12_UAV_SLOT_COUNT);
-
                 auto d3d12opts = GetD3D12Options<D3D12_FEATURE_D3D12_OPTIONS, D3D12_FEATURE_DATA_D3D12_OPTIONS>(pD3D12);
 
                 switch (d3d12opts.TiledResourcesTier)
@@ -1448,13 +1432,8 @@ namespace
             }
             else if (pD3D11_3)
             {
-                maxTexDim = XTOSTRING(D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION);
-                maxCubeDim = XTOSTRING(D3D11_REQ_TEXTURECUBE_DIMENSION);
-                maxVolDim = XTOSTRING(D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION);
-                maxTexRepeat = XTOSTRING(D3D11_REQ_FILTERING_HW_ADDRESSABLE_RESOURCE_DIMENSION);
-                maxAnisotropy = XTOSTRING(D3D11_REQ_MAXANISOTROPY);
-                maxInputSlots = XTOSTRING(D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT);
-                mrt = XTOSTRING(D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT);
+                // The table describes 12.x in terms of Direct3D 12
+                pLimits = FindFLDesc(D3D_FEATURE_LEVEL_11_1)->pLimits;
                 uavSlots = XTOSTRING(D3D11_1_UAV_SLOT_COUNT);
 
                 D3D11_TILED_RESOURCES_TIER tiled = D3D11_TILED_RESOURCES_NOT_SUPPORTED;
@@ -1507,27 +1486,6 @@ namespace
             break;
 
         case D3D_FEATURE_LEVEL_11_1:
-            shaderModel = "5.0";
-            computeShader = "Yes (CS 5.0)";
-            maxTexDim = XTOSTRING(D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION);
-            maxCubeDim = XTOSTRING(D3D11_REQ_TEXTURECUBE_DIMENSION);
-            maxVolDim = XTOSTRING(D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION);
-            maxTexRepeat = XTOSTRING(D3D11_REQ_FILTERING_HW_ADDRESSABLE_RESOURCE_DIMENSION);
-            maxAnisotropy = XTOSTRING(D3D11_REQ_MAXANISOTROPY);
-            maxInputSlots = XTOSTRING(D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT);
-            mrt = XTOSTRING(D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT);
-            extFormats = c_szYes;
-            x2_10BitFormat = c_szYes;
-            logic_ops = c_szYes;
-            cb_partial = c_szYes;
-            cb_offsetting = c_szYes;
-            uavSlots = XTOSTRING(D3D11_1_UAV_SLOT_COUNT);
-            uavEveryStage = c_szYes;
-            uavOnlyRender = "16";
-            nonpow2 = "Full";
-            bpp16 = c_szYes;
-            instancing = c_szYes;
-
             if (pD3D12)
             {
                 shaderModel = "5.1";
@@ -1620,19 +1578,6 @@ namespace
             break;
 
         case D3D_FEATURE_LEVEL_11_0:
-            shaderModel = "5.0";
-            computeShader = "Yes (CS 5.0)";
-            maxTexDim = XTOSTRING(D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION);
-            maxCubeDim = XTOSTRING(D3D11_REQ_TEXTURECUBE_DIMENSION);
-            maxVolDim = XTOSTRING(D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION);
-            maxTexRepeat = XTOSTRING(D3D11_REQ_FILTERING_HW_ADDRESSABLE_RESOURCE_DIMENSION);
-            maxAnisotropy = XTOSTRING(D3D11_REQ_MAXANISOTROPY);
-            maxInputSlots = XTOSTRING(D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT);
-            mrt = XTOSTRING(D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT);
-            extFormats = c_szYes;
-            x2_10BitFormat = c_szYes;
-            instancing = c_szYes;
-
             if (pD3D12)
             {
                 shaderModel = "5.1";
@@ -1733,9 +1678,6 @@ namespace
             break;
 
         case D3D_FEATURE_LEVEL_10_1:
-            shaderModel = "4.x";
-            instancing = c_szYes;
-
             if (pD3D11_3)
             {
                 consrv_rast = rast_ordered_views = ps_stencil_ref = c_szNo;
@@ -1806,20 +1748,9 @@ namespace
                 extFormats = (ext) ? c_szOptYes : c_szOptNo;
                 x2_10BitFormat = (x2) ? c_szOptYes : c_szOptNo;
             }
-
-            maxTexDim = XTOSTRING(D3D10_REQ_TEXTURE2D_U_OR_V_DIMENSION);
-            maxCubeDim = XTOSTRING(D3D10_REQ_TEXTURECUBE_DIMENSION);
-            maxVolDim = XTOSTRING(D3D10_REQ_TEXTURE3D_U_V_OR_W_DIMENSION);
-            maxTexRepeat = XTOSTRING(D3D10_REQ_FILTERING_HW_ADDRESSABLE_RESOURCE_DIMENSION);
-            maxAnisotropy = XTOSTRING(D3D10_REQ_MAXANISOTROPY);
-            maxInputSlots = XTOSTRING(D3D10_1_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT);
-            mrt = XTOSTRING(D3D10_SIMULTANEOUS_RENDER_TARGET_COUNT);
             break;
 
         case D3D_FEATURE_LEVEL_10_0:
-            shaderModel = "4.0";
-            instancing = c_szYes;
-
             if (pD3D11_3)
             {
                 consrv_rast = rast_ordered_views = ps_stencil_ref = c_szNo;
@@ -1889,31 +1820,9 @@ namespace
                 extFormats = (ext) ? c_szOptYes : c_szOptNo;
                 x2_10BitFormat = (x2) ? c_szOptYes : c_szOptNo;
             }
-
-            maxTexDim = XTOSTRING(D3D10_REQ_TEXTURE2D_U_OR_V_DIMENSION);
-            maxCubeDim = XTOSTRING(D3D10_REQ_TEXTURECUBE_DIMENSION);
-            maxVolDim = XTOSTRING(D3D10_REQ_TEXTURE3D_U_V_OR_W_DIMENSION);
-            maxTexRepeat = XTOSTRING(D3D10_REQ_FILTERING_HW_ADDRESSABLE_RESOURCE_DIMENSION);
-            maxAnisotropy = XTOSTRING(D3D10_REQ_MAXANISOTROPY);
-            maxInputSlots = XTOSTRING(D3D10_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT);
-            mrt = XTOSTRING(D3D10_SIMULTANEOUS_RENDER_TARGET_COUNT);
             break;
 
         case D3D_FEATURE_LEVEL_9_3:
-            _10level9 = TRUE;
-            shaderModel = "2.0 (4_0_level_9_3) [vs_2_a/ps_2_b]";
-            computeShader = c_szNA;
-            maxTexDim = XTOSTRING2(D3D_FL9_3_REQ_TEXTURE2D_U_OR_V_DIMENSION);
-            maxCubeDim = XTOSTRING2(D3D_FL9_3_REQ_TEXTURECUBE_DIMENSION);
-            maxVolDim = XTOSTRING2(D3D_FL9_1_REQ_TEXTURE3D_U_V_OR_W_DIMENSION);
-            maxTexRepeat = XTOSTRING2(D3D_FL9_3_MAX_TEXTURE_REPEAT);
-            maxAnisotropy = XTOSTRING(D3D11_REQ_MAXANISOTROPY);
-            maxPrimCount = XTOSTRING2(D3D_FL9_2_IA_PRIMITIVE_MAX_COUNT);
-            maxInputSlots = XTOSTRING(D3D10_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT);
-            mrt = XTOSTRING2(D3D_FL9_3_SIMULTANEOUS_RENDER_TARGET_COUNT);
-            extFormats = c_szYes;
-            instancing = c_szYes;
-
             if (pD3D11_2 || pD3D11_3)
             {
                 ID3D11Device* pD3D = (pD3D11_3) ? pD3D11_3 : pD3D11_2;
@@ -1950,20 +1859,6 @@ namespace
             break;
 
         case D3D_FEATURE_LEVEL_9_2:
-            _10level9 = TRUE;
-            shaderModel = "2.0 (4_0_level_9_1)";
-            computeShader = c_szNA;
-            maxTexDim = XTOSTRING2(D3D_FL9_1_REQ_TEXTURE2D_U_OR_V_DIMENSION);
-            maxCubeDim = XTOSTRING2(D3D_FL9_1_REQ_TEXTURECUBE_DIMENSION);
-            maxVolDim = XTOSTRING2(D3D_FL9_1_REQ_TEXTURE3D_U_V_OR_W_DIMENSION);
-            maxTexRepeat = XTOSTRING2(D3D_FL9_2_MAX_TEXTURE_REPEAT);
-            maxAnisotropy = XTOSTRING(D3D11_REQ_MAXANISOTROPY);
-            maxPrimCount = XTOSTRING2(D3D_FL9_2_IA_PRIMITIVE_MAX_COUNT);
-            maxInputSlots = XTOSTRING(D3D10_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT);
-            mrt = XTOSTRING2(D3D_FL9_1_SIMULTANEOUS_RENDER_TARGET_COUNT);
-            extFormats = c_szYes;
-            instancing = c_szNo;
-
             if (pD3D11_2 || pD3D11_3)
             {
                 ID3D11Device* pD3D = (pD3D11_3) ? pD3D11_3 : pD3D11_2;
@@ -2001,20 +1896,6 @@ namespace
             break;
 
         case D3D_FEATURE_LEVEL_9_1:
-            _10level9 = TRUE;
-            shaderModel = "2.0 (4_0_level_9_1)";
-            computeShader = c_szNA;
-            maxTexDim = XTOSTRING2(D3D_FL9_1_REQ_TEXTURE2D_U_OR_V_DIMENSION);
-            maxCubeDim = XTOSTRING2(D3D_FL9_1_REQ_TEXTURECUBE_DIMENSION);
-            maxVolDim = XTOSTRING2(D3D_FL9_1_REQ_TEXTURE3D_U_V_OR_W_DIMENSION);
-            maxTexRepeat = XTOSTRING2(D3D_FL9_1_MAX_TEXTURE_REPEAT);
-            maxAnisotropy = XTOSTRING2(D3D_FL9_1_DEFAULT_MAX_ANISOTROPY);
-            maxPrimCount = XTOSTRING2(D3D_FL9_1_IA_PRIMITIVE_MAX_COUNT);
-            maxInputSlots = XTOSTRING(D3D10_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT);
-            mrt = XTOSTRING2(D3D_FL9_1_SIMULTANEOUS_RENDER_TARGET_COUNT);
-            extFormats = c_szYes;
-            instancing = c_szNo;
-
             if (pD3D11_2 || pD3D11_3)
             {
                 ID3D11Device* pD3D = (pD3D11_3) ? pD3D11_3 : pD3D11_2;
@@ -2052,9 +1933,10 @@ namespace
             break;
 
         default:
-            return E_FAIL;
+            break;
         }
 
+        const char* maxTexDim = pLimits->maxTexDim;
         if (d3dType == D3D_DRIVER_TYPE_WARP)
         {
             maxTexDim = (pD3D12 || pD3D11_3 || pD3D11_2 || pD3D11_1) ? "16777216" : "65536";
@@ -2078,360 +1960,165 @@ namespace
             }
         }
 
-        if (!pPrintInfo)
-        {
-            LVLINE("Shader Model", shaderModel);
-            LVYESNO("Geometry Shader", (fl >= D3D_FEATURE_LEVEL_10_0));
-            LVYESNO("Stream Out", (fl >= D3D_FEATURE_LEVEL_10_0));
+        EmitLineRow(pPrintInfo, "Shader Model", shaderModel);
+        EmitYesNoRow(pPrintInfo, "Geometry Shader", (fl >= D3D_FEATURE_LEVEL_10_0));
+        EmitYesNoRow(pPrintInfo, "Stream Out", (fl >= D3D_FEATURE_LEVEL_10_0));
 
-            if (pD3D12 || pD3D11_3 || pD3D11_2 || pD3D11_1 || pD3D11)
+        if (pD3D12 || pD3D11_3 || pD3D11_2 || pD3D11_1 || pD3D11)
+        {
+            if (g_dwViewState == IDM_VIEWALL || computeShader != c_szNo)
             {
-                if (g_dwViewState == IDM_VIEWALL || computeShader != c_szNo)
-                {
-                    LVLINE("DirectCompute", computeShader);
-                }
-
-                LVYESNO("Hull & Domain Shaders", (fl >= D3D_FEATURE_LEVEL_11_0));
+                EmitLineRow(pPrintInfo, "DirectCompute", computeShader);
             }
 
-            if (pD3D12)
-            {
-                LVLINE("Variable Rate Shading (VRS)", vrs);
-                LVLINE("Mesh & Amplification Shaders", meshShaders);
-                LVLINE("DirectX Raytracing", dxr);
-            }
+            EmitYesNoRow(pPrintInfo, "Hull & Domain Shaders", (fl >= D3D_FEATURE_LEVEL_11_0));
+        }
 
-            LVYESNO("Texture Resource Arrays", (fl >= D3D_FEATURE_LEVEL_10_0));
+        if (pD3D12)
+        {
+            EmitLineRow(pPrintInfo, "Variable Rate Shading (VRS)", vrs);
+            EmitLineRow(pPrintInfo, "Mesh & Amplification Shaders", meshShaders);
+            EmitLineRow(pPrintInfo, "DirectX Raytracing", dxr);
+        }
 
-            if (d3dVer != 0)
-            {
-                LVYESNO("Cubemap Resource Arrays", (fl >= D3D_FEATURE_LEVEL_10_1));
-            }
+        EmitYesNoRow(pPrintInfo, "Texture Resource Arrays", (fl >= D3D_FEATURE_LEVEL_10_0));
 
-            LVYESNO("BC4/BC5 Compression", (fl >= D3D_FEATURE_LEVEL_10_0));
+        if (d3dVer != 0)
+        {
+            EmitYesNoRow(pPrintInfo, "Cubemap Resource Arrays", (fl >= D3D_FEATURE_LEVEL_10_1));
+        }
 
-            if (pD3D12 || pD3D11_3 || pD3D11_2 || pD3D11_1 || pD3D11)
-            {
-                LVYESNO("BC6H/BC7 Compression", (fl >= D3D_FEATURE_LEVEL_11_0));
-            }
+        EmitYesNoRow(pPrintInfo, "BC4/BC5 Compression", (fl >= D3D_FEATURE_LEVEL_10_0));
 
-            LVYESNO("Alpha-to-coverage", (fl >= D3D_FEATURE_LEVEL_10_0));
+        if (pD3D12 || pD3D11_3 || pD3D11_2 || pD3D11_1 || pD3D11)
+        {
+            EmitYesNoRow(pPrintInfo, "BC6H/BC7 Compression", (fl >= D3D_FEATURE_LEVEL_11_0));
+        }
 
-            if (pD3D11_1 || pD3D11_2 || pD3D11_3 || pD3D12)
-            {
-                LVLINE("Logic Ops (Output Merger)", logic_ops);
-            }
+        EmitYesNoRow(pPrintInfo, "Alpha-to-coverage", (fl >= D3D_FEATURE_LEVEL_10_0));
 
-            if (pD3D11_1 || pD3D11_2 || pD3D11_3)
-            {
-                LVLINE("Constant Buffer Partial Updates", cb_partial);
-                LVLINE("Constant Buffer Offsetting", cb_offsetting);
+        if (pD3D11_1 || pD3D11_2 || pD3D11_3 || pD3D12)
+        {
+            EmitLineRow(pPrintInfo, "Logic Ops (Output Merger)", logic_ops);
+        }
 
-                if (uavEveryStage)
-                {
-                    LVLINE("UAVs at Every Stage", uavEveryStage);
-                }
+        if (pD3D11_1 || pD3D11_2 || pD3D11_3)
+        {
+            EmitLineRow(pPrintInfo, "Constant Buffer Partial Updates", cb_partial);
+            EmitLineRow(pPrintInfo, "Constant Buffer Offsetting", cb_offsetting);
 
-                if (uavOnlyRender)
-                {
-                    LVLINE("UAV-only rendering", uavOnlyRender);
-                }
+            if (uavEveryStage)
+            {
+                EmitLineRow(pPrintInfo, "UAVs at Every Stage", uavEveryStage);
             }
 
-            if (pD3D11_2 || pD3D11_3 || pD3D12)
+            if (uavOnlyRender)
             {
-                if (tiled_rsc)
-                {
-                    LVLINE("Tiled Resources", tiled_rsc);
-                }
+                EmitLineRow(pPrintInfo, "UAV-only rendering", uavOnlyRender);
             }
+        }
 
-            if (pD3D11_2 || pD3D11_3)
+        if (pD3D11_2 || pD3D11_3 || pD3D12)
+        {
+            if (tiled_rsc)
             {
-                if (minmaxfilter)
-                {
-                    LVLINE("Min/Max Filtering", minmaxfilter);
-                }
-
-                if (mapdefaultbuff)
-                {
-                    LVLINE("Map DEFAULT Buffers", mapdefaultbuff);
-                }
+                EmitLineRow(pPrintInfo, "Tiled Resources", tiled_rsc);
             }
+        }
 
-            if (pD3D11_3 || pD3D12)
+        if (pD3D11_2 || pD3D11_3)
+        {
+            if (minmaxfilter)
             {
-                if (consrv_rast)
-                {
-                    LVLINE("Conservative Rasterization", consrv_rast);
-                }
-
-                if (ps_stencil_ref)
-                {
-                    LVLINE("PS-Specified Stencil Ref", ps_stencil_ref);
-                }
-
-                if (rast_ordered_views)
-                {
-                    LVLINE("Rasterizer Ordered Views", rast_ordered_views);
-                }
+                EmitLineRow(pPrintInfo, "Min/Max Filtering", minmaxfilter);
             }
 
-            if (pD3D12 && binding_rsc)
+            if (mapdefaultbuff)
             {
-                LVLINE("Resource Binding", binding_rsc);
+                EmitLineRow(pPrintInfo, "Map DEFAULT Buffers", mapdefaultbuff);
             }
+        }
 
-            if (g_DXGIFactory1 && !pD3D12)
+        if (pD3D11_3 || pD3D12)
+        {
+            if (consrv_rast)
             {
-                LVLINE("Extended Formats (BGRA, etc.)", extFormats);
-
-                if (x2_10BitFormat && (g_dwViewState == IDM_VIEWALL || x2_10BitFormat != c_szNo))
-                {
-                    LVLINE("10-bit XR High Color Format", x2_10BitFormat);
-                }
+                EmitLineRow(pPrintInfo, "Conservative Rasterization", consrv_rast);
             }
 
-            if (pD3D11_1 || pD3D11_2 || pD3D11_3)
+            if (ps_stencil_ref)
             {
-                LVLINE("16-bit Formats (565/5551/4444)", bpp16);
+                EmitLineRow(pPrintInfo, "PS-Specified Stencil Ref", ps_stencil_ref);
             }
 
-            if (nonpow2 && !pD3D12)
+            if (rast_ordered_views)
             {
-                LVLINE("Non-Power-of-2 Textures", nonpow2);
+                EmitLineRow(pPrintInfo, "Rasterizer Ordered Views", rast_ordered_views);
             }
+        }
 
-            LVLINE("Max Texture Dimension", maxTexDim);
-            LVLINE("Max Cubemap Dimension", maxCubeDim);
+        if (pD3D12 && binding_rsc)
+        {
+            EmitLineRow(pPrintInfo, "Resource Binding", binding_rsc);
+        }
 
-            if (maxVolDim)
-            {
-                LVLINE("Max Volume Extent", maxVolDim);
-            }
+        if (g_DXGIFactory1 && !pD3D12)
+        {
+            EmitLineRow(pPrintInfo, "Extended Formats (BGRA, etc.)", extFormats);
 
-            if (maxTexRepeat)
+            if (x2_10BitFormat && (g_dwViewState == IDM_VIEWALL || x2_10BitFormat != c_szNo))
             {
-                LVLINE("Max Texture Repeat", maxTexRepeat);
+                EmitLineRow(pPrintInfo, "10-bit XR High Color Format", x2_10BitFormat);
             }
+        }
 
-            LVLINE("Max Input Slots", maxInputSlots);
+        if (pD3D11_1 || pD3D11_2 || pD3D11_3)
+        {
+            EmitLineRow(pPrintInfo, "16-bit Formats (565/5551/4444)", bpp16);
+        }
 
-            if (uavSlots)
-            {
-                LVLINE("UAV Slots", uavSlots);
-            }
+        if (nonpow2 && !pD3D12)
+        {
+            EmitLineRow(pPrintInfo, "Non-Power-of-2 Textures", nonpow2);
+        }
 
-            if (maxAnisotropy)
-            {
-                LVLINE("Max Anisotropy", maxAnisotropy);
-            }
+        EmitLineRow(pPrintInfo, "Max Texture Dimension", maxTexDim);
+        EmitLineRow(pPrintInfo, "Max Cubemap Dimension", pLimits->maxCubeDim);
+        EmitLineRow(pPrintInfo, "Max Volume Extent", pLimits->maxVolDim);
+        EmitLineRow(pPrintInfo, "Max Texture Repeat", pLimits->maxTexRepeat);
+        EmitLineRow(pPrintInfo, "Max Input Slots", pLimits->maxInputSlots);
 
-            LVLINE("Max Primitive Count", maxPrimCount);
+        if (uavSlots)
+        {
+            EmitLineRow(pPrintInfo, "UAV Slots", uavSlots);
+        }
+
+        EmitLineRow(pPrintInfo, "Max Anisotropy", pLimits->maxAnisotropy);
+        EmitLineRow(pPrintInfo, "Max Primitive Count", pLimits->maxPrimCount);
+        EmitLineRow(pPrintInfo, "Simultaneous Render Targets", pLimits->mrt);
+
+        if (pDesc->_10level9)
+        {
+            EmitYesNoRow(pPrintInfo, "Occlusion Queries", (fl >= D3D_FEATURE_LEVEL_9_2));
+            EmitYesNoRow(pPrintInfo, "Separate Alpha Blend", (fl >= D3D_FEATURE_LEVEL_9_2));
+            EmitYesNoRow(pPrintInfo, "Mirror Once", (fl >= D3D_FEATURE_LEVEL_9_2));
+            EmitYesNoRow(pPrintInfo, "Overlapping Vertex Elements", (fl >= D3D_FEATURE_LEVEL_9_2));
+            EmitYesNoRow(pPrintInfo, "Independant Write Masks", (fl >= D3D_FEATURE_LEVEL_9_3));
+
+            EmitLineRow(pPrintInfo, "Instancing", instancing);
 
-            if (mrt)
+            if (pD3D11_1 || pD3D11_2 || pD3D11_3)
             {
-                LVLINE("Simultaneous Render Targets", mrt);
+                EmitLineRow(pPrintInfo, "Shadow Support", shadows);
             }
 
-            if (_10level9)
+            if (pD3D11_2 || pD3D11_3)
             {
-                LVYESNO("Occlusion Queries", (fl >= D3D_FEATURE_LEVEL_9_2));
-                LVYESNO("Separate Alpha Blend", (fl >= D3D_FEATURE_LEVEL_9_2));
-                LVYESNO("Mirror Once", (fl >= D3D_FEATURE_LEVEL_9_2));
-                LVYESNO("Overlapping Vertex Elements", (fl >= D3D_FEATURE_LEVEL_9_2));
-                LVYESNO("Independant Write Masks", (fl >= D3D_FEATURE_LEVEL_9_3));
-
-                LVLINE("Instancing", instancing);
-
-                if (pD3D11_1 || pD3D11_2 || pD3D11_3)
-                {
-                    LVLINE("Shadow Support", shadows);
-                }
-
-                if (pD3D11_2 || pD3D11_3)
-                {
-                    LVLINE("Cubemap Render w/ non-Cube Depth", cubeRT);
-                }
+                EmitLineRow(pPrintInfo, "Cubemap Render w/ non-Cube Depth", cubeRT);
             }
-
-            LVLINE("Note", FL_NOTE);
         }
-        else
-        {
-            PRINTLINE("Shader Model", shaderModel);
-            PRINTYESNO("Geometry Shader", (fl >= D3D_FEATURE_LEVEL_10_0));
-            PRINTYESNO("Stream Out", (fl >= D3D_FEATURE_LEVEL_10_0));
-
-            if (pD3D12 || pD3D11_3 || pD3D11_2 || pD3D11_1 || pD3D11)
-            {
-                PRINTLINE("DirectCompute", computeShader);
-                PRINTYESNO("Hull & Domain Shaders", (fl >= D3D_FEATURE_LEVEL_11_0));
-            }
-
-            if (pD3D12)
-            {
-                PRINTLINE("Variable Rate Shading (VRS)", vrs);
-                PRINTLINE("Mesh & Amplification Shaders", meshShaders);
-                PRINTLINE("DirectX Raytracing", dxr);
-            }
-
-            PRINTYESNO("Texture Resource Arrays", (fl >= D3D_FEATURE_LEVEL_10_0));
-
-            if (d3dVer != 0)
-            {
-                PRINTYESNO("Cubemap Resource Arrays", (fl >= D3D_FEATURE_LEVEL_10_1));
-            }
-
-            PRINTYESNO("BC4/BC5 Compression", (fl >= D3D_FEATURE_LEVEL_10_0));
-
-            if (pD3D11_3 || pD3D11_2 || pD3D11_1 || pD3D11)
-            {
-                PRINTYESNO("BC6H/BC7 Compression", (fl >= D3D_FEATURE_LEVEL_11_0));
-            }
-
-            PRINTYESNO("Alpha-to-coverage", (fl >= D3D_FEATURE_LEVEL_10_0));
-
-            if (pD3D11_1 || pD3D11_2 || pD3D11_3 || pD3D12)
-            {
-                PRINTLINE("Logic Ops (Output Merger)", logic_ops);
-            }
-
-            if (pD3D11_1 || pD3D11_2 || pD3D11_3)
-            {
-                PRINTLINE("Constant Buffer Partial Updates", cb_partial);
-                PRINTLINE("Constant Buffer Offsetting", cb_offsetting);
-
-                if (uavEveryStage)
-                {
-                    PRINTLINE("UAVs at Every Stage", uavEveryStage);
-                }
-
-                if (uavOnlyRender)
-                {
-                    PRINTLINE("UAV-only rendering", uavOnlyRender);
-                }
-            }
-
-            if (pD3D11_2 || pD3D11_3 || pD3D12)
-            {
-                if (tiled_rsc)
-                {
-                    PRINTLINE("Tiled Resources", tiled_rsc);
-                }
-            }
-
-            if (pD3D11_2 || pD3D11_3)
-            {
-                if (minmaxfilter)
-                {
-                    PRINTLINE("Min/Max Filtering", minmaxfilter);
-                }
-
-                if (mapdefaultbuff)
-                {
-                    PRINTLINE("Map DEFAULT Buffers", mapdefaultbuff);
-                }
-            }
-
-            if (pD3D11_3 || pD3D12)
-            {
-                if (consrv_rast)
-                {
-                    PRINTLINE("Conservative Rasterization", consrv_rast);
-                }
-
-                if (ps_stencil_ref)
-                {
-                    PRINTLINE("PS-Specified Stencil Ref ", ps_stencil_ref);
-                }
-
-                if (rast_ordered_views)
-                {
-                    PRINTLINE("Rasterizer Ordered Views", rast_ordered_views);
-                }
-            }
 
-            if (pD3D12 && binding_rsc)
-            {
-                PRINTLINE("Resource Binding", binding_rsc);
-            }
-
-            if (g_DXGIFactory1 && !pD3D12)
-            {
-                PRINTLINE("Extended Formats (BGRA, etc.)", extFormats);
-
-                if (x2_10BitFormat)
-                {
-                    PRINTLINE("10-bit XR High Color Format", x2_10BitFormat);
-                }
-            }
-
-            if (pD3D11_1 || pD3D11_2 || pD3D11_3)
-            {
-                PRINTLINE("16-bit Formats (565/5551/4444)", bpp16);
-            }
-
-            if (nonpow2)
-            {
-                PRINTLINE("Non-Power-of-2 Textures", nonpow2);
-            }
-
-            PRINTLINE("Max Texture Dimension", maxTexDim);
-            PRINTLINE("Max Cubemap Dimension", maxCubeDim);
-
-            if (maxVolDim)
-            {
-                PRINTLINE("Max Volume Extent", maxVolDim);
-            }
-
-            if (maxTexRepeat)
-            {
-                PRINTLINE("Max Texture Repeat", maxTexRepeat);
-            }
-
-            PRINTLINE("Max Input Slots", maxInputSlots);
-
-            if (uavSlots)
-            {
-                PRINTLINE("UAV Slots", uavSlots);
-            }
-
-            if (maxAnisotropy)
-            {
-                PRINTLINE("Max Anisotropy", maxAnisotropy);
-            }
-
-            PRINTLINE("Max Primitive Count", maxPrimCount);
-
-            if (mrt)
-            {
-                PRINTLINE("Simultaneous Render Targets", mrt);
-            }
-
-            if (_10level9)
-            {
-                PRINTYESNO("Occlusion Queries", (fl >= D3D_FEATURE_LEVEL_9_2));
-                PRINTYESNO("Separate Alpha Blend", (fl >= D3D_FEATURE_LEVEL_9_2));
-                PRINTYESNO("Mirror Once", (fl >= D3D_FEATURE_LEVEL_9_2));
-                PRINTYESNO("Overlapping Vertex Elements", (fl >= D3D_FEATURE_LEVEL_9_2));
-                PRINTYESNO("Independant Write Masks", (fl >= D3D_FEATURE_LEVEL_9_3));
-
-                PRINTLINE("Instancing", instancing);
-
-                if (pD3D11_1 || pD3D11_2 || pD3D11_3)
-                {
-                    PRINTLINE("Shadow Support", shadows);
-                }
-
-                if (pD3D11_2 || pD3D11_3)
-                {
-                    PRINTLINE("Cubemap Render w/ non-Cube Depth", cubeRT);
-                }
-            }
-
-            PRINTLINE("Note", FL_NOTE);
-        }
+        EmitLineRow(pPrintInfo, "Note", FL_NOTE);
 
         return S_OK;
     }
@@ -2444,19 +2131,16 @@ namespace
         if (!pDevice)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
 
-            if (lParam2 == D3D10_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET)
-            {
-                LVAddColumn(g_hwndLV, 1, "Value", 25);
-                LVAddColumn(g_hwndLV, 2, "Quality Level", 25);
-            }
-            else
-            {
-                LVAddColumn(g_hwndLV, 1, "Value", 60);
-            }
+        if (lParam2 == D3D10_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET)
+        {
+            EmitColumn(pPrintInfo, 1, "Value", 25);
+            EmitColumn(pPrintInfo, 2, "Quality Level", 25);
+        }
+        else
+        {
+            EmitColumn(pPrintInfo, 1, "Value", 60);
         }
 
         if (!lParam2)
@@ -2466,26 +2150,13 @@ namespace
             BOOL ext, x2;
             CheckExtendedFormats(pDevice, ext, x2);
 
-            if (!pPrintInfo)
+            if (g_DXGIFactory1)
             {
-                if (g_DXGIFactory1)
-                {
-                    LVYESNO("Extended Formats (BGRA, etc.)", ext);
-                    LVYESNO("10-bit XR High Color Format", x2);
-                }
-
-                LVLINE("Note", D3D10_NOTE);
+                EmitYesNoRow(pPrintInfo, "Extended Formats (BGRA, etc.)", ext);
+                EmitYesNoRow(pPrintInfo, "10-bit XR High Color Format", x2);
             }
-            else
-            {
-                if (g_DXGIFactory1)
-                {
-                    PRINTYESNO("Extended Formats (BGRA, etc.)", ext);
-                    PRINTYESNO("10-bit XR High Color Format", x2);
-                }
 
-                PRINTLINE("Note", D3D10_NOTE);
-            }
+            EmitLineRow(pPrintInfo, "Note", D3D10_NOTE);
 
             return S_OK;
         }
@@ -2581,49 +2252,26 @@ namespace
 
             if (lParam2 == D3D10_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET)
             {
-                UINT quality;
-                HRESULT hr = pDevice->CheckMultisampleQualityLevels(fmt, (UINT)lParam3, &quality);
+                UINT quality = MSAAQuality(pDevice, fmt, (UINT)lParam3);
 
-                BOOL msaa = (SUCCEEDED(hr) && quality > 0) != 0;
+                BOOL msaa = (quality > 0);
 
-                if (!pPrintInfo)
+                if (g_dwViewState == IDM_VIEWALL || msaa)
                 {
-                    if (g_dwViewState == IDM_VIEWALL || msaa)
+                    const ROWCELL cells[3] =
                     {
-                        LVAddText(g_hwndLV, 0, FormatName(fmt));
-                        LVAddText(g_hwndLV, 1, msaa ? c_szYes : c_szNo); \
-
-                            TCHAR strBuffer[16];
-                        sprintf_s(strBuffer, 16, "%u", msaa ? quality : 0);
-                        LVAddText(g_hwndLV, 2, strBuffer);
-                    }
-                }
-                else
-                {
-                    TCHAR strBuffer[32];
-                    if (msaa)
-                        sprintf_s(strBuffer, 32, "Yes (%u)", quality);
-                    else
-                        strcpy_s(strBuffer, 32, c_szNo);
-
-                    PrintStringValueLine(FormatName(fmt), strBuffer, pPrintInfo);
+                        { CELL_TEXT, FormatName(fmt), 0 },
+                        { CELL_BOOL, nullptr, static_cast<DWORD>(msaa) },
+                        { CELL_UINT, nullptr, (msaa) ? quality : 0 },
+                    };
+                    EmitRow(pPrintInfo, 3, cells);
                 }
             }
             else
             {
-                UINT fmtSupport = 0;
-                HRESULT hr = pDevice->CheckFormatSupport(fmt, &fmtSupport);
-                if (FAILED(hr))
-                    fmtSupport = 0;
+                UINT fmtSupport = FormatSupport1(pDevice, fmt);
 
-                if (!pPrintInfo)
-                {
-                    LVYESNO(FormatName(fmt), fmtSupport & (UINT)lParam2);
-                }
-                else
-                {
-                    PRINTYESNO(FormatName(fmt), fmtSupport & (UINT)lParam2);
-                }
+                EmitYesNoRow(pPrintInfo, FormatName(fmt), fmtSupport & (UINT)lParam2);
             }
         }
 
@@ -2636,19 +2284,16 @@ namespace
         if (!pDevice)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
 
-            if (lParam2 == D3D10_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET)
-            {
-                LVAddColumn(g_hwndLV, 1, "Value", 25);
-                LVAddColumn(g_hwndLV, 2, "Quality Level", 25);
-            }
-            else
-            {
-                LVAddColumn(g_hwndLV, 1, "Value", 60);
-            }
+        if (lParam2 == D3D10_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET)
+        {
+            EmitColumn(pPrintInfo, 1, "Value", 25);
+            EmitColumn(pPrintInfo, 2, "Quality Level", 25);
+        }
+        else
+        {
+            EmitColumn(pPrintInfo, 1, "Value", 60);
         }
 
         if (!lParam2)
@@ -2678,31 +2323,16 @@ namespace
             BOOL ext, x2;
             CheckExtendedFormats(pDevice, ext, x2);
 
-            if (!pPrintInfo)
-            {
-                LVLINE("Feature Level", FLName(fl));
-
-                if (g_DXGIFactory1 != nullptr && (fl >= D3D10_FEATURE_LEVEL_10_0))
-                {
-                    LVYESNO("Extended Formats (BGRA, etc.)", ext);
-                    LVYESNO("10-bit XR High Color Format", x2);
-                }
+            EmitLineRow(pPrintInfo, "Feature Level", FLName(fl));
 
-                LVLINE("Note", szNote);
-            }
-            else
+            if (g_DXGIFactory1 != nullptr && (fl >= D3D10_FEATURE_LEVEL_10_0))
             {
-                PRINTLINE("Feature Level", FLName(fl));
-
-                if (g_DXGIFactory1 != nullptr && (fl >= D3D10_FEATURE_LEVEL_10_0))
-                {
-                    PRINTYESNO("Extended Formats (BGRA, etc.)", ext);
-                    PRINTYESNO("10-bit XR High Color Format", x2);
-                }
-
-                PRINTLINE("Note", szNote);
+                EmitYesNoRow(pPrintInfo, "Extended Formats (BGRA, etc.)", ext);
+                EmitYesNoRow(pPrintInfo, "10-bit XR High Color Format", x2);
             }
 
+            EmitLineRow(pPrintInfo, "Note", szNote);
+
             return S_OK;
         }
 
@@ -2783,49 +2413,26 @@ namespace
 
             if (lParam2 == D3D10_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET)
             {
-                UINT quality;
-                HRESULT hr = pDevice->CheckMultisampleQualityLevels(fmt, (UINT)lParam3, &quality);
+                UINT quality = MSAAQuality(pDevice, fmt, (UINT)lParam3);
 
-                BOOL msaa = (SUCCEEDED(hr) && quality > 0) != 0;
+                BOOL msaa = (quality > 0);
 
-                if (!pPrintInfo)
+                if (g_dwViewState == IDM_VIEWALL || msaa)
                 {
-                    if (g_dwViewState == IDM_VIEWALL || msaa)
+                    const ROWCELL cells[3] =
                     {
-                        LVAddText(g_hwndLV, 0, FormatName(fmt));
-                        LVAddText(g_hwndLV, 1, msaa ? c_szYes : c_szNo); \
-
-                            TCHAR strBuffer[16];
-                        sprintf_s(strBuffer, 16, "%u", msaa ? quality : 0);
-                        LVAddText(g_hwndLV, 2, strBuffer);
-                    }
-                }
-                else
-                {
-                    TCHAR strBuffer[32];
-                    if (msaa)
-                        sprintf_s(strBuffer, 32, "Yes (%u)", quality);
-                    else
-                        strcpy_s(strBuffer, 32, c_szNo);
-
-                    PrintStringValueLine(FormatName(fmt), strBuffer, pPrintInfo);
+                        { CELL_TEXT, FormatName(fmt), 0 },
+                        { CELL_BOOL, nullptr, static_cast<DWORD>(msaa) },
+                        { CELL_UINT, nullptr, (msaa) ? quality : 0 },
+                    };
+                    EmitRow(pPrintInfo, 3, cells);
                 }
             }
             else
             {
-                UINT fmtSupport = 0;
-                HRESULT hr = pDevice->CheckFormatSupport(fmt, &fmtSupport);
-                if (FAILED(hr))
-                    fmtSupport = 0;
+                UINT fmtSupport = FormatSupport1(pDevice, fmt);
 
-                if (!pPrintInfo)
-                {
-                    LVYESNO(FormatName(fmt), fmtSupport & (UINT)lParam2);
-                }
-                else
-                {
-                    PRINTYESNO(FormatName(fmt), fmtSupport & (UINT)lParam2);
-                }
+                EmitYesNoRow(pPrintInfo, FormatName(fmt), fmtSupport & (UINT)lParam2);
             }
         }
 
@@ -2833,29 +2440,39 @@ namespace
     }
 
 
-    HRESULT D3D10InfoMSAA(LPARAM lParam1, LPARAM lParam2, PRINTCBINFO* pPrintInfo)
+    HRESULT D3D10InfoMSAA(LPARAM lParam1, LPARAM /*lParam2*/, PRINTCBINFO* pPrintInfo)
     {
         auto pDevice = reinterpret_cast<ID3D10Device*>(lParam1);
         if (!pDevice)
             return S_OK;
 
-        auto sampCount = reinterpret_cast<BOOL*>(lParam2);
+        const MSAASUPPORT* pTable = GetMSAASupport(pDevice);
+        if (!pTable)
+            return E_OUTOFMEMORY;
 
-        if (!pPrintInfo)
+        // The columns of 10level9 devices come from the formats they support
+        DWORD sampCount = MSAASampleCounts(pTable, g_cfsMSAA_10);
+
+        ID3D10Device1* pDevice1 = nullptr;
+        if (SUCCEEDED(pDevice->QueryInterface(IID_PPV_ARGS(&pDevice1))))
         {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
+            if (pDevice1->GetFeatureLevel() <= D3D10_FEATURE_LEVEL_9_3)
+                sampCount = MSAASampleCounts(pTable, g_cfsMSAA_10level9);
+            pDevice1->Release();
+        }
 
-            UINT column = 1;
-            for (UINT samples = 2; samples <= D3D10_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
-            {
-                if (!sampCount[samples - 1] && !IsMSAAPowerOf2(samples))
-                    continue;
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
 
-                TCHAR strBuffer[8];
-                sprintf_s(strBuffer, 8, "%ux", samples);
-                LVAddColumn(g_hwndLV, column, strBuffer, 8);
-                ++column;
-            }
+        UINT column = 1;
+        for (UINT samples = 2; samples <= D3D10_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
+        {
+            if (!(sampCount & (1u << (samples - 1))) && !IsMSAAPowerOf2(samples))
+                continue;
+
+            TCHAR strBuffer[8];
+            sprintf_s(strBuffer, 8, "%ux", samples);
+            EmitColumn(pPrintInfo, column, strBuffer, 8);
+            ++column;
         }
 
         const UINT count = sizeof(g_cfsMSAA_10) / sizeof(DXGI_FORMAT);
@@ -2864,68 +2481,44 @@ namespace
         {
             DXGI_FORMAT fmt = g_cfsMSAA_10[i];
 
-            UINT sampQ[D3D10_MAX_MULTISAMPLE_SAMPLE_COUNT];
-            memset(sampQ, 0, sizeof(sampQ));
+            const UINT* sampQ = pTable->quality[fmt];
 
             BOOL any = FALSE;
             for (UINT samples = 2; samples <= D3D10_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
             {
-                UINT quality;
-                HRESULT hr = pDevice->CheckMultisampleQualityLevels(fmt, samples, &quality);
-
-                if (SUCCEEDED(hr) && quality > 0)
+                if (sampQ[samples - 1] > 0)
                 {
-                    sampQ[samples - 1] = quality;
                     any = TRUE;
+                    break;
                 }
             }
 
-            if (!pPrintInfo)
-            {
-                if (g_dwViewState != IDM_VIEWALL && !any)
-                    continue;
-
-                LVAddText(g_hwndLV, 0, FormatName(fmt));
+            if (g_dwViewState != IDM_VIEWALL && !any)
+                continue;
 
-                UINT column = 1;
-                for (UINT samples = 2; samples <= D3D10_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
-                {
-                    if (!sampCount[samples - 1] && !IsMSAAPowerOf2(samples))
-                        continue;
+            ROWCELL cells[D3D10_MAX_MULTISAMPLE_SAMPLE_COUNT + 1] = {};
+            TCHAR strQuality[D3D10_MAX_MULTISAMPLE_SAMPLE_COUNT + 1][16];
 
-                    if (sampQ[samples - 1] > 0)
-                    {
-                        TCHAR strBuffer[32];
-                        sprintf_s(strBuffer, 32, "Yes (%u)", sampQ[samples - 1]);
-                        LVAddText(g_hwndLV, column, strBuffer);
-                    }
-                    else
-                        LVAddText(g_hwndLV, column, c_szNo);
+            cells[0] = { CELL_TEXT, FormatName(fmt), 0 };
 
-                    ++column;
-                }
-            }
-            else
+            UINT cCells = 1;
+            for (UINT samples = 2; samples <= D3D10_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
             {
-                TCHAR buff[1024];
-                *buff = 0;
+                if (!(sampCount & (1u << (samples - 1))) && !IsMSAAPowerOf2(samples))
+                    continue;
 
-                for (UINT samples = 2; samples <= D3D10_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
+                if (sampQ[samples - 1] > 0)
                 {
-                    if (!sampCount[samples - 1] && !IsMSAAPowerOf2(samples))
-                        continue;
-
-                    TCHAR strBuffer[32];
-                    if (sampQ[samples - 1] > 0)
-                        sprintf_s(strBuffer, 32, "%ux: Yes (%u)   ", samples, sampQ[samples - 1]);
-                    else
-                        sprintf_s(strBuffer, 32, "%ux: No   ", samples);
-
-                    strcat_s(buff, 1024, strBuffer);
+                    sprintf_s(strQuality[cCells], 16, "Yes (%u)", sampQ[samples - 1]);
+                    cells[cCells] = { CELL_TEXT, strQuality[cCells], 0 };
                 }
+                else
+                    cells[cCells] = { CELL_BOOL, nullptr, FALSE };
 
-                PrintStringValueLine(FormatName(fmt), buff, pPrintInfo);
+                ++cCells;
             }
+
+            EmitRow(pPrintInfo, cCells, cells);
         }
 
         return S_OK;
@@ -2939,19 +2532,16 @@ namespace
         if (!pDevice)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
 
-            if (lParam2 == D3D11_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET)
-            {
-                LVAddColumn(g_hwndLV, 1, "Value", 25);
-                LVAddColumn(g_hwndLV, 2, "Quality Level", 25);
-            }
-            else
-            {
-                LVAddColumn(g_hwndLV, 1, "Value", 60);
-            }
+        if (lParam2 == D3D11_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET)
+        {
+            EmitColumn(pPrintInfo, 1, "Value", 25);
+            EmitColumn(pPrintInfo, 2, "Quality Level", 25);
+        }
+        else
+        {
+            EmitColumn(pPrintInfo, 1, "Value", 60);
         }
 
         if (!lParam2)
@@ -2987,28 +2577,14 @@ namespace
                 break;
             }
 
-            if (!pPrintInfo)
-            {
-                LVLINE("Feature Level", FLName(fl));
-
-                LVYESNO("Driver Concurrent Creates", threading.DriverConcurrentCreates);
-                LVYESNO("Driver Command Lists", threading.DriverCommandLists);
-                LVYESNO("Double-precision Shaders", doubles.DoublePrecisionFloatShaderOps);
-                LVYESNO("DirectCompute CS 4.x", d3d10xhw.ComputeShaders_Plus_RawAndStructuredBuffers_Via_Shader_4_x);
-
-                LVLINE("Note", szNote);
-            }
-            else
-            {
-                PRINTLINE("Feature Level", FLName(fl));
+            EmitLineRow(pPrintInfo, "Feature Level", FLName(fl));
 
-                PRINTYESNO("Driver Concurrent Creates", threading.DriverConcurrentCreates);
-                PRINTYESNO("Driver Command Lists", threading.DriverCommandLists);
-                PRINTYESNO("Double-precision Shaders", doubles.DoublePrecisionFloatShaderOps);
-                PRINTYESNO("DirectCompute CS 4.x", d3d10xhw.ComputeShaders_Plus_RawAndStructuredBuffers_Via_Shader_4_x);
+            EmitYesNoRow(pPrintInfo, "Driver Concurrent Creates", threading.DriverConcurrentCreates);
+            EmitYesNoRow(pPrintInfo, "Driver Command Lists", threading.DriverCommandLists);
+            EmitYesNoRow(pPrintInfo, "Double-precision Shaders", doubles.DoublePrecisionFloatShaderOps);
+            EmitYesNoRow(pPrintInfo, "DirectCompute CS 4.x", d3d10xhw.ComputeShaders_Plus_RawAndStructuredBuffers_Via_Shader_4_x);
 
-                PRINTLINE("Note", szNote);
-            }
+            EmitLineRow(pPrintInfo, "Note", szNote);
 
             return S_OK;
         }
@@ -3100,49 +2676,26 @@ namespace
                 if (fmt == DXGI_FORMAT_B5G6R5_UNORM || fmt == DXGI_FORMAT_B5G5R5A1_UNORM || fmt == DXGI_FORMAT_B4G4R4A4_UNORM)
                     continue;
 
-                UINT quality;
-                HRESULT hr = pDevice->CheckMultisampleQualityLevels(fmt, (UINT)lParam3, &quality);
+                UINT quality = MSAAQuality(pDevice, fmt, (UINT)lParam3);
 
-                BOOL msaa = (SUCCEEDED(hr) && quality > 0) != 0;
+                BOOL msaa = (quality > 0);
 
-                if (!pPrintInfo)
+                if (g_dwViewState == IDM_VIEWALL || msaa)
                 {
-                    if (g_dwViewState == IDM_VIEWALL || msaa)
+                    const ROWCELL cells[3] =
                     {
-                        LVAddText(g_hwndLV, 0, FormatName(fmt));
-                        LVAddText(g_hwndLV, 1, msaa ? c_szYes : c_szNo); \
-
-                            TCHAR strBuffer[16];
-                        sprintf_s(strBuffer, 16, "%u", msaa ? quality : 0);
-                        LVAddText(g_hwndLV, 2, strBuffer);
-                    }
-                }
-                else
-                {
-                    TCHAR strBuffer[32];
-                    if (msaa)
-                        sprintf_s(strBuffer, 32, "Yes (%u)", quality);
-                    else
-                        strcpy_s(strBuffer, 32, c_szNo);
-
-                    PrintStringValueLine(FormatName(fmt), strBuffer, pPrintInfo);
+                        { CELL_TEXT, FormatName(fmt), 0 },
+                        { CELL_BOOL, nullptr, static_cast<DWORD>(msaa) },
+                        { CELL_UINT, nullptr, (msaa) ? quality : 0 },
+                    };
+                    EmitRow(pPrintInfo, 3, cells);
                 }
             }
             else
             {
-                UINT fmtSupport = 0;
-                HRESULT hr = pDevice->CheckFormatSupport(fmt, &fmtSupport);
-                if (FAILED(hr))
-                    fmtSupport = 0;
+                UINT fmtSupport = FormatSupport1(pDevice, fmt);
 
-                if (!pPrintInfo)
-                {
-                    LVYESNO(FormatName(fmt), fmtSupport & (UINT)lParam2);
-                }
-                else
-                {
-                    PRINTYESNO(FormatName(fmt), fmtSupport & (UINT)lParam2);
-                }
+                EmitYesNoRow(pPrintInfo, FormatName(fmt), fmtSupport & (UINT)lParam2);
             }
         }
 
@@ -3215,78 +2768,39 @@ namespace
 
         const char* nonpow2 = (d3d9opts.FullNonPow2TextureSupport) ? "Full" : "Conditional";
 
-        if (!pPrintInfo)
+        EmitLineRow(pPrintInfo, "Feature Level", FLName(fl));
+
+        EmitYesNoRow(pPrintInfo, "Driver Concurrent Creates", threading.DriverConcurrentCreates);
+        EmitYesNoRow(pPrintInfo, "Driver Command Lists", threading.DriverCommandLists);
+        EmitLineRow(pPrintInfo, "Double-precision Shaders", double_shaders);
+        EmitYesNoRow(pPrintInfo, "DirectCompute CS 4.x", d3d10xhw.ComputeShaders_Plus_RawAndStructuredBuffers_Via_Shader_4_x);
+
+        EmitYesNoRow(pPrintInfo, "Driver sees DiscardResource/View", d3d11opts.DiscardAPIsSeenByDriver);
+        EmitYesNoRow(pPrintInfo, "Driver sees COPY_FLAGS", d3d11opts.FlagsForUpdateAndCopySeenByDriver);
+        EmitLineRow(pPrintInfo, "ClearView", clearview);
+        EmitYesNoRow(pPrintInfo, "Copy w/ Overlapping Rect", d3d11opts.CopyWithOverlap);
+        EmitYesNoRow(pPrintInfo, "CB Partial Update", d3d11opts.ConstantBufferPartialUpdate);
+        EmitYesNoRow(pPrintInfo, "CB Offsetting", d3d11opts.ConstantBufferOffsetting);
+        EmitYesNoRow(pPrintInfo, "Map NO_OVERWRITE on Dynamic CB", d3d11opts.MapNoOverwriteOnDynamicConstantBuffer);
+
+        if (fl >= D3D_FEATURE_LEVEL_10_0)
         {
-            LVLINE("Feature Level", FLName(fl));
+            EmitYesNoRow(pPrintInfo, "Map NO_OVERWRITE on Dynamic SRV", d3d11opts.MapNoOverwriteOnDynamicBufferSRV);
+            EmitYesNoRow(pPrintInfo, "MSAA with ForcedSampleCount=1", d3d11opts.MultisampleRTVWithForcedSampleCountOne);
+            EmitYesNoRow(pPrintInfo, "Extended resource sharing", d3d11opts.ExtendedResourceSharing);
+        }
 
-            LVYESNO("Driver Concurrent Creates", threading.DriverConcurrentCreates);
-            LVYESNO("Driver Command Lists", threading.DriverCommandLists);
-            LVLINE("Double-precision Shaders", double_shaders);
-            LVYESNO("DirectCompute CS 4.x", d3d10xhw.ComputeShaders_Plus_RawAndStructuredBuffers_Via_Shader_4_x);
+        if (fl >= D3D_FEATURE_LEVEL_11_0)
+        {
+            EmitYesNoRow(pPrintInfo, "Saturating Add Instruction", d3d11opts.SAD4ShaderInstructions);
+        }
 
-            LVYESNO("Driver sees DiscardResource/View", d3d11opts.DiscardAPIsSeenByDriver);
-            LVYESNO("Driver sees COPY_FLAGS", d3d11opts.FlagsForUpdateAndCopySeenByDriver);
-            LVLINE("ClearView", clearview);
-            LVYESNO("Copy w/ Overlapping Rect", d3d11opts.CopyWithOverlap);
-            LVYESNO("CB Partial Update", d3d11opts.ConstantBufferPartialUpdate);
-            LVYESNO("CB Offsetting", d3d11opts.ConstantBufferOffsetting);
-            LVYESNO("Map NO_OVERWRITE on Dynamic CB", d3d11opts.MapNoOverwriteOnDynamicConstantBuffer);
+        EmitYesNoRow(pPrintInfo, "Tile-based Deferred Renderer", d3d11arch.TileBasedDeferredRenderer);
 
-            if (fl >= D3D_FEATURE_LEVEL_10_0)
-            {
-                LVYESNO("Map NO_OVERWRITE on Dynamic SRV", d3d11opts.MapNoOverwriteOnDynamicBufferSRV);
-                LVYESNO("MSAA with ForcedSampleCount=1", d3d11opts.MultisampleRTVWithForcedSampleCountOne);
-                LVYESNO("Extended resource sharing", d3d11opts.ExtendedResourceSharing);
-            }
+        EmitLineRow(pPrintInfo, "Non-Power-of-2 Textures", nonpow2);
 
-            if (fl >= D3D_FEATURE_LEVEL_11_0)
-            {
-                LVYESNO("Saturating Add Instruction", d3d11opts.SAD4ShaderInstructions);
-            }
-
-            LVYESNO("Tile-based Deferred Renderer", d3d11arch.TileBasedDeferredRenderer);
-
-            LVLINE("Non-Power-of-2 Textures", nonpow2);
-
-            LVLINE("Pixel Shader Precision", ps_precis);
-            LVLINE("Other Stage Precision", other_precis);
-        }
-        else
-        {
-            PRINTLINE("Feature Level", FLName(fl));
-
-            PRINTYESNO("Driver Concurrent Creates", threading.DriverConcurrentCreates);
-            PRINTYESNO("Driver Command Lists", threading.DriverCommandLists);
-            PRINTLINE("Double-precision Shaders", double_shaders);
-            PRINTYESNO("DirectCompute CS 4.x", d3d10xhw.ComputeShaders_Plus_RawAndStructuredBuffers_Via_Shader_4_x);
-
-            PRINTYESNO("Driver sees DiscardResource/View", d3d11opts.DiscardAPIsSeenByDriver);
-            PRINTYESNO("Driver sees COPY_FLAGS", d3d11opts.FlagsForUpdateAndCopySeenByDriver);
-            PRINTLINE("ClearView", clearview);
-            PRINTYESNO("Copy w/ Overlapping Rect", d3d11opts.CopyWithOverlap);
-            PRINTYESNO("CB Partial Update", d3d11opts.ConstantBufferPartialUpdate);
-            PRINTYESNO("CB Offsetting", d3d11opts.ConstantBufferOffsetting);
-            PRINTYESNO("Map NO_OVERWRITE on Dynamic CB", d3d11opts.MapNoOverwriteOnDynamicConstantBuffer);
-
-            if (fl >= D3D_FEATURE_LEVEL_10_0)
-            {
-                PRINTYESNO("Map NO_OVERWRITE on Dynamic SRV", d3d11opts.MapNoOverwriteOnDynamicBufferSRV);
-                PRINTYESNO("MSAA with ForcedSampleCount=1", d3d11opts.MultisampleRTVWithForcedSampleCountOne);
-                PRINTYESNO("Extended resource sharing", d3d11opts.ExtendedResourceSharing);
-            }
-
-            if (fl >= D3D_FEATURE_LEVEL_11_0)
-            {
-                PRINTYESNO("Saturating Add Instruction", d3d11opts.SAD4ShaderInstructions);
-            }
-
-            PRINTYESNO("Tile-based Deferred Renderer", d3d11arch.TileBasedDeferredRenderer);
-
-            PRINTLINE("Non-Power-of-2 Textures", nonpow2);
-
-            PRINTLINE("Pixel Shader Precision", ps_precis);
-            PRINTLINE("Other Stage Precision", other_precis);
-        }
+        EmitLineRow(pPrintInfo, "Pixel Shader Precision", ps_precis);
+        EmitLineRow(pPrintInfo, "Other Stage Precision", other_precis);
     }
 
     HRESULT D3D11Info1(LPARAM lParam1, LPARAM lParam2, LPARAM lParam3, PRINTCBINFO* pPrintInfo)
@@ -3295,19 +2809,16 @@ namespace
         if (!pDevice)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
 
-            if (lParam2 == D3D11_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET)
-            {
-                LVAddColumn(g_hwndLV, 1, "Value", 25);
-                LVAddColumn(g_hwndLV, 2, "Quality Level", 25);
-            }
-            else
-            {
-                LVAddColumn(g_hwndLV, 1, "Value", 60);
-            }
+        if (lParam2 == D3D11_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET)
+        {
+            EmitColumn(pPrintInfo, 1, "Value", 25);
+            EmitColumn(pPrintInfo, 2, "Quality Level", 25);
+        }
+        else
+        {
+            EmitColumn(pPrintInfo, 1, "Value", 60);
         }
 
         // General Direct3D 11.1 device information
@@ -3342,14 +2853,7 @@ namespace
                 break;
             }
 
-            if (!pPrintInfo)
-            {
-                LVLINE("Note", szNote);
-            }
-            else
-            {
-                PRINTLINE("Note", szNote);
-            }
+            EmitLineRow(pPrintInfo, "Note", szNote);
 
             return S_OK;
         }
@@ -3616,67 +3120,30 @@ namespace
                 if (g_dwViewState != IDM_VIEWALL && fmt == DXGI_FORMAT_B5G6R5_UNORM)
                     continue;
 
-                UINT quality;
-                HRESULT hr = pDevice->CheckMultisampleQualityLevels(fmt, (UINT)lParam3, &quality);
+                UINT quality = MSAAQuality(pDevice, fmt, (UINT)lParam3);
 
-                BOOL msaa = (SUCCEEDED(hr) && quality > 0) != 0;
+                BOOL msaa = (quality > 0);
 
-                if (!pPrintInfo)
+                if (g_dwViewState == IDM_VIEWALL || msaa)
                 {
-                    if (g_dwViewState == IDM_VIEWALL || msaa)
+                    const ROWCELL cells[3] =
                     {
-                        LVAddText(g_hwndLV, 0, FormatName(fmt));
-                        LVAddText(g_hwndLV, 1, msaa ? c_szYes : c_szNo); \
-
-                            TCHAR strBuffer[16];
-                        sprintf_s(strBuffer, 16, "%u", msaa ? quality : 0);
-                        LVAddText(g_hwndLV, 2, strBuffer);
-                    }
-                }
-                else
-                {
-                    TCHAR strBuffer[32];
-                    if (msaa)
-                        sprintf_s(strBuffer, 32, "Yes (%u)", quality);
-                    else
-                        strcpy_s(strBuffer, 32, c_szNo);
-
-                    PrintStringValueLine(FormatName(fmt), strBuffer, pPrintInfo);
+                        { CELL_TEXT, FormatName(fmt), 0 },
+                        { CELL_BOOL, nullptr, static_cast<DWORD>(msaa) },
+                        { CELL_UINT, nullptr, (msaa) ? quality : 0 },
+                    };
+                    EmitRow(pPrintInfo, 3, cells);
                 }
             }
             else if (lParam2 != LPARAM(-1))
             {
-                UINT fmtSupport = 0;
-                HRESULT hr = pDevice->CheckFormatSupport(fmt, &fmtSupport);
-                if (FAILED(hr))
-                    fmtSupport = 0;
+                UINT fmtSupport = FormatSupport1(pDevice, fmt);
 
-                if (!pPrintInfo)
-                {
-                    LVYESNO(FormatName(fmt), fmtSupport & (UINT)lParam2);
-                }
-                else
-                {
-                    PRINTYESNO(FormatName(fmt), fmtSupport & (UINT)lParam2);
-                }
+                EmitYesNoRow(pPrintInfo, FormatName(fmt), fmtSupport & (UINT)lParam2);
             }
             else
             {
-                D3D11_FEATURE_DATA_FORMAT_SUPPORT2 cfs2;
-                cfs2.InFormat = fmt;
-                cfs2.OutFormatSupport2 = 0;
-                HRESULT hr = pDevice->CheckFeatureSupport(D3D11_FEATURE_FORMAT_SUPPORT2, &cfs2, sizeof(cfs2));
-                if (FAILED(hr))
-                    cfs2.OutFormatSupport2 = 0;
-
-                if (!pPrintInfo)
-                {
-                    LVYESNO(FormatName(fmt), cfs2.OutFormatSupport2 & (UINT)lParam3);
-                }
-                else
-                {
-                    PRINTYESNO(FormatName(fmt), cfs2.OutFormatSupport2 & (UINT)lParam3);
-                }
+                EmitYesNoRow(pPrintInfo, FormatName(fmt), FormatSupport2(pDevice, fmt) & (UINT)lParam3);
             }
         }
 
@@ -3689,11 +3156,8 @@ namespace
         if (!pDevice)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-            LVAddColumn(g_hwndLV, 1, "Value", 60);
-        }
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 1, "Value", 60);
 
         // General Direct3D 11.2 device information
         D3D_FEATURE_LEVEL fl = pDevice->GetFeatureLevel();
@@ -3733,18 +3197,9 @@ namespace
                 break;
             }
 
-            if (!pPrintInfo)
-            {
-                LVYESNO("Profile Marker Support", marker.Profile);
-
-                LVLINE("Note", szNote);
-            }
-            else
-            {
-                PRINTYESNO("Profile Marker Support", marker.Profile);
+            EmitYesNoRow(pPrintInfo, "Profile Marker Support", marker.Profile);
 
-                PRINTLINE("Note", szNote);
-            }
+            EmitLineRow(pPrintInfo, "Note", szNote);
 
             return S_OK;
         }
@@ -3823,37 +3278,13 @@ namespace
 
             if (lParam2 != LPARAM(-1))
             {
-                UINT fmtSupport = 0;
-                HRESULT hr = pDevice->CheckFormatSupport(fmt, &fmtSupport);
-                if (FAILED(hr))
-                    fmtSupport = 0;
+                UINT fmtSupport = FormatSupport1(pDevice, fmt);
 
-                if (!pPrintInfo)
-                {
-                    LVYESNO(FormatName(fmt), fmtSupport & (UINT)lParam2);
-                }
-                else
-                {
-                    PRINTYESNO(FormatName(fmt), fmtSupport & (UINT)lParam2);
-                }
+                EmitYesNoRow(pPrintInfo, FormatName(fmt), fmtSupport & (UINT)lParam2);
             }
             else
             {
-                D3D11_FEATURE_DATA_FORMAT_SUPPORT2 cfs2;
-                cfs2.InFormat = fmt;
-                cfs2.OutFormatSupport2 = 0;
-                HRESULT hr = pDevice->CheckFeatureSupport(D3D11_FEATURE_FORMAT_SUPPORT2, &cfs2, sizeof(cfs2));
-                if (FAILED(hr))
-                    cfs2.OutFormatSupport2 = 0;
-
-                if (!pPrintInfo)
-                {
-                    LVYESNO(FormatName(fmt), cfs2.OutFormatSupport2 & (UINT)lParam3);
-                }
-                else
-                {
-                    PRINTYESNO(FormatName(fmt), cfs2.OutFormatSupport2 & (UINT)lParam3);
-                }
+                EmitYesNoRow(pPrintInfo, FormatName(fmt), FormatSupport2(pDevice, fmt) & (UINT)lParam3);
             }
         }
 
@@ -3867,11 +3298,8 @@ namespace
         if (!pDevice)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-            LVAddColumn(g_hwndLV, 1, "Value", 60);
-        }
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 1, "Value", 60);
 
         // General Direct3D 11.3/11.4 device information
         D3D_FEATURE_LEVEL fl = pDevice->GetFeatureLevel();
@@ -3962,65 +3390,33 @@ namespace
                 strcpy_s(shaderCache, "None");
             }
 
-            if (!pPrintInfo)
-            {
-                LVYESNO("Profile Marker Support", marker.Profile);
-
-                LVYESNO("Map DEFAULT Textures", d3d11opts2.MapOnDefaultTextures);
-                LVYESNO("Standard Swizzle", d3d11opts2.StandardSwizzle);
-                LVYESNO("Unified Memory Architecture (UMA)", d3d11opts2.UnifiedMemoryArchitecture);
-                LVYESNO("Extended formats TypedUAVLoad", d3d11opts2.TypedUAVLoadAdditionalFormats);
+            EmitYesNoRow(pPrintInfo, "Profile Marker Support", marker.Profile);
 
-                LVLINE("Conservative Rasterization", consrv_rast);
-                LVLINE("Tiled Resources", tiled_rsc);
-                LVYESNO("PS-Specified Stencil Ref", d3d11opts2.PSSpecifiedStencilRefSupported);
-                LVYESNO("Rasterizer Ordered Views", d3d11opts2.ROVsSupported);
+            EmitYesNoRow(pPrintInfo, "Map DEFAULT Textures", d3d11opts2.MapOnDefaultTextures);
+            EmitYesNoRow(pPrintInfo, "Standard Swizzle", d3d11opts2.StandardSwizzle);
+            EmitYesNoRow(pPrintInfo, "Unified Memory Architecture (UMA)", d3d11opts2.UnifiedMemoryArchitecture);
+            EmitYesNoRow(pPrintInfo, "Extended formats TypedUAVLoad", d3d11opts2.TypedUAVLoadAdditionalFormats);
 
-                LVYESNO("VP/RT from Rast-feeding Shader", d3d11opts3.VPAndRTArrayIndexFromAnyShaderFeedingRasterizer);
+            EmitLineRow(pPrintInfo, "Conservative Rasterization", consrv_rast);
+            EmitLineRow(pPrintInfo, "Tiled Resources", tiled_rsc);
+            EmitYesNoRow(pPrintInfo, "PS-Specified Stencil Ref", d3d11opts2.PSSpecifiedStencilRefSupported);
+            EmitYesNoRow(pPrintInfo, "Rasterizer Ordered Views", d3d11opts2.ROVsSupported);
 
-                if (lParam3 != 0)
-                {
-                    LVLINE("Max GPU VM bits per resource", vmRes);
-                    LVLINE("Max GPU VM bits per process", vmProcess);
-
-                    LVYESNO("Extended Shared NV12", d3d11opts4.ExtendedNV12SharedTextureSupported);
-                    LVLINE("Shader Cache", shaderCache);
-
-                    LVLINE("Shared Resource Tier", sharedResTier);
-                }
+            EmitYesNoRow(pPrintInfo, "VP/RT from Rast-feeding Shader", d3d11opts3.VPAndRTArrayIndexFromAnyShaderFeedingRasterizer);
 
-                LVLINE("Note", szNote);
-            }
-            else
+            if (lParam3 != 0)
             {
-                PRINTYESNO("Profile Marker Support", marker.Profile);
-
-                PRINTYESNO("Map DEFAULT Textures", d3d11opts2.MapOnDefaultTextures);
-                PRINTYESNO("Standard Swizzle", d3d11opts2.StandardSwizzle);
-                PRINTYESNO("Unified Memory Architecture (UMA)", d3d11opts2.UnifiedMemoryArchitecture);
-                PRINTYESNO("Extended formats TypedUAVLoad", d3d11opts2.TypedUAVLoadAdditionalFormats);
-
-                PRINTLINE("Conservative Rasterization", consrv_rast);
-                PRINTLINE("Tiled Resources", tiled_rsc);
-                PRINTYESNO("PS-Specified Stencil Ref", d3d11opts2.PSSpecifiedStencilRefSupported);
-                PRINTYESNO("Rasterizer Ordered Views", d3d11opts2.ROVsSupported);
-
-                PRINTYESNO("VP/RT from Rast-feeding Shader", d3d11opts3.VPAndRTArrayIndexFromAnyShaderFeedingRasterizer);
-
-                if (lParam3 != 0)
-                {
-                    PRINTLINE("Max GPU VM bits per resource", vmRes);
-                    PRINTLINE("Max GPU VM bits per process", vmProcess);
-
-                    PRINTYESNO("Extended Shared NV12", d3d11opts4.ExtendedNV12SharedTextureSupported);
-                    PRINTLINE("Shader Cache", shaderCache);
+                EmitLineRow(pPrintInfo, "Max GPU VM bits per resource", vmRes);
+                EmitLineRow(pPrintInfo, "Max GPU VM bits per process", vmProcess);
 
-                    PRINTLINE("Shared Resource Tier", sharedResTier);
-                }
+                EmitYesNoRow(pPrintInfo, "Extended Shared NV12", d3d11opts4.ExtendedNV12SharedTextureSupported);
+                EmitLineRow(pPrintInfo, "Shader Cache", shaderCache);
 
-                PRINTLINE("Note", szNote);
+                EmitLineRow(pPrintInfo, "Shared Resource Tier", sharedResTier);
             }
 
+            EmitLineRow(pPrintInfo, "Note", szNote);
+
             return S_OK;
         }
 
@@ -4098,66 +3494,43 @@ namespace
 
             if (lParam2 != LPARAM(-1))
             {
-                UINT fmtSupport = 0;
-                HRESULT hr = pDevice->CheckFormatSupport(fmt, &fmtSupport);
-                if (FAILED(hr))
-                    fmtSupport = 0;
+                UINT fmtSupport = FormatSupport1(pDevice, fmt);
 
-                if (!pPrintInfo)
-                {
-                    LVYESNO(FormatName(fmt), fmtSupport & (UINT)lParam2);
-                }
-                else
-                {
-                    PRINTYESNO(FormatName(fmt), fmtSupport & (UINT)lParam2);
-                }
+                EmitYesNoRow(pPrintInfo, FormatName(fmt), fmtSupport & (UINT)lParam2);
             }
             else
             {
-                D3D11_FEATURE_DATA_FORMAT_SUPPORT2 cfs2;
-                cfs2.InFormat = fmt;
-                cfs2.OutFormatSupport2 = 0;
-                HRESULT hr = pDevice->CheckFeatureSupport(D3D11_FEATURE_FORMAT_SUPPORT2, &cfs2, sizeof(cfs2));
-                if (FAILED(hr))
-                    cfs2.OutFormatSupport2 = 0;
-
-                if (!pPrintInfo)
-                {
-                    LVYESNO(FormatName(fmt), cfs2.OutFormatSupport2 & (UINT)lParam3);
-                }
-                else
-                {
-                    PRINTYESNO(FormatName(fmt), cfs2.OutFormatSupport2 & (UINT)lParam3);
-                }
+                EmitYesNoRow(pPrintInfo, FormatName(fmt), FormatSupport2(pDevice, fmt) & (UINT)lParam3);
             }
         }
 
         return S_OK;
     }
 
-    HRESULT D3D11InfoMSAA(LPARAM lParam1, LPARAM lParam2, LPARAM lParam3, PRINTCBINFO* pPrintInfo)
+    HRESULT D3D11InfoMSAA(LPARAM lParam1, LPARAM /*lParam2*/, LPARAM lParam3, PRINTCBINFO* pPrintInfo)
     {
         auto pDevice = reinterpret_cast<ID3D11Device*>(lParam1);
         if (!pDevice)
             return S_OK;
 
-        auto sampCount = reinterpret_cast<BOOL*>(lParam2);
+        const MSAASUPPORT* pTable = GetMSAASupport(pDevice);
+        if (!pTable)
+            return E_OUTOFMEMORY;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
+        const DWORD sampCount = MSAASampleCounts(pTable, g_cfsMSAA_11);
 
-            UINT column = 1;
-            for (UINT samples = 2; samples <= D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
-            {
-                if (!sampCount[samples - 1] && !IsMSAAPowerOf2(samples))
-                    continue;
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
 
-                TCHAR strBuffer[8];
-                sprintf_s(strBuffer, 8, "%ux", samples);
-                LVAddColumn(g_hwndLV, column, strBuffer, 8);
-                ++column;
-            }
+        UINT column = 1;
+        for (UINT samples = 2; samples <= D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
+        {
+            if (!(sampCount & (1u << (samples - 1))) && !IsMSAAPowerOf2(samples))
+                continue;
+
+            TCHAR strBuffer[8];
+            sprintf_s(strBuffer, 8, "%ux", samples);
+            EmitColumn(pPrintInfo, column, strBuffer, 8);
+            ++column;
         }
 
         const UINT count = sizeof(g_cfsMSAA_11) / sizeof(DXGI_FORMAT);
@@ -4171,129 +3544,47 @@ namespace
                 && (fmt == DXGI_FORMAT_B5G6R5_UNORM || fmt == DXGI_FORMAT_B5G5R5A1_UNORM || fmt == DXGI_FORMAT_B4G4R4A4_UNORM))
                 continue;
 
-            UINT sampQ[D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT];
-            memset(sampQ, 0, sizeof(sampQ));
+            const UINT* sampQ = pTable->quality[fmt];
 
             BOOL any = FALSE;
             for (UINT samples = 2; samples <= D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
             {
-                UINT quality;
-                HRESULT hr = pDevice->CheckMultisampleQualityLevels(fmt, samples, &quality);
-
-                if (SUCCEEDED(hr) && quality > 0)
+                if (sampQ[samples - 1] > 0)
                 {
-                    sampQ[samples - 1] = quality;
                     any = TRUE;
+                    break;
                 }
             }
 
-            if (!pPrintInfo)
-            {
-                if (g_dwViewState != IDM_VIEWALL && !any)
-                    continue;
-
-                LVAddText(g_hwndLV, 0, FormatName(fmt));
+            if (g_dwViewState != IDM_VIEWALL && !any)
+                continue;
 
-                UINT column = 1;
-                for (UINT samples = 2; samples <= D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
-                {
-                    if (!sampCount[samples - 1] && !IsMSAAPowerOf2(samples))
-                        continue;
+            ROWCELL cells[D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT + 1] = {};
+            TCHAR strQuality[D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT + 1][16];
 
-                    if (sampQ[samples - 1] > 0)
-                    {
-                        TCHAR strBuffer[32];
-                        sprintf_s(strBuffer, 32, "Yes (%u)", sampQ[samples - 1]);
-                        LVAddText(g_hwndLV, column, strBuffer);
-                    }
-                    else
-                        LVAddText(g_hwndLV, column, c_szNo);
+            cells[0] = { CELL_TEXT, FormatName(fmt), 0 };
 
-                    ++column;
-                }
-            }
-            else
+            UINT cCells = 1;
+            for (UINT samples = 2; samples <= D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
             {
-                TCHAR buff[1024];
-                *buff = 0;
+                if (!(sampCount & (1u << (samples - 1))) && !IsMSAAPowerOf2(samples))
+                    continue;
 
-                for (UINT samples = 2; samples <= D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
+                if (sampQ[samples - 1] > 0)
                 {
-                    if (!sampCount[samples - 1] && !IsMSAAPowerOf2(samples))
-                        continue;
-
-                    TCHAR strBuffer[32];
-                    if (sampQ[samples - 1] > 0)
-                        sprintf_s(strBuffer, 32, "%ux: Yes (%u)   ", samples, sampQ[samples - 1]);
-                    else
-                        sprintf_s(strBuffer, 32, "%ux: No   ", samples);
-
-                    strcat_s(buff, 1024, strBuffer);
+                    sprintf_s(strQuality[cCells], 16, "Yes (%u)", sampQ[samples - 1]);
+                    cells[cCells] = { CELL_TEXT, strQuality[cCells], 0 };
                 }
+                else
+                    cells[cCells] = { CELL_BOOL, nullptr, FALSE };
 
-                PrintStringValueLine(FormatName(fmt), buff, pPrintInfo);
+                ++cCells;
             }
-        }
-
-        return S_OK;
-    }
-
-    void FillMSAASampleTable(ID3D10Device* pDevice, BOOL sampCount[], BOOL _10level9)
-    {
-        memset(sampCount, 0, sizeof(BOOL) * D3D10_MAX_MULTISAMPLE_SAMPLE_COUNT);
-        sampCount[0] = TRUE;    // sample count of 1 is always required
-
-        UINT count = 0;
-        const DXGI_FORMAT* array = nullptr;
-
-        if (_10level9)
-        {
-            count = sizeof(g_cfsMSAA_10level9) / sizeof(DXGI_FORMAT);
-            array = g_cfsMSAA_10level9;
-        }
-        else
-        {
-            count = sizeof(g_cfsMSAA_10) / sizeof(DXGI_FORMAT);
-            array = g_cfsMSAA_10;
-        }
 
-        for (UINT samples = 2; samples <= D3D10_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
-        {
-            for (UINT i = 0; i < count; ++i)
-            {
-                UINT quality;
-                HRESULT hr = pDevice->CheckMultisampleQualityLevels(array[i], samples, &quality);
-
-                if (SUCCEEDED(hr) && quality > 0)
-                {
-                    sampCount[samples - 1] = TRUE;
-                    break;
-                }
-            }
+            EmitRow(pPrintInfo, cCells, cells);
         }
-    }
-
-    void FillMSAASampleTable(ID3D11Device* pDevice, BOOL sampCount[])
-    {
-        memset(sampCount, 0, sizeof(BOOL) * D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT);
-        sampCount[0] = TRUE;    // sample count of 1 is always required
-
-        for (UINT samples = 2; samples <= D3D11_MAX_MULTISAMPLE_SAMPLE_COUNT; ++samples)
-        {
-            const UINT count = sizeof(g_cfsMSAA_11) / sizeof(DXGI_FORMAT);
-
-            for (UINT i = 0; i < count; ++i)
-            {
-                UINT quality;
-                HRESULT hr = pDevice->CheckMultisampleQualityLevels(g_cfsMSAA_11[i], samples, &quality);
 
-                if (SUCCEEDED(hr) && quality > 0)
-                {
-                    sampCount[samples - 1] = TRUE;
-                    break;
-                }
-            }
-        }
+        return S_OK;
     }
 
     //-----------------------------------------------------------------------------
@@ -4303,14 +3594,11 @@ namespace
         if (!pDevice)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-            LVAddColumn(g_hwndLV, 1, "Texture2D", 15);
-            LVAddColumn(g_hwndLV, 2, "Input", 15);
-            LVAddColumn(g_hwndLV, 3, "Output", 15);
-            LVAddColumn(g_hwndLV, 4, "Encoder", 15);
-        }
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 1, "Texture2D", 15);
+        EmitColumn(pPrintInfo, 2, "Input", 15);
+        EmitColumn(pPrintInfo, 3, "Output", 15);
+        EmitColumn(pPrintInfo, 4, "Encoder", 15);
 
         static const DXGI_FORMAT cfsVideo[] =
         {
@@ -4335,40 +3623,25 @@ namespace
         {
             DXGI_FORMAT fmt = cfsVideo[i];
 
-            UINT fmtSupport = 0;
-            HRESULT hr = pDevice->CheckFormatSupport(fmt, &fmtSupport);
-            if (FAILED(hr))
-                fmtSupport = 0;
+            UINT fmtSupport = FormatSupport1(pDevice, fmt);
 
             bool any = (fmtSupport & (D3D11_FORMAT_SUPPORT_TEXTURE2D
                 | D3D11_FORMAT_SUPPORT_VIDEO_PROCESSOR_INPUT
                 | D3D11_FORMAT_SUPPORT_VIDEO_PROCESSOR_OUTPUT
                 | D3D11_FORMAT_SUPPORT_VIDEO_ENCODER)) ? true : false;
 
-            if (!pPrintInfo)
-            {
-                if (g_dwViewState != IDM_VIEWALL && !any)
-                    continue;
-
-                LVAddText(g_hwndLV, 0, FormatName(fmt));
+            if (g_dwViewState != IDM_VIEWALL && !any)
+                continue;
 
-                LVAddText(g_hwndLV, 1, (fmtSupport & D3D11_FORMAT_SUPPORT_TEXTURE2D) ? c_szYes : c_szNo);
-                LVAddText(g_hwndLV, 2, (fmtSupport & D3D11_FORMAT_SUPPORT_VIDEO_PROCESSOR_INPUT) ? c_szYes : c_szNo);
-                LVAddText(g_hwndLV, 3, (fmtSupport & D3D11_FORMAT_SUPPORT_VIDEO_PROCESSOR_OUTPUT) ? c_szYes : c_szNo);
-                LVAddText(g_hwndLV, 4, (fmtSupport & D3D11_FORMAT_SUPPORT_VIDEO_ENCODER) ? c_szYes : c_szNo);
-            }
-            else
+            const ROWCELL cells[5] =
             {
-                TCHAR buff[1024];
-
-                sprintf_s(buff, "Texture2D: %-3s   Input: %-3s   Output: %-3s   Encoder: %-3s",
-                    (fmtSupport & D3D11_FORMAT_SUPPORT_TEXTURE2D) ? c_szYes : c_szNo,
-                    (fmtSupport & D3D11_FORMAT_SUPPORT_VIDEO_PROCESSOR_INPUT) ? c_szYes : c_szNo,
-                    (fmtSupport & D3D11_FORMAT_SUPPORT_VIDEO_PROCESSOR_OUTPUT) ? c_szYes : c_szNo,
-                    (fmtSupport & D3D11_FORMAT_SUPPORT_VIDEO_ENCODER) ? c_szYes : c_szNo);
-
-                PrintStringValueLine(FormatName(fmt), buff, pPrintInfo);
-            }
+                { CELL_TEXT, FormatName(fmt), 0 },
+                { CELL_BOOL, nullptr, (fmtSupport & D3D11_FORMAT_SUPPORT_TEXTURE2D) ? 1u : 0u },
+                { CELL_BOOL, nullptr, (fmtSupport & D3D11_FORMAT_SUPPORT_VIDEO_PROCESSOR_INPUT) ? 1u : 0u },
+                { CELL_BOOL, nullptr, (fmtSupport & D3D11_FORMAT_SUPPORT_VIDEO_PROCESSOR_OUTPUT) ? 1u : 0u },
+                { CELL_BOOL, nullptr, (fmtSupport & D3D11_FORMAT_SUPPORT_VIDEO_ENCODER) ? 1u : 0u },
+            };
+            EmitRow(pPrintInfo, 5, cells);
         }
 
         return S_OK;
@@ -4383,11 +3656,8 @@ namespace
 
         auto fl = static_cast<D3D_FEATURE_LEVEL>(lParam2);
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-            LVAddColumn(g_hwndLV, 1, "Value", 60);
-        }
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 1, "Value", 60);
 
         auto d3d12opts = GetD3D12Options<D3D12_FEATURE_D3D12_OPTIONS, D3D12_FEATURE_DATA_D3D12_OPTIONS>(pDevice);
         auto d3d12opts2 = GetD3D12Options<D3D12_FEATURE_D3D12_OPTIONS2, D3D12_FEATURE_DATA_D3D12_OPTIONS2>(pDevice);
@@ -4534,134 +3804,67 @@ namespace
         auto d3d12opts21 = GetD3D12Options<D3D12_FEATURE_D3D12_OPTIONS21, D3D12_FEATURE_DATA_D3D12_OPTIONS21>(pDevice);
 #endif
 
-        if (!pPrintInfo)
-        {
-            LVLINE("Feature Level", FLName(fl));
-            LVLINE("Shader Model", shaderModel);
-            LVLINE("Root Signature", rootSig);
-
-            LVYESNO("Standard Swizzle 64KB", d3d12opts.StandardSwizzle64KBSupported);
-            LVYESNO("Extended formats TypedUAVLoad", d3d12opts.TypedUAVLoadAdditionalFormats);
-
-            LVLINE("Conservative Rasterization", consrv_rast);
-            LVLINE("Resource Binding", binding_rsc);
-            LVLINE("Tiled Resources", tiled_rsc);
-            LVLINE("Resource Heap", heap);
-            LVYESNO("Rasterizer Ordered Views", d3d12opts.ROVsSupported);
-
-            LVYESNO("VP/RT without GS Emulation", d3d12opts.VPAndRTArrayIndexFromAnyShaderFeedingRasterizerSupportedWithoutGSEmulation);
-
-            LVYESNO("Depth bound test supported", d3d12opts2.DepthBoundsTestSupported);
-            LVLINE("Programmable Sample Positions", prgSamplePos);
-
-            LVLINE("View Instancing", viewInstTier);
-
-            LVYESNO("Casting fully typed formats", d3d12opts3.CastingFullyTypedFormatSupported);
-            LVYESNO("Copy queue timestamp queries", d3d12opts3.CopyQueueTimestampQueriesSupported);
-
-            LVYESNO("Create heaps from existing system memory", d3d12eheaps.Supported);
-
-            LVYESNO("64KB aligned MSAA textures", d3d12opts4.MSAA64KBAlignedTextureSupported);
-
-            LVLINE("Heap serialization", heapSerial);
-
-            LVLINE("Render Passes", renderPasses);
-
-            LVLINE("DirectX Raytracing", dxr);
-
-            LVYESNO("Background processing supported", d3d12opts6.BackgroundProcessingSupported);
-
-#if defined(NTDDI_WIN10_FE) || defined(USING_D3D12_AGILITY_SDK)
-            LVYESNO("Unaligned BC texture (not a multiple of 4)", d3d12opts8.UnalignedBlockTexturesSupported);
-#endif
-
-#if defined(NTDDI_WIN10_NI) || defined(USING_D3D12_AGILITY_SDK)
-            LVYESNO("Enhanced Barriers", d3d12opts12.EnhancedBarriersSupported);
-            LVYESNO("Relaxed format casting", d3d12opts12.RelaxedFormatCastingSupported);
-            LVYESNO("Alpha blend factor support", d3d12opts13.AlphaBlendFactorSupported);
-            LVYESNO("Unrestricted buffer/texture copy pitch", d3d12opts13.UnrestrictedBufferTextureCopyPitchSupported);
-            LVYESNO("Unrestricted vertex alignment", d3d12opts13.UnrestrictedVertexElementAlignmentSupported);
-            LVYESNO("Copy between textures of any dimension", d3d12opts13.TextureCopyBetweenDimensionsSupported);
-            LVLINE("Inverted viewport flips support", vp_flips)
-#endif
-
-#if defined(NTDDI_WIN10_CU) || defined(USING_D3D12_AGILITY_SDK)
-            LVYESNO("Independent front/back stencil refmask", d3d12opts14.IndependentFrontAndBackStencilRefMaskSupported);
-            LVYESNO("Triangle fans primitives", d3d12opts15.TriangleFanSupported);
-            LVYESNO("Dynamic IB strip-cut support", d3d12opts15.DynamicIndexBufferStripCutSupported);
-            LVYESNO("Dynamic depth bias support", d3d12opts16.DynamicDepthBiasSupported);
-            LVYESNO("GPU upload heap support", d3d12opts16.GPUUploadHeapSupported);
-#endif
-
-#if defined(NTDDI_WIN11_GE) || defined(USING_D3D12_AGILITY_SDK)
-            LVYESNO("Non-normalized coordinate samplers", d3d12opts17.NonNormalizedCoordinateSamplersSupported);
-            LVYESNO("Manual write tracking res", d3d12opts17.ManualWriteTrackingResourceSupported);
-#endif
-        }
-        else
-        {
-            PRINTLINE("Feature Level", FLName(fl));
-            PRINTLINE("Shader Model", shaderModel);
-            PRINTLINE("Root Signature", rootSig);
+        EmitLineRow(pPrintInfo, "Feature Level", FLName(fl));
+        EmitLineRow(pPrintInfo, "Shader Model", shaderModel);
+        EmitLineRow(pPrintInfo, "Root Signature", rootSig);
 
-            PRINTYESNO("Standard Swizzle 64KB", d3d12opts.StandardSwizzle64KBSupported);
-            PRINTYESNO("Extended formats TypedUAVLoad", d3d12opts.TypedUAVLoadAdditionalFormats);
+        EmitYesNoRow(pPrintInfo, "Standard Swizzle 64KB", d3d12opts.StandardSwizzle64KBSupported);
+        EmitYesNoRow(pPrintInfo, "Extended formats TypedUAVLoad", d3d12opts.TypedUAVLoadAdditionalFormats);
 
-            PRINTLINE("Conservative Rasterization", consrv_rast);
-            PRINTLINE("Resource Binding", binding_rsc);
-            PRINTLINE("Tiled Resources", tiled_rsc);
-            PRINTLINE("Resource Heap", heap);
-            PRINTYESNO("Rasterizer Ordered Views", d3d12opts.ROVsSupported);
+        EmitLineRow(pPrintInfo, "Conservative Rasterization", consrv_rast);
+        EmitLineRow(pPrintInfo, "Resource Binding", binding_rsc);
+        EmitLineRow(pPrintInfo, "Tiled Resources", tiled_rsc);
+        EmitLineRow(pPrintInfo, "Resource Heap", heap);
+        EmitYesNoRow(pPrintInfo, "Rasterizer Ordered Views", d3d12opts.ROVsSupported);
 
-            PRINTYESNO("VP/RT without GS Emulation", d3d12opts.VPAndRTArrayIndexFromAnyShaderFeedingRasterizerSupportedWithoutGSEmulation);
+        EmitYesNoRow(pPrintInfo, "VP/RT without GS Emulation", d3d12opts.VPAndRTArrayIndexFromAnyShaderFeedingRasterizerSupportedWithoutGSEmulation);
 
-            PRINTYESNO("Depth bound test supported", d3d12opts2.DepthBoundsTestSupported);
-            PRINTLINE("Programmable Sample Positions", prgSamplePos);
+        EmitYesNoRow(pPrintInfo, "Depth bound test supported", d3d12opts2.DepthBoundsTestSupported);
+        EmitLineRow(pPrintInfo, "Programmable Sample Positions", prgSamplePos);
 
-            PRINTLINE("View Instancing", viewInstTier);
+        EmitLineRow(pPrintInfo, "View Instancing", viewInstTier);
 
-            PRINTYESNO("Casting fully typed formats", d3d12opts3.CastingFullyTypedFormatSupported);
-            PRINTYESNO("Copy queue timestamp queries", d3d12opts3.CopyQueueTimestampQueriesSupported);
+        EmitYesNoRow(pPrintInfo, "Casting fully typed formats", d3d12opts3.CastingFullyTypedFormatSupported);
+        EmitYesNoRow(pPrintInfo, "Copy queue timestamp queries", d3d12opts3.CopyQueueTimestampQueriesSupported);
 
-            PRINTYESNO("Create heaps from existing system memory", d3d12eheaps.Supported);
+        EmitYesNoRow(pPrintInfo, "Create heaps from existing system memory", d3d12eheaps.Supported);
 
-            PRINTYESNO("64KB aligned MSAA textures", d3d12opts4.MSAA64KBAlignedTextureSupported);
+        EmitYesNoRow(pPrintInfo, "64KB aligned MSAA textures", d3d12opts4.MSAA64KBAlignedTextureSupported);
 
-            PRINTLINE("Heap serialization", heapSerial);
+        EmitLineRow(pPrintInfo, "Heap serialization", heapSerial);
 
-            PRINTLINE("Render Passes", renderPasses);
+        EmitLineRow(pPrintInfo, "Render Passes", renderPasses);
 
-            PRINTLINE("DirectX Raytracing", dxr);
+        EmitLineRow(pPrintInfo, "DirectX Raytracing", dxr);
 
-            PRINTYESNO("Background processing supported", d3d12opts6.BackgroundProcessingSupported);
+        EmitYesNoRow(pPrintInfo, "Background processing supported", d3d12opts6.BackgroundProcessingSupported);
 
 #if defined(NTDDI_WIN10_FE) || defined(USING_D3D12_AGILITY_SDK)
-            PRINTYESNO("Unaligned BC texture (not a multiple of 4)", d3d12opts8.UnalignedBlockTexturesSupported);
+        EmitYesNoRow(pPrintInfo, "Unaligned BC texture (not a multiple of 4)", d3d12opts8.UnalignedBlockTexturesSupported);
 #endif
 
 #if defined(NTDDI_WIN10_NI) || defined(USING_D3D12_AGILITY_SDK)
-            PRINTYESNO("Enhanced Barriers", d3d12opts12.EnhancedBarriersSupported);
-            PRINTYESNO("Relaxed format casting", d3d12opts12.RelaxedFormatCastingSupported);
-            PRINTYESNO("Alpha blend factor support", d3d12opts13.AlphaBlendFactorSupported);
-            PRINTYESNO("Unrestricted buffer/texture copy pitch", d3d12opts13.UnrestrictedBufferTextureCopyPitchSupported);
-            PRINTYESNO("Unrestricted vertex alignment", d3d12opts13.UnrestrictedVertexElementAlignmentSupported);
-            PRINTYESNO("Copy between textures of any dimension", d3d12opts13.TextureCopyBetweenDimensionsSupported);
-            PRINTLINE("Inverted viewport flips support", vp_flips);
+        EmitYesNoRow(pPrintInfo, "Enhanced Barriers", d3d12opts12.EnhancedBarriersSupported);
+        EmitYesNoRow(pPrintInfo, "Relaxed format casting", d3d12opts12.RelaxedFormatCastingSupported);
+        EmitYesNoRow(pPrintInfo, "Alpha blend factor support", d3d12opts13.AlphaBlendFactorSupported);
+        EmitYesNoRow(pPrintInfo, "Unrestricted buffer/texture copy pitch", d3d12opts13.UnrestrictedBufferTextureCopyPitchSupported);
+        EmitYesNoRow(pPrintInfo, "Unrestricted vertex alignment", d3d12opts13.UnrestrictedVertexElementAlignmentSupported);
+        EmitYesNoRow(pPrintInfo, "Copy between textures of any dimension", d3d12opts13.TextureCopyBetweenDimensionsSupported);
+        EmitLineRow(pPrintInfo, "Inverted viewport flips support", vp_flips);
 #endif
 
 #if defined(NTDDI_WIN10_CU) || defined(USING_D3D12_AGILITY_SDK)
-            PRINTYESNO("Independent front/back stencil refmask", d3d12opts14.IndependentFrontAndBackStencilRefMaskSupported);
-            PRINTYESNO("Triangle fan primitives", d3d12opts15.TriangleFanSupported);
-            PRINTYESNO("Dynamic IB strip-cut support", d3d12opts15.DynamicIndexBufferStripCutSupported);
-            PRINTYESNO("Dynamic depth bias support", d3d12opts16.DynamicDepthBiasSupported);
-            PRINTYESNO("GPU upload heap support", d3d12opts16.GPUUploadHeapSupported);
+        EmitYesNoRow(pPrintInfo, "Independent front/back stencil refmask", d3d12opts14.IndependentFrontAndBackStencilRefMaskSupported);
+        EmitYesNoRow(pPrintInfo, "Triangle fans primitives", d3d12opts15.TriangleFanSupported);
+        EmitYesNoRow(pPrintInfo, "Dynamic IB strip-cut support", d3d12opts15.DynamicIndexBufferStripCutSupported);
+        EmitYesNoRow(pPrintInfo, "Dynamic depth bias support", d3d12opts16.DynamicDepthBiasSupported);
+        EmitYesNoRow(pPrintInfo, "GPU upload heap support", d3d12opts16.GPUUploadHeapSupported);
 #endif
 
 #if defined(NTDDI_WIN11_GE) || defined(USING_D3D12_AGILITY_SDK)
-            PRINTYESNO("Non-normalized coordinate samplers", d3d12opts17.NonNormalizedCoordinateSamplersSupported);
-            PRINTYESNO("Manual write tracking res", d3d12opts17.ManualWriteTrackingResourceSupported);
+        EmitYesNoRow(pPrintInfo, "Non-normalized coordinate samplers", d3d12opts17.NonNormalizedCoordinateSamplersSupported);
+        EmitYesNoRow(pPrintInfo, "Manual write tracking res", d3d12opts17.ManualWriteTrackingResourceSupported);
 #endif
-        }
 
         return S_OK;
     }
@@ -4672,11 +3875,8 @@ namespace
         if (!pDevice)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-            LVAddColumn(g_hwndLV, 1, "Value", 60);
-        }
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 1, "Value", 60);
 
         auto d3d12arch = GetD3D12Options<D3D12_FEATURE_ARCHITECTURE, D3D12_FEATURE_DATA_ARCHITECTURE>(pDevice);
 
@@ -4696,32 +3896,16 @@ namespace
         char vmProcess[16];
         sprintf_s(vmProcess, 16, "%u", d3d12vm.MaxGPUVirtualAddressBitsPerProcess);
 
-        if (!pPrintInfo)
+        EmitYesNoRow(pPrintInfo, "Tile-based Renderer", d3d12arch.TileBasedRenderer);
+        EmitYesNoRow(pPrintInfo, "Unified Memory Architecture (UMA)", d3d12arch.UMA);
+        EmitYesNoRow(pPrintInfo, "Cache Coherent UMA", d3d12arch.CacheCoherentUMA);
+        if (usearch1)
         {
-            LVYESNO("Tile-based Renderer", d3d12arch.TileBasedRenderer);
-            LVYESNO("Unified Memory Architecture (UMA)", d3d12arch.UMA);
-            LVYESNO("Cache Coherent UMA", d3d12arch.CacheCoherentUMA);
-            if (usearch1)
-            {
-                LVYESNO("Isolated MMU", d3d12arch1.IsolatedMMU);
-            }
-
-            LVLINE("Max GPU VM bits per resource", vmRes);
-            LVLINE("Max GPU VM bits per process", vmProcess);
+            EmitYesNoRow(pPrintInfo, "Isolated MMU", d3d12arch1.IsolatedMMU);
         }
-        else
-        {
-            PRINTYESNO("Tile-based Renderer", d3d12arch.TileBasedRenderer);
-            PRINTYESNO("Unified Memory Architecture (UMA)", d3d12arch.UMA);
-            PRINTYESNO("Cache Coherent UMA", d3d12arch.CacheCoherentUMA);
-            if (usearch1)
-            {
-                PRINTYESNO("Isolated MMU", d3d12arch1.IsolatedMMU);
-            }
 
-            PRINTLINE("Max GPU VM bits per resource", vmRes);
-            PRINTLINE("Max GPU VM bits per process", vmProcess);
-        }
+        EmitLineRow(pPrintInfo, "Max GPU VM bits per resource", vmRes);
+        EmitLineRow(pPrintInfo, "Max GPU VM bits per process", vmProcess);
 
         return S_OK;
     }
@@ -4732,11 +3916,8 @@ namespace
         if (!pDevice)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-            LVAddColumn(g_hwndLV, 1, "Value", 60);
-        }
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 1, "Value", 60);
 
         auto d3d12opts = GetD3D12Options<D3D12_FEATURE_D3D12_OPTIONS, D3D12_FEATURE_DATA_D3D12_OPTIONS>(pDevice);
         auto d3d12opts1 = GetD3D12Options<D3D12_FEATURE_D3D12_OPTIONS1, D3D12_FEATURE_DATA_D3D12_OPTIONS1>(pDevice);
@@ -4894,175 +4075,87 @@ namespace
         nonNormalizedCoords = d3d12opts17.NonNormalizedCoordinateSamplersSupported ? c_szYes : c_szNo;
 #endif
 
-        if (!pPrintInfo)
+        EmitYesNoRow(pPrintInfo, "Double-precision Shaders", d3d12opts.DoublePrecisionFloatShaderOps);
+
+        EmitLineRow(pPrintInfo, "Minimum Precision", precis);
+        EmitYesNoRow(pPrintInfo, "Native 16-bit Shader Ops", d3d12opts4.Native16BitShaderOpsSupported);
+
+        EmitYesNoRow(pPrintInfo, "Wave operations", d3d12opts1.WaveOps);
+        if (d3d12opts1.WaveOps)
+        {
+            EmitLineRow(pPrintInfo, "Wave lane count", wave_lane_count);
+            EmitLineRow(pPrintInfo, "Total lane count", lane_count);
+            EmitYesNoRow(pPrintInfo, "Expanded compute resource states", d3d12opts1.ExpandedComputeResourceStates);
+        }
+
+        if (wavemmatier)
+        {
+            EmitLineRow(pPrintInfo, "Wave MMA", wavemmatier);
+        }
+
+        EmitYesNoRow(pPrintInfo, "PS-Specified Stencil Ref", d3d12opts.PSSpecifiedStencilRefSupported);
+
+        EmitYesNoRow(pPrintInfo, "Barycentrics", d3d12opts3.BarycentricsSupported);
+
+        if (*atomicInt64)
         {
-            LVYESNO("Double-precision Shaders", d3d12opts.DoublePrecisionFloatShaderOps);
+            EmitLineRow(pPrintInfo, "atomic<int64>", atomicInt64);
+        }
 
-            LVLINE("Minimum Precision", precis);
-            LVYESNO("Native 16-bit Shader Ops", d3d12opts4.Native16BitShaderOpsSupported);
+        EmitLineRow(pPrintInfo, "Variable Rate Shading (VRS)", vrs);
+        if (d3d12opts6.VariableShadingRateTier != D3D12_VARIABLE_SHADING_RATE_TIER_NOT_SUPPORTED)
+        {
+            EmitYesNoRow(pPrintInfo, "VRS: Additional shading rates", d3d12opts6.AdditionalShadingRatesSupported);
+            EmitYesNoRow(pPrintInfo, "VRS: Per-primitive SV_ViewportIndex", d3d12opts6.PerPrimitiveShadingRateSupportedWithViewportIndexing);
+            EmitLineRow(pPrintInfo, "VRS: Screen-space tile size", vrs_tile_size);
 
-            LVYESNO("Wave operations", d3d12opts1.WaveOps);
-            if (d3d12opts1.WaveOps)
+            if (vrssum)
             {
-                LVLINE("Wave lane count", wave_lane_count);
-                LVLINE("Total lane count", lane_count);
-                LVYESNO("Expanded compute resource states", d3d12opts1.ExpandedComputeResourceStates);
+                EmitLineRow(pPrintInfo, "VRS: Sum combiner", vrssum);
             }
+        }
 
-            if (wavemmatier)
+        EmitLineRow(pPrintInfo, "Mesh & Amplification Shaders", meshShaders);
+        if (d3d12opts7.MeshShaderTier != D3D12_MESH_SHADER_TIER_NOT_SUPPORTED)
+        {
+            if (msderiv)
             {
-                LVLINE("Wave MMA", wavemmatier);
+                EmitLineRow(pPrintInfo, "MS/AS: Derivatives Support", msderiv);
             }
 
-            LVYESNO("PS-Specified Stencil Ref", d3d12opts.PSSpecifiedStencilRefSupported);
-
-            LVYESNO("Barycentrics", d3d12opts3.BarycentricsSupported);
-
-            if (*atomicInt64)
+            if (msperprim)
             {
-                LVLINE("atomic<int64>", atomicInt64);
+                EmitLineRow(pPrintInfo, "MS: Per-Primitive Shading", msperprim);
             }
 
-            LVLINE("Variable Rate Shading (VRS)", vrs);
-            if (d3d12opts6.VariableShadingRateTier != D3D12_VARIABLE_SHADING_RATE_TIER_NOT_SUPPORTED)
+            if (msrtarrayindex)
             {
-                LVYESNO("VRS: Additional shading rates", d3d12opts6.AdditionalShadingRatesSupported);
-                LVYESNO("VRS: Per-primitive SV_ViewportIndex", d3d12opts6.PerPrimitiveShadingRateSupportedWithViewportIndexing);
-                LVLINE("VRS: Screen-space tile size", vrs_tile_size);
-
-                if (vrssum)
-                {
-                    LVLINE("VRS: Sum combiner", vrssum);
-                }
-            }
-
-            LVLINE("Mesh & Amplification Shaders", meshShaders);
-            if (d3d12opts7.MeshShaderTier != D3D12_MESH_SHADER_TIER_NOT_SUPPORTED)
-            {
-                if (msderiv)
-                {
-                    LVLINE("MS/AS: Derivatives Support", msderiv);
-                }
-
-                if (msperprim)
-                {
-                    LVLINE("MS: Per-Primitive Shading", msperprim);
-                }
-
-                if (msrtarrayindex)
-                {
-                    LVLINE("MS: RT Array Index Support", msrtarrayindex);
-                }
-
-                if (ms_stats_culled)
-                {
-                    LVLINE("MS: Stats incl culled prims", ms_stats_culled);
-                }
+                EmitLineRow(pPrintInfo, "MS: RT Array Index Support", msrtarrayindex);
             }
 
-            LVLINE("Sampler Feedback", feedbackTier);
-
-            LVLINE("Shader Cache", shaderCache);
-
-            if (adv_texture_ops)
+            if (ms_stats_culled)
             {
-                LVLINE("Advanced texture ops", adv_texture_ops);
-            }
-
-            if (writeable_msaa_txt)
-            {
-                LVLINE("Writeable MSAA textures", writeable_msaa_txt);
-            }
-
-            if (nonNormalizedCoords)
-            {
-                LVLINE("Non-normalized sampler coordinates", nonNormalizedCoords);
+                EmitLineRow(pPrintInfo, "MS: Stats incl culled prims", ms_stats_culled);
             }
         }
-        else
-        {
-            PRINTYESNO("Double-precision Shaders", d3d12opts.DoublePrecisionFloatShaderOps);
-
-            PRINTLINE("Minimum Precision", precis);
-            PRINTYESNO("Native 16-bit Shader Ops", d3d12opts4.Native16BitShaderOpsSupported);
-
-            PRINTYESNO("Wave operations", d3d12opts1.WaveOps);
-            if (d3d12opts1.WaveOps)
-            {
-                PRINTLINE("Wave lane count", wave_lane_count);
-                PRINTLINE("Total lane count", lane_count);
-                PRINTYESNO("Expanded compute resource states", d3d12opts1.ExpandedComputeResourceStates);
-            }
-
-            if (wavemmatier)
-            {
-                PRINTLINE("Wave MMA", wavemmatier);
-            }
-
-            PRINTYESNO("PS-Specified Stencil Ref", d3d12opts.PSSpecifiedStencilRefSupported);
-
-            PRINTYESNO("Barycentrics", d3d12opts3.BarycentricsSupported);
-
-            if (*atomicInt64)
-            {
-                PRINTLINE("atomic<int64>", atomicInt64);
-            }
-
-            PRINTLINE("Variable Rate Shading (VRS)", vrs);
-            if (d3d12opts6.VariableShadingRateTier != D3D12_VARIABLE_SHADING_RATE_TIER_NOT_SUPPORTED)
-            {
-                PRINTYESNO("VRS: Additional shading rates", d3d12opts6.AdditionalShadingRatesSupported);
-                PRINTYESNO("VRS: Per-primitive SV_ViewportIndex", d3d12opts6.PerPrimitiveShadingRateSupportedWithViewportIndexing);
-                PRINTLINE("VRS: Screen-space tile size", vrs_tile_size);
-
-                if (vrssum)
-                {
-                    PRINTLINE("VRS: Sum combiner", vrssum);
-                }
-            }
-
-            PRINTLINE("Mesh & Amplification Shaders", meshShaders);
-            if (d3d12opts7.MeshShaderTier != D3D12_MESH_SHADER_TIER_NOT_SUPPORTED)
-            {
-                if (msderiv)
-                {
-                    PRINTLINE("MS/AS: Derivatives Support", msderiv);
-                }
-
-                if (msperprim)
-                {
-                    PRINTLINE("MS: Per-Primitive Shading", msperprim);
-                }
-
-                if (msrtarrayindex)
-                {
-                    PRINTLINE("MS: RT Array Index Support", msrtarrayindex);
-                }
 
-                if (ms_stats_culled)
-                {
-                    PRINTLINE("MS: Stats incl culled prims", ms_stats_culled);
-                }
-            }
+        EmitLineRow(pPrintInfo, "Sampler Feedback", feedbackTier);
 
-            PRINTLINE("Sampler Feedback", feedbackTier);
+        EmitLineRow(pPrintInfo, "Shader Cache", shaderCache);
 
-            PRINTLINE("Shader Cache", shaderCache);
-
-            if (adv_texture_ops)
-            {
-                PRINTLINE("Advanced texture ops", adv_texture_ops);
-            }
+        if (adv_texture_ops)
+        {
+            EmitLineRow(pPrintInfo, "Advanced texture ops", adv_texture_ops);
+        }
 
-            if (writeable_msaa_txt)
-            {
-                PRINTLINE("Writeable MSAA textures", writeable_msaa_txt);
-            }
+        if (writeable_msaa_txt)
+        {
+            EmitLineRow(pPrintInfo, "Writeable MSAA textures", writeable_msaa_txt);
+        }
 
-            if (nonNormalizedCoords)
-            {
-                PRINTLINE("Non-normalized sampler coordinates", nonNormalizedCoords);
-            }
+        if (nonNormalizedCoords)
+        {
+            EmitLineRow(pPrintInfo, "Non-normalized sampler coordinates", nonNormalizedCoords);
         }
 
         return S_OK;
@@ -5074,11 +4167,8 @@ namespace
         if (!pDevice)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-            LVAddColumn(g_hwndLV, 1, "Value", 60);
-        }
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 1, "Value", 60);
 
         auto d3d12opts = GetD3D12Options<D3D12_FEATURE_D3D12_OPTIONS, D3D12_FEATURE_DATA_D3D12_OPTIONS>(pDevice);
         auto d3d12opts4 = GetD3D12Options<D3D12_FEATURE_D3D12_OPTIONS4, D3D12_FEATURE_DATA_D3D12_OPTIONS4>(pDevice);
@@ -5105,30 +4195,19 @@ namespace
         default: sharedResTier = c_szYes; break;
         }
 
-        if (!pPrintInfo)
-        {
-            LVLINE("Cross-node Sharing", sharing);
-            LVYESNO("Cross-adapter Row-Major Texture", d3d12opts.CrossAdapterRowMajorTextureSupported);
+        EmitLineRow(pPrintInfo, "Cross-node Sharing", sharing);
+        EmitYesNoRow(pPrintInfo, "Cross-adapter Row-Major Texture", d3d12opts.CrossAdapterRowMajorTextureSupported);
 
-            LVLINE("Shared Resource Tier", sharedResTier);
-            LVYESNO("Atomic Shader Instructions", d3d12xnode.AtomicShaderInstructions);
-        }
-        else
-        {
-            PRINTLINE("Cross-node Sharing", sharing);
-            PRINTYESNO("Cross-adapter Row-Major Texture", d3d12opts.CrossAdapterRowMajorTextureSupported);
-
-            PRINTLINE("Shared Resource Tier", sharedResTier);
-            PRINTYESNO("Atomic Shader Instructions", d3d12xnode.AtomicShaderInstructions);
-        }
+        EmitLineRow(pPrintInfo, "Shared Resource Tier", sharedResTier);
+        EmitYesNoRow(pPrintInfo, "Atomic Shader Instructions", d3d12xnode.AtomicShaderInstructions);
 
         return S_OK;
     }
 
     //-----------------------------------------------------------------------------
-    void D3D10_FillTree(HTREEITEM hTree, ID3D10Device* pDevice, D3D_DRIVER_TYPE devType)
+    void D3D10_FillTree(HCAPNODE hTree, ID3D10Device* pDevice, D3D_DRIVER_TYPE devType)
     {
-        HTREEITEM hTreeD3D = TVAddNodeEx(hTree, "Direct3D 10.0", TRUE, IDI_CAPS, D3D10Info,
+        HCAPNODE hTreeD3D = TVAddNodeEx(hTree, "Direct3D 10.0", TRUE, IDI_CAPS, D3D10Info,
             (LPARAM)pDevice, 0, 0);
 
         TVAddNodeEx(hTreeD3D, "Features", FALSE, IDI_CAPS, D3D_FeatureLevel,
@@ -5147,8 +4226,6 @@ namespace
             (LPARAM)pDevice, (LPARAM)D3D10_FORMAT_SUPPORT_BLENDABLE, 0);
 
         // MSAA
-        FillMSAASampleTable(pDevice, g_sampCount10, FALSE);
-
         TVAddNodeEx(hTreeD3D, "2x MSAA", FALSE, IDI_CAPS, D3D10Info,
             (LPARAM)pDevice, (LPARAM)D3D10_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET, 2);
 
@@ -5158,17 +4235,17 @@ namespace
         TVAddNodeEx(hTreeD3D, "8x MSAA", FALSE, IDI_CAPS, D3D10Info,
             (LPARAM)pDevice, (LPARAM)D3D10_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET, 8);
 
-        TVAddNode(hTreeD3D, "Other MSAA", FALSE, IDI_CAPS, D3D10InfoMSAA, (LPARAM)pDevice, (LPARAM)g_sampCount10);
+        TVAddNode(hTreeD3D, "Other MSAA", FALSE, IDI_CAPS, D3D10InfoMSAA, (LPARAM)pDevice, 0);
 
         TVAddNodeEx(hTreeD3D, "MSAA Load", FALSE, IDI_CAPS, D3D10Info,
             (LPARAM)pDevice, (LPARAM)D3D10_FORMAT_SUPPORT_MULTISAMPLE_LOAD, 0);
     }
 
-    void D3D10_FillTree1(HTREEITEM hTree, ID3D10Device1* pDevice, DWORD flMask, D3D_DRIVER_TYPE devType)
+    void D3D10_FillTree1(HCAPNODE hTree, ID3D10Device1* pDevice, DWORD flMask, D3D_DRIVER_TYPE devType)
     {
         D3D10_FEATURE_LEVEL1 fl = pDevice->GetFeatureLevel();
 
-        HTREEITEM hTreeD3D = TVAddNodeEx(hTree, "Direct3D 10.1", TRUE,
+        HCAPNODE hTreeD3D = TVAddNodeEx(hTree, "Direct3D 10.1", TRUE,
             IDI_CAPS, D3D10Info1, (LPARAM)pDevice, 0, 0);
 
         TVAddNodeEx(hTreeD3D, FLName(fl), FALSE, IDI_CAPS, D3D_FeatureLevel, (LPARAM)fl, (LPARAM)pDevice, D3D_FL_LPARAM3_D3D10_1(devType));
@@ -5176,7 +4253,7 @@ namespace
         if ((g_DXGIFactory1 != nullptr && fl != D3D10_FEATURE_LEVEL_9_1)
             || (g_DXGIFactory1 == nullptr && fl != D3D10_FEATURE_LEVEL_10_0))
         {
-            HTREEITEM hTreeF = TVAddNode(hTreeD3D, "Additional Feature Levels", TRUE, IDI_CAPS, nullptr, 0, 0);
+            HCAPNODE hTreeF = TVAddNode(hTreeD3D, "Additional Feature Levels", TRUE, IDI_CAPS, nullptr, 0, 0);
 
             switch (fl)
             {
@@ -5231,8 +4308,6 @@ namespace
         // MSAA (for all but 10 devices, which are handled in their "native" node)
         if (fl != D3D10_FEATURE_LEVEL_10_0)
         {
-            FillMSAASampleTable(pDevice, g_sampCount10_1, (fl != D3D10_FEATURE_LEVEL_10_1));
-
             if (fl == D3D10_FEATURE_LEVEL_10_1)
             {
                 TVAddNodeEx(hTreeD3D, "2x MSAA", FALSE, IDI_CAPS, D3D10Info1,
@@ -5244,7 +4319,7 @@ namespace
                 TVAddNodeEx(hTreeD3D, "8x MSAA", FALSE, IDI_CAPS, D3D10Info1,
                     (LPARAM)pDevice, (LPARAM)D3D10_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET, 8);
 
-                TVAddNode(hTreeD3D, "Other MSAA", FALSE, IDI_CAPS, D3D10InfoMSAA, (LPARAM)pDevice, (LPARAM)g_sampCount10_1);
+                TVAddNode(hTreeD3D, "Other MSAA", FALSE, IDI_CAPS, D3D10InfoMSAA, (LPARAM)pDevice, 0);
             }
             else // 10level9
             {
@@ -5267,14 +4342,11 @@ namespace
         if (!pDevice)
             return S_OK;
 
-        if (!pPrintInfo)
-        {
-            LVAddColumn(g_hwndLV, 0, "Name", c_DefNameLength);
-            LVAddColumn(g_hwndLV, 1, "Texture2D", 15);
-            LVAddColumn(g_hwndLV, 2, "Input", 15);
-            LVAddColumn(g_hwndLV, 3, "Output", 15);
-            LVAddColumn(g_hwndLV, 4, "Encoder", 15);
-        }
+        EmitColumn(pPrintInfo, 0, "Name", c_DefNameLength);
+        EmitColumn(pPrintInfo, 1, "Texture2D", 15);
+        EmitColumn(pPrintInfo, 2, "Input", 15);
+        EmitColumn(pPrintInfo, 3, "Output", 15);
+        EmitColumn(pPrintInfo, 4, "Encoder", 15);
 
         static const DXGI_FORMAT cfsVideo[] =
         {
@@ -5297,58 +4369,40 @@ namespace
 
         for (UINT i = 0; i < std::size(cfsVideo); ++i)
         {
-            D3D12_FEATURE_DATA_FORMAT_SUPPORT fmtSupport = {
-                cfsVideo[i], D3D12_FORMAT_SUPPORT1_NONE, D3D12_FORMAT_SUPPORT2_NONE,
-            };
-            if (FAILED(pDevice->CheckFeatureSupport(D3D12_FEATURE_FORMAT_SUPPORT,
-                &fmtSupport, sizeof(D3D12_FEATURE_DATA_FORMAT_SUPPORT))))
-            {
-                fmtSupport.Support1 = D3D12_FORMAT_SUPPORT1_NONE;
-                fmtSupport.Support2 = D3D12_FORMAT_SUPPORT2_NONE;
-            }
+            DXGI_FORMAT fmt = cfsVideo[i];
 
-            bool any = (fmtSupport.Support1 & (D3D12_FORMAT_SUPPORT1_TEXTURE2D
+            UINT fmtSupport = FormatSupport1(pDevice, fmt);
+
+            bool any = (fmtSupport & (D3D12_FORMAT_SUPPORT1_TEXTURE2D
                 | D3D12_FORMAT_SUPPORT1_VIDEO_PROCESSOR_INPUT
                 | D3D12_FORMAT_SUPPORT1_VIDEO_PROCESSOR_OUTPUT
                 | D3D12_FORMAT_SUPPORT1_VIDEO_ENCODER)) ? true : false;
 
-            if (!pPrintInfo)
-            {
-                if (g_dwViewState != IDM_VIEWALL && !any)
-                    continue;
-
-                LVAddText(g_hwndLV, 0, FormatName(fmtSupport.Format));
+            if (g_dwViewState != IDM_VIEWALL && !any)
+                continue;
 
-                LVAddText(g_hwndLV, 1, (fmtSupport.Support1 & D3D12_FORMAT_SUPPORT1_TEXTURE2D) ? c_szYes : c_szNo);
-                LVAddText(g_hwndLV, 2, (fmtSupport.Support1 & D3D12_FORMAT_SUPPORT1_VIDEO_PROCESSOR_INPUT) ? c_szYes : c_szNo);
-                LVAddText(g_hwndLV, 3, (fmtSupport.Support1 & D3D12_FORMAT_SUPPORT1_VIDEO_PROCESSOR_OUTPUT) ? c_szYes : c_szNo);
-                LVAddText(g_hwndLV, 4, (fmtSupport.Support1 & D3D12_FORMAT_SUPPORT1_VIDEO_ENCODER) ? c_szYes : c_szNo);
-            }
-            else
+            const ROWCELL cells[5] =
             {
-                TCHAR buff[1024];
-
-                sprintf_s(buff, "Texture2D: %-3s   Input: %-3s   Output: %-3s   Encoder: %-3s",
-                    (fmtSupport.Support1 & D3D12_FORMAT_SUPPORT1_TEXTURE2D) ? c_szYes : c_szNo,
-                    (fmtSupport.Support1 & D3D12_FORMAT_SUPPORT1_VIDEO_PROCESSOR_INPUT) ? c_szYes : c_szNo,
-                    (fmtSupport.Support1 & D3D12_FORMAT_SUPPORT1_VIDEO_PROCESSOR_OUTPUT) ? c_szYes : c_szNo,
-                    (fmtSupport.Support1 & D3D12_FORMAT_SUPPORT1_VIDEO_ENCODER) ? c_szYes : c_szNo);
-
-                PrintStringValueLine(FormatName(fmtSupport.Format), buff, pPrintInfo);
-            }
+                { CELL_TEXT, FormatName(fmt), 0 },
+                { CELL_BOOL, nullptr, (fmtSupport & D3D12_FORMAT_SUPPORT1_TEXTURE2D) ? 1u : 0u },
+                { CELL_BOOL, nullptr, (fmtSupport & D3D12_FORMAT_SUPPORT1_VIDEO_PROCESSOR_INPUT) ? 1u : 0u },
+                { CELL_BOOL, nullptr, (fmtSupport & D3D12_FORMAT_SUPPORT1_VIDEO_PROCESSOR_OUTPUT) ? 1u : 0u },
+                { CELL_BOOL, nullptr, (fmtSupport & D3D12_FORMAT_SUPPORT1_VIDEO_ENCODER) ? 1u : 0u },
+            };
+            EmitRow(pPrintInfo, 5, cells);
         }
 
         return S_OK;
     }
 
     //-----------------------------------------------------------------------------
-    void D3D11_FillTree(HTREEITEM hTree, ID3D11Device* pDevice, DWORD flMask, D3D_DRIVER_TYPE devType)
+    void D3D11_FillTree(HCAPNODE hTree, ID3D11Device* pDevice, DWORD flMask, D3D_DRIVER_TYPE devType)
     {
         D3D_FEATURE_LEVEL fl = pDevice->GetFeatureLevel();
         if (fl > D3D_FEATURE_LEVEL_11_0)
             fl = D3D_FEATURE_LEVEL_11_0;
 
-        HTREEITEM hTreeD3D = TVAddNodeEx(hTree, "Direct3D 11.0", TRUE,
+        HCAPNODE hTreeD3D = TVAddNodeEx(hTree, "Direct3D 11.0", TRUE,
             IDI_CAPS, D3D11Info, (LPARAM)pDevice, 0, 0);
 
         TVAddNodeEx(hTreeD3D, FLName(fl), FALSE, IDI_CAPS, D3D_FeatureLevel,
@@ -5356,7 +4410,7 @@ namespace
 
         if (fl != D3D_FEATURE_LEVEL_9_1)
         {
-            HTREEITEM hTreeF = TVAddNode(hTreeD3D, "Additional Feature Levels", TRUE, IDI_CAPS, nullptr, 0, 0);
+            HCAPNODE hTreeF = TVAddNode(hTreeD3D, "Additional Feature Levels", TRUE, IDI_CAPS, nullptr, 0, 0);
 
             switch (fl)
             {
@@ -5417,7 +4471,6 @@ namespace
                 (LPARAM)pDevice, (LPARAM)D3D11_FORMAT_SUPPORT_RENDER_TARGET, 0);
 
             // MSAA (MSAA data for 10level9 is shown under the 10.1 node)
-            FillMSAASampleTable(pDevice, g_sampCount11);
 
             TVAddNodeEx(hTreeD3D, "2x MSAA", FALSE, IDI_CAPS, D3D11Info,
                 (LPARAM)pDevice, (LPARAM)D3D11_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET, 2);
@@ -5429,17 +4482,17 @@ namespace
                 (LPARAM)pDevice, (LPARAM)D3D11_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET, 8);
 
             TVAddNodeEx(hTreeD3D, "Other MSAA", FALSE, IDI_CAPS, D3D11InfoMSAA,
-                (LPARAM)pDevice, (LPARAM)g_sampCount11, 0);
+                (LPARAM)pDevice, 0, 0);
         }
     }
 
-    void D3D11_FillTree1(HTREEITEM hTree, ID3D11Device1* pDevice, DWORD flMask, D3D_DRIVER_TYPE devType)
+    void D3D11_FillTree1(HCAPNODE hTree, ID3D11Device1* pDevice, DWORD flMask, D3D_DRIVER_TYPE devType)
     {
         D3D_FEATURE_LEVEL fl = pDevice->GetFeatureLevel();
         if (fl > D3D_FEATURE_LEVEL_11_1)
             fl = D3D_FEATURE_LEVEL_11_1;
 
-        HTREEITEM hTreeD3D = TVAddNodeEx(hTree, "Direct3D 11.1", TRUE,
+        HCAPNODE hTreeD3D = TVAddNodeEx(hTree, "Direct3D 11.1", TRUE,
             IDI_CAPS, D3D11Info1, (LPARAM)pDevice, 0, 0);
 
         TVAddNodeEx(hTreeD3D, FLName(fl), FALSE, IDI_CAPS, D3D_FeatureLevel,
@@ -5447,7 +4500,7 @@ namespace
 
         if (fl != D3D_FEATURE_LEVEL_9_1)
         {
-            HTREEITEM hTreeF = TVAddNode(hTreeD3D, "Additional Feature Levels", TRUE, IDI_CAPS, nullptr, 0, 0);
+            HCAPNODE hTreeF = TVAddNode(hTreeD3D, "Additional Feature Levels", TRUE, IDI_CAPS, nullptr, 0, 0);
 
             switch (fl)
             {
@@ -5541,7 +4594,6 @@ namespace
             }
 
             // MSAA (MSAA data for 10level9 is shown under the 10.1 node)
-            FillMSAASampleTable(pDevice, g_sampCount11_1);
 
             TVAddNodeEx(hTreeD3D, "2x MSAA", FALSE, IDI_CAPS, D3D11Info1,
                 (LPARAM)pDevice, (LPARAM)D3D11_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET, 2);
@@ -5553,7 +4605,7 @@ namespace
                 (LPARAM)pDevice, (LPARAM)D3D11_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET, 8);
 
             TVAddNodeEx(hTreeD3D, "Other MSAA", FALSE, IDI_CAPS, D3D11InfoMSAA,
-                (LPARAM)pDevice, (LPARAM)g_sampCount11_1, 1);
+                (LPARAM)pDevice, 0, 1);
 
             TVAddNodeEx(hTreeD3D, "MSAA Load", FALSE, IDI_CAPS, D3D11Info1,
                 (LPARAM)pDevice, (LPARAM)D3D11_FORMAT_SUPPORT_MULTISAMPLE_LOAD, 0);
@@ -5565,13 +4617,13 @@ namespace
         }
     }
 
-    void D3D11_FillTree2(HTREEITEM hTree, ID3D11Device2* pDevice, DWORD flMask, D3D_DRIVER_TYPE devType)
+    void D3D11_FillTree2(HCAPNODE hTree, ID3D11Device2* pDevice, DWORD flMask, D3D_DRIVER_TYPE devType)
     {
         D3D_FEATURE_LEVEL fl = pDevice->GetFeatureLevel();
         if (fl > D3D_FEATURE_LEVEL_11_1)
             fl = D3D_FEATURE_LEVEL_11_1;
 
-        HTREEITEM hTreeD3D = TVAddNodeEx(hTree, "Direct3D 11.2", TRUE,
+        HCAPNODE hTreeD3D = TVAddNodeEx(hTree, "Direct3D 11.2", TRUE,
             IDI_CAPS, D3D11Info2, (LPARAM)pDevice, 0, 0);
 
         TVAddNodeEx(hTreeD3D, FLName(fl), FALSE, IDI_CAPS, D3D_FeatureLevel,
@@ -5579,7 +4631,7 @@ namespace
 
         if (fl != D3D_FEATURE_LEVEL_9_1)
         {
-            HTREEITEM hTreeF = TVAddNode(hTreeD3D, "Additional Feature Levels", TRUE, IDI_CAPS, nullptr, 0, 0);
+            HCAPNODE hTreeF = TVAddNode(hTreeD3D, "Additional Feature Levels", TRUE, IDI_CAPS, nullptr, 0, 0);
 
             switch (fl)
             {
@@ -5639,11 +4691,11 @@ namespace
             (LPARAM)pDevice, (LPARAM)-1, (LPARAM)D3D11_FORMAT_SUPPORT2_SHAREABLE);
     }
 
-    void D3D11_FillTree3(HTREEITEM hTree, ID3D11Device3* pDevice, ID3D11Device4* pDevice4, DWORD flMask, D3D_DRIVER_TYPE devType)
+    void D3D11_FillTree3(HCAPNODE hTree, ID3D11Device3* pDevice, ID3D11Device4* pDevice4, DWORD flMask, D3D_DRIVER_TYPE devType)
     {
         D3D_FEATURE_LEVEL fl = pDevice->GetFeatureLevel();
 
-        HTREEITEM hTreeD3D = TVAddNodeEx(hTree, (pDevice4) ? "Direct3D 11.3/11.4" : "Direct3D 11.3", TRUE,
+        HCAPNODE hTreeD3D = TVAddNodeEx(hTree, (pDevice4) ? "Direct3D 11.3/11.4" : "Direct3D 11.3", TRUE,
             IDI_CAPS, D3D11Info3, (LPARAM)pDevice, 0, (LPARAM)pDevice4);
 
         TVAddNodeEx(hTreeD3D, FLName(fl), FALSE, IDI_CAPS, D3D_FeatureLevel,
@@ -5651,7 +4703,7 @@ namespace
 
         if (fl != D3D_FEATURE_LEVEL_9_1)
         {
-            HTREEITEM hTreeF = TVAddNode(hTreeD3D, "Additional Feature Levels", TRUE, IDI_CAPS, nullptr, 0, 0);
+            HCAPNODE hTreeF = TVAddNode(hTreeD3D, "Additional Feature Levels", TRUE, IDI_CAPS, nullptr, 0, 0);
 
             switch (fl)
             {
@@ -5736,17 +4788,17 @@ namespace
     }
 
     //-----------------------------------------------------------------------------
-    void D3D12_FillTree(HTREEITEM hTree, ID3D12Device* pDevice, D3D_DRIVER_TYPE devType)
+    void D3D12_FillTree(HCAPNODE hTree, ID3D12Device* pDevice, D3D_DRIVER_TYPE devType)
     {
         D3D_FEATURE_LEVEL fl = GetD3D12FeatureLevel(pDevice);
 
-        HTREEITEM hTreeD3D = TVAddNodeEx(hTree, "Direct3D 12", TRUE, IDI_CAPS, D3D12Info, (LPARAM)pDevice, (LPARAM)fl, 0);
+        HCAPNODE hTreeD3D = TVAddNodeEx(hTree, "Direct3D 12", TRUE, IDI_CAPS, D3D12Info, (LPARAM)pDevice, (LPARAM)fl, 0);
 
         TVAddNodeEx(hTreeD3D, FLName(fl), FALSE, IDI_CAPS, D3D_FeatureLevel, (LPARAM)fl, (LPARAM)pDevice, D3D_FL_LPARAM3_D3D12(devType));
 
         if (fl != D3D_FEATURE_LEVEL_11_0)
         {
-            HTREEITEM hTreeF = TVAddNode(hTreeD3D, "Additional Feature Levels", TRUE, IDI_CAPS, nullptr, 0, 0);
+            HCAPNODE hTreeF = TVAddNode(hTreeD3D, "Additional Feature Levels", TRUE, IDI_CAPS, nullptr, 0, 0);
 
             switch (fl)
             {
@@ -5787,6 +4839,15 @@ namespace
 //-----------------------------------------------------------------------------
 VOID DXGI_Init()
 {
+    // Mock devices stand in for DXGI 1.1 and Direct3D 11, see dxmock.cpp
+    if (MockIsActive() && !MockIsRecording())
+    {
+        if (SUCCEEDED(MockCreateDXGIFactory1(IID_PPV_ARGS(&g_DXGIFactory1))))
+            g_DXGIFactory = g_DXGIFactory1;
+        g_D3D11CreateDevice = MockD3D11CreateDevice;
+        return;
+    }
+
     // DXGI
     g_dxgi = LoadLibraryEx("dxgi.dll", 0, LOAD_LIBRARY_SEARCH_SYSTEM32);
     if (g_dxgi)
@@ -5897,133 +4958,105 @@ VOID DXGI_Init()
     {
         g_D3D12CreateDevice = reinterpret_cast<PFN_D3D12_CREATE_DEVICE>(GetProcAddress(g_d3d12, "D3D12CreateDevice"));
     }
+
+    // While recording, the adapters are enumerated through a mock factory
+    // that records their queries and those of their Direct3D 11 devices.
+    // Direct3D 10.x is handed the real adapters, everything else is as is.
+    if (MockIsRecording() && g_DXGIFactory1
+        && SUCCEEDED(MockCreateDXGIFactory1(IID_PPV_ARGS(&g_DXGIFactoryRecord))))
+    {
+        g_DXGIFactory1 = g_DXGIFactoryRecord;
+
+        if (g_D3D10CreateDevice1)
+            g_D3D10CreateDevice1 = MockD3D10CreateDevice1;
+        if (g_D3D10CreateDevice)
+            g_D3D10CreateDevice = MockD3D10CreateDevice;
+        if (g_D3D11CreateDevice)
+            g_D3D11CreateDevice = MockD3D11CreateDevice;
+    }
 }
 
 
 //-----------------------------------------------------------------------------
-// Name: DXGI_FillTree()
-//-----------------------------------------------------------------------------
-VOID DXGI_FillTree(HWND hwndTV)
+namespace
 {
-    if (!g_DXGIFactory)
-        return;
-
-    HTREEITEM hTree = TVAddNode(TVI_ROOT, "DXGI Devices", TRUE, IDI_DIRECTX, nullptr, 0, 0);
-
-    // Hardware driver types
-    IDXGIAdapter* pAdapter = nullptr;
-    IDXGIAdapter1* pAdapter1 = nullptr;
-    IDXGIAdapter2* pAdapter2 = nullptr;
-    IDXGIAdapter3* pAdapter3 = nullptr;
-    HRESULT hr;
-    for (UINT iAdapter = 0; ; ++iAdapter)
+    //-----------------------------------------------------------------------------
+    HRESULT ProbeD3D11(void* pContext, const D3D_FEATURE_LEVEL* pLevels, UINT nLevels, D3D_FEATURE_LEVEL* pfl)
     {
-        if (g_DXGIFactory1)
-        {
-            hr = g_DXGIFactory1->EnumAdapters1(iAdapter, &pAdapter1);
-            pAdapter = pAdapter1;
-
-            if (SUCCEEDED(hr))
-            {
-                HRESULT hr2 = pAdapter1->QueryInterface(IID_PPV_ARGS(&pAdapter2));
-                if (FAILED(hr2))
-                    pAdapter2 = nullptr;
-
-                hr2 = pAdapter1->QueryInterface(IID_PPV_ARGS(&pAdapter3));
-                if (FAILED(hr2))
-                    pAdapter3 = nullptr;
-            }
-        }
-        else
-        {
-            hr = g_DXGIFactory->EnumAdapters(iAdapter, &pAdapter);
-        }
-
-        if (FAILED(hr))
-            break;
+        // With no device pointer the runtime only checks support, so nothing
+        // is created and there is nothing to release
+        TRACESCOPE trace("D3D11CreateDevice", (nLevels > 0) ? FLName(pLevels[0]) : nullptr);
+        return StatsCall(API_D3D11CREATEDEVICE, g_D3D11CreateDevice, static_cast<IDXGIAdapter*>(pContext), D3D_DRIVER_TYPE_UNKNOWN, nullptr, 0,
+            pLevels, nLevels, D3D11_SDK_VERSION, nullptr, pfl, nullptr);
+    }
 
-        if (pAdapter2)
-        {
-            DXGI_ADAPTER_DESC2 aDesc2;
-            pAdapter2->GetDesc2(&aDesc2);
 
-            if (aDesc2.Flags & DXGI_ADAPTER_FLAG_SOFTWARE)
-            {
-                // Skip "always there" Microsoft Basics Display Driver
-                pAdapter2->Release();
-                pAdapter1->Release();
-                continue;
-            }
-        }
+    // Per-adapter device creation is the slow part of startup, so each
+    // hardware adapter is probed on the system thread pool. Tree nodes are
+    // only created afterwards, on the calling thread and in adapter order.
+    struct ADAPTERPROBE
+    {
+        ADAPTERPROBE* pNext;
 
+        UINT iAdapter;
+        IDXGIAdapter* pAdapter;
+        IDXGIAdapter1* pAdapter1;
+        IDXGIAdapter2* pAdapter2;
+        IDXGIAdapter3* pAdapter3;
         DXGI_ADAPTER_DESC aDesc;
-        hr = pAdapter->GetDesc(&aDesc);
-        if (FAILED(hr))
-            continue;
 
-        char szDesc[128];
-        wcstombs_s(nullptr, szDesc, aDesc.Description, 128);
+        ID3D12Device* pDevice12;
 
-        HTREEITEM hTreeA;
+        ID3D11Device* pDevice11;
+        ID3D11Device1* pDevice11_1;
+        ID3D11Device2* pDevice11_2;
+        ID3D11Device3* pDevice11_3;
+        ID3D11Device4* pDevice11_4;
+        DWORD flMaskDX11;
 
-        // No need for DXGIAdapterInfo3 as there's no extra desc information to display
+        ID3D10Device* pDevice10;
+        ID3D10Device1* pDevice10_1;
+        DWORD flMaskDX10;
+    };
 
+    //-----------------------------------------------------------------------------
+    // Name: ReleaseAdapter()
+    // Desc: Drops an enumerated adapter that won't be probed. Its
+    //       IDXGIAdapter1, if any, is the same reference as pAdapter.
+    //-----------------------------------------------------------------------------
+    VOID ReleaseAdapter(IDXGIAdapter* pAdapter, IDXGIAdapter2* pAdapter2, IDXGIAdapter3* pAdapter3)
+    {
+        if (pAdapter3)
+            pAdapter3->Release();
         if (pAdapter2)
-        {
-            hTreeA = TVAddNode(hTree, szDesc, TRUE, IDI_CAPS, DXGIAdapterInfo2, iAdapter, (LPARAM)(pAdapter2));
-        }
-        else if (pAdapter1)
-        {
-            hTreeA = TVAddNode(hTree, szDesc, TRUE, IDI_CAPS, DXGIAdapterInfo1, iAdapter, (LPARAM)(pAdapter1));
-        }
-        else
-        {
-            hTreeA = TVAddNode(hTree, szDesc, TRUE, IDI_CAPS, DXGIAdapterInfo, iAdapter, (LPARAM)(pAdapter));
-        }
-
-        // Outputs
-        HTREEITEM hTreeO = nullptr;
-
-        IDXGIOutput* pOutput = nullptr;
-        for (UINT iOutput = 0; ; ++iOutput)
-        {
-            hr = pAdapter->EnumOutputs(iOutput, &pOutput);
-
-            if (FAILED(hr))
-                break;
-
-            if (iOutput == 0)
-            {
-                hTreeO = TVAddNode(hTreeA, "Outputs", TRUE, IDI_CAPS, DXGIFeatures, 0, 0);
-            }
-
-            DXGI_OUTPUT_DESC oDesc;
-            pOutput->GetDesc(&oDesc);
-
-            char szDeviceName[32];
-            wcstombs_s(nullptr, szDeviceName, oDesc.DeviceName, 32);
-
-            HTREEITEM hTreeD = TVAddNode(hTreeO, szDeviceName, TRUE, IDI_CAPS, DXGIOutputInfo, iOutput, (LPARAM)pOutput);
+            pAdapter2->Release();
+        pAdapter->Release();
+    }
 
-            TVAddNode(hTreeD, "Display Modes", FALSE, IDI_CAPS, DXGIOutputModes, iOutput, (LPARAM)pOutput);
-        }
+    //-----------------------------------------------------------------------------
+    // Name: ProbeAdapter()
+    // Desc: Creates the Direct3D 12, 11.x, and 10.x devices for one adapter.
+    //       Must not touch the capability tree, as it runs on a worker thread.
+    //-----------------------------------------------------------------------------
+    VOID ProbeAdapter(ADAPTERPROBE* pProbe)
+    {
+        TRACESCOPE trace("ProbeAdapter");
+        HRESULT hr;
 
         // Direct3D 12
 #ifdef EXTRA_DEBUG
         OutputDebugStringA("Direct3D 12\n");
 #endif
-        ID3D12Device* pDevice12 = nullptr;
-
-        if (pAdapter3 != 0 && g_D3D12CreateDevice != 0)
+        if (pProbe->pAdapter3 != 0 && g_D3D12CreateDevice != 0)
         {
-            hr = g_D3D12CreateDevice(pAdapter3, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&pDevice12));
+            TRACESCOPE trace12("D3D12CreateDevice");
+            hr = StatsCall(API_D3D12CREATEDEVICE, g_D3D12CreateDevice, pProbe->pAdapter3, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&pProbe->pDevice12));
             if (SUCCEEDED(hr))
             {
 #ifdef EXTRA_DEBUG
-                D3D_FEATURE_LEVEL fl = GetD3D12FeatureLevel(pDevice12);
+                D3D_FEATURE_LEVEL fl = GetD3D12FeatureLevel(pProbe->pDevice12);
                 OutputDebugString(FLName(fl));
 #endif
-                D3D12_FillTree(hTreeA, pDevice12, D3D_DRIVER_TYPE_HARDWARE);
             }
             else
             {
@@ -6032,7 +5065,7 @@ VOID DXGI_FillTree(HWND hwndTV)
                 sprintf_s(buff, ": Failed (%08X)\n", hr);
                 OutputDebugStringA(buff);
 #endif
-                pDevice12 = nullptr;
+                pProbe->pDevice12 = nullptr;
             }
         }
 
@@ -6040,122 +5073,57 @@ VOID DXGI_FillTree(HWND hwndTV)
 #ifdef EXTRA_DEBUG
         OutputDebugStringA("Direct3D 11.x\n");
 #endif
-
-        ID3D11Device* pDevice11 = nullptr;
-        ID3D11Device1* pDevice11_1 = nullptr;
-        ID3D11Device2* pDevice11_2 = nullptr;
-        ID3D11Device3* pDevice11_3 = nullptr;
-        ID3D11Device4* pDevice11_4 = nullptr;
-        DWORD flMaskDX11 = 0;
-        if (pAdapter1 != nullptr && g_D3D11CreateDevice != nullptr)
+        if (pProbe->pAdapter1 != nullptr && g_D3D11CreateDevice != nullptr)
         {
             D3D_FEATURE_LEVEL flHigh = (D3D_FEATURE_LEVEL)0;
+            UINT nProbes = 0;
 
-            for (UINT i = 1 /* Skip 12.2 for DX11 */; i < std::size(g_featureLevels); ++i)
-            {
-#ifdef EXTRA_DEBUG
-                OutputDebugString(FLName(g_featureLevels[i]));
-#endif
-                hr = g_D3D11CreateDevice(pAdapter1, D3D_DRIVER_TYPE_UNKNOWN, nullptr, 0,
-                    &g_featureLevels[i], 1,
-                    D3D11_SDK_VERSION, &pDevice11, nullptr, nullptr);
-                if (SUCCEEDED(hr))
-                {
-#ifdef EXTRA_DEBUG
-                    OutputDebugString(": Success\n");
-#endif
-                    switch (g_featureLevels[i])
-                    {
-                    case D3D_FEATURE_LEVEL_9_1:  flMaskDX11 |= FLMASK_9_1; break;
-                    case D3D_FEATURE_LEVEL_9_2:  flMaskDX11 |= FLMASK_9_2; break;
-                    case D3D_FEATURE_LEVEL_9_3:  flMaskDX11 |= FLMASK_9_3; break;
-                    case D3D_FEATURE_LEVEL_10_0: flMaskDX11 |= FLMASK_10_0; break;
-                    case D3D_FEATURE_LEVEL_10_1: flMaskDX11 |= FLMASK_10_1; break;
-                    case D3D_FEATURE_LEVEL_11_0: flMaskDX11 |= FLMASK_11_0; break;
-                    case D3D_FEATURE_LEVEL_11_1: flMaskDX11 |= FLMASK_11_1; break;
-                    case D3D_FEATURE_LEVEL_12_0: flMaskDX11 |= FLMASK_12_0; break;
-                    case D3D_FEATURE_LEVEL_12_1: flMaskDX11 |= FLMASK_12_1; break;
-                    default: break;
-                    }
+            // Skip 12.2 for DX11
+            hr = DetectFeatureLevels(&g_featureLevels[1], static_cast<UINT>(std::size(g_featureLevels) - 1),
+                ProbeD3D11, pProbe->pAdapter1, &flHigh, &pProbe->flMaskDX11, &nProbes);
 
-                    if (g_featureLevels[i] > flHigh)
-                        flHigh = g_featureLevels[i];
-                }
-                else
-                {
 #ifdef EXTRA_DEBUG
-                    char buff[64] = {};
-                    sprintf_s(buff, ": Failed (%08X)\n", hr);
-                    OutputDebugStringA(buff);
-#endif
-                    pDevice11 = nullptr;
-                }
-
-                if (pDevice11)
-                {
-                    // Some Intel Integrated Graphics WDDM 1.0 drivers will crash if you try to release here
-                    // For this application, leaking a few device instances is not a big deal
-                    if (aDesc.VendorId != 0x8086)
-                        pDevice11->Release();
-
-                    pDevice11 = nullptr;
-                }
+            {
+                char buff[64] = {};
+                sprintf_s(buff, "%s: %u probes (%08X)\n", SUCCEEDED(hr) ? FLName(flHigh) : "None", nProbes, hr);
+                OutputDebugStringA(buff);
             }
+#endif
 
-            if (flHigh > 0)
+            if (SUCCEEDED(hr))
             {
-                hr = g_D3D11CreateDevice(pAdapter1, D3D_DRIVER_TYPE_UNKNOWN, nullptr, 0, &flHigh, 1,
+                TRACESCOPE trace11("D3D11CreateDevice", FLName(flHigh));
+                ID3D11Device* pDevice11 = nullptr;
+                hr = StatsCall(API_D3D11CREATEDEVICE, g_D3D11CreateDevice, pProbe->pAdapter1, D3D_DRIVER_TYPE_UNKNOWN, nullptr, 0, &flHigh, 1,
                     D3D11_SDK_VERSION, &pDevice11, nullptr, nullptr);
 
                 if (SUCCEEDED(hr))
                 {
-                    hr = pDevice11->QueryInterface(IID_PPV_ARGS(&pDevice11_1));
+                    pProbe->pDevice11 = pDevice11;
+
+                    hr = pDevice11->QueryInterface(IID_PPV_ARGS(&pProbe->pDevice11_1));
                     if (FAILED(hr))
-                        pDevice11_1 = nullptr;
+                        pProbe->pDevice11_1 = nullptr;
 
-                    hr = pDevice11->QueryInterface(IID_PPV_ARGS(&pDevice11_2));
+                    hr = pDevice11->QueryInterface(IID_PPV_ARGS(&pProbe->pDevice11_2));
                     if (FAILED(hr))
-                        pDevice11_2 = nullptr;
+                        pProbe->pDevice11_2 = nullptr;
 
-                    hr = pDevice11->QueryInterface(IID_PPV_ARGS(&pDevice11_3));
+                    hr = pDevice11->QueryInterface(IID_PPV_ARGS(&pProbe->pDevice11_3));
                     if (FAILED(hr))
-                        pDevice11_3 = nullptr;
+                        pProbe->pDevice11_3 = nullptr;
 
-                    hr = pDevice11->QueryInterface(IID_PPV_ARGS(&pDevice11_4));
+                    hr = pDevice11->QueryInterface(IID_PPV_ARGS(&pProbe->pDevice11_4));
                     if (FAILED(hr))
-                        pDevice11_4 = nullptr;
+                        pProbe->pDevice11_4 = nullptr;
                 }
-                else if (FAILED(hr))
-                    pDevice11 = nullptr;
             }
         }
 
-        if (pDevice11 || pDevice11_1 || pDevice11_2 || pDevice11_3)
-        {
-            HTREEITEM hTree11 = (pDevice11_1 || pDevice11_2 || pDevice11_3)
-                ? TVAddNode(hTreeA, "Direct3D 11", TRUE, IDI_CAPS, nullptr, 0, 0)
-                : hTreeA;
-
-            if (pDevice11)
-                D3D11_FillTree(hTree11, pDevice11, flMaskDX11, D3D_DRIVER_TYPE_HARDWARE);
-
-            if (pDevice11_1)
-                D3D11_FillTree1(hTree11, pDevice11_1, flMaskDX11, D3D_DRIVER_TYPE_HARDWARE);
-
-            if (pDevice11_2)
-                D3D11_FillTree2(hTree11, pDevice11_2, flMaskDX11, D3D_DRIVER_TYPE_HARDWARE);
-
-            if (pDevice11_3)
-                D3D11_FillTree3(hTree11, pDevice11_3, pDevice11_4, flMaskDX11, D3D_DRIVER_TYPE_HARDWARE);
-        }
-
         // Direct3D 10.x
 #ifdef EXTRA_DEBUG
         OutputDebugStringA("Direct3D 10.x\n");
 #endif
-        ID3D10Device* pDevice10 = nullptr;
-        ID3D10Device1* pDevice10_1 = nullptr;
-        DWORD flMaskDX10 = 0;
         if (g_D3D10CreateDevice1)
         {
             // Since 10 & 10.1 are so close, try to create just one device object for both...
@@ -6165,6 +5133,8 @@ VOID DXGI_FillTree(HWND hwndTV)
                 D3D10_FEATURE_LEVEL_9_3, D3D10_FEATURE_LEVEL_9_2, D3D10_FEATURE_LEVEL_9_1
             };
 
+            ID3D10Device1* pDevice10_1 = nullptr;
+
             // Test every feature-level since some devices might be missing some
             D3D10_FEATURE_LEVEL1 flHigh = (D3D10_FEATURE_LEVEL1)0;
             for (UINT i = 0; i < std::size(lvl); ++i)
@@ -6182,7 +5152,8 @@ VOID DXGI_FillTree(HWND hwndTV)
                 OutputDebugString(FLName(lvl[i]));
 #endif
 
-                hr = g_D3D10CreateDevice1(pAdapter, D3D10_DRIVER_TYPE_HARDWARE, nullptr, 0, lvl[i], D3D10_1_SDK_VERSION, &pDevice10_1);
+                TRACESCOPE trace10("D3D10CreateDevice1", FLName(lvl[i]));
+                hr = StatsCall(API_D3D10CREATEDEVICE1, g_D3D10CreateDevice1, pProbe->pAdapter, D3D10_DRIVER_TYPE_HARDWARE, nullptr, 0, lvl[i], D3D10_1_SDK_VERSION, &pDevice10_1);
                 if (SUCCEEDED(hr))
                 {
 #ifdef EXTRA_DEBUG
@@ -6191,11 +5162,11 @@ VOID DXGI_FillTree(HWND hwndTV)
 
                     switch (lvl[i])
                     {
-                    case D3D10_FEATURE_LEVEL_9_1:  flMaskDX10 |= FLMASK_9_1; break;
-                    case D3D10_FEATURE_LEVEL_9_2:  flMaskDX10 |= FLMASK_9_2; break;
-                    case D3D10_FEATURE_LEVEL_9_3:  flMaskDX10 |= FLMASK_9_3; break;
-                    case D3D10_FEATURE_LEVEL_10_0: flMaskDX10 |= FLMASK_10_0; break;
-                    case D3D10_FEATURE_LEVEL_10_1: flMaskDX10 |= FLMASK_10_1; break;
+                    case D3D10_FEATURE_LEVEL_9_1:  pProbe->flMaskDX10 |= FLMASK_9_1; break;
+                    case D3D10_FEATURE_LEVEL_9_2:  pProbe->flMaskDX10 |= FLMASK_9_2; break;
+                    case D3D10_FEATURE_LEVEL_9_3:  pProbe->flMaskDX10 |= FLMASK_9_3; break;
+                    case D3D10_FEATURE_LEVEL_10_0: pProbe->flMaskDX10 |= FLMASK_10_0; break;
+                    case D3D10_FEATURE_LEVEL_10_1: pProbe->flMaskDX10 |= FLMASK_10_1; break;
                     }
 
                     if (lvl[i] > flHigh)
@@ -6220,44 +5191,305 @@ VOID DXGI_FillTree(HWND hwndTV)
 
             if (flHigh > 0)
             {
-                hr = g_D3D10CreateDevice1(pAdapter, D3D10_DRIVER_TYPE_HARDWARE, nullptr, 0, flHigh, D3D10_1_SDK_VERSION, &pDevice10_1);
+                TRACESCOPE trace10("D3D10CreateDevice1", FLName(flHigh));
+                hr = StatsCall(API_D3D10CREATEDEVICE1, g_D3D10CreateDevice1, pProbe->pAdapter, D3D10_DRIVER_TYPE_HARDWARE, nullptr, 0, flHigh, D3D10_1_SDK_VERSION, &pDevice10_1);
                 if (SUCCEEDED(hr))
                 {
+                    pProbe->pDevice10_1 = pDevice10_1;
+
                     if (flHigh >= D3D10_FEATURE_LEVEL_10_0)
                     {
-                        hr = pDevice10_1->QueryInterface(IID_PPV_ARGS(&pDevice10));
+                        hr = pDevice10_1->QueryInterface(IID_PPV_ARGS(&pProbe->pDevice10));
                         if (FAILED(hr))
-                            pDevice10 = nullptr;
+                            pProbe->pDevice10 = nullptr;
                     }
                 }
-                else
-                {
-                    pDevice10_1 = nullptr;
-                }
             }
         }
         else if (g_D3D10CreateDevice)
         {
-            hr = g_D3D10CreateDevice(pAdapter, D3D10_DRIVER_TYPE_HARDWARE, nullptr, 0, D3D10_SDK_VERSION, &pDevice10);
+            TRACESCOPE trace10("D3D10CreateDevice");
+            hr = StatsCall(API_D3D10CREATEDEVICE, g_D3D10CreateDevice, pProbe->pAdapter, D3D10_DRIVER_TYPE_HARDWARE, nullptr, 0, D3D10_SDK_VERSION, &pProbe->pDevice10);
+            if (FAILED(hr))
+                pProbe->pDevice10 = nullptr;
+        }
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID CALLBACK ProbeAdapterWork(PTP_CALLBACK_INSTANCE, PVOID pContext, PTP_WORK)
+    {
+        ProbeAdapter(reinterpret_cast<ADAPTERPROBE*>(pContext));
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: AddAdapterToTV()
+    // Desc: Adds the adapter node, its outputs, and the devices found by
+    //       ProbeAdapter()
+    //-----------------------------------------------------------------------------
+    VOID AddAdapterToTV(HCAPNODE hTree, const ADAPTERPROBE* pProbe)
+    {
+        char szDesc[128];
+        wcstombs_s(nullptr, szDesc, pProbe->aDesc.Description, 128);
+
+        HCAPNODE hTreeA;
+
+        // No need for DXGIAdapterInfo3 as there's no extra desc information to display
+
+        if (pProbe->pAdapter2)
+        {
+            hTreeA = TVAddNode(hTree, szDesc, TRUE, IDI_CAPS, DXGIAdapterInfo2, pProbe->iAdapter, (LPARAM)(pProbe->pAdapter2));
+        }
+        else if (pProbe->pAdapter1)
+        {
+            hTreeA = TVAddNode(hTree, szDesc, TRUE, IDI_CAPS, DXGIAdapterInfo1, pProbe->iAdapter, (LPARAM)(pProbe->pAdapter1));
+        }
+        else
+        {
+            hTreeA = TVAddNode(hTree, szDesc, TRUE, IDI_CAPS, DXGIAdapterInfo, pProbe->iAdapter, (LPARAM)(pProbe->pAdapter));
+        }
+
+        // Outputs
+        HCAPNODE hTreeO = nullptr;
+
+        IDXGIOutput* pOutput = nullptr;
+        for (UINT iOutput = 0; ; ++iOutput)
+        {
+            HRESULT hr = pProbe->pAdapter->EnumOutputs(iOutput, &pOutput);
+
             if (FAILED(hr))
-                pDevice10 = nullptr;
+                break;
+
+            if (iOutput == 0)
+            {
+                hTreeO = TVAddNode(hTreeA, "Outputs", TRUE, IDI_CAPS, DXGIFeatures, 0, 0);
+            }
+
+            DXGI_OUTPUT_DESC oDesc;
+            pOutput->GetDesc(&oDesc);
+
+            char szDeviceName[32];
+            wcstombs_s(nullptr, szDeviceName, oDesc.DeviceName, 32);
+
+            HCAPNODE hTreeD = TVAddNode(hTreeO, szDeviceName, TRUE, IDI_CAPS, DXGIOutputInfo, iOutput, (LPARAM)pOutput);
+
+            TVAddNode(hTreeD, "Display Modes", FALSE, IDI_CAPS, DXGIOutputModes, iOutput, (LPARAM)pOutput);
+        }
+
+        // Direct3D 12
+        if (pProbe->pDevice12)
+            D3D12_FillTree(hTreeA, pProbe->pDevice12, D3D_DRIVER_TYPE_HARDWARE);
+
+        // Direct3D 11.x
+        if (pProbe->pDevice11 || pProbe->pDevice11_1 || pProbe->pDevice11_2 || pProbe->pDevice11_3)
+        {
+            HCAPNODE hTree11 = (pProbe->pDevice11_1 || pProbe->pDevice11_2 || pProbe->pDevice11_3)
+                ? TVAddNode(hTreeA, "Direct3D 11", TRUE, IDI_CAPS, nullptr, 0, 0)
+                : hTreeA;
+
+            if (pProbe->pDevice11)
+                D3D11_FillTree(hTree11, pProbe->pDevice11, pProbe->flMaskDX11, D3D_DRIVER_TYPE_HARDWARE);
+
+            if (pProbe->pDevice11_1)
+                D3D11_FillTree1(hTree11, pProbe->pDevice11_1, pProbe->flMaskDX11, D3D_DRIVER_TYPE_HARDWARE);
+
+            if (pProbe->pDevice11_2)
+                D3D11_FillTree2(hTree11, pProbe->pDevice11_2, pProbe->flMaskDX11, D3D_DRIVER_TYPE_HARDWARE);
+
+            if (pProbe->pDevice11_3)
+                D3D11_FillTree3(hTree11, pProbe->pDevice11_3, pProbe->pDevice11_4, pProbe->flMaskDX11, D3D_DRIVER_TYPE_HARDWARE);
         }
 
         // Direct3D 10
-        if (pDevice10 || pDevice10_1)
+        if (pProbe->pDevice10 || pProbe->pDevice10_1)
         {
-            HTREEITEM hTree10 = (pDevice10_1)
+            HCAPNODE hTree10 = (pProbe->pDevice10_1)
                 ? TVAddNode(hTreeA, "Direct3D 10", TRUE, IDI_CAPS, nullptr, 0, 0)
                 : hTreeA;
 
-            if (pDevice10)
-                D3D10_FillTree(hTree10, pDevice10, D3D_DRIVER_TYPE_HARDWARE);
+            if (pProbe->pDevice10)
+                D3D10_FillTree(hTree10, pProbe->pDevice10, D3D_DRIVER_TYPE_HARDWARE);
 
             // Direct3D 10.1 (includes 10level9 feature levels)
-            if (pDevice10_1)
-                D3D10_FillTree1(hTree10, pDevice10_1, flMaskDX10, D3D_DRIVER_TYPE_HARDWARE);
+            if (pProbe->pDevice10_1)
+                D3D10_FillTree1(hTree10, pProbe->pDevice10_1, pProbe->flMaskDX10, D3D_DRIVER_TYPE_HARDWARE);
         }
     }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: DXGI_GetCacheKey()
+// Desc: Adds the DXGI adapters, their driver versions and outputs to the
+//       snapshot cache key, without creating any devices
+//-----------------------------------------------------------------------------
+VOID DXGI_GetCacheKey()
+{
+    DWORD dwFactories = ((g_DXGIFactory) ? 0x1u : 0u) | ((g_DXGIFactory1) ? 0x2u : 0u)
+        | ((g_DXGIFactory2) ? 0x4u : 0u) | ((g_DXGIFactory3) ? 0x8u : 0u)
+        | ((g_DXGIFactory4) ? 0x10u : 0u) | ((g_DXGIFactory5) ? 0x20u : 0u);
+    CacheKeyAdd(&dwFactories, sizeof(dwFactories));
+
+    if (!g_DXGIFactory)
+        return;
+
+    for (UINT iAdapter = 0; ; ++iAdapter)
+    {
+        IDXGIAdapter* pAdapter = nullptr;
+        if (FAILED(g_DXGIFactory->EnumAdapters(iAdapter, &pAdapter)))
+            break;
+
+        // The LUID is assigned at boot, so it is left out of the key
+        DXGI_ADAPTER_DESC desc = {};
+        if (SUCCEEDED(pAdapter->GetDesc(&desc)))
+            desc.AdapterLuid = {};
+        CacheKeyAdd(&desc, sizeof(desc));
+
+        LARGE_INTEGER umdVersion = {};
+        if (FAILED(pAdapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umdVersion)))
+            umdVersion.QuadPart = 0;
+        CacheKeyAdd(&umdVersion, sizeof(umdVersion));
+
+        for (UINT iOutput = 0; ; ++iOutput)
+        {
+            IDXGIOutput* pOutput = nullptr;
+            if (FAILED(pAdapter->EnumOutputs(iOutput, &pOutput)))
+                break;
+
+            DXGI_OUTPUT_DESC outputDesc = {};
+            if (SUCCEEDED(pOutput->GetDesc(&outputDesc)))
+                outputDesc.Monitor = nullptr;
+            CacheKeyAdd(&outputDesc, sizeof(outputDesc));
+
+            pOutput->Release();
+        }
+
+        pAdapter->Release();
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: DXGI_FillTree()
+//-----------------------------------------------------------------------------
+VOID DXGI_FillTree()
+{
+    if (!g_DXGIFactory)
+        return;
+
+    TRACESCOPE trace("DXGI_FillTree");
+
+    HCAPNODE hTree = TVAddNode(nullptr, "DXGI Devices", TRUE, IDI_DIRECTX, nullptr, 0, 0);
+
+    // Hardware driver types
+    ADAPTERPROBE* pFirstProbe = nullptr;
+    ADAPTERPROBE** ppLastProbe = &pFirstProbe;
+    HRESULT hr;
+    for (UINT iAdapter = 0; ; ++iAdapter)
+    {
+        IDXGIAdapter* pAdapter = nullptr;
+        IDXGIAdapter1* pAdapter1 = nullptr;
+        IDXGIAdapter2* pAdapter2 = nullptr;
+        IDXGIAdapter3* pAdapter3 = nullptr;
+
+        if (g_DXGIFactory1)
+        {
+            hr = g_DXGIFactory1->EnumAdapters1(iAdapter, &pAdapter1);
+            pAdapter = pAdapter1;
+
+            if (SUCCEEDED(hr))
+            {
+                HRESULT hr2 = pAdapter1->QueryInterface(IID_PPV_ARGS(&pAdapter2));
+                if (FAILED(hr2))
+                    pAdapter2 = nullptr;
+
+                hr2 = pAdapter1->QueryInterface(IID_PPV_ARGS(&pAdapter3));
+                if (FAILED(hr2))
+                    pAdapter3 = nullptr;
+            }
+        }
+        else
+        {
+            hr = g_DXGIFactory->EnumAdapters(iAdapter, &pAdapter);
+        }
+
+        if (FAILED(hr))
+            break;
+
+        if (pAdapter2)
+        {
+            DXGI_ADAPTER_DESC2 aDesc2;
+            pAdapter2->GetDesc2(&aDesc2);
+
+            if (aDesc2.Flags & DXGI_ADAPTER_FLAG_SOFTWARE)
+            {
+                // Skip "always there" Microsoft Basics Display Driver
+                ReleaseAdapter(pAdapter, pAdapter2, pAdapter3);
+                continue;
+            }
+        }
+
+        auto pProbe = new (std::nothrow) ADAPTERPROBE{};
+        if (!pProbe)
+        {
+            ReleaseAdapter(pAdapter, pAdapter2, pAdapter3);
+            break;
+        }
+
+        hr = pAdapter->GetDesc(&pProbe->aDesc);
+        if (FAILED(hr))
+        {
+            ReleaseAdapter(pAdapter, pAdapter2, pAdapter3);
+            delete pProbe;
+            continue;
+        }
+
+        pProbe->iAdapter = iAdapter;
+        pProbe->pAdapter = pAdapter;
+        pProbe->pAdapter1 = pAdapter1;
+        pProbe->pAdapter2 = pAdapter2;
+        pProbe->pAdapter3 = pAdapter3;
+
+        *ppLastProbe = pProbe;
+        ppLastProbe = &pProbe->pNext;
+    }
+
+    // Probe all adapters concurrently, falling back to the calling thread
+    // if work can't be queued
+    PTP_WORK work[64] = {};
+    UINT cWork = 0;
+    for (ADAPTERPROBE* pProbe = pFirstProbe; pProbe; pProbe = pProbe->pNext)
+    {
+        PTP_WORK pWork = (cWork < std::size(work))
+            ? CreateThreadpoolWork(ProbeAdapterWork, pProbe, nullptr)
+            : nullptr;
+        if (pWork)
+        {
+            SubmitThreadpoolWork(pWork);
+            work[cWork++] = pWork;
+        }
+        else
+        {
+            ProbeAdapter(pProbe);
+        }
+    }
+
+    for (UINT i = 0; i < cWork; ++i)
+    {
+        WaitForThreadpoolWorkCallbacks(work[i], FALSE);
+        CloseThreadpoolWork(work[i]);
+    }
+
+    // Join results in adapter order
+    while (pFirstProbe)
+    {
+        ADAPTERPROBE* pProbe = pFirstProbe;
+        pFirstProbe = pProbe->pNext;
+
+        AddAdapterToTV(hTree, pProbe);
+        delete pProbe;
+    }
 
     // WARP
     DWORD flMaskWARP = FLMASK_9_1 | FLMASK_9_2 | FLMASK_9_3 | FLMASK_10_0 | FLMASK_10_1;
@@ -6267,8 +5499,9 @@ VOID DXGI_FillTree(HWND hwndTV)
 #ifdef EXTRA_DEBUG
         OutputDebugString("WARP10\n");
 #endif
+        TRACESCOPE traceWARP("D3D10CreateDevice1", "WARP");
 
-        hr = g_D3D10CreateDevice1(nullptr, D3D10_DRIVER_TYPE_WARP, nullptr, 0, D3D10_FEATURE_LEVEL_10_1,
+        hr = StatsCall(API_D3D10CREATEDEVICE1, g_D3D10CreateDevice1, nullptr, D3D10_DRIVER_TYPE_WARP, nullptr, 0, D3D10_FEATURE_LEVEL_10_1,
             D3D10_1_SDK_VERSION, &pDeviceWARP10);
         if (FAILED(hr))
             pDeviceWARP10 = nullptr;
@@ -6284,21 +5517,22 @@ VOID DXGI_FillTree(HWND hwndTV)
 #ifdef EXTRA_DEBUG
         OutputDebugString("WARP11\n");
 #endif
+        TRACESCOPE traceWARP("D3D11CreateDevice", "WARP");
         D3D_FEATURE_LEVEL fl;
         // Skip 12.2
-        hr = g_D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0,
+        hr = StatsCall(API_D3D11CREATEDEVICE, g_D3D11CreateDevice, nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0,
             &g_featureLevels[1], static_cast<UINT>(std::size(g_featureLevels) - 1),
             D3D11_SDK_VERSION, &pDeviceWARP11, &fl, nullptr);
         if (FAILED(hr))
         {
             // Try without 12.x
-            hr = g_D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0,
+            hr = StatsCall(API_D3D11CREATEDEVICE, g_D3D11CreateDevice, nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0,
                 &g_featureLevels[3], static_cast<UINT>(std::size(g_featureLevels) - 3),
                 D3D11_SDK_VERSION, &pDeviceWARP11, &fl, nullptr);
 
             if (FAILED(hr))
             {
-                hr = g_D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0, nullptr, 0,
+                hr = StatsCall(API_D3D11CREATEDEVICE, g_D3D11CreateDevice, nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0, nullptr, 0,
                     D3D11_SDK_VERSION, &pDeviceWARP11, &fl, nullptr);
             }
         }
@@ -6346,11 +5580,12 @@ VOID DXGI_FillTree(HWND hwndTV)
 #ifdef EXTRA_DEBUG
         OutputDebugString("WARP12\n");
 #endif
+        TRACESCOPE traceWARP("D3D12CreateDevice", "WARP");
         IDXGIAdapter* warpAdapter = nullptr;
         hr = g_DXGIFactory4->EnumWarpAdapter(IID_PPV_ARGS(&warpAdapter));
         if (SUCCEEDED(hr))
         {
-            hr = g_D3D12CreateDevice(warpAdapter, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&pDeviceWARP12));
+            hr = StatsCall(API_D3D12CREATEDEVICE, g_D3D12CreateDevice, warpAdapter, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&pDeviceWARP12));
             if (SUCCEEDED(hr))
             {
 #ifdef EXTRA_DEBUG
@@ -6380,7 +5615,7 @@ VOID DXGI_FillTree(HWND hwndTV)
 
     if (pDeviceWARP10 || pDeviceWARP11 || pDeviceWARP11_1 || pDeviceWARP11_2 || pDeviceWARP11_3 || pDeviceWARP11_4 || pDeviceWARP12)
     {
-        HTREEITEM hTreeW = TVAddNode(hTree, "Windows Advanced Rasterization Platform (WARP)", TRUE, IDI_CAPS, nullptr, 0, 0);
+        HCAPNODE hTreeW = TVAddNode(hTree, "Windows Advanced Rasterization Platform (WARP)", TRUE, IDI_CAPS, nullptr, 0, 0);
 
         // DirectX 12 (WARP)
         if (pDeviceWARP12)
@@ -6389,7 +5624,7 @@ VOID DXGI_FillTree(HWND hwndTV)
         // DirectX 11.x (WARP)
         if (pDeviceWARP11 || pDeviceWARP11_1 || pDeviceWARP11_2 || pDeviceWARP11_3)
         {
-            HTREEITEM hTree11 = (pDeviceWARP11_1 || pDeviceWARP11_2 || pDeviceWARP11_3)
+            HCAPNODE hTree11 = (pDeviceWARP11_1 || pDeviceWARP11_2 || pDeviceWARP11_3)
                 ? TVAddNode(hTreeW, "Direct3D 11", TRUE, IDI_CAPS, nullptr, 0, 0)
                 : hTreeW;
 
@@ -6410,7 +5645,7 @@ VOID DXGI_FillTree(HWND hwndTV)
         if (pDeviceWARP10)
         {
             // WARP supported both 10 and 10.1 when first released
-            HTREEITEM hTree10 = TVAddNode(hTreeW, "Direct3D 10", TRUE, IDI_CAPS, nullptr, 0, 0);
+            HCAPNODE hTree10 = TVAddNode(hTreeW, "Direct3D 10", TRUE, IDI_CAPS, nullptr, 0, 0);
 
             D3D10_FillTree(hTree10, pDeviceWARP10, D3D_DRIVER_TYPE_WARP);
             D3D10_FillTree1(hTree10, pDeviceWARP10, flMaskWARP, D3D_DRIVER_TYPE_WARP);
@@ -6422,7 +5657,8 @@ VOID DXGI_FillTree(HWND hwndTV)
     ID3D10Device* pDeviceREF10 = nullptr;
     if (g_D3D10CreateDevice1)
     {
-        hr = g_D3D10CreateDevice1(nullptr, D3D10_DRIVER_TYPE_REFERENCE, nullptr, 0, D3D10_FEATURE_LEVEL_10_1,
+        TRACESCOPE traceREF("D3D10CreateDevice1", "REF");
+        hr = StatsCall(API_D3D10CREATEDEVICE1, g_D3D10CreateDevice1, nullptr, D3D10_DRIVER_TYPE_REFERENCE, nullptr, 0, D3D10_FEATURE_LEVEL_10_1,
             D3D10_1_SDK_VERSION, &pDeviceREF10_1);
         if (SUCCEEDED(hr))
         {
@@ -6435,7 +5671,8 @@ VOID DXGI_FillTree(HWND hwndTV)
     }
     else if (g_D3D10CreateDevice != nullptr)
     {
-        hr = g_D3D10CreateDevice(nullptr, D3D10_DRIVER_TYPE_REFERENCE, nullptr, 0, D3D10_SDK_VERSION, &pDeviceREF10);
+        TRACESCOPE traceREF("D3D10CreateDevice", "REF");
+        hr = StatsCall(API_D3D10CREATEDEVICE, g_D3D10CreateDevice, nullptr, D3D10_DRIVER_TYPE_REFERENCE, nullptr, 0, D3D10_SDK_VERSION, &pDeviceREF10);
         if (FAILED(hr))
             pDeviceREF10 = nullptr;
     }
@@ -6448,8 +5685,9 @@ VOID DXGI_FillTree(HWND hwndTV)
     DWORD flMaskREF = FLMASK_9_1 | FLMASK_9_2 | FLMASK_9_3 | FLMASK_10_0 | FLMASK_10_1 | FLMASK_11_0;
     if (g_D3D11CreateDevice)
     {
+        TRACESCOPE traceREF("D3D11CreateDevice", "REF");
         D3D_FEATURE_LEVEL lvl = D3D_FEATURE_LEVEL_11_1;
-        hr = g_D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_REFERENCE, nullptr, 0, &lvl, 1,
+        hr = StatsCall(API_D3D11CREATEDEVICE, g_D3D11CreateDevice, nullptr, D3D_DRIVER_TYPE_REFERENCE, nullptr, 0, &lvl, 1,
             D3D11_SDK_VERSION, &pDeviceREF11, nullptr, nullptr);
 
         if (SUCCEEDED(hr))
@@ -6473,7 +5711,7 @@ VOID DXGI_FillTree(HWND hwndTV)
         }
         else
         {
-            hr = g_D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_REFERENCE, nullptr, 0, nullptr, 0,
+            hr = StatsCall(API_D3D11CREATEDEVICE, g_D3D11CreateDevice, nullptr, D3D_DRIVER_TYPE_REFERENCE, nullptr, 0, nullptr, 0,
                 D3D11_SDK_VERSION, &pDeviceREF11, nullptr, nullptr);
             if (SUCCEEDED(hr))
             {
@@ -6486,14 +5724,14 @@ VOID DXGI_FillTree(HWND hwndTV)
 
     if (pDeviceREF10 || pDeviceREF10_1 || pDeviceREF11 || pDeviceREF11_1 || pDeviceREF11_2 || pDeviceREF11_3)
     {
-        HTREEITEM hTreeR = TVAddNode(hTree, "Reference", TRUE, IDI_CAPS, nullptr, 0, 0);
+        HCAPNODE hTreeR = TVAddNode(hTree, "Reference", TRUE, IDI_CAPS, nullptr, 0, 0);
 
         // No REF for Direct3D 12
 
         // Direct3D 11.x (REF)
         if (pDeviceREF11 || pDeviceREF11_1 || pDeviceREF11_2 || pDeviceREF11_3)
         {
-            HTREEITEM hTree11 = (pDeviceREF11_1 || pDeviceREF11_2 || pDeviceREF11_3)
+            HCAPNODE hTree11 = (pDeviceREF11_1 || pDeviceREF11_2 || pDeviceREF11_3)
                 ? TVAddNode(hTreeR, "Direct3D 11", TRUE, IDI_CAPS, nullptr, 0, 0)
                 : hTreeR;
 
@@ -6513,7 +5751,7 @@ VOID DXGI_FillTree(HWND hwndTV)
         // Direct3D 10.x (REF)
         if (pDeviceREF10 || pDeviceREF10_1)
         {
-            HTREEITEM hTree10 = (pDeviceREF10_1)
+            HCAPNODE hTree10 = (pDeviceREF10_1)
                 ? TVAddNode(hTreeR, "Direct3D 10", TRUE, IDI_CAPS, nullptr, 0, 0)
                 : hTreeR;
 
@@ -6525,7 +5763,7 @@ VOID DXGI_FillTree(HWND hwndTV)
         }
     }
 
-    TreeView_Expand(hwndTV, hTree, TVE_EXPAND);
+    TVExpandNode(hTree);
 }
 
 
@@ -6534,6 +5772,9 @@ VOID DXGI_FillTree(HWND hwndTV)
 //-----------------------------------------------------------------------------
 VOID DXGI_CleanUp()
 {
+    FreeFormatSupport();
+    FreeMSAASupport();
+
     if (g_DXGIFactory)
     {
         SAFE_RELEASE(g_DXGIFactory);
@@ -6545,6 +5786,8 @@ VOID DXGI_CleanUp()
         g_DXGIFactory5 = nullptr;
     }
 
+    SAFE_RELEASE(g_DXGIFactoryRecord);
+
     if (g_dxgi)
     {
         FreeLibrary(g_dxgi);
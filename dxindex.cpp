@@ -0,0 +1,418 @@
+//-----------------------------------------------------------------------------
+// Name: dxindex.cpp
+//
+// Desc: DirectX Capabilities Viewer search index
+//
+//       An inverted index from words to the texts that contain them. Texts
+//       are split into words at anything that isn't an ASCII letter or digit,
+//       and words are compared without case. A query matches the texts that
+//       contain, for each of its words, a word starting with it, so results
+//       can be shown while the query is typed.
+//
+//       The words are kept in a hash table while texts are added, and sorted
+//       for prefix lookups when a query follows additions. Postings list the
+//       texts of each word. Everything is carved from chunks and freed with
+//       the index. The index doesn't know about the tree, see dxsearch.cpp.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+#include <cstdlib>
+
+namespace
+{
+    constexpr DWORD  c_cbIndexChunk = 64 * 1024;
+    constexpr size_t c_cchToken = 64;
+    constexpr UINT   c_maxQueryTokens = 8;
+
+    struct SEARCHPOST
+    {
+        SEARCHPOST* pNext;
+        SEARCHHIT*  pHit;
+    };
+
+    struct SEARCHTOKEN
+    {
+        SEARCHTOKEN*    pNext;      // Hash chain
+        DWORD           dwHash;
+        SEARCHPOST*     pFirst;     // Most recent hit first
+        CHAR            str[1];
+    };
+}
+
+struct SEARCHINDEX
+{
+    SEARCHTOKEN**   ppSlots;
+    DWORD           cSlots;
+    DWORD           cTokens;
+    SEARCHTOKEN**   ppSorted;       // Tokens in strcmp() order, for prefix lookups
+    DWORD           cSorted;        // Out of date if less than cTokens
+    DWORD           cHits;
+    DWORD           dwQuery;
+    BYTE*           pChunk;         // Chunks start with a link to the previous one
+    DWORD           cbChunkUsed;
+};
+
+namespace
+{
+    //-----------------------------------------------------------------------------
+    BOOL IsTokenChar(CHAR ch)
+    {
+        return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: NextToken()
+    // Desc: Copies the next word of *ppch in lower case into szToken, and
+    //       returns its length. Words longer than a token are cut short.
+    //-----------------------------------------------------------------------------
+    size_t NextToken(const CHAR** ppch, CHAR* szToken)
+    {
+        const CHAR* pch = *ppch;
+        while (*pch && !IsTokenChar(*pch))
+            ++pch;
+
+        size_t cch = 0;
+        for (; IsTokenChar(*pch); ++pch)
+        {
+            if (cch < c_cchToken - 1)
+                szToken[cch++] = (*pch >= 'A' && *pch <= 'Z') ? static_cast<CHAR>(*pch - 'A' + 'a') : *pch;
+        }
+        szToken[cch] = '\0';
+
+        *ppch = pch;
+        return cch;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    DWORD HashToken(const CHAR* pch, size_t cch)
+    {
+        DWORD dwHash = 2166136261u;
+        for (size_t i = 0; i < cch; ++i)
+            dwHash = (dwHash ^ static_cast<BYTE>(pch[i])) * 16777619u;
+        return dwHash;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    void* AllocIndex(SEARCHINDEX* pIndex, size_t cb)
+    {
+        cb = (cb + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+        if (cb > c_cbIndexChunk - sizeof(BYTE*))
+            return nullptr;
+
+        if (!pIndex->pChunk || pIndex->cbChunkUsed + cb > c_cbIndexChunk)
+        {
+            auto pChunk = new (std::nothrow) BYTE[c_cbIndexChunk];
+            if (!pChunk)
+                return nullptr;
+
+            *reinterpret_cast<BYTE**>(pChunk) = pIndex->pChunk;
+            pIndex->pChunk = pChunk;
+            pIndex->cbChunkUsed = sizeof(BYTE*);
+        }
+
+        void* pv = pIndex->pChunk + pIndex->cbChunkUsed;
+        pIndex->cbChunkUsed += static_cast<DWORD>(cb);
+        return pv;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    BOOL GrowSlots(SEARCHINDEX* pIndex)
+    {
+        DWORD cSlots = (pIndex->cSlots) ? pIndex->cSlots * 2 : 4096;
+        auto ppSlots = new (std::nothrow) SEARCHTOKEN*[cSlots];
+        if (!ppSlots)
+            return FALSE;
+        memset(ppSlots, 0, cSlots * sizeof(SEARCHTOKEN*));
+
+        for (DWORD i = 0; i < pIndex->cSlots; ++i)
+        {
+            SEARCHTOKEN* pToken = pIndex->ppSlots[i];
+            while (pToken)
+            {
+                SEARCHTOKEN* pNext = pToken->pNext;
+                SEARCHTOKEN** ppSlot = &ppSlots[pToken->dwHash & (cSlots - 1)];
+                pToken->pNext = *ppSlot;
+                *ppSlot = pToken;
+                pToken = pNext;
+            }
+        }
+
+        delete[] pIndex->ppSlots;
+        pIndex->ppSlots = ppSlots;
+        pIndex->cSlots = cSlots;
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: AddToken()
+    // Desc: Finds a word, adding it if it is new
+    //-----------------------------------------------------------------------------
+    SEARCHTOKEN* AddToken(SEARCHINDEX* pIndex, const CHAR* szToken, size_t cch)
+    {
+        if (pIndex->cTokens >= pIndex->cSlots && !GrowSlots(pIndex))
+            return nullptr;
+
+        DWORD dwHash = HashToken(szToken, cch);
+        SEARCHTOKEN** ppSlot = &pIndex->ppSlots[dwHash & (pIndex->cSlots - 1)];
+        for (SEARCHTOKEN* pToken = *ppSlot; pToken; pToken = pToken->pNext)
+        {
+            if (pToken->dwHash == dwHash && strcmp(pToken->str, szToken) == 0)
+                return pToken;
+        }
+
+        auto pToken = static_cast<SEARCHTOKEN*>(AllocIndex(pIndex, sizeof(SEARCHTOKEN) + cch));
+        if (!pToken)
+            return nullptr;
+
+        pToken->dwHash = dwHash;
+        pToken->pFirst = nullptr;
+        memcpy(pToken->str, szToken, cch + 1);
+
+        pToken->pNext = *ppSlot;
+        *ppSlot = pToken;
+        pIndex->cTokens++;
+        return pToken;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    int __cdecl CompareTokens(const void* pv1, const void* pv2)
+    {
+        return strcmp((*static_cast<SEARCHTOKEN* const*>(pv1))->str, (*static_cast<SEARCHTOKEN* const*>(pv2))->str);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    int __cdecl CompareHits(const void* pv1, const void* pv2)
+    {
+        DWORD i1 = (*static_cast<const SEARCHHIT* const*>(pv1))->iHit;
+        DWORD i2 = (*static_cast<const SEARCHHIT* const*>(pv2))->iHit;
+        return (i1 < i2) ? -1 : (i1 > i2) ? 1 : 0;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: SortTokens()
+    // Desc: Brings the sorted tokens up to date with the ones added since
+    //-----------------------------------------------------------------------------
+    BOOL SortTokens(SEARCHINDEX* pIndex)
+    {
+        if (pIndex->cSorted == pIndex->cTokens && (pIndex->ppSorted || !pIndex->cTokens))
+            return TRUE;
+
+        delete[] pIndex->ppSorted;
+        pIndex->cSorted = 0;
+        pIndex->ppSorted = new (std::nothrow) SEARCHTOKEN*[pIndex->cTokens];
+        if (!pIndex->ppSorted)
+            return FALSE;
+
+        for (DWORD i = 0; i < pIndex->cSlots; ++i)
+        {
+            for (SEARCHTOKEN* pToken = pIndex->ppSlots[i]; pToken; pToken = pToken->pNext)
+                pIndex->ppSorted[pIndex->cSorted++] = pToken;
+        }
+
+        qsort(pIndex->ppSorted, pIndex->cSorted, sizeof(SEARCHTOKEN*), CompareTokens);
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: HasPrefix()
+    // Desc: Whether a word of strText starts with szPrefix
+    //-----------------------------------------------------------------------------
+    BOOL HasPrefix(const CHAR* strText, const CHAR* szPrefix, size_t cchPrefix)
+    {
+        CHAR szToken[c_cchToken];
+        const CHAR* pch = strText;
+        while (*pch)
+        {
+            if (NextToken(&pch, szToken) >= cchPrefix && memcmp(szToken, szPrefix, cchPrefix) == 0)
+                return TRUE;
+        }
+
+        return FALSE;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: IndexCreate()
+//-----------------------------------------------------------------------------
+SEARCHINDEX* IndexCreate()
+{
+    auto pIndex = new (std::nothrow) SEARCHINDEX;
+    if (pIndex)
+        memset(pIndex, 0, sizeof(SEARCHINDEX));
+    return pIndex;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: IndexDestroy()
+// Desc: Frees the index and all the hits returned by IndexQuery()
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+VOID IndexDestroy(SEARCHINDEX* pIndex)
+{
+    if (!pIndex)
+        return;
+
+    BYTE* pChunk = pIndex->pChunk;
+    while (pChunk)
+    {
+        BYTE* pPrev = *reinterpret_cast<BYTE**>(pChunk);
+        delete[] pChunk;
+        pChunk = pPrev;
+    }
+
+    delete[] pIndex->ppSlots;
+    delete[] pIndex->ppSorted;
+    delete pIndex;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: IndexAdd()
+// Desc: Adds strText under each of its words. pItem and strRow are returned
+//       with the hit; strRow may be nullptr.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+BOOL IndexAdd(SEARCHINDEX* pIndex, void* pItem, const CHAR* strRow, const CHAR* strText)
+{
+    size_t cchRow = (strRow) ? strlen(strRow) + 1 : 0;
+    size_t cchText = strlen(strText) + 1;
+
+    auto pHit = static_cast<SEARCHHIT*>(AllocIndex(pIndex, sizeof(SEARCHHIT) + cchRow + cchText));
+    if (!pHit)
+        return FALSE;
+
+    auto pch = reinterpret_cast<CHAR*>(pHit + 1);
+    memcpy(pch, strText, cchText);
+    pHit->strText = pch;
+    pHit->strRow = nullptr;
+    if (strRow)
+    {
+        memcpy(pch + cchText, strRow, cchRow);
+        pHit->strRow = pch + cchText;
+    }
+    pHit->pItem = pItem;
+    pHit->iHit = pIndex->cHits++;
+    pHit->dwQuery = 0;
+
+    CHAR szToken[c_cchToken];
+    const CHAR* pchText = pHit->strText;
+    while (*pchText)
+    {
+        size_t cch = NextToken(&pchText, szToken);
+        if (!cch)
+            continue;
+
+        SEARCHTOKEN* pToken = AddToken(pIndex, szToken, cch);
+        if (!pToken)
+            return FALSE;
+
+        // Words repeated in a text are posted once
+        if (pToken->pFirst && pToken->pFirst->pHit == pHit)
+            continue;
+
+        auto pPost = static_cast<SEARCHPOST*>(AllocIndex(pIndex, sizeof(SEARCHPOST)));
+        if (!pPost)
+            return FALSE;
+
+        pPost->pHit = pHit;
+        pPost->pNext = pToken->pFirst;
+        pToken->pFirst = pPost;
+    }
+
+    return TRUE;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: IndexQuery()
+// Desc: Finds the texts matching szQuery and returns how many there are. Up
+//       to cMaxHits of them are stored in ppHits, in the order they were
+//       added. The hits stay valid until the index is destroyed.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+UINT IndexQuery(SEARCHINDEX* pIndex, LPCSTR szQuery, const SEARCHHIT** ppHits, UINT cMaxHits)
+{
+    CHAR szTokens[c_maxQueryTokens][c_cchToken];
+    size_t cchTokens[c_maxQueryTokens] = {};
+    UINT cQuery = 0;
+    UINT iLongest = 0;
+
+    const CHAR* pch = szQuery;
+    while (*pch && cQuery < c_maxQueryTokens)
+    {
+        size_t cch = NextToken(&pch, szTokens[cQuery]);
+        if (!cch)
+            continue;
+
+        cchTokens[cQuery] = cch;
+        if (cch > cchTokens[iLongest])
+            iLongest = cQuery;
+        ++cQuery;
+    }
+
+    if (!cQuery || !SortTokens(pIndex) || !pIndex->cSorted)
+        return 0;
+
+    // Walk the postings of the words that start with the longest query word,
+    // which are the fewest, and check the other query words against the text
+    const CHAR* szPrefix = szTokens[iLongest];
+    size_t cchPrefix = cchTokens[iLongest];
+
+    DWORD iLow = 0;
+    DWORD iHigh = pIndex->cSorted;
+    while (iLow < iHigh)
+    {
+        DWORD iMid = iLow + (iHigh - iLow) / 2;
+        if (strcmp(pIndex->ppSorted[iMid]->str, szPrefix) < 0)
+            iLow = iMid + 1;
+        else
+            iHigh = iMid;
+    }
+
+    DWORD dwQuery = ++pIndex->dwQuery;
+    UINT cFound = 0;
+    for (DWORD i = iLow; i < pIndex->cSorted && strncmp(pIndex->ppSorted[i]->str, szPrefix, cchPrefix) == 0; ++i)
+    {
+        for (SEARCHPOST* pPost = pIndex->ppSorted[i]->pFirst; pPost; pPost = pPost->pNext)
+        {
+            SEARCHHIT* pHit = pPost->pHit;
+            if (pHit->dwQuery == dwQuery)
+                continue;
+            pHit->dwQuery = dwQuery;
+
+            BOOL fMatch = TRUE;
+            for (UINT j = 0; j < cQuery && fMatch; ++j)
+            {
+                if (j != iLongest)
+                    fMatch = HasPrefix(pHit->strText, szTokens[j], cchTokens[j]);
+            }
+
+            if (!fMatch)
+                continue;
+
+            if (cFound < cMaxHits)
+                ppHits[cFound] = pHit;
+            ++cFound;
+        }
+    }
+
+    if (cFound && cMaxHits)
+        qsort(ppHits, (cFound < cMaxHits) ? cFound : cMaxHits, sizeof(SEARCHHIT*), CompareHits);
+    return cFound;
+}
@@ -0,0 +1,443 @@
+//-----------------------------------------------------------------------------
+// Name: dxjson.cpp
+//
+// Desc: DirectX Capabilities Viewer JSON export
+//
+//       Writes the whole capability tree as JSON. Every node becomes
+//
+//          { "name": "...", "rows": [ [cell, ...], ... ], "children": [ ... ] }
+//
+//       Rows are whatever the node's display callback emits, one array per
+//       row. Cells from the row emitter keep their type, and their text
+//       stays a string unless it is one of the shared Yes/No/n/a values.
+//       Text printed with PrintLine has no type, so it is typed from its
+//       contents as booleans, integers, null, or strings.
+//       Output is streamed through an OUTPUTSINK.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+#include <cctype>
+#include <cstdlib>
+
+BOOL g_PrintToJson = FALSE; // Print callbacks emit JSON rows instead of text
+
+extern const char c_szYes[];
+extern const char c_szNo[];
+extern const char c_szNA[];
+extern const char c_szOptYes[];
+extern const char c_szOptNo[];
+
+namespace
+{
+    constexpr UINT  c_maxJsonCells = 16;
+    constexpr UINT  c_cchJsonRow = 1024;
+
+    struct JSONWRITER
+    {
+        OUTPUTSINK  sink;
+        BOOL        fFirst;                 // Next value is the first in its array/object
+
+        // Cells of the line currently being "printed"
+        UINT    cCells;
+        UINT    cchRow;
+        UINT    ichCell[c_maxJsonCells];
+        CHAR    strRow[c_cchJsonRow];
+    };
+
+    JSONWRITER* g_pJson = nullptr;
+    CHAR        g_chThousand = ',';
+
+    //-----------------------------------------------------------------------------
+    VOID JsonWrite(const CHAR* pch, size_t cch)
+    {
+        SinkWrite(&g_pJson->sink, pch, cch);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID JsonWrite(const CHAR* str)
+    {
+        JsonWrite(str, strlen(str));
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: JsonSeparator()
+    // Desc: Writes the comma between values of an array or object
+    //-----------------------------------------------------------------------------
+    VOID JsonSeparator()
+    {
+        if (!g_pJson->fFirst)
+            JsonWrite(",", 1);
+
+        g_pJson->fFirst = FALSE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID JsonWriteString(const CHAR* pch, size_t cch)
+    {
+        SinkWriteJsonString(&g_pJson->sink, pch, cch);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: JsonWriteKeyword()
+    // Desc: Writes the shared Yes/No/n/a texts as true, false and null
+    //-----------------------------------------------------------------------------
+    BOOL JsonWriteKeyword(const CHAR* str)
+    {
+        if (!strcmp(str, c_szYes) || !strcmp(str, c_szOptYes))
+        {
+            JsonWrite("true");
+            return TRUE;
+        }
+
+        if (!strcmp(str, c_szNo) || !strcmp(str, c_szOptNo))
+        {
+            JsonWrite("false");
+            return TRUE;
+        }
+
+        if (!strcmp(str, c_szNA))
+        {
+            JsonWrite("null");
+            return TRUE;
+        }
+
+        return FALSE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: ParseGroupedUInt()
+    // Desc: Copies the digits of str to szValue if str is an unsigned integer
+    //       as Int2Str prints it: no leading zero unless it is "0", and
+    //       groups of exactly three digits after the first.
+    //-----------------------------------------------------------------------------
+    BOOL ParseGroupedUInt(const CHAR* str, CHAR* szValue, size_t cchValueMax)
+    {
+        if (str[0] == '0')
+        {
+            if (str[1] || cchValueMax < 2)
+                return FALSE;
+
+            strcpy_s(szValue, cchValueMax, "0");
+            return TRUE;
+        }
+
+        size_t cchValue = 0;
+        size_t cchGroup = 0;
+        BOOL fGrouped = FALSE;
+        for (const CHAR* pch = str; *pch; ++pch)
+        {
+            if (isdigit(static_cast<BYTE>(*pch)))
+            {
+                if (cchValue + 1 >= cchValueMax)
+                    return FALSE;
+
+                szValue[cchValue++] = *pch;
+                ++cchGroup;
+            }
+            else if (*pch == g_chThousand && cchGroup > 0
+                && ((fGrouped) ? cchGroup == 3 : cchGroup <= 3))
+            {
+                fGrouped = TRUE;
+                cchGroup = 0;
+            }
+            else
+            {
+                return FALSE;
+            }
+        }
+
+        if (!cchValue || (fGrouped && cchGroup != 3))
+            return FALSE;
+
+        szValue[cchValue] = 0;
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: JsonWriteCell()
+    // Desc: Writes one printed cell, recovering its type from the text
+    //-----------------------------------------------------------------------------
+    VOID JsonWriteCell(const CHAR* str)
+    {
+        JsonSeparator();
+
+        if (JsonWriteKeyword(str))
+            return;
+
+        // Hex values, as printed by PrintHexValueLine and PrintCapsToDC
+        if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X') && str[2])
+        {
+            const CHAR* pch = str + 2;
+            while (isxdigit(static_cast<BYTE>(*pch)))
+                ++pch;
+
+            if (!*pch && pch - str <= 2 + 16)
+            {
+                CHAR szValue[32];
+                sprintf_s(szValue, "%llu", _strtoui64(str + 2, nullptr, 16));
+                JsonWrite(szValue);
+                return;
+            }
+        }
+
+        // Unsigned integers, as printed by Int2Str with digit grouping
+        CHAR szValue[32];
+        if (ParseGroupedUInt(str, szValue, std::size(szValue)))
+        {
+            JsonWrite(szValue);
+            return;
+        }
+
+        JsonWriteString(str, strlen(str));
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Row emitter backend, rows arrive with their cells already typed
+    //-----------------------------------------------------------------------------
+    HRESULT JsonEmitColumn(void* /*pContext*/, int /*iCol*/, const CHAR* /*strName*/, int /*width*/)
+    {
+        return S_OK;
+    }
+
+
+    HRESULT JsonEmitRow(void* /*pContext*/, UINT cCells, const ROWCELL* pCells)
+    {
+        if (!cCells)
+            return S_OK;
+
+        // Keep any cells printed through PrintLine in order
+        if (g_pJson->cCells)
+            JsonEndRow();
+
+        JsonSeparator();
+        JsonWrite("[");
+        g_pJson->fFirst = TRUE;
+
+        for (UINT i = 0; i < cCells; ++i)
+        {
+            switch (pCells[i].type)
+            {
+            case CELL_UINT:
+            case CELL_HEX:
+            {
+                CHAR szValue[16];
+                sprintf_s(szValue, "%lu", pCells[i].dwValue);
+                JsonSeparator();
+                JsonWrite(szValue);
+                break;
+            }
+
+            case CELL_BOOL:
+                JsonSeparator();
+                JsonWrite((pCells[i].dwValue) ? "true" : "false");
+                break;
+
+            default:
+            {
+                const CHAR* str = (pCells[i].str) ? pCells[i].str : "";
+                JsonSeparator();
+                if (!JsonWriteKeyword(str))
+                    JsonWriteString(str, strlen(str));
+                break;
+            }
+            }
+        }
+
+        JsonWrite("]");
+        g_pJson->fFirst = FALSE;
+
+        return (g_pJson->sink.fFailed) ? E_FAIL : S_OK;
+    }
+
+    const ROWEMITTER c_JsonEmitter = { JsonEmitColumn, JsonEmitRow, nullptr };
+
+
+    //-----------------------------------------------------------------------------
+    // Name: JsonWriteNode()
+    // Desc: Writes a node, its rows, and its children
+    //-----------------------------------------------------------------------------
+    HRESULT JsonWriteNode(HCAPNODE hNode, PRINTCBINFO* pci)
+    {
+        TVExpandLazyNode(hNode);
+
+        JsonSeparator();
+        JsonWrite("{\"name\":");
+        JsonWriteString(hNode->strText, strlen(hNode->strText));
+
+        JsonWrite(",\"rows\":[");
+        g_pJson->fFirst = TRUE;
+
+        const NODEINFO* pni = &hNode->ni;
+        if (pni->fnDisplayCallback)
+        {
+            pci->hCurrTree = hNode;
+
+            HRESULT hr;
+            if (pni->bUseLParam3)
+                hr = ((DISPLAYCALLBACKEX)(pni->fnDisplayCallback))(pni->lParam1, pni->lParam2, pni->lParam3, pci);
+            else
+                hr = pni->fnDisplayCallback(pni->lParam1, pni->lParam2, pci);
+
+            if (FAILED(hr))
+                return hr;
+
+            // Flush a final line the callback didn't terminate
+            if (g_pJson->cCells)
+                JsonEndRow();
+        }
+        JsonWrite("]");
+
+        if (hNode->pFirstChild)
+        {
+            JsonWrite(",\"children\":[");
+            g_pJson->fFirst = TRUE;
+
+            for (HCAPNODE hChild = hNode->pFirstChild; hChild; hChild = hChild->pNext)
+            {
+                HRESULT hr = JsonWriteNode(hChild, pci);
+                if (FAILED(hr))
+                    return hr;
+            }
+
+            JsonWrite("]");
+        }
+
+        JsonWrite("}");
+        g_pJson->fFirst = FALSE;
+
+        return (g_pJson->sink.fFailed) ? E_FAIL : S_OK;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: JsonAddCell()
+// Desc: Called by PrintLine() in JSON mode to add a cell to the current row
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT JsonAddCell(LPCTSTR pszBuff, size_t cchBuff)
+{
+    if (!g_pJson)
+        return E_FAIL;
+
+    if (!pszBuff || !cchBuff)
+        return S_OK;
+
+    if (g_pJson->cCells >= c_maxJsonCells
+        || g_pJson->cchRow + cchBuff + 1 > c_cchJsonRow)
+        return S_OK;
+
+    // Cells are printed padded to the column width
+    while (cchBuff > 0 && pszBuff[cchBuff - 1] == ' ')
+        --cchBuff;
+
+    g_pJson->ichCell[g_pJson->cCells++] = g_pJson->cchRow;
+    memcpy(g_pJson->strRow + g_pJson->cchRow, pszBuff, cchBuff);
+    g_pJson->cchRow += static_cast<UINT>(cchBuff);
+    g_pJson->strRow[g_pJson->cchRow++] = 0;
+
+    return S_OK;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: JsonEndRow()
+// Desc: Called by PrintNextLine() in JSON mode to write out the current row
+//-----------------------------------------------------------------------------
+HRESULT JsonEndRow()
+{
+    if (!g_pJson)
+        return E_FAIL;
+
+    if (!g_pJson->cCells)
+        return S_OK;
+
+    JsonSeparator();
+    JsonWrite("[");
+    g_pJson->fFirst = TRUE;
+
+    for (UINT i = 0; i < g_pJson->cCells; ++i)
+        JsonWriteCell(g_pJson->strRow + g_pJson->ichCell[i]);
+
+    JsonWrite("]");
+    g_pJson->fFirst = FALSE;
+
+    g_pJson->cCells = 0;
+    g_pJson->cchRow = 0;
+
+    return (g_pJson->sink.fFailed) ? E_FAIL : S_OK;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: DXView_OnJson()
+// Desc: Writes the whole capability tree to strPath as JSON
+//-----------------------------------------------------------------------------
+BOOL DXView_OnJson(HWND /*hWnd*/, LPCTSTR strPath)
+{
+    if (!strPath || !*strPath)
+        return FALSE;
+
+    HANDLE hFile = CreateFile(strPath, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    g_pJson = new (std::nothrow) JSONWRITER;
+    if (!g_pJson)
+    {
+        CloseHandle(hFile);
+        return FALSE;
+    }
+
+    memset(g_pJson, 0, sizeof(JSONWRITER));
+    SinkInitFile(&g_pJson->sink, hFile);
+    g_pJson->fFirst = TRUE;
+
+    char strThousand[4] = {};
+    if (GetLocaleInfo(LOCALE_USER_DEFAULT, LOCALE_STHOUSAND, strThousand, 4) > 0)
+        g_chThousand = strThousand[0];
+
+    // Callbacks only use the layout fields to compute column offsets
+    PRINTCBINFO pci = {};
+    pci.dwLineHeight = 1;
+    pci.dwCharWidth = 1;
+    pci.dwCharsPerLine = 80;
+    pci.dwLinesPerPage = 0xFFFFFFFF;
+    pci.pEmitter = &c_JsonEmitter;
+
+    g_PrintToJson = TRUE;
+
+    HRESULT hr = S_OK;
+    JsonWrite("{\"version\":1,\"tree\":[");
+    for (HCAPNODE hNode = TVGetRoot(); hNode && SUCCEEDED(hr); hNode = hNode->pNext)
+    {
+        hr = JsonWriteNode(hNode, &pci);
+    }
+    JsonWrite("]}\r\n");
+
+    g_PrintToJson = FALSE;
+
+    BOOL fResult = SUCCEEDED(hr) && SinkFlush(&g_pJson->sink);
+
+    delete g_pJson;
+    g_pJson = nullptr;
+
+    CloseHandle(hFile);
+
+    if (!fResult)
+        DeleteFile(strPath);
+
+    return fResult;
+}
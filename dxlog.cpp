@@ -0,0 +1,258 @@
+//-----------------------------------------------------------------------------
+// Name: dxlog.cpp
+//
+// Desc: DirectX Capabilities Viewer text log reader
+//
+//       Reads the text written by "Print whole tree to file" (dxview.log)
+//       back as nodes and rows, so old logs can be processed like snapshots.
+//       The layout is the one PrintTreeStats() writes:
+//
+//       - a node at depth d is indented by d * DEF_TAB_SIZE spaces
+//       - its rows follow, indented two levels deeper than the node
+//       - name/value rows have the value c_tabStop columns past the indent
+//       - other rows (tables) are split at runs of two or more spaces
+//
+//       Any line indented past the children of the current node is one of
+//       its rows, so rows are never mistaken for grandchildren. Column names
+//       aren't printed, so table cells have none.
+//
+//       The file is mapped and scanned in place. Only the current line and
+//       the text of the current node's ancestors are copied, to hand them out
+//       NUL terminated, into one fixed size work area.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+#include <cstdlib>
+
+extern const char c_szYes[];
+extern const char c_szNo[];
+
+namespace
+{
+    constexpr UINT   c_maxLogDepth = 32;
+    constexpr UINT   c_maxLogCells = 16;
+    constexpr size_t c_cchLogLine = 1024;
+    constexpr size_t c_cchLogNode = 256;
+
+    struct LOGWALK
+    {
+        const SNAPSHOTWALKER* pWalker;
+        int     depth;                              // Of the current node, -1 before the first
+        BOOL    fSkip;                              // The current node is too deep, ignore it
+        CHAR    strNodes[c_maxLogDepth][c_cchLogNode];
+        CHAR    strLine[c_cchLogLine];
+    };
+
+
+    //-----------------------------------------------------------------------------
+    // Name: IsLogText()
+    // Desc: A log is plain text and starts with an unindented node
+    //-----------------------------------------------------------------------------
+    BOOL IsLogText(const CHAR* pch, size_t cch)
+    {
+        BOOL fFirst = TRUE;
+        for (size_t i = 0; i < cch; ++i)
+        {
+            auto ch = static_cast<BYTE>(pch[i]);
+            if (ch < 0x20 && ch != '\r' && ch != '\n' && ch != '\t')
+                return FALSE;
+
+            if (fFirst && ch > ' ')
+                fFirst = FALSE;
+            else if (fFirst && ch == ' ')
+                return FALSE;
+        }
+
+        return !fFirst;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: TypeCell()
+    // Desc: Gives back the type of the values the printer writes recognizably
+    //-----------------------------------------------------------------------------
+    VOID TypeCell(ROWCELL* pCell, const CHAR* str)
+    {
+        pCell->type = CELL_TEXT;
+        pCell->str = str;
+        pCell->dwValue = 0;
+
+        if (strcmp(str, c_szYes) == 0 || strcmp(str, c_szNo) == 0)
+        {
+            pCell->type = CELL_BOOL;
+            pCell->dwValue = (*str == *c_szYes) ? 1u : 0u;
+            return;
+        }
+
+        // PrintHexValueLine() writes "0x%08x"
+        if (str[0] == '0' && str[1] == 'x' && strlen(str) == 10)
+        {
+            CHAR* pEnd = nullptr;
+            unsigned long value = strtoul(str + 2, &pEnd, 16);
+            if (pEnd && !*pEnd)
+            {
+                pCell->type = CELL_HEX;
+                pCell->dwValue = static_cast<DWORD>(value);
+            }
+        }
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: ParseRow()
+    // Desc: Splits a row of the current node into cells and passes them on
+    //-----------------------------------------------------------------------------
+    VOID ParseRow(LOGWALK* pWalk, const CHAR* pch, size_t cch)
+    {
+        if (cch >= c_cchLogLine)
+            cch = c_cchLogLine - 1;
+
+        CHAR* strLine = pWalk->strLine;
+        memcpy(strLine, pch, cch);
+        strLine[cch] = '\0';
+
+        ROWCELL cells[c_maxLogCells];
+        UINT cCells = 0;
+
+        const auto ichValue = static_cast<size_t>(c_tabStop);
+        if (cch > ichValue && strLine[ichValue - 1] == ' ' && strLine[ichValue] != ' ')
+        {
+            size_t cchName = ichValue;
+            while (cchName > 0 && strLine[cchName - 1] == ' ')
+                --cchName;
+            strLine[cchName] = '\0';
+
+            TypeCell(&cells[cCells++], strLine);
+            TypeCell(&cells[cCells++], strLine + ichValue);
+        }
+        else
+        {
+            size_t i = 0;
+            while (i < cch && cCells < c_maxLogCells)
+            {
+                size_t ichStart = i;
+                while (i < cch && !(strLine[i] == ' ' && (i + 1 == cch || strLine[i + 1] == ' ')))
+                    ++i;
+
+                size_t ichEnd = i;
+                while (i < cch && strLine[i] == ' ')
+                    ++i;
+
+                strLine[ichEnd] = '\0';
+                TypeCell(&cells[cCells++], strLine + ichStart);
+            }
+        }
+
+        (void)pWalk->pWalker->rows.fnRow(pWalk->pWalker->rows.pContext, cCells, cells);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: ParseLine()
+    // Desc: A line is a node, or a row of the current node if it is indented
+    //       past the node's children
+    //-----------------------------------------------------------------------------
+    VOID ParseLine(LOGWALK* pWalk, const CHAR* pch, size_t cch)
+    {
+        while (cch > 0 && (pch[cch - 1] == '\r' || pch[cch - 1] == ' '))
+            --cch;
+
+        size_t indent = 0;
+        while (indent < cch && pch[indent] == ' ')
+            ++indent;
+
+        if (indent == cch)
+            return;
+
+        if (static_cast<int>(indent) > (pWalk->depth + 1) * DEF_TAB_SIZE)
+        {
+            if (pWalk->depth >= 0 && !pWalk->fSkip)
+                ParseRow(pWalk, pch + indent, cch - indent);
+            return;
+        }
+
+        UINT depth = static_cast<UINT>(indent / DEF_TAB_SIZE);
+        pWalk->depth = static_cast<int>(depth);
+        pWalk->fSkip = (depth >= c_maxLogDepth);
+        if (pWalk->fSkip)
+            return;
+
+        size_t cchText = cch - indent;
+        if (cchText >= c_cchLogNode)
+            cchText = c_cchLogNode - 1;
+
+        CHAR* strText = pWalk->strNodes[depth];
+        memcpy(strText, pch + indent, cchText);
+        strText[cchText] = '\0';
+
+        pWalk->pWalker->fnNode(pWalk->pWalker->rows.pContext, depth, strText);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: LogWalkFile()
+// Desc: Passes the nodes and rows of a text log to pWalker, in the same way
+//       as CacheWalkSnapshot(). Nothing is passed if the file isn't text.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+BOOL LogWalkFile(LPCSTR szPath, const SNAPSHOTWALKER* pWalker)
+{
+    if (!szPath || !*szPath)
+        return FALSE;
+
+    HANDLE hFile = CreateFile(szPath, GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    LARGE_INTEGER fileSize = {};
+    const CHAR* pBase = nullptr;
+    if (GetFileSizeEx(hFile, &fileSize) && fileSize.HighPart == 0 && fileSize.LowPart > 0)
+    {
+        HANDLE hMapping = CreateFileMapping(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (hMapping)
+        {
+            pBase = static_cast<const CHAR*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(hMapping);
+        }
+    }
+    CloseHandle(hFile);
+
+    if (!pBase)
+        return FALSE;
+
+    size_t cb = fileSize.LowPart;
+    BOOL fText = IsLogText(pBase, cb);
+    if (fText)
+    {
+        auto pWalk = new (std::nothrow) LOGWALK;
+        fText = (pWalk != nullptr);
+        if (pWalk)
+        {
+            pWalk->pWalker = pWalker;
+            pWalk->depth = -1;
+            pWalk->fSkip = FALSE;
+
+            const CHAR* pch = pBase;
+            const CHAR* pEnd = pBase + cb;
+            while (pch < pEnd)
+            {
+                auto pEol = static_cast<const CHAR*>(memchr(pch, '\n', static_cast<size_t>(pEnd - pch)));
+                size_t cch = static_cast<size_t>(((pEol) ? pEol : pEnd) - pch);
+                ParseLine(pWalk, pch, cch);
+                pch += cch + 1;
+            }
+
+            delete pWalk;
+        }
+    }
+
+    UnmapViewOfFile(pBase);
+    return fText;
+}
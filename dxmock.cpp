@@ -0,0 +1,1960 @@
+//-----------------------------------------------------------------------------
+// Name: dxmock.cpp
+//
+// Desc: DirectX Capabilities Viewer mock devices and query recording
+//
+//       With "--mock <file>" the DirectX runtimes are replaced by mock devices
+//       described in a text file. The tree builder, the exports and the
+//       snapshot cache can then be run and timed without a GPU or driver.
+//       The probes use the mocks through the runtime entry points, so they
+//       run the same code as with real devices. Mocked are DXGI 1.1
+//       (IDXGIFactory1, IDXGIAdapter1, IDXGIOutput), Direct3D 11
+//       (ID3D11Device) and Direct3D 9 (IDirect3D9). Direct3D 10.x and 12,
+//       WARP, DXGI 1.2 and later, ID3D11Device1 and later, Direct3D 9Ex and
+//       DirectDraw are not, and show up as missing.
+//
+//       With "--record <file>" the DirectX runtimes are loaded as usual, and
+//       the same mock objects wrap the real DXGI 1.1 factory, Direct3D 11
+//       hardware devices and Direct3D 9: their queries are passed on to the
+//       driver, and each answer and time is written to the file on exit.
+//       Anything else, including the interfaces the mocks don't implement,
+//       is answered by the real objects and not recorded, so the tree is
+//       complete but "--mock" replays the recorded part of it only. Given
+//       the file, "--mock" answers each recorded query exactly as the driver
+//       did, so a field machine's run can be reproduced and its query mix
+//       timed elsewhere. Direct3D 9 is recorded without the 9Ex additions.
+//       Only queries that were made are recorded, so record a run that
+//       saves the whole tree, e.g. "--record rec.txt tree.txt".
+//
+//       The file has a "name = value" setting per line, and '#' starts a
+//       comment. Values are numbers (decimal, or hex with 0x), text, lists
+//       of numbers, or hex bytes for structures. Settings are looked up in a
+//       hash table, so a mock call costs the same whatever the file's size.
+//
+//       latency                         Microseconds every mock call takes
+//       latency.<call>                  ... one call, e.g. latency.CheckFormatSupport
+//       adapters                        Number of adapters
+//
+//       For adapter n:
+//       adapter<n>.description          Adapter name
+//       adapter<n>.vendorid, deviceid, subsysid, revision
+//       adapter<n>.videomemory, systemmemory, sharedmemory
+//       adapter<n>.umdversion           Driver version
+//       adapter<n>.d3d11.featurelevel   Highest D3D_FEATURE_LEVEL, e.g. 0xb100
+//       adapter<n>.d3d11.feature.<f>    Data of D3D11_FEATURE f, as hex bytes
+//       adapter<n>.d3d11.format.<f>     D3D11_FORMAT_SUPPORT of DXGI_FORMAT f
+//       adapter<n>.d3d11.format2.<f>    D3D11_FORMAT_SUPPORT2 of DXGI_FORMAT f
+//       adapter<n>.d3d11.msaa           Highest sample count
+//       adapter<n>.d3d9.caps            D3DCAPS9, as hex bytes
+//       adapter<n>.d3d9.modes           Display modes, e.g. 1920x1080@60 1280x720@60
+//       adapter<n>.d3d9.adapterformats  D3DFORMATs of the display, first is current
+//       adapter<n>.d3d9.format.<f>      D3DUSAGE flags of D3DFORMAT f
+//       adapter<n>.d3d9.msaa            Highest D3DMULTISAMPLE_TYPE
+//
+//       A DXGI_FORMAT f may be given by number or by name, e.g.
+//       adapter0.d3d11.format.DXGI_FORMAT_R8G8B8A8_UNORM = 0x6bb5e002
+//
+//       A recording holds the answers of single calls instead, named after
+//       the call and its arguments, e.g.
+//       adapter0.d3d11.CheckFormatSupport.28 = 0x00000000 6bb5e002
+//       with the HRESULT and, if it succeeded, the call's output as hex
+//       bytes. These settings take precedence over the ones above.
+//
+//       Queries of anything not in the file fail as they would on a device
+//       without support for it.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+#include <cstdlib>
+
+#include <dxgi.h>
+#include <d3d10_1.h>
+#include <d3d11.h>
+#include <d3d9.h>
+
+#include "dxtables.h"
+
+namespace
+{
+    using LPCREATEDXGIFACTORY1 = HRESULT(WINAPI*)(REFIID, void**);
+    using LPD3D10CREATEDEVICE = HRESULT(WINAPI*)(IDXGIAdapter*, D3D10_DRIVER_TYPE, HMODULE, UINT, UINT32, ID3D10Device**);
+    using LPDIRECT3D9CREATE9 = IDirect3D9 * (WINAPI*)(UINT SDKVersion);
+
+    // Mock calls that can be given a latency of their own
+    enum MOCKCALL : UINT
+    {
+        MC_ENUMADAPTERS,
+        MC_GETDESC,
+        MC_CHECKINTERFACESUPPORT,
+        MC_ENUMOUTPUTS,
+        MC_GETDISPLAYMODELIST,
+        MC_D3D11CREATEDEVICE,
+        MC_CHECKFEATURESUPPORT,
+        MC_CHECKFORMATSUPPORT,
+        MC_CHECKMULTISAMPLEQUALITYLEVELS,
+        MC_GETADAPTERCOUNT,
+        MC_GETADAPTERIDENTIFIER,
+        MC_GETADAPTERMODECOUNT,
+        MC_ENUMADAPTERMODES,
+        MC_GETADAPTERDISPLAYMODE,
+        MC_CHECKDEVICETYPE,
+        MC_CHECKDEVICEFORMAT,
+        MC_CHECKDEVICEMULTISAMPLETYPE,
+        MC_CHECKDEPTHSTENCILMATCH,
+        MC_CHECKDEVICEFORMATCONVERSION,
+        MC_GETDEVICECAPS,
+        MC_COUNT
+    };
+
+    const CHAR* const c_strMockCalls[MC_COUNT] =
+    {
+        "EnumAdapters",
+        "GetDesc",
+        "CheckInterfaceSupport",
+        "EnumOutputs",
+        "GetDisplayModeList",
+        "D3D11CreateDevice",
+        "CheckFeatureSupport",
+        "CheckFormatSupport",
+        "CheckMultisampleQualityLevels",
+        "GetAdapterCount",
+        "GetAdapterIdentifier",
+        "GetAdapterModeCount",
+        "EnumAdapterModes",
+        "GetAdapterDisplayMode",
+        "CheckDeviceType",
+        "CheckDeviceFormat",
+        "CheckDeviceMultiSampleType",
+        "CheckDepthStencilMatch",
+        "CheckDeviceFormatConversion",
+        "GetDeviceCaps",
+    };
+
+    constexpr size_t c_cchMockName = 128;
+    constexpr UINT   c_maxMockModes = 256;
+
+    struct MOCKENTRY
+    {
+        DWORD       dwHash;
+        const CHAR* strName;
+        const CHAR* strValue;
+    };
+
+    struct MOCKDATA
+    {
+        CHAR*       pText;          // The file, split in place into names and values
+        MOCKENTRY*  pEntries;       // Open addressed, nullptr strName if free
+        DWORD       cSlots;         // A power of 2
+        LONGLONG    qpcLatency[MC_COUNT];
+    };
+
+    struct RECORDENTRY
+    {
+        DWORD       dwHash;
+        CHAR*       str;            // The name, a '\0' and the value
+    };
+
+    struct RECORDER
+    {
+        SRWLOCK         lock;       // Guards the entries, the probes record from several threads
+        RECORDENTRY*    pEntries;   // Open addressed, nullptr str if free
+        DWORD           cSlots;     // A power of 2
+        DWORD           cEntries;
+
+        volatile LONG   cCalls[MC_COUNT];
+        volatile LONG64 qpcCalls[MC_COUNT];
+
+        HMODULE                 hDXGI;
+        HMODULE                 hD3D10;
+        HMODULE                 hD3D10_1;
+        HMODULE                 hD3D11;
+        HMODULE                 hD3D9;
+        LPCREATEDXGIFACTORY1    pfnCreateDXGIFactory1;
+        LPD3D10CREATEDEVICE     pfnD3D10CreateDevice;
+        PFN_D3D10_CREATE_DEVICE1 pfnD3D10CreateDevice1;
+        PFN_D3D11_CREATE_DEVICE pfnD3D11CreateDevice;
+        LPDIRECT3D9CREATE9      pfnDirect3DCreate9;
+    };
+
+    MOCKDATA* s_pMock = nullptr;
+    RECORDER* s_pRecorder = nullptr;
+
+
+    //-----------------------------------------------------------------------------
+    DWORD HashName(const CHAR* str)
+    {
+        DWORD dwHash = 2166136261u;
+        for (; *str; ++str)
+            dwHash = (dwHash ^ static_cast<BYTE>(*str)) * 16777619u;
+        return dwHash;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    DWORD HashBytes(const void* pData, size_t cbData)
+    {
+        auto pb = static_cast<const BYTE*>(pData);
+        DWORD dwHash = 2166136261u;
+        for (size_t i = 0; i < cbData; ++i)
+            dwHash = (dwHash ^ pb[i]) * 16777619u;
+        return dwHash;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    const CHAR* FindSetting(const CHAR* strName)
+    {
+        if (!s_pMock)
+            return nullptr;
+
+        DWORD dwHash = HashName(strName);
+        DWORD mask = s_pMock->cSlots - 1;
+        for (DWORD i = dwHash & mask; s_pMock->pEntries[i].strName; i = (i + 1) & mask)
+        {
+            const MOCKENTRY& entry = s_pMock->pEntries[i];
+            if (entry.dwHash == dwHash && strcmp(entry.strName, strName) == 0)
+                return entry.strValue;
+        }
+        return nullptr;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: AdapterSetting()
+    // Desc: Gives back the value of "adapter<iAdapter>.<strName>", with %u in
+    //       strName replaced by n, or nullptr if it isn't set
+    //-----------------------------------------------------------------------------
+    const CHAR* AdapterSetting(UINT iAdapter, const CHAR* strName, UINT n = 0)
+    {
+        CHAR szSetting[c_cchMockName];
+        int cch = sprintf_s(szSetting, "adapter%u.", iAdapter);
+        if (cch < 0)
+            return nullptr;
+
+        sprintf_s(szSetting + cch, c_cchMockName - static_cast<size_t>(cch), strName, n);
+        return FindSetting(szSetting);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    ULONGLONG Number(const CHAR* strValue, ULONGLONG defValue = 0)
+    {
+        return (strValue) ? strtoull(strValue, nullptr, 0) : defValue;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: Bytes()
+    // Desc: Copies hex bytes to pData, zero fills the rest of it
+    //-----------------------------------------------------------------------------
+    VOID Bytes(const CHAR* strValue, void* pData, size_t cbData)
+    {
+        memset(pData, 0, cbData);
+
+        auto pb = static_cast<BYTE*>(pData);
+        size_t cb = 0;
+        int nibble = -1;
+        for (const CHAR* pch = strValue; *pch && cb < cbData; ++pch)
+        {
+            CHAR ch = *pch;
+            int digit = (ch >= '0' && ch <= '9') ? ch - '0'
+                : (ch >= 'a' && ch <= 'f') ? ch - 'a' + 10
+                : (ch >= 'A' && ch <= 'F') ? ch - 'A' + 10
+                : -1;
+            if (digit < 0)
+                continue;
+
+            if (nibble < 0)
+            {
+                nibble = digit;
+            }
+            else
+            {
+                pb[cb++] = static_cast<BYTE>((nibble << 4) | digit);
+                nibble = -1;
+            }
+        }
+    }
+
+
+    //-----------------------------------------------------------------------------
+    BOOL ListHas(const CHAR* strList, ULONGLONG value)
+    {
+        if (!strList)
+            return FALSE;
+
+        for (const CHAR* pch = strList; *pch; )
+        {
+            CHAR* pEnd = nullptr;
+            ULONGLONG item = strtoull(pch, &pEnd, 0);
+            if (pEnd == pch)
+                break;
+            if (item == value)
+                return TRUE;
+
+            pch = pEnd;
+            while (*pch == ' ' || *pch == ',')
+                ++pch;
+        }
+        return FALSE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: Delay()
+    // Desc: Spends the latency of a call. Sleep() is far too coarse for the
+    //       microseconds most driver queries take, so this spins.
+    //-----------------------------------------------------------------------------
+    VOID Delay(MOCKCALL call)
+    {
+        LONGLONG qpcLatency = (s_pMock) ? s_pMock->qpcLatency[call] : 0;
+        if (qpcLatency <= 0)
+            return;
+
+        LONGLONG qpcStart = TraceNow();
+        while (TraceNow() - qpcStart < qpcLatency)
+            YieldProcessor();
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: Replay()
+    // Desc: Gives back the recorded answer of a call, "<hr> <output bytes>",
+    //       if there is one
+    //-----------------------------------------------------------------------------
+    BOOL Replay(const CHAR* szName, HRESULT* phr, void* pOut, size_t cbOut)
+    {
+        const CHAR* strValue = FindSetting(szName);
+        if (!strValue)
+            return FALSE;
+
+        CHAR* pEnd = nullptr;
+        *phr = static_cast<HRESULT>(strtoul(strValue, &pEnd, 0));
+        if (pOut)
+            Bytes(pEnd, pOut, cbOut);
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: RecordSet()
+    // Desc: Sets a recorded setting, replacing an earlier answer of the call
+    //-----------------------------------------------------------------------------
+    VOID RecordSet(const CHAR* szName, const CHAR* szValue)
+    {
+        size_t cchName = strlen(szName);
+        size_t cchValue = strlen(szValue);
+        auto str = new (std::nothrow) CHAR[cchName + cchValue + 2];
+        if (!str)
+            return;
+        memcpy(str, szName, cchName + 1);
+        memcpy(str + cchName + 1, szValue, cchValue + 1);
+
+        DWORD dwHash = HashName(szName);
+
+        AcquireSRWLockExclusive(&s_pRecorder->lock);
+
+        // Keep the table at most three quarters full
+        if ((s_pRecorder->cEntries + 1) * 4 > s_pRecorder->cSlots * 3)
+        {
+            DWORD cSlots = s_pRecorder->cSlots * 2;
+            auto pEntries = new (std::nothrow) RECORDENTRY[cSlots]();
+            if (!pEntries)
+            {
+                ReleaseSRWLockExclusive(&s_pRecorder->lock);
+                delete[] str;
+                return;
+            }
+
+            for (DWORD i = 0; i < s_pRecorder->cSlots; ++i)
+            {
+                const RECORDENTRY& entry = s_pRecorder->pEntries[i];
+                if (!entry.str)
+                    continue;
+
+                DWORD j = entry.dwHash & (cSlots - 1);
+                while (pEntries[j].str)
+                    j = (j + 1) & (cSlots - 1);
+                pEntries[j] = entry;
+            }
+
+            delete[] s_pRecorder->pEntries;
+            s_pRecorder->pEntries = pEntries;
+            s_pRecorder->cSlots = cSlots;
+        }
+
+        DWORD mask = s_pRecorder->cSlots - 1;
+        DWORD i = dwHash & mask;
+        while (s_pRecorder->pEntries[i].str
+            && (s_pRecorder->pEntries[i].dwHash != dwHash || strcmp(s_pRecorder->pEntries[i].str, szName) != 0))
+            i = (i + 1) & mask;
+
+        RECORDENTRY& entry = s_pRecorder->pEntries[i];
+        if (entry.str)
+            delete[] entry.str;
+        else
+            ++s_pRecorder->cEntries;
+        entry = { dwHash, str };
+
+        ReleaseSRWLockExclusive(&s_pRecorder->lock);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: Record()
+    // Desc: Records the answer of a driver call that started at qpcStart, as
+    //       the HRESULT and, if the call succeeded, the output in hex bytes
+    //-----------------------------------------------------------------------------
+    VOID Record(MOCKCALL call, LONGLONG qpcStart, const CHAR* szName, HRESULT hr, const void* pOut, size_t cbOut)
+    {
+        InterlockedIncrement(&s_pRecorder->cCalls[call]);
+        InterlockedExchangeAdd64(&s_pRecorder->qpcCalls[call], TraceNow() - qpcStart);
+
+        if (FAILED(hr) || !pOut)
+            cbOut = 0;
+
+        auto szValue = new (std::nothrow) CHAR[cbOut * 2 + 16];
+        if (!szValue)
+            return;
+
+        int cch = sprintf_s(szValue, 16, "0x%08lX", static_cast<unsigned long>(hr));
+        if (cbOut > 0 && cch > 0)
+        {
+            static const CHAR c_hex[] = "0123456789abcdef";
+            auto pb = static_cast<const BYTE*>(pOut);
+            CHAR* pch = szValue + cch;
+            *pch++ = ' ';
+            for (size_t i = 0; i < cbOut; ++i)
+            {
+                *pch++ = c_hex[pb[i] >> 4];
+                *pch++ = c_hex[pb[i] & 0xf];
+            }
+            *pch = '\0';
+        }
+
+        RecordSet(szName, szValue);
+        delete[] szValue;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    int __cdecl CompareRecordEntries(const void* p1, const void* p2)
+    {
+        return strcmp(*static_cast<const CHAR* const*>(p1), *static_cast<const CHAR* const*>(p2));
+    }
+
+
+    //-----------------------------------------------------------------------------
+    UINT AdapterCount()
+    {
+        return static_cast<UINT>(Number(FindSetting("adapters")));
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: GetMode()
+    // Desc: Gives back display mode iMode of "d3d9.modes", e.g. "1920x1080@60"
+    //-----------------------------------------------------------------------------
+    BOOL GetMode(UINT iAdapter, UINT iMode, D3DDISPLAYMODE* pMode)
+    {
+        const CHAR* strModes = AdapterSetting(iAdapter, "d3d9.modes");
+        if (!strModes || iMode >= c_maxMockModes)
+            return FALSE;
+
+        const CHAR* pch = strModes;
+        for (UINT i = 0; ; ++i)
+        {
+            while (*pch == ' ' || *pch == ',')
+                ++pch;
+            if (!*pch)
+                return FALSE;
+
+            if (i == iMode)
+            {
+                UINT width = 0, height = 0, refresh = 0;
+                if (sscanf_s(pch, "%ux%u@%u", &width, &height, &refresh) < 2)
+                    return FALSE;
+
+                pMode->Width = width;
+                pMode->Height = height;
+                pMode->RefreshRate = refresh;
+                pMode->Format = static_cast<D3DFORMAT>(Number(AdapterSetting(iAdapter, "d3d9.adapterformats")));
+                return TRUE;
+            }
+
+            while (*pch && *pch != ' ' && *pch != ',')
+                ++pch;
+        }
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: IsAdapterFormat9()
+    // Desc: Only HAL devices are mocked, on the listed display formats
+    //-----------------------------------------------------------------------------
+    BOOL IsAdapterFormat9(UINT iAdapter, D3DDEVTYPE devType, D3DFORMAT fmtAdapter)
+    {
+        return iAdapter < AdapterCount() && devType == D3DDEVTYPE_HAL
+            && ListHas(AdapterSetting(iAdapter, "d3d9.adapterformats"), static_cast<ULONGLONG>(fmtAdapter));
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // IUnknown for the mock objects, which own the real object they pass the
+    // calls on to while recording
+    //-----------------------------------------------------------------------------
+    template<class T>
+    class MockUnknown : public T
+    {
+    public:
+        ULONG STDMETHODCALLTYPE AddRef() override
+        {
+            return static_cast<ULONG>(InterlockedIncrement(&cRef));
+        }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            LONG c = InterlockedDecrement(&cRef);
+            if (c == 0)
+                delete this;
+            return static_cast<ULONG>(c);
+        }
+
+        virtual ~MockUnknown()
+        {
+            if (pReal)
+                pReal->Release();
+        }
+
+    protected:
+        explicit MockUnknown(T* pRealObject) : pReal(pRealObject) {}
+
+        HRESULT GetInterface(REFIID riid, void** ppv, BOOL fSupported)
+        {
+            if (!ppv)
+                return E_POINTER;
+
+            *ppv = nullptr;
+            if (!fSupported && riid != __uuidof(IUnknown))
+            {
+                // While recording, the real object answers for the rest, unrecorded
+                return (pReal) ? pReal->QueryInterface(riid, ppv) : E_NOINTERFACE;
+            }
+
+            AddRef();
+            *ppv = static_cast<T*>(this);
+            return S_OK;
+        }
+
+        volatile LONG   cRef = 1;
+        T*              pReal;
+    };
+
+
+    //-----------------------------------------------------------------------------
+    // Name: MockOutput
+    // Desc: DXGI output that only answers its description and display modes
+    //-----------------------------------------------------------------------------
+    class MockOutput : public MockUnknown<IDXGIOutput>
+    {
+    public:
+        MockOutput(UINT i, UINT iOut, IDXGIOutput* pRealOutput) : MockUnknown(pRealOutput), iAdapter(i), iOutput(iOut) {}
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override
+        {
+            return GetInterface(riid, ppv, riid == __uuidof(IDXGIObject) || riid == __uuidof(IDXGIOutput));
+        }
+
+        HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*) override { return DXGI_ERROR_NOT_FOUND; }
+        HRESULT STDMETHODCALLTYPE GetParent(REFIID, void** ppParent) override
+        {
+            if (ppParent)
+                *ppParent = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetDesc(DXGI_OUTPUT_DESC* pDesc) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.output%u.GetDesc", iAdapter, iOutput);
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->GetDesc(pDesc);
+                Record(MC_GETDESC, qpcStart, szName, hr, pDesc, sizeof(DXGI_OUTPUT_DESC));
+                return hr;
+            }
+
+            Delay(MC_GETDESC);
+
+            if (!pDesc)
+                return E_INVALIDARG;
+
+            if (!Replay(szName, &hr, pDesc, sizeof(DXGI_OUTPUT_DESC)))
+            {
+                memset(pDesc, 0, sizeof(DXGI_OUTPUT_DESC));
+                hr = S_OK;
+            }
+
+            // The monitor handle was only good on the recording machine
+            pDesc->Monitor = nullptr;
+            return hr;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetDisplayModeList(DXGI_FORMAT format, UINT flags, UINT* pNumModes, DXGI_MODE_DESC* pDesc) override
+        {
+            if (!pNumModes)
+                return E_INVALIDARG;
+
+            // The count and the modes are answers of their own
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.output%u.GetDisplayModeList.%u.%x%s", iAdapter, iOutput,
+                static_cast<UINT>(format), flags, (pDesc) ? ".modes" : "");
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->GetDisplayModeList(format, flags, pNumModes, pDesc);
+                if (pDesc)
+                    Record(MC_GETDISPLAYMODELIST, qpcStart, szName, hr, pDesc, *pNumModes * sizeof(DXGI_MODE_DESC));
+                else
+                    Record(MC_GETDISPLAYMODELIST, qpcStart, szName, hr, pNumModes, sizeof(UINT));
+                return hr;
+            }
+
+            Delay(MC_GETDISPLAYMODELIST);
+
+            if (pDesc)
+            {
+                if (Replay(szName, &hr, pDesc, *pNumModes * sizeof(DXGI_MODE_DESC)))
+                    return hr;
+            }
+            else if (Replay(szName, &hr, pNumModes, sizeof(UINT)))
+            {
+                return hr;
+            }
+
+            *pNumModes = 0;
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE FindClosestMatchingMode(const DXGI_MODE_DESC*, DXGI_MODE_DESC*, IUnknown*) override { return DXGI_ERROR_UNSUPPORTED; }
+        HRESULT STDMETHODCALLTYPE WaitForVBlank() override { return DXGI_ERROR_UNSUPPORTED; }
+        HRESULT STDMETHODCALLTYPE TakeOwnership(IUnknown*, BOOL) override { return DXGI_ERROR_UNSUPPORTED; }
+        void STDMETHODCALLTYPE ReleaseOwnership() override {}
+        HRESULT STDMETHODCALLTYPE GetGammaControlCapabilities(DXGI_GAMMA_CONTROL_CAPABILITIES*) override { return DXGI_ERROR_UNSUPPORTED; }
+        HRESULT STDMETHODCALLTYPE SetGammaControl(const DXGI_GAMMA_CONTROL*) override { return DXGI_ERROR_UNSUPPORTED; }
+        HRESULT STDMETHODCALLTYPE GetGammaControl(DXGI_GAMMA_CONTROL*) override { return DXGI_ERROR_UNSUPPORTED; }
+        HRESULT STDMETHODCALLTYPE SetDisplaySurface(IDXGISurface*) override { return DXGI_ERROR_UNSUPPORTED; }
+        HRESULT STDMETHODCALLTYPE GetDisplaySurfaceData(IDXGISurface*) override { return DXGI_ERROR_UNSUPPORTED; }
+        HRESULT STDMETHODCALLTYPE GetFrameStatistics(DXGI_FRAME_STATISTICS*) override { return DXGI_ERROR_UNSUPPORTED; }
+
+    private:
+        UINT iAdapter;
+        UINT iOutput;
+    };
+
+
+    //-----------------------------------------------------------------------------
+    // Name: MockAdapter
+    // Desc: DXGI adapter, whose outputs are only known from a recording
+    //-----------------------------------------------------------------------------
+    class MockAdapter : public MockUnknown<IDXGIAdapter1>
+    {
+    public:
+        MockAdapter(UINT i, IDXGIAdapter1* pRealAdapter) : MockUnknown(pRealAdapter), iAdapter(i) {}
+
+        UINT Index() const { return iAdapter; }
+        IDXGIAdapter1* Real() const { return pReal; }
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override
+        {
+            return GetInterface(riid, ppv, riid == __uuidof(IDXGIObject)
+                || riid == __uuidof(IDXGIAdapter) || riid == __uuidof(IDXGIAdapter1));
+        }
+
+        HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*) override { return DXGI_ERROR_NOT_FOUND; }
+        HRESULT STDMETHODCALLTYPE GetParent(REFIID, void** ppParent) override
+        {
+            if (ppParent)
+                *ppParent = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        HRESULT STDMETHODCALLTYPE EnumOutputs(UINT iOutput, IDXGIOutput** ppOutput) override
+        {
+            if (!ppOutput)
+                return E_INVALIDARG;
+
+            *ppOutput = nullptr;
+
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.EnumOutputs.%u", iAdapter, iOutput);
+
+            HRESULT hr;
+            IDXGIOutput* pRealOutput = nullptr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->EnumOutputs(iOutput, &pRealOutput);
+                Record(MC_ENUMOUTPUTS, qpcStart, szName, hr, nullptr, 0);
+                if (FAILED(hr))
+                    return hr;
+            }
+            else
+            {
+                Delay(MC_ENUMOUTPUTS);
+
+                if (!Replay(szName, &hr, nullptr, 0))
+                    hr = DXGI_ERROR_NOT_FOUND;
+                if (FAILED(hr))
+                    return hr;
+            }
+
+            *ppOutput = new (std::nothrow) MockOutput(iAdapter, iOutput, pRealOutput);
+            if (!*ppOutput)
+            {
+                if (pRealOutput)
+                    pRealOutput->Release();
+                return E_OUTOFMEMORY;
+            }
+            return hr;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetDesc(DXGI_ADAPTER_DESC* pDesc) override
+        {
+            DXGI_ADAPTER_DESC1 desc1;
+            HRESULT hr = GetDesc1(&desc1);
+            if (SUCCEEDED(hr))
+                memcpy(pDesc, &desc1, sizeof(DXGI_ADAPTER_DESC));
+            return hr;
+        }
+
+        HRESULT STDMETHODCALLTYPE CheckInterfaceSupport(REFGUID guid, LARGE_INTEGER* pUMDVersion) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.CheckInterfaceSupport.%08lX", iAdapter, guid.Data1);
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->CheckInterfaceSupport(guid, pUMDVersion);
+                Record(MC_CHECKINTERFACESUPPORT, qpcStart, szName, hr, pUMDVersion, sizeof(LARGE_INTEGER));
+                return hr;
+            }
+
+            Delay(MC_CHECKINTERFACESUPPORT);
+
+            LARGE_INTEGER version;
+            if (Replay(szName, &hr, &version, sizeof(version)))
+            {
+                if (pUMDVersion)
+                    *pUMDVersion = version;
+                return hr;
+            }
+
+            const CHAR* strVersion = AdapterSetting(iAdapter, "umdversion");
+            if (!strVersion)
+                return DXGI_ERROR_UNSUPPORTED;
+
+            if (pUMDVersion)
+                pUMDVersion->QuadPart = static_cast<LONGLONG>(Number(strVersion));
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetDesc1(DXGI_ADAPTER_DESC1* pDesc) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.GetDesc1", iAdapter);
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->GetDesc1(pDesc);
+                Record(MC_GETDESC, qpcStart, szName, hr, pDesc, sizeof(DXGI_ADAPTER_DESC1));
+                return hr;
+            }
+
+            Delay(MC_GETDESC);
+
+            if (!pDesc)
+                return E_INVALIDARG;
+
+            if (Replay(szName, &hr, pDesc, sizeof(DXGI_ADAPTER_DESC1)))
+                return hr;
+
+            memset(pDesc, 0, sizeof(DXGI_ADAPTER_DESC1));
+
+            const CHAR* strDesc = AdapterSetting(iAdapter, "description");
+            if (strDesc)
+                MultiByteToWideChar(CP_ACP, 0, strDesc, -1, pDesc->Description, static_cast<int>(std::size(pDesc->Description) - 1));
+
+            pDesc->VendorId = static_cast<UINT>(Number(AdapterSetting(iAdapter, "vendorid")));
+            pDesc->DeviceId = static_cast<UINT>(Number(AdapterSetting(iAdapter, "deviceid")));
+            pDesc->SubSysId = static_cast<UINT>(Number(AdapterSetting(iAdapter, "subsysid")));
+            pDesc->Revision = static_cast<UINT>(Number(AdapterSetting(iAdapter, "revision")));
+            pDesc->DedicatedVideoMemory = static_cast<SIZE_T>(Number(AdapterSetting(iAdapter, "videomemory")));
+            pDesc->DedicatedSystemMemory = static_cast<SIZE_T>(Number(AdapterSetting(iAdapter, "systemmemory")));
+            pDesc->SharedSystemMemory = static_cast<SIZE_T>(Number(AdapterSetting(iAdapter, "sharedmemory")));
+            pDesc->AdapterLuid.LowPart = iAdapter + 1;
+            return S_OK;
+        }
+
+    private:
+        UINT iAdapter;
+    };
+
+
+    //-----------------------------------------------------------------------------
+    // Name: MockFactory
+    // Desc: DXGI 1.1 factory of the mock adapters
+    //-----------------------------------------------------------------------------
+    class MockFactory : public MockUnknown<IDXGIFactory1>
+    {
+    public:
+        explicit MockFactory(IDXGIFactory1* pRealFactory) : MockUnknown(pRealFactory) {}
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override
+        {
+            return GetInterface(riid, ppv, riid == __uuidof(IDXGIObject)
+                || riid == __uuidof(IDXGIFactory) || riid == __uuidof(IDXGIFactory1));
+        }
+
+        HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*) override { return DXGI_ERROR_NOT_FOUND; }
+        HRESULT STDMETHODCALLTYPE GetParent(REFIID, void** ppParent) override
+        {
+            if (ppParent)
+                *ppParent = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        HRESULT STDMETHODCALLTYPE EnumAdapters(UINT iAdapter, IDXGIAdapter** ppAdapter) override
+        {
+            IDXGIAdapter1* pAdapter1 = nullptr;
+            HRESULT hr = EnumAdapters1(iAdapter, &pAdapter1);
+            *ppAdapter = pAdapter1;
+            return hr;
+        }
+
+        HRESULT STDMETHODCALLTYPE MakeWindowAssociation(HWND, UINT) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE GetWindowAssociation(HWND* pWindowHandle) override
+        {
+            if (pWindowHandle)
+                *pWindowHandle = nullptr;
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE CreateSwapChain(IUnknown*, DXGI_SWAP_CHAIN_DESC*, IDXGISwapChain** ppSwapChain) override
+        {
+            if (ppSwapChain)
+                *ppSwapChain = nullptr;
+            return E_NOTIMPL;
+        }
+
+        HRESULT STDMETHODCALLTYPE CreateSoftwareAdapter(HMODULE, IDXGIAdapter** ppAdapter) override
+        {
+            if (ppAdapter)
+                *ppAdapter = nullptr;
+            return DXGI_ERROR_UNSUPPORTED;
+        }
+
+        HRESULT STDMETHODCALLTYPE EnumAdapters1(UINT iAdapter, IDXGIAdapter1** ppAdapter) override
+        {
+            if (!ppAdapter)
+                return E_INVALIDARG;
+
+            *ppAdapter = nullptr;
+
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "dxgi.EnumAdapters1.%u", iAdapter);
+
+            HRESULT hr;
+            IDXGIAdapter1* pRealAdapter = nullptr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->EnumAdapters1(iAdapter, &pRealAdapter);
+                Record(MC_ENUMADAPTERS, qpcStart, szName, hr, nullptr, 0);
+                if (FAILED(hr))
+                    return hr;
+            }
+            else
+            {
+                Delay(MC_ENUMADAPTERS);
+
+                if (!Replay(szName, &hr, nullptr, 0))
+                    hr = (iAdapter < AdapterCount()) ? S_OK : DXGI_ERROR_NOT_FOUND;
+                if (FAILED(hr))
+                    return hr;
+            }
+
+            *ppAdapter = new (std::nothrow) MockAdapter(iAdapter, pRealAdapter);
+            if (!*ppAdapter)
+            {
+                if (pRealAdapter)
+                    pRealAdapter->Release();
+                return E_OUTOFMEMORY;
+            }
+            return hr;
+        }
+
+        BOOL STDMETHODCALLTYPE IsCurrent() override { return (pReal) ? pReal->IsCurrent() : TRUE; }
+    };
+
+
+    //-----------------------------------------------------------------------------
+    // Name: MockDevice11
+    // Desc: Direct3D 11 device that only answers capability queries
+    //-----------------------------------------------------------------------------
+    class MockDevice11 : public MockUnknown<ID3D11Device>
+    {
+    public:
+        MockDevice11(UINT i, D3D_FEATURE_LEVEL fl, ID3D11Device* pRealDevice) : MockUnknown(pRealDevice), iAdapter(i), featureLevel(fl) {}
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override
+        {
+            return GetInterface(riid, ppv, riid == __uuidof(ID3D11Device));
+        }
+
+        HRESULT STDMETHODCALLTYPE CreateBuffer(const D3D11_BUFFER_DESC*, const D3D11_SUBRESOURCE_DATA*, ID3D11Buffer**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateTexture1D(const D3D11_TEXTURE1D_DESC*, const D3D11_SUBRESOURCE_DATA*, ID3D11Texture1D**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateTexture2D(const D3D11_TEXTURE2D_DESC*, const D3D11_SUBRESOURCE_DATA*, ID3D11Texture2D**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateTexture3D(const D3D11_TEXTURE3D_DESC*, const D3D11_SUBRESOURCE_DATA*, ID3D11Texture3D**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateShaderResourceView(ID3D11Resource*, const D3D11_SHADER_RESOURCE_VIEW_DESC*, ID3D11ShaderResourceView**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateUnorderedAccessView(ID3D11Resource*, const D3D11_UNORDERED_ACCESS_VIEW_DESC*, ID3D11UnorderedAccessView**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateRenderTargetView(ID3D11Resource*, const D3D11_RENDER_TARGET_VIEW_DESC*, ID3D11RenderTargetView**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateDepthStencilView(ID3D11Resource*, const D3D11_DEPTH_STENCIL_VIEW_DESC*, ID3D11DepthStencilView**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC*, UINT, const void*, SIZE_T, ID3D11InputLayout**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateVertexShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11VertexShader**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateGeometryShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11GeometryShader**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateGeometryShaderWithStreamOutput(const void*, SIZE_T, const D3D11_SO_DECLARATION_ENTRY*, UINT,
+            const UINT*, UINT, UINT, ID3D11ClassLinkage*, ID3D11GeometryShader**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreatePixelShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11PixelShader**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateHullShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11HullShader**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateDomainShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11DomainShader**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateComputeShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11ComputeShader**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateClassLinkage(ID3D11ClassLinkage**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateBlendState(const D3D11_BLEND_DESC*, ID3D11BlendState**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC*, ID3D11DepthStencilState**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateRasterizerState(const D3D11_RASTERIZER_DESC*, ID3D11RasterizerState**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateSamplerState(const D3D11_SAMPLER_DESC*, ID3D11SamplerState**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateQuery(const D3D11_QUERY_DESC*, ID3D11Query**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreatePredicate(const D3D11_QUERY_DESC*, ID3D11Predicate**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateCounter(const D3D11_COUNTER_DESC*, ID3D11Counter**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CreateDeferredContext(UINT, ID3D11DeviceContext**) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE OpenSharedResource(HANDLE, REFIID, void**) override { return E_NOTIMPL; }
+
+        HRESULT STDMETHODCALLTYPE CheckFormatSupport(DXGI_FORMAT format, UINT* pFormatSupport) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.d3d11.CheckFormatSupport.%u", iAdapter, static_cast<UINT>(format));
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->CheckFormatSupport(format, pFormatSupport);
+                Record(MC_CHECKFORMATSUPPORT, qpcStart, szName, hr, pFormatSupport, sizeof(UINT));
+                return hr;
+            }
+
+            Delay(MC_CHECKFORMATSUPPORT);
+
+            if (!pFormatSupport)
+                return E_INVALIDARG;
+
+            if (Replay(szName, &hr, pFormatSupport, sizeof(UINT)))
+                return hr;
+
+            const CHAR* strSupport = AdapterSetting(iAdapter, "d3d11.format.%u", static_cast<UINT>(format));
+            *pFormatSupport = static_cast<UINT>(Number(strSupport));
+            return (strSupport) ? S_OK : E_FAIL;
+        }
+
+        HRESULT STDMETHODCALLTYPE CheckMultisampleQualityLevels(DXGI_FORMAT format, UINT sampleCount, UINT* pNumQualityLevels) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.d3d11.CheckMultisampleQualityLevels.%u.%u", iAdapter, static_cast<UINT>(format), sampleCount);
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->CheckMultisampleQualityLevels(format, sampleCount, pNumQualityLevels);
+                Record(MC_CHECKMULTISAMPLEQUALITYLEVELS, qpcStart, szName, hr, pNumQualityLevels, sizeof(UINT));
+                return hr;
+            }
+
+            Delay(MC_CHECKMULTISAMPLEQUALITYLEVELS);
+
+            if (!pNumQualityLevels)
+                return E_INVALIDARG;
+
+            if (Replay(szName, &hr, pNumQualityLevels, sizeof(UINT)))
+                return hr;
+
+            UINT support = static_cast<UINT>(Number(AdapterSetting(iAdapter, "d3d11.format.%u", static_cast<UINT>(format))));
+            UINT maxSamples = static_cast<UINT>(Number(AdapterSetting(iAdapter, "d3d11.msaa"), 1));
+            *pNumQualityLevels = ((support & D3D11_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET) && sampleCount <= maxSamples) ? 1u : 0u;
+            return S_OK;
+        }
+
+        void STDMETHODCALLTYPE CheckCounterInfo(D3D11_COUNTER_INFO* pCounterInfo) override
+        {
+            if (pCounterInfo)
+                memset(pCounterInfo, 0, sizeof(D3D11_COUNTER_INFO));
+        }
+
+        HRESULT STDMETHODCALLTYPE CheckCounter(const D3D11_COUNTER_DESC*, D3D11_COUNTER_TYPE*, UINT*,
+            LPSTR, UINT*, LPSTR, UINT*, LPSTR, UINT*) override { return E_INVALIDARG; }
+
+        HRESULT STDMETHODCALLTYPE CheckFeatureSupport(D3D11_FEATURE feature, void* pFeatureSupportData, UINT featureSupportDataSize) override
+        {
+            if (!pFeatureSupportData)
+                return E_INVALIDARG;
+
+            // Some queries have inputs, e.g. the format, so those are part of the name
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.d3d11.CheckFeatureSupport.%u.%u.%08lX", iAdapter, static_cast<UINT>(feature),
+                featureSupportDataSize, static_cast<unsigned long>(HashBytes(pFeatureSupportData, featureSupportDataSize)));
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->CheckFeatureSupport(feature, pFeatureSupportData, featureSupportDataSize);
+                Record(MC_CHECKFEATURESUPPORT, qpcStart, szName, hr, pFeatureSupportData, featureSupportDataSize);
+                return hr;
+            }
+
+            Delay(MC_CHECKFEATURESUPPORT);
+
+            if (Replay(szName, &hr, pFeatureSupportData, featureSupportDataSize))
+                return hr;
+
+            // The format queries are answered per format
+            if (feature == D3D11_FEATURE_FORMAT_SUPPORT && featureSupportDataSize == sizeof(D3D11_FEATURE_DATA_FORMAT_SUPPORT))
+            {
+                auto pData = static_cast<D3D11_FEATURE_DATA_FORMAT_SUPPORT*>(pFeatureSupportData);
+                return CheckFormatSupport(pData->InFormat, &pData->OutFormatSupport);
+            }
+
+            if (feature == D3D11_FEATURE_FORMAT_SUPPORT2 && featureSupportDataSize == sizeof(D3D11_FEATURE_DATA_FORMAT_SUPPORT2))
+            {
+                auto pData = static_cast<D3D11_FEATURE_DATA_FORMAT_SUPPORT2*>(pFeatureSupportData);
+                pData->OutFormatSupport2 = static_cast<UINT>(Number(AdapterSetting(iAdapter, "d3d11.format2.%u", static_cast<UINT>(pData->InFormat))));
+                return S_OK;
+            }
+
+            const CHAR* strData = AdapterSetting(iAdapter, "d3d11.feature.%u", static_cast<UINT>(feature));
+            if (!strData)
+                return E_INVALIDARG;
+
+            Bytes(strData, pFeatureSupportData, featureSupportDataSize);
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*) override { return DXGI_ERROR_NOT_FOUND; }
+        HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override { return E_NOTIMPL; }
+        D3D_FEATURE_LEVEL STDMETHODCALLTYPE GetFeatureLevel() override { return featureLevel; }
+        UINT STDMETHODCALLTYPE GetCreationFlags() override { return 0; }
+        HRESULT STDMETHODCALLTYPE GetDeviceRemovedReason() override { return S_OK; }
+        void STDMETHODCALLTYPE GetImmediateContext(ID3D11DeviceContext** ppImmediateContext) override
+        {
+            if (pReal)
+                pReal->GetImmediateContext(ppImmediateContext);
+            else if (ppImmediateContext)
+                *ppImmediateContext = nullptr;
+        }
+        HRESULT STDMETHODCALLTYPE SetExceptionMode(UINT) override { return S_OK; }
+        UINT STDMETHODCALLTYPE GetExceptionMode() override { return 0; }
+
+    private:
+        UINT                iAdapter;
+        D3D_FEATURE_LEVEL   featureLevel;
+    };
+
+
+    //-----------------------------------------------------------------------------
+    // Name: MockD3D9
+    // Desc: Direct3D 9 with a HAL device per mock adapter
+    //-----------------------------------------------------------------------------
+    class MockD3D9 : public MockUnknown<IDirect3D9>
+    {
+    public:
+        explicit MockD3D9(IDirect3D9* pRealD3D) : MockUnknown(pRealD3D) {}
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override
+        {
+            return GetInterface(riid, ppv, riid == IID_IDirect3D9);
+        }
+
+        HRESULT STDMETHODCALLTYPE RegisterSoftwareDevice(void*) override { return D3DERR_INVALIDCALL; }
+
+        UINT STDMETHODCALLTYPE GetAdapterCount() override
+        {
+            HRESULT hr;
+            UINT cAdapters = 0;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                cAdapters = pReal->GetAdapterCount();
+                Record(MC_GETADAPTERCOUNT, qpcStart, "d3d9.GetAdapterCount", S_OK, &cAdapters, sizeof(cAdapters));
+                return cAdapters;
+            }
+
+            Delay(MC_GETADAPTERCOUNT);
+
+            return (Replay("d3d9.GetAdapterCount", &hr, &cAdapters, sizeof(cAdapters))) ? cAdapters : AdapterCount();
+        }
+
+        HRESULT STDMETHODCALLTYPE GetAdapterIdentifier(UINT iAdapter, DWORD flags, D3DADAPTER_IDENTIFIER9* pIdentifier) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.d3d9.GetAdapterIdentifier.%lu", iAdapter, flags);
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->GetAdapterIdentifier(iAdapter, flags, pIdentifier);
+                Record(MC_GETADAPTERIDENTIFIER, qpcStart, szName, hr, pIdentifier, sizeof(D3DADAPTER_IDENTIFIER9));
+                return hr;
+            }
+
+            Delay(MC_GETADAPTERIDENTIFIER);
+
+            if (!pIdentifier)
+                return D3DERR_INVALIDCALL;
+
+            if (Replay(szName, &hr, pIdentifier, sizeof(D3DADAPTER_IDENTIFIER9)))
+                return hr;
+
+            if (iAdapter >= AdapterCount())
+                return D3DERR_INVALIDCALL;
+
+            memset(pIdentifier, 0, sizeof(D3DADAPTER_IDENTIFIER9));
+
+            const CHAR* strDesc = AdapterSetting(iAdapter, "description");
+            if (strDesc)
+                strncpy_s(pIdentifier->Description, strDesc, _TRUNCATE);
+
+            pIdentifier->DriverVersion.QuadPart = static_cast<LONGLONG>(Number(AdapterSetting(iAdapter, "umdversion")));
+            pIdentifier->VendorId = static_cast<DWORD>(Number(AdapterSetting(iAdapter, "vendorid")));
+            pIdentifier->DeviceId = static_cast<DWORD>(Number(AdapterSetting(iAdapter, "deviceid")));
+            pIdentifier->SubSysId = static_cast<DWORD>(Number(AdapterSetting(iAdapter, "subsysid")));
+            pIdentifier->Revision = static_cast<DWORD>(Number(AdapterSetting(iAdapter, "revision")));
+            return S_OK;
+        }
+
+        UINT STDMETHODCALLTYPE GetAdapterModeCount(UINT iAdapter, D3DFORMAT format) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.d3d9.GetAdapterModeCount.%u", iAdapter, static_cast<UINT>(format));
+
+            HRESULT hr;
+            UINT cModes = 0;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                cModes = pReal->GetAdapterModeCount(iAdapter, format);
+                Record(MC_GETADAPTERMODECOUNT, qpcStart, szName, S_OK, &cModes, sizeof(cModes));
+                return cModes;
+            }
+
+            Delay(MC_GETADAPTERMODECOUNT);
+
+            if (Replay(szName, &hr, &cModes, sizeof(cModes)))
+                return cModes;
+
+            D3DDISPLAYMODE mode;
+            while (GetMode(iAdapter, cModes, &mode) && mode.Format == format)
+                ++cModes;
+            return cModes;
+        }
+
+        HRESULT STDMETHODCALLTYPE EnumAdapterModes(UINT iAdapter, D3DFORMAT format, UINT iMode, D3DDISPLAYMODE* pMode) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.d3d9.EnumAdapterModes.%u.%u", iAdapter, static_cast<UINT>(format), iMode);
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->EnumAdapterModes(iAdapter, format, iMode, pMode);
+                Record(MC_ENUMADAPTERMODES, qpcStart, szName, hr, pMode, sizeof(D3DDISPLAYMODE));
+                return hr;
+            }
+
+            Delay(MC_ENUMADAPTERMODES);
+
+            if (!pMode)
+                return D3DERR_INVALIDCALL;
+
+            if (Replay(szName, &hr, pMode, sizeof(D3DDISPLAYMODE)))
+                return hr;
+
+            if (!GetMode(iAdapter, iMode, pMode) || pMode->Format != format)
+                return D3DERR_INVALIDCALL;
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetAdapterDisplayMode(UINT iAdapter, D3DDISPLAYMODE* pMode) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.d3d9.GetAdapterDisplayMode", iAdapter);
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->GetAdapterDisplayMode(iAdapter, pMode);
+                Record(MC_GETADAPTERDISPLAYMODE, qpcStart, szName, hr, pMode, sizeof(D3DDISPLAYMODE));
+                return hr;
+            }
+
+            Delay(MC_GETADAPTERDISPLAYMODE);
+
+            if (!pMode)
+                return D3DERR_INVALIDCALL;
+
+            if (Replay(szName, &hr, pMode, sizeof(D3DDISPLAYMODE)))
+                return hr;
+
+            return (GetMode(iAdapter, 0, pMode)) ? S_OK : D3DERR_INVALIDCALL;
+        }
+
+        HRESULT STDMETHODCALLTYPE CheckDeviceType(UINT iAdapter, D3DDEVTYPE devType, D3DFORMAT fmtAdapter,
+            D3DFORMAT fmtBackBuffer, BOOL bWindowed) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.d3d9.CheckDeviceType.%u.%u.%u.%d", iAdapter, static_cast<UINT>(devType),
+                static_cast<UINT>(fmtAdapter), static_cast<UINT>(fmtBackBuffer), bWindowed);
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->CheckDeviceType(iAdapter, devType, fmtAdapter, fmtBackBuffer, bWindowed);
+                Record(MC_CHECKDEVICETYPE, qpcStart, szName, hr, nullptr, 0);
+                return hr;
+            }
+
+            Delay(MC_CHECKDEVICETYPE);
+
+            if (Replay(szName, &hr, nullptr, 0))
+                return hr;
+
+            if (!IsAdapterFormat9(iAdapter, devType, fmtAdapter))
+                return D3DERR_NOTAVAILABLE;
+
+            // Back buffers of the display format, or of one with alpha
+            return (fmtBackBuffer == fmtAdapter
+                || (fmtAdapter == D3DFMT_X8R8G8B8 && fmtBackBuffer == D3DFMT_A8R8G8B8)
+                || (fmtAdapter == D3DFMT_X1R5G5B5 && fmtBackBuffer == D3DFMT_A1R5G5B5))
+                ? S_OK : D3DERR_NOTAVAILABLE;
+        }
+
+        HRESULT STDMETHODCALLTYPE CheckDeviceFormat(UINT iAdapter, D3DDEVTYPE devType, D3DFORMAT fmtAdapter, DWORD usage,
+            D3DRESOURCETYPE rType, D3DFORMAT fmtCheck) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.d3d9.CheckDeviceFormat.%u.%u.%lu.%u.%u", iAdapter, static_cast<UINT>(devType),
+                static_cast<UINT>(fmtAdapter), usage, static_cast<UINT>(rType), static_cast<UINT>(fmtCheck));
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->CheckDeviceFormat(iAdapter, devType, fmtAdapter, usage, rType, fmtCheck);
+                Record(MC_CHECKDEVICEFORMAT, qpcStart, szName, hr, nullptr, 0);
+                return hr;
+            }
+
+            Delay(MC_CHECKDEVICEFORMAT);
+
+            if (Replay(szName, &hr, nullptr, 0))
+                return hr;
+
+            if (!IsAdapterFormat9(iAdapter, devType, fmtAdapter))
+                return D3DERR_NOTAVAILABLE;
+
+            const CHAR* strUsage = AdapterSetting(iAdapter, "d3d9.format.%u", static_cast<UINT>(fmtCheck));
+            if (!strUsage)
+                return D3DERR_NOTAVAILABLE;
+
+            return ((usage & ~static_cast<DWORD>(Number(strUsage))) == 0) ? S_OK : D3DERR_NOTAVAILABLE;
+        }
+
+        HRESULT STDMETHODCALLTYPE CheckDeviceMultiSampleType(UINT iAdapter, D3DDEVTYPE devType, D3DFORMAT fmtSurface, BOOL bWindowed,
+            D3DMULTISAMPLE_TYPE msType, DWORD* pQualityLevels) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.d3d9.CheckDeviceMultiSampleType.%u.%u.%d.%u", iAdapter, static_cast<UINT>(devType),
+                static_cast<UINT>(fmtSurface), bWindowed, static_cast<UINT>(msType));
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->CheckDeviceMultiSampleType(iAdapter, devType, fmtSurface, bWindowed, msType, pQualityLevels);
+                Record(MC_CHECKDEVICEMULTISAMPLETYPE, qpcStart, szName, hr, pQualityLevels, sizeof(DWORD));
+                return hr;
+            }
+
+            Delay(MC_CHECKDEVICEMULTISAMPLETYPE);
+
+            DWORD qualityLevels = 0;
+            if (Replay(szName, &hr, &qualityLevels, sizeof(qualityLevels)))
+            {
+                if (pQualityLevels)
+                    *pQualityLevels = qualityLevels;
+                return hr;
+            }
+
+            if (pQualityLevels)
+                *pQualityLevels = 0;
+
+            if (iAdapter >= AdapterCount() || devType != D3DDEVTYPE_HAL
+                || static_cast<ULONGLONG>(msType) > Number(AdapterSetting(iAdapter, "d3d9.msaa")))
+                return D3DERR_NOTAVAILABLE;
+
+            if (pQualityLevels)
+                *pQualityLevels = 1;
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE CheckDepthStencilMatch(UINT iAdapter, D3DDEVTYPE devType, D3DFORMAT fmtAdapter,
+            D3DFORMAT fmtRender, D3DFORMAT fmtDS) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.d3d9.CheckDepthStencilMatch.%u.%u.%u.%u", iAdapter, static_cast<UINT>(devType),
+                static_cast<UINT>(fmtAdapter), static_cast<UINT>(fmtRender), static_cast<UINT>(fmtDS));
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->CheckDepthStencilMatch(iAdapter, devType, fmtAdapter, fmtRender, fmtDS);
+                Record(MC_CHECKDEPTHSTENCILMATCH, qpcStart, szName, hr, nullptr, 0);
+                return hr;
+            }
+
+            Delay(MC_CHECKDEPTHSTENCILMATCH);
+
+            if (Replay(szName, &hr, nullptr, 0))
+                return hr;
+
+            return (IsAdapterFormat9(iAdapter, devType, fmtAdapter)) ? S_OK : D3DERR_NOTAVAILABLE;
+        }
+
+        HRESULT STDMETHODCALLTYPE CheckDeviceFormatConversion(UINT iAdapter, D3DDEVTYPE devType, D3DFORMAT fmtSource,
+            D3DFORMAT fmtTarget) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.d3d9.CheckDeviceFormatConversion.%u.%u.%u", iAdapter, static_cast<UINT>(devType),
+                static_cast<UINT>(fmtSource), static_cast<UINT>(fmtTarget));
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->CheckDeviceFormatConversion(iAdapter, devType, fmtSource, fmtTarget);
+                Record(MC_CHECKDEVICEFORMATCONVERSION, qpcStart, szName, hr, nullptr, 0);
+                return hr;
+            }
+
+            Delay(MC_CHECKDEVICEFORMATCONVERSION);
+
+            return (Replay(szName, &hr, nullptr, 0)) ? hr : D3DERR_NOTAVAILABLE;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetDeviceCaps(UINT iAdapter, D3DDEVTYPE devType, D3DCAPS9* pCaps) override
+        {
+            CHAR szName[c_cchMockName];
+            sprintf_s(szName, "adapter%u.d3d9.GetDeviceCaps.%u", iAdapter, static_cast<UINT>(devType));
+
+            HRESULT hr;
+            if (pReal)
+            {
+                LONGLONG qpcStart = TraceNow();
+                hr = pReal->GetDeviceCaps(iAdapter, devType, pCaps);
+                Record(MC_GETDEVICECAPS, qpcStart, szName, hr, pCaps, sizeof(D3DCAPS9));
+                return hr;
+            }
+
+            Delay(MC_GETDEVICECAPS);
+
+            if (!pCaps)
+                return D3DERR_INVALIDCALL;
+
+            if (Replay(szName, &hr, pCaps, sizeof(D3DCAPS9)))
+                return hr;
+
+            if (iAdapter >= AdapterCount() || devType != D3DDEVTYPE_HAL)
+                return D3DERR_NOTAVAILABLE;
+
+            const CHAR* strCaps = AdapterSetting(iAdapter, "d3d9.caps");
+            Bytes((strCaps) ? strCaps : "", pCaps, sizeof(D3DCAPS9));
+            pCaps->DeviceType = devType;
+            pCaps->AdapterOrdinal = iAdapter;
+            return S_OK;
+        }
+
+        HMONITOR STDMETHODCALLTYPE GetAdapterMonitor(UINT iAdapter) override
+        {
+            return (pReal) ? pReal->GetAdapterMonitor(iAdapter) : nullptr;
+        }
+
+        HRESULT STDMETHODCALLTYPE CreateDevice(UINT, D3DDEVTYPE, HWND, DWORD, D3DPRESENT_PARAMETERS*,
+            IDirect3DDevice9** ppReturnedDeviceInterface) override
+        {
+            if (ppReturnedDeviceInterface)
+                *ppReturnedDeviceInterface = nullptr;
+            return D3DERR_NOTAVAILABLE;
+        }
+    };
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: MockStart()
+// Desc: Loads the mock devices from szPath. Call before the DirectX
+//       components are initialized.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+BOOL MockStart(LPCSTR szPath)
+{
+    if (s_pMock || s_pRecorder)
+        return FALSE;
+
+    HANDLE hFile = CreateFile(szPath, GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    LARGE_INTEGER fileSize = {};
+    DWORD cbRead = 0;
+    CHAR* pText = nullptr;
+    if (GetFileSizeEx(hFile, &fileSize) && fileSize.HighPart == 0 && fileSize.LowPart < MAXDWORD)
+    {
+        pText = new (std::nothrow) CHAR[fileSize.LowPart + 1];
+        if (pText && !ReadFile(hFile, pText, fileSize.LowPart, &cbRead, nullptr))
+            cbRead = 0;
+    }
+    CloseHandle(hFile);
+
+    auto pMock = new (std::nothrow) MOCKDATA{};
+    if (!pText || !pMock || cbRead != fileSize.LowPart)
+    {
+        delete[] pText;
+        delete pMock;
+        return FALSE;
+    }
+    pText[cbRead] = '\0';
+
+    // Snapshots of the mock devices are cached like those of real ones, and
+    // must not be reused once the file changes
+    CacheKeyAdd(pText, cbRead);
+
+    DWORD cLines = 1;
+    for (DWORD i = 0; i < cbRead; ++i)
+        cLines += (pText[i] == '\n') ? 1u : 0u;
+
+    pMock->pText = pText;
+    pMock->cSlots = 16;
+    while (pMock->cSlots < cLines * 2)
+        pMock->cSlots *= 2;
+    pMock->pEntries = new (std::nothrow) MOCKENTRY[pMock->cSlots]();
+    if (!pMock->pEntries)
+    {
+        delete[] pText;
+        delete pMock;
+        return FALSE;
+    }
+
+    // Split each "name = value" line in place
+    DWORD mask = pMock->cSlots - 1;
+    for (CHAR* pch = pText; *pch; )
+    {
+        CHAR* pLine = pch;
+        while (*pch && *pch != '\n')
+            ++pch;
+        if (*pch)
+            *pch++ = '\0';
+
+        CHAR* pComment = strchr(pLine, '#');
+        if (pComment)
+            *pComment = '\0';
+
+        CHAR* pEqual = strchr(pLine, '=');
+        if (!pEqual)
+            continue;
+        *pEqual = '\0';
+
+        CHAR* strName = pLine;
+        CHAR* strValue = pEqual + 1;
+        while (*strName == ' ' || *strName == '\t')
+            ++strName;
+        while (*strValue == ' ' || *strValue == '\t')
+            ++strValue;
+
+        for (CHAR* str : { strName, strValue })
+        {
+            size_t cch = strlen(str);
+            while (cch > 0 && (str[cch - 1] == ' ' || str[cch - 1] == '\t' || str[cch - 1] == '\r'))
+                str[--cch] = '\0';
+        }
+
+        if (!*strName)
+            continue;
+
+        // Names of formats are replaced by their numbers, which are shorter
+        CHAR* pFormat = strstr(strName, ".DXGI_FORMAT_");
+        if (pFormat)
+        {
+            CHAR* strFormat = pFormat + 1;
+            CHAR* pRest = strchr(strFormat, '.');
+            if (!pRest)
+                pRest = strFormat + strlen(strFormat);
+
+            CHAR chRest = *pRest;
+            *pRest = '\0';
+            DXGI_FORMAT fmt = FindFormat(strFormat);
+            *pRest = chRest;
+
+            if (fmt != DXGI_FORMAT_UNKNOWN)
+            {
+                CHAR szFormat[16];
+                int cch = sprintf_s(szFormat, "%u", static_cast<UINT>(fmt));
+                memcpy(strFormat, szFormat, static_cast<size_t>(cch));
+                memmove(strFormat + cch, pRest, strlen(pRest) + 1);
+            }
+        }
+
+        // A later setting of the same name wins
+        DWORD dwHash = HashName(strName);
+        DWORD i = dwHash & mask;
+        while (pMock->pEntries[i].strName
+            && (pMock->pEntries[i].dwHash != dwHash || strcmp(pMock->pEntries[i].strName, strName) != 0))
+            i = (i + 1) & mask;
+
+        pMock->pEntries[i] = { dwHash, strName, strValue };
+    }
+
+    s_pMock = pMock;
+
+    LARGE_INTEGER freq = {};
+    QueryPerformanceFrequency(&freq);
+    ULONGLONG usLatency = Number(FindSetting("latency"));
+    for (UINT call = 0; call < MC_COUNT; ++call)
+    {
+        CHAR szSetting[c_cchMockName];
+        sprintf_s(szSetting, "latency.%s", c_strMockCalls[call]);
+        ULONGLONG us = Number(FindSetting(szSetting), usLatency);
+        s_pMock->qpcLatency[call] = static_cast<LONGLONG>(us) * freq.QuadPart / 1000000;
+    }
+
+    return TRUE;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: MockRecordStart()
+// Desc: Loads the DirectX runtimes whose queries are to be recorded. Call
+//       before the DirectX components are initialized.
+//-----------------------------------------------------------------------------
+BOOL MockRecordStart()
+{
+    if (s_pMock || s_pRecorder)
+        return FALSE;
+
+    auto pRecorder = new (std::nothrow) RECORDER{};
+    if (!pRecorder)
+        return FALSE;
+
+    pRecorder->cSlots = 4096;
+    pRecorder->pEntries = new (std::nothrow) RECORDENTRY[pRecorder->cSlots]();
+    if (!pRecorder->pEntries)
+    {
+        delete pRecorder;
+        return FALSE;
+    }
+    InitializeSRWLock(&pRecorder->lock);
+
+    pRecorder->hDXGI = LoadLibraryEx("dxgi.dll", nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
+    if (pRecorder->hDXGI)
+        pRecorder->pfnCreateDXGIFactory1 = reinterpret_cast<LPCREATEDXGIFACTORY1>(GetProcAddress(pRecorder->hDXGI, "CreateDXGIFactory1"));
+
+    // Direct3D 10.x isn't recorded, but has to be handed the real adapters
+    pRecorder->hD3D10_1 = LoadLibraryEx("d3d10_1.dll", nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
+    if (pRecorder->hD3D10_1)
+        pRecorder->pfnD3D10CreateDevice1 = reinterpret_cast<PFN_D3D10_CREATE_DEVICE1>(GetProcAddress(pRecorder->hD3D10_1, "D3D10CreateDevice1"));
+
+    pRecorder->hD3D10 = LoadLibraryEx("d3d10.dll", nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
+    if (pRecorder->hD3D10)
+        pRecorder->pfnD3D10CreateDevice = reinterpret_cast<LPD3D10CREATEDEVICE>(GetProcAddress(pRecorder->hD3D10, "D3D10CreateDevice"));
+
+    pRecorder->hD3D11 = LoadLibraryEx("d3d11.dll", nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
+    if (pRecorder->hD3D11)
+        pRecorder->pfnD3D11CreateDevice = reinterpret_cast<PFN_D3D11_CREATE_DEVICE>(GetProcAddress(pRecorder->hD3D11, "D3D11CreateDevice"));
+
+    pRecorder->hD3D9 = LoadLibraryEx("d3d9.dll", nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
+    if (pRecorder->hD3D9)
+        pRecorder->pfnDirect3DCreate9 = reinterpret_cast<LPDIRECT3D9CREATE9>(GetProcAddress(pRecorder->hD3D9, "Direct3DCreate9"));
+
+    s_pRecorder = pRecorder;
+    return TRUE;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: MockRecordWrite()
+// Desc: Writes the recorded answers, sorted by name, and the average time of
+//       each call to szPath, in the format MockStart() reads
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+BOOL MockRecordWrite(LPCSTR szPath)
+{
+    if (!s_pRecorder)
+        return FALSE;
+
+    AcquireSRWLockExclusive(&s_pRecorder->lock);
+
+    auto pstrEntries = new (std::nothrow) const CHAR*[s_pRecorder->cEntries + 1];
+    auto pSink = new (std::nothrow) OUTPUTSINK;
+    HANDLE hFile = INVALID_HANDLE_VALUE;
+    if (pstrEntries && pSink)
+    {
+        hFile = CreateFile(szPath, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    }
+
+    BOOL fOK = FALSE;
+    if (hFile != INVALID_HANDLE_VALUE)
+    {
+        SinkInitFile(pSink, hFile);
+
+        static const CHAR c_szHeader[] = "# Driver query answers recorded with --record, replay with --mock\r\n";
+        SinkWrite(pSink, c_szHeader, strlen(c_szHeader));
+
+        LARGE_INTEGER freq = {};
+        QueryPerformanceFrequency(&freq);
+        for (UINT call = 0; call < MC_COUNT; ++call)
+        {
+            LONG cCalls = s_pRecorder->cCalls[call];
+            if (cCalls <= 0 || freq.QuadPart <= 0)
+                continue;
+
+            double us = static_cast<double>(s_pRecorder->qpcCalls[call]) * 1000000.0
+                / static_cast<double>(freq.QuadPart) / static_cast<double>(cCalls);
+
+            CHAR szLine[c_cchMockName];
+            int cch = sprintf_s(szLine, "latency.%s = %lu\r\n", c_strMockCalls[call], static_cast<unsigned long>(us + 0.5));
+            if (cch > 0)
+                SinkWrite(pSink, szLine, static_cast<size_t>(cch));
+        }
+
+        DWORD cEntries = 0;
+        for (DWORD i = 0; i < s_pRecorder->cSlots; ++i)
+        {
+            if (s_pRecorder->pEntries[i].str)
+                pstrEntries[cEntries++] = s_pRecorder->pEntries[i].str;
+        }
+        qsort(pstrEntries, cEntries, sizeof(const CHAR*), CompareRecordEntries);
+
+        for (DWORD i = 0; i < cEntries; ++i)
+        {
+            const CHAR* strName = pstrEntries[i];
+            size_t cchName = strlen(strName);
+            const CHAR* strValue = strName + cchName + 1;
+
+            SinkWrite(pSink, strName, cchName);
+            SinkWrite(pSink, " = ", 3);
+            SinkWrite(pSink, strValue, strlen(strValue));
+            SinkWrite(pSink, "\r\n", 2);
+        }
+
+        fOK = SinkFlush(pSink);
+        CloseHandle(hFile);
+
+        if (!fOK)
+            DeleteFile(szPath);
+    }
+
+    ReleaseSRWLockExclusive(&s_pRecorder->lock);
+
+    delete pSink;
+    delete[] pstrEntries;
+    return fOK;
+}
+
+
+//-----------------------------------------------------------------------------
+BOOL MockIsActive()
+{
+    return s_pMock != nullptr || s_pRecorder != nullptr;
+}
+
+
+//-----------------------------------------------------------------------------
+BOOL MockIsRecording()
+{
+    return s_pRecorder != nullptr;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: MockStop()
+// Desc: Frees the settings or the recording, and unloads the recorded
+//       runtimes. Call once the mock objects have been released.
+//-----------------------------------------------------------------------------
+VOID MockStop()
+{
+    if (s_pMock)
+    {
+        delete[] s_pMock->pEntries;
+        delete[] s_pMock->pText;
+        delete s_pMock;
+        s_pMock = nullptr;
+    }
+
+    if (s_pRecorder)
+    {
+        for (DWORD i = 0; i < s_pRecorder->cSlots; ++i)
+            delete[] s_pRecorder->pEntries[i].str;
+        delete[] s_pRecorder->pEntries;
+
+        for (HMODULE hModule : { s_pRecorder->hDXGI, s_pRecorder->hD3D10, s_pRecorder->hD3D10_1, s_pRecorder->hD3D11, s_pRecorder->hD3D9 })
+        {
+            if (hModule)
+                FreeLibrary(hModule);
+        }
+
+        delete s_pRecorder;
+        s_pRecorder = nullptr;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: MockCreateDXGIFactory1()
+// Desc: Stands in for CreateDXGIFactory1
+//-----------------------------------------------------------------------------
+HRESULT WINAPI MockCreateDXGIFactory1(REFIID riid, void** ppFactory)
+{
+    if (!ppFactory)
+        return E_INVALIDARG;
+
+    *ppFactory = nullptr;
+    if (!MockIsActive())
+        return DXGI_ERROR_UNSUPPORTED;
+
+    IDXGIFactory1* pRealFactory = nullptr;
+    if (s_pRecorder)
+    {
+        if (!s_pRecorder->pfnCreateDXGIFactory1)
+            return DXGI_ERROR_UNSUPPORTED;
+
+        HRESULT hr = s_pRecorder->pfnCreateDXGIFactory1(IID_PPV_ARGS(&pRealFactory));
+        if (FAILED(hr))
+            return hr;
+    }
+
+    auto pFactory = new (std::nothrow) MockFactory(pRealFactory);
+    if (!pFactory)
+    {
+        if (pRealFactory)
+            pRealFactory->Release();
+        return E_OUTOFMEMORY;
+    }
+
+    HRESULT hr = pFactory->QueryInterface(riid, ppFactory);
+    pFactory->Release();
+    return hr;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: MockD3D11CreateDevice()
+// Desc: Stands in for D3D11CreateDevice, for hardware adapters only
+//-----------------------------------------------------------------------------
+HRESULT WINAPI MockD3D11CreateDevice(IDXGIAdapter* pAdapter, D3D_DRIVER_TYPE driverType, HMODULE hSoftware,
+    UINT flags, const D3D_FEATURE_LEVEL* pFeatureLevels, UINT featureLevels, UINT sdkVersion,
+    ID3D11Device** ppDevice, D3D_FEATURE_LEVEL* pFeatureLevel, ID3D11DeviceContext** ppImmediateContext)
+{
+    if (ppDevice)
+        *ppDevice = nullptr;
+    if (ppImmediateContext)
+        *ppImmediateContext = nullptr;
+
+    if (!MockIsActive())
+        return DXGI_ERROR_UNSUPPORTED;
+
+    // Only mock adapters exist while mocking. WARP and the reference device
+    // are created unrecorded while recording.
+    if (!pAdapter)
+    {
+        if (!s_pRecorder || !s_pRecorder->pfnD3D11CreateDevice)
+            return DXGI_ERROR_UNSUPPORTED;
+
+        return s_pRecorder->pfnD3D11CreateDevice(nullptr, driverType, hSoftware, flags,
+            pFeatureLevels, featureLevels, sdkVersion, ppDevice, pFeatureLevel, ppImmediateContext);
+    }
+
+    auto pMockAdapter = static_cast<MockAdapter*>(pAdapter);
+    UINT iAdapter = pMockAdapter->Index();
+
+    // The requested levels are a tail of the viewer's list, or a single one
+    CHAR szName[c_cchMockName];
+    sprintf_s(szName, "adapter%u.D3D11CreateDevice.%u.%u.%u", iAdapter,
+        (pFeatureLevels && featureLevels > 0) ? static_cast<UINT>(pFeatureLevels[0]) : 0u,
+        (pFeatureLevels) ? featureLevels : 0u, (ppDevice) ? 1u : 0u);
+
+    HRESULT hr;
+    D3D_FEATURE_LEVEL fl = static_cast<D3D_FEATURE_LEVEL>(0);
+    ID3D11Device* pRealDevice = nullptr;
+    if (s_pRecorder)
+    {
+        if (!s_pRecorder->pfnD3D11CreateDevice || !pMockAdapter->Real())
+            return DXGI_ERROR_UNSUPPORTED;
+
+        LONGLONG qpcStart = TraceNow();
+        hr = s_pRecorder->pfnD3D11CreateDevice(pMockAdapter->Real(), driverType, hSoftware, flags,
+            pFeatureLevels, featureLevels, sdkVersion, (ppDevice) ? &pRealDevice : nullptr, &fl, ppImmediateContext);
+        Record(MC_D3D11CREATEDEVICE, qpcStart, szName, hr, &fl, sizeof(fl));
+    }
+    else
+    {
+        Delay(MC_D3D11CREATEDEVICE);
+
+        if (!Replay(szName, &hr, &fl, sizeof(fl)))
+        {
+            auto flHigh = static_cast<D3D_FEATURE_LEVEL>(Number(AdapterSetting(iAdapter, "d3d11.featurelevel")));
+
+            static const D3D_FEATURE_LEVEL c_defaultLevels[] =
+            {
+                D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_10_1, D3D_FEATURE_LEVEL_10_0,
+                D3D_FEATURE_LEVEL_9_3, D3D_FEATURE_LEVEL_9_2, D3D_FEATURE_LEVEL_9_1,
+            };
+            if (!pFeatureLevels)
+            {
+                pFeatureLevels = c_defaultLevels;
+                featureLevels = static_cast<UINT>(std::size(c_defaultLevels));
+            }
+
+            UINT iLevel = 0;
+            while (iLevel < featureLevels && pFeatureLevels[iLevel] > flHigh)
+                ++iLevel;
+
+            // Without a device pointer only the support is checked
+            hr = (iLevel == featureLevels) ? DXGI_ERROR_UNSUPPORTED : (ppDevice) ? S_OK : S_FALSE;
+            if (SUCCEEDED(hr))
+                fl = pFeatureLevels[iLevel];
+        }
+    }
+
+    if (FAILED(hr))
+        return hr;
+
+    if (pFeatureLevel)
+        *pFeatureLevel = fl;
+
+    if (!ppDevice)
+        return hr;
+
+    *ppDevice = new (std::nothrow) MockDevice11(iAdapter, fl, pRealDevice);
+    if (!*ppDevice)
+    {
+        if (pRealDevice)
+            pRealDevice->Release();
+        return E_OUTOFMEMORY;
+    }
+    return hr;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: MockD3D10CreateDevice1()
+// Desc: Stands in for D3D10CreateDevice1 while recording, which passes the
+//       call on unrecorded with the real adapter
+//-----------------------------------------------------------------------------
+HRESULT WINAPI MockD3D10CreateDevice1(IDXGIAdapter* pAdapter, D3D10_DRIVER_TYPE driverType, HMODULE hSoftware,
+    UINT flags, D3D10_FEATURE_LEVEL1 featureLevel, UINT sdkVersion, ID3D10Device1** ppDevice)
+{
+    if (ppDevice)
+        *ppDevice = nullptr;
+
+    if (!s_pRecorder || !s_pRecorder->pfnD3D10CreateDevice1)
+        return DXGI_ERROR_UNSUPPORTED;
+
+    IDXGIAdapter* pRealAdapter = (pAdapter) ? static_cast<MockAdapter*>(pAdapter)->Real() : nullptr;
+    if (pAdapter && !pRealAdapter)
+        return DXGI_ERROR_UNSUPPORTED;
+
+    return s_pRecorder->pfnD3D10CreateDevice1(pRealAdapter, driverType, hSoftware, flags, featureLevel, sdkVersion, ppDevice);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: MockD3D10CreateDevice()
+// Desc: Stands in for D3D10CreateDevice while recording, see above
+//-----------------------------------------------------------------------------
+HRESULT WINAPI MockD3D10CreateDevice(IDXGIAdapter* pAdapter, D3D10_DRIVER_TYPE driverType, HMODULE hSoftware,
+    UINT flags, UINT32 sdkVersion, ID3D10Device** ppDevice)
+{
+    if (ppDevice)
+        *ppDevice = nullptr;
+
+    if (!s_pRecorder || !s_pRecorder->pfnD3D10CreateDevice)
+        return DXGI_ERROR_UNSUPPORTED;
+
+    IDXGIAdapter* pRealAdapter = (pAdapter) ? static_cast<MockAdapter*>(pAdapter)->Real() : nullptr;
+    if (pAdapter && !pRealAdapter)
+        return DXGI_ERROR_UNSUPPORTED;
+
+    return s_pRecorder->pfnD3D10CreateDevice(pRealAdapter, driverType, hSoftware, flags, sdkVersion, ppDevice);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: MockDirect3DCreate9()
+// Desc: Stands in for Direct3DCreate9
+//-----------------------------------------------------------------------------
+IDirect3D9* WINAPI MockDirect3DCreate9(UINT sdkVersion)
+{
+    if (!MockIsActive())
+        return nullptr;
+
+    IDirect3D9* pRealD3D = nullptr;
+    if (s_pRecorder)
+    {
+        if (s_pRecorder->pfnDirect3DCreate9)
+            pRealD3D = s_pRecorder->pfnDirect3DCreate9(sdkVersion);
+        if (!pRealD3D)
+            return nullptr;
+    }
+
+    auto pD3D = new (std::nothrow) MockD3D9(pRealD3D);
+    if (!pD3D && pRealD3D)
+        pRealD3D->Release();
+    return pD3D;
+}
@@ -22,6 +22,7 @@ namespace
     BOOL   g_fAbortPrint = FALSE; // Did User Abort Print operation ?!?
     HWND   g_hAbortPrintDlg = nullptr;  // Print Abort Dialog handle
     HANDLE g_FileHandle = nullptr;  // Handle to log file
+    OUTPUTSINK* g_pFileSink = nullptr;  // Buffers writes to g_FileHandle
 
     DWORD iLastXPos = 0;
 
@@ -33,7 +34,7 @@ namespace
     VOID DoMessage(DWORD dwTitle, DWORD dwMsg);
 
     BOOL CALLBACK PrintTreeStats(HINSTANCE hInstance, HWND hWnd, HWND hTreeWnd,
-        HTREEITEM hRoot);
+        HCAPNODE hRoot);
 
 
     //-----------------------------------------------------------------------------
@@ -122,7 +123,7 @@ namespace
     HRESULT PrintEndPage(_In_ PRINTCBINFO* pci)
     {
         if (g_PrintToFile)
-            return S_OK;
+            return (g_pFileSink && !SinkFlush(g_pFileSink)) ? E_FAIL : S_OK;
 
         if (!pci)
             return E_FAIL;
@@ -165,7 +166,7 @@ namespace
     // Desc: Print user defined stuff
     //-----------------------------------------------------------------------------
     BOOL CALLBACK PrintTreeStats(HINSTANCE hInstance, HWND hWnd, HWND hTreeWnd,
-        HTREEITEM hRoot)
+        HCAPNODE hRoot)
     {
         static DOCINFO  di;
         static PRINTDLG pd = {};
@@ -175,7 +176,7 @@ namespace
             return FALSE;
 
         // Get Starting point for tree
-        HTREEITEM   hStartTree = (hRoot) ? hRoot : TreeView_GetRoot(hTreeWnd);
+        HCAPNODE    hStartTree = (hRoot) ? hRoot : TVGetRoot();
         if (!hStartTree)
             return FALSE;
 
@@ -190,7 +191,6 @@ namespace
         HANDLE      hHeap = nullptr;
         DWORD       buffSize;
         DWORD       cchLen;
-        TV_ITEM     tvi;
 
         // Initialize Print Dialog structure
         pd.lStructSize = sizeof(PRINTDLG);
@@ -273,12 +273,9 @@ namespace
         //
         // Set Document title to Root string
         //
-        tvi.mask = TVIF_CHILDREN | TVIF_TEXT;
-        tvi.hItem = hStartTree;
-        tvi.pszText = pstrBuff;
-        tvi.cchTextMax = pci.dwCharsPerLine;
-        if (TreeView_GetItem(hTreeWnd, &tvi))
+        if (*hStartTree->strText)
         {
+            strncpy_s(pstrBuff, pci.dwCharsPerLine + 1, hStartTree->strText, _TRUNCATE);
             SetWindowText(g_hAbortPrintDlg, pstrBuff);
             SetAbortProc(pd.hDC, AbortProc);
             cchLen = static_cast<DWORD>(_tcsclen(pstrBuff));
@@ -337,6 +334,21 @@ namespace
             }
             g_FileHandle = CreateFile(pstrFile, GENERIC_WRITE, 0, nullptr,
                 CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (g_FileHandle == INVALID_HANDLE_VALUE)
+            {
+                g_FileHandle = nullptr;
+                goto lblCLEANUP;
+            }
+
+            g_pFileSink = new (std::nothrow) OUTPUTSINK;
+            if (!g_pFileSink)
+            {
+                CloseHandle(g_FileHandle);
+                g_FileHandle = nullptr;
+                goto lblCLEANUP;
+            }
+
+            SinkInitFile(g_pFileSink, g_FileHandle);
         }
         else
             if (StartDoc(pd.hDC, &di) < 0)
@@ -374,66 +386,59 @@ namespace
                 // and print it's text info and associated Node caps
                 //
 
-                tvi.mask = TVIF_CHILDREN | TVIF_TEXT | TVIF_PARAM;
-                tvi.hItem = pci.hCurrTree;
-                tvi.pszText = pstrBuff;
-                tvi.lParam = 0;
-                tvi.cchTextMax = pci.dwCharsPerLine;
-                if (TreeView_GetItem(hTreeWnd, &tvi))
+                // Lazy nodes are populated through the same path as a UI expand
+                TVExpandLazyNode(pci.hCurrTree);
+
+                //
+                // Print the current node's text and associated Node caps
+                //
+                cchLen = static_cast<DWORD>(_tcslen(pci.hCurrTree->strText));
+                if (cchLen > 0)
                 {
-                    cchLen = static_cast<DWORD>(_tcslen(pstrBuff));
-                    cchLen = __min(cchLen, buffSize);
-                    if (cchLen > 0)
+                    int xOffset = (int)(pci.dwCurrIndent * DEF_TAB_SIZE * pci.dwCharWidth);
+                    int yOffset = (int)(pci.dwLineHeight * pci.dwCurrLine);
+
+                    // Print this line
+                    if (FAILED(PrintLine(xOffset, yOffset, pci.hCurrTree->strText, cchLen, &pci)))
                     {
-                        int xOffset = (int)(pci.dwCurrIndent * DEF_TAB_SIZE * pci.dwCharWidth);
-                        int yOffset = (int)(pci.dwLineHeight * pci.dwCurrLine);
+                        goto lblCLEANUP;
+                    }
 
-                        // Print this line
-                        if (FAILED(PrintLine(xOffset, yOffset, pstrBuff, cchLen, &pci)))
-                        {
-                            goto lblCLEANUP;
-                        }
+                    // Advance to next line in page
+                    if (FAILED(PrintNextLine(&pci)))
+                    {
+                        goto lblCLEANUP;
+                    }
 
-                        // Advance to next line in page
-                        if (FAILED(PrintNextLine(&pci)))
+                    // Check if there is any additional node info
+                    // that needs to be printed
+                    NODEINFO* pni = &pci.hCurrTree->ni;
+                    if (pni->fnDisplayCallback)
+                    {
+                        // Force indent to offset node info from tree info
+                        pci.dwCurrIndent += 2;
+
+                        if (pni->bUseLParam3)
                         {
-                            goto lblCLEANUP;
+                            if (FAILED(((DISPLAYCALLBACKEX)(pni->fnDisplayCallback))(pni->lParam1, pni->lParam2, pni->lParam3, &pci)))
+                            {
+                                // Error, callback failed
+                                goto lblCLEANUP;
+                            }
                         }
-
-                        // Check if there is any additional node info
-                        // that needs to be printed
-                        if (tvi.lParam != 0)
+                        else
                         {
-                            NODEINFO* pni = (NODEINFO*)tvi.lParam;
-
-                            if (pni && pni->fnDisplayCallback)
+                            if (FAILED(pni->fnDisplayCallback(pni->lParam1, pni->lParam2, &pci)))
                             {
-                                // Force indent to offset node info from tree info
-                                pci.dwCurrIndent += 2;
-
-                                if (pni->bUseLParam3)
-                                {
-                                    if (FAILED(((DISPLAYCALLBACKEX)(pni->fnDisplayCallback))(pni->lParam1, pni->lParam2, pni->lParam3, &pci)))
-                                    {
-                                        // Error, callback failed
-                                        goto lblCLEANUP;
-                                    }
-                                }
-                                else
-                                {
-                                    if (FAILED(pni->fnDisplayCallback(pni->lParam1, pni->lParam2, &pci)))
-                                    {
-                                        // Error, callback failed
-                                        goto lblCLEANUP;
-                                    }
-                                }
-
-                                // Recover indent
-                                pci.dwCurrIndent -= 2;
+                                // Error, callback failed
+                                goto lblCLEANUP;
                             }
                         }
+
+                        // Recover indent
+                        pci.dwCurrIndent -= 2;
                     }
-                } // End if TreeView_GetItem()
+                }
 
 
 
@@ -442,18 +447,13 @@ namespace
                 //
 
                 // Get first child, if any
-                if (tvi.cChildren)
+                if (pci.hCurrTree->pFirstChild)
                 {
-                    // Get First child
-                    HTREEITEM hTempTree = TreeView_GetChild(hTreeWnd, pci.hCurrTree);
-                    if (hTempTree)
-                    {
-                        // Increase Indentation
-                        pci.dwCurrIndent++;
+                    // Increase Indentation
+                    pci.dwCurrIndent++;
 
-                        pci.hCurrTree = hTempTree;
-                        continue;
-                    }
+                    pci.hCurrTree = pci.hCurrTree->pFirstChild;
+                    continue;
                 }
 
                 // Exit, if we are the root
@@ -466,10 +466,9 @@ namespace
                 }
 
                 // Get next sibling in the chain
-                HTREEITEM hTempTree = TreeView_GetNextSibling(hTreeWnd, pci.hCurrTree);
-                if (hTempTree)
+                if (pci.hCurrTree->pNext)
                 {
-                    pci.hCurrTree = hTempTree;
+                    pci.hCurrTree = pci.hCurrTree->pNext;
                     continue;
                 }
 
@@ -478,8 +477,8 @@ namespace
                 fFindNext = FALSE;
                 while (!fFindNext)
                 {
-                    hTempTree = TreeView_GetParent(hTreeWnd, pci.hCurrTree);
-                    if ((!hTempTree) || (hTempTree == hRoot))
+                    HCAPNODE hTempTree = pci.hCurrTree->pParent;
+                    if ((!hTempTree) || (hTempTree == hRoot) || (hTempTree->pParent == nullptr))
                     {
                         // We have reached the root, so stop
                         PrintEndPage(&pci);
@@ -496,11 +495,10 @@ namespace
 
                         // Since we have already processed the parent
                         // we want to get the uncle/aunt node
-                        hTempTree = TreeView_GetNextSibling(hTreeWnd, pci.hCurrTree);
-                        if (hTempTree)
+                        if (pci.hCurrTree->pNext)
                         {
                             // Found a non-processed node
-                            pci.hCurrTree = hTempTree;
+                            pci.hCurrTree = pci.hCurrTree->pNext;
                             fFindNext = TRUE;
                         }
                     }
@@ -517,7 +515,14 @@ namespace
         {
             if (g_PrintToFile)
             {
+                if (!SinkFlush(g_pFileSink))
+                    fResult = FALSE;
+
+                delete g_pFileSink;
+                g_pFileSink = nullptr;
+
                 CloseHandle(g_FileHandle);
+                g_FileHandle = nullptr;
             }
             else
                 EndDoc(pd.hDC);
@@ -574,7 +579,7 @@ namespace
 BOOL DXView_OnPrint(HWND hWnd, HWND hTreeWnd, BOOL bPrintAll)
 {
     HINSTANCE hInstance;
-    HTREEITEM hRoot;
+    HCAPNODE  hRoot;
 
     // Check Parameters
     if (!hWnd || !hTreeWnd)
@@ -591,7 +596,7 @@ BOOL DXView_OnPrint(HWND hWnd, HWND hTreeWnd, BOOL bPrintAll)
     }
     else
     {
-        hRoot = TreeView_GetSelection(hTreeWnd);
+        hRoot = TVGetNode(hTreeWnd, TreeView_GetSelection(hTreeWnd));
         if (!hRoot)
             DoMessage(IDS_PRINT_WARNING, IDS_PRINT_NEEDSELECT);
     }
@@ -609,7 +614,7 @@ BOOL DXView_OnPrint(HWND hWnd, HWND hTreeWnd, BOOL bPrintAll)
 BOOL DXView_OnFile(HWND hWnd, HWND hTreeWnd, BOOL bPrintAll)
 {
     HINSTANCE hInstance;
-    HTREEITEM hRoot;
+    HCAPNODE  hRoot;
 
     // Check Parameters
     if (!hWnd || !hTreeWnd)
@@ -626,7 +631,7 @@ BOOL DXView_OnFile(HWND hWnd, HWND hTreeWnd, BOOL bPrintAll)
     }
     else
     {
-        hRoot = TreeView_GetSelection(hTreeWnd);
+        hRoot = TVGetNode(hTreeWnd, TreeView_GetSelection(hTreeWnd));
         if (!hRoot)
             DoMessage(IDS_PRINT_WARNING, IDS_PRINT_NEEDSELECT);
     }
@@ -649,6 +654,9 @@ HRESULT PrintLine(int xOffset, int yOffset, LPCTSTR pszBuff, size_t cchBuff,
     if (!pci)
         return E_FAIL;
 
+    if (g_PrintToJson)
+        return JsonAddCell(pszBuff, cchBuff);
+
     // Check if we need to start a new page
     if (FAILED(PrintStartPage(pci)))
         return E_FAIL;
@@ -660,20 +668,15 @@ HRESULT PrintLine(int xOffset, int yOffset, LPCTSTR pszBuff, size_t cchBuff,
     // Print text out to buffer current line
     if (g_PrintToFile)
     {
-        DWORD dwDummy;
-        TCHAR Temp[80];
-
         int offset = (xOffset - iLastXPos) / pci->dwCharWidth;
 
         if (offset < 0 || offset >= 80)
             return S_OK;
 
-        memset(Temp, ' ', sizeof(TCHAR) * 79);
-        Temp[offset] = 0;
-        WriteFile(g_FileHandle, Temp, (xOffset - iLastXPos) / pci->dwCharWidth, &dwDummy, nullptr);
+        SinkFill(g_pFileSink, ' ', offset);
         iLastXPos = (xOffset - iLastXPos) + (pci->dwCharWidth * static_cast<DWORD>(cchBuff));
 
-        WriteFile(g_FileHandle, pszBuff, static_cast<DWORD>(cchBuff), &dwDummy, nullptr);
+        SinkWrite(g_pFileSink, pszBuff, cchBuff * sizeof(TCHAR));
     }
     else
     {
@@ -691,11 +694,12 @@ HRESULT PrintLine(int xOffset, int yOffset, LPCTSTR pszBuff, size_t cchBuff,
 _Use_decl_annotations_
 HRESULT PrintNextLine(PRINTCBINFO* pci)
 {
+    if (g_PrintToJson)
+        return JsonEndRow();
+
     if (g_PrintToFile)
     {
-        DWORD dwDummy;
-
-        WriteFile(g_FileHandle, "\r\n", 2, &dwDummy, nullptr);
+        SinkWrite(g_pFileSink, "\r\n", 2);
         iLastXPos = 0;
         return S_OK;
     }
@@ -0,0 +1,251 @@
+//-----------------------------------------------------------------------------
+// Name: dxprobe.cpp
+//
+// Desc: DirectX Capabilities Viewer background probing
+//
+//       Creating and probing every device takes a while, so the interactive
+//       viewer builds the tree on a worker thread and shows the window at
+//       once. Each section is built out of view (TVBeginStage) and posted
+//       to the window as a batch when complete. The window then shows it in
+//       place of a "probing..." placeholder, and the sections that are
+//       ready can be browsed while the others are probed.
+//
+//       The batches are:
+//       - DXGI and Direct3D 9, loaded from the snapshot cache while the
+//         adapters and drivers are unchanged, else probed and cached
+//       - DirectDraw, always probed
+//
+//       Saving the cache runs every display callback with each view
+//       setting, so the commands that change the view or walk the whole
+//       tree are disabled until the last batch is in.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+#include <objbase.h>
+
+VOID DXGI_FillTree();
+VOID DXG_FillTree();
+VOID DD_FillTree();
+VOID DXGI_GetCacheKey();
+VOID DXG_GetCacheKey();
+
+namespace
+{
+    constexpr UINT c_cProbeBatches = 2;
+
+    // Commands that need the whole tree
+    const UINT c_idProbeCommands[] =
+    {
+        IDM_VIEWAVAIL,
+        IDM_VIEWALL,
+        IDM_VIEW9EX,
+        IDM_PRINTWHOLETREETOPRINTER,
+        IDM_PRINTSUBTREETOPRINTER,
+        IDM_PRINTWHOLETREETOFILE,
+        IDM_PRINTSUBTREETOFILE,
+        IDM_FIND,
+    };
+
+    const CHAR* const c_strPlaceholders[c_cProbeBatches][2] =
+    {
+        { "DXGI Devices (probing...)", "Direct3D9 Devices (probing...)" },
+        { "DirectDraw Devices (probing...)", nullptr },
+    };
+
+    struct PROBEBATCH
+    {
+        CAPSTAGE    stage;              // The batch's top-level nodes and their memory
+        HCAPNODE    hPlaceholders[2];   // Replaced by the staged nodes
+    };
+
+    struct PROBEJOB
+    {
+        HWND            hWnd;
+        PROBEBATCH*     pBatches[c_cProbeBatches];
+        volatile LONG   fCancel;        // The window is going away, don't post
+    };
+
+    PROBEJOB    s_job = {};
+    PTP_WORK    s_pWork = nullptr;
+    UINT        s_cPending = 0;         // Batches not spliced in yet
+
+
+    //-----------------------------------------------------------------------------
+    VOID FreeBatch(PROBEBATCH* pBatch)
+    {
+        TVFreeStage(&pBatch->stage);
+        delete pBatch;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: PostBatch()
+    // Desc: Hands a completed batch to the window, which then owns it
+    //-----------------------------------------------------------------------------
+    VOID PostBatch(PROBEJOB* pJob, UINT iBatch)
+    {
+        PROBEBATCH* pBatch = pJob->pBatches[iBatch];
+        pJob->pBatches[iBatch] = nullptr;
+
+        if (InterlockedCompareExchange(&pJob->fCancel, 0, 0)
+            || !PostMessage(pJob->hWnd, WM_PROBEBATCH, 0, reinterpret_cast<LPARAM>(pBatch)))
+        {
+            FreeBatch(pBatch);
+        }
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID CALLBACK ProbeWork(PTP_CALLBACK_INSTANCE /*pInstance*/, PVOID pContext, PTP_WORK /*pWork*/)
+    {
+        auto pJob = static_cast<PROBEJOB*>(pContext);
+
+        HRESULT hr = CoInitializeEx(nullptr, COINITBASE_MULTITHREADED);
+
+        TVBeginStage(&pJob->pBatches[0]->stage);
+        DXGI_GetCacheKey();
+        DXG_GetCacheKey();
+        if (!CacheLoad())
+        {
+            DXGI_FillTree();
+            DXG_FillTree();
+            CacheSave();
+        }
+        TVEndStage();
+        PostBatch(pJob, 0);
+
+        TVBeginStage(&pJob->pBatches[1]->stage);
+        DD_FillTree();
+        TVEndStage();
+        PostBatch(pJob, 1);
+
+        if (SUCCEEDED(hr))
+            CoUninitialize();
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID EnableProbeCommands(HWND hWnd, BOOL fEnable)
+    {
+        HMENU hMenu = GetMenu(hWnd);
+        for (UINT id : c_idProbeCommands)
+            EnableMenuItem(hMenu, id, MF_BYCOMMAND | ((fEnable) ? MF_ENABLED : MF_GRAYED));
+        DrawMenuBar(hWnd);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: ProbeStart()
+// Desc: Adds placeholders for the top-level nodes and starts probing them
+//       on the thread pool. Returns FALSE if the caller should probe itself.
+//-----------------------------------------------------------------------------
+BOOL ProbeStart(HWND hWnd)
+{
+    if (s_pWork)
+        return TRUE;
+
+    PROBEJOB job = {};
+    job.hWnd = hWnd;
+    for (UINT i = 0; i < c_cProbeBatches; ++i)
+    {
+        job.pBatches[i] = new (std::nothrow) PROBEBATCH;
+        if (!job.pBatches[i])
+            break;
+        memset(job.pBatches[i], 0, sizeof(PROBEBATCH));
+    }
+
+    if (!job.pBatches[c_cProbeBatches - 1])
+    {
+        for (PROBEBATCH* pBatch : job.pBatches)
+            delete pBatch;
+        return FALSE;
+    }
+
+    s_job = job;
+    s_pWork = CreateThreadpoolWork(ProbeWork, &s_job, nullptr);
+    if (!s_pWork)
+    {
+        for (PROBEBATCH* pBatch : s_job.pBatches)
+            delete pBatch;
+        s_job = {};
+        return FALSE;
+    }
+
+    for (UINT i = 0; i < c_cProbeBatches; ++i)
+    {
+        for (UINT j = 0; j < 2 && c_strPlaceholders[i][j]; ++j)
+            s_job.pBatches[i]->hPlaceholders[j] = TVAddNode(nullptr, c_strPlaceholders[i][j], FALSE, IDI_DIRECTX, nullptr, 0, 0);
+    }
+    s_cPending = c_cProbeBatches;
+
+    EnableProbeCommands(hWnd, FALSE);
+    SubmitThreadpoolWork(s_pWork);
+    return TRUE;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: ProbeOnBatch()
+// Desc: Handles WM_PROBEBATCH: shows a batch in place of its placeholders
+//-----------------------------------------------------------------------------
+VOID ProbeOnBatch(HWND hWnd, LPARAM lParam)
+{
+    auto pBatch = reinterpret_cast<PROBEBATCH*>(lParam);
+    if (!pBatch)
+        return;
+
+    for (HCAPNODE hPlaceholder : pBatch->hPlaceholders)
+    {
+        if (hPlaceholder)
+            TVSpliceStage(hPlaceholder, &pBatch->stage);
+    }
+    FreeBatch(pBatch);
+
+    if (s_cPending > 0 && --s_cPending == 0)
+    {
+        EnableProbeCommands(hWnd, TRUE);
+
+        // Build the search index now that the tree is complete
+        SearchStart();
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+BOOL ProbeIsBusy()
+{
+    return s_cPending > 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: ProbeWait()
+// Desc: Waits for the probes to finish, before DirectX is cleaned up, and
+//       drops the batches that were not shown
+//-----------------------------------------------------------------------------
+VOID ProbeWait(HWND hWnd)
+{
+    if (!s_pWork)
+        return;
+
+    InterlockedExchange(&s_job.fCancel, 1);
+    WaitForThreadpoolWorkCallbacks(s_pWork, FALSE);
+    CloseThreadpoolWork(s_pWork);
+    s_pWork = nullptr;
+
+    MSG msg;
+    while (PeekMessage(&msg, hWnd, WM_PROBEBATCH, WM_PROBEBATCH, PM_REMOVE))
+    {
+        auto pBatch = reinterpret_cast<PROBEBATCH*>(msg.lParam);
+        if (pBatch)
+            FreeBatch(pBatch);
+    }
+
+    s_cPending = 0;
+}
@@ -0,0 +1,467 @@
+//-----------------------------------------------------------------------------
+// Name: dxsearch.cpp
+//
+// Desc: DirectX Capabilities Viewer capability tree search
+//
+//       Indexes the name of every node and every row its display callback
+//       shows with View All, so the Find dialog can list the matches while
+//       a query is typed. Display callbacks aren't thread safe, so the
+//       index is built on the UI thread from a timer, a few nodes at a time,
+//       while the viewer is idle. Nodes are visited breadth first. Children
+//       of lazy nodes expanded after their parent was indexed are queued as
+//       they are created. Unexpanded lazy nodes aren't expanded for the
+//       index, as that can create devices.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+extern HWND  g_hwndTV;
+extern DWORD g_dwViewState;
+
+namespace
+{
+    constexpr UINT_PTR c_idSearchTimer = 1;
+    constexpr UINT     c_searchTimerMs = 10;
+    constexpr DWORD    c_searchSliceMs = 15;    // Indexing time per timer tick
+    constexpr UINT     c_maxSearchResults = 500;
+    constexpr UINT     c_maxSearchPath = 16;
+    constexpr size_t   c_cchSearchText = 512;
+    constexpr size_t   c_cchSearchQuery = 256;
+
+    SEARCHINDEX*    s_pIndex = nullptr;
+    BOOL            s_fFailed = FALSE;      // Out of memory, the index is incomplete
+    BOOL            s_fRootsQueued = FALSE;
+    BOOL            s_fTimer = FALSE;
+
+    // Nodes waiting to be indexed
+    HCAPNODE*       s_pQueue = nullptr;
+    UINT            s_iQueue = 0;
+    UINT            s_cQueue = 0;
+    UINT            s_cMaxQueue = 0;
+
+    HWND            s_hwndFind = nullptr;
+    const SEARCHHIT* s_pResults[c_maxSearchResults];
+    UINT            s_cResults = 0;
+
+
+    //-----------------------------------------------------------------------------
+    BOOL QueueNode(HCAPNODE hNode)
+    {
+        if (s_iQueue == s_cQueue)
+        {
+            s_iQueue = 0;
+            s_cQueue = 0;
+        }
+
+        if (s_cQueue == s_cMaxQueue)
+        {
+            UINT cMax = (s_cMaxQueue) ? s_cMaxQueue * 2 : 256;
+            auto pQueue = new (std::nothrow) HCAPNODE[cMax];
+            if (!pQueue)
+                return FALSE;
+
+            if (s_pQueue)
+                memcpy(pQueue, s_pQueue, s_cQueue * sizeof(HCAPNODE));
+            delete[] s_pQueue;
+            s_pQueue = pQueue;
+            s_cMaxQueue = cMax;
+        }
+
+        s_pQueue[s_cQueue++] = hNode;
+        return TRUE;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID QueueChildren(HCAPNODE hNode)
+    {
+        for (HCAPNODE hChild = hNode->pFirstChild; hChild && !s_fFailed; hChild = hChild->pNext)
+            s_fFailed = !QueueNode(hChild);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    HRESULT SearchEmitColumn(void* /*pContext*/, int /*iCol*/, const CHAR* /*strName*/, int /*width*/)
+    {
+        return S_OK;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: SearchEmitRow()
+    // Desc: Indexes a row as its cells separated by " | "
+    //-----------------------------------------------------------------------------
+    HRESULT SearchEmitRow(void* pContext, UINT cCells, const ROWCELL* pCells)
+    {
+        if (!cCells)
+            return S_OK;
+
+        CHAR strText[c_cchSearchText] = {};
+        CHAR strRow[c_cchRowCell] = {};
+        for (UINT i = 0; i < cCells; ++i)
+        {
+            CHAR szBuff[c_cchRowCell];
+            const CHAR* str = RowCellText(&pCells[i], szBuff);
+            if (i == 0)
+                strncpy_s(strRow, str, _TRUNCATE);
+            else
+                strncat_s(strText, " | ", _TRUNCATE);
+            strncat_s(strText, str, _TRUNCATE);
+        }
+
+        if (!IndexAdd(s_pIndex, pContext, strRow, strText))
+        {
+            s_fFailed = TRUE;
+            return E_OUTOFMEMORY;
+        }
+
+        return S_OK;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: IndexNode()
+    // Desc: Indexes a node's name and rows, and queues its children
+    //-----------------------------------------------------------------------------
+    VOID IndexNode(HCAPNODE hNode)
+    {
+        hNode->fIndexed = TRUE;
+
+        if (!IndexAdd(s_pIndex, hNode, nullptr, hNode->strText))
+        {
+            s_fFailed = TRUE;
+            return;
+        }
+
+        const NODEINFO* pni = &hNode->ni;
+        if (pni->fnDisplayCallback)
+        {
+            ROWEMITTER emitter = { SearchEmitColumn, SearchEmitRow, hNode };
+
+            PRINTCBINFO pci = {};
+            pci.hCurrTree = hNode;
+            pci.pEmitter = &emitter;
+
+            DWORD dwViewState = g_dwViewState;
+            g_dwViewState = IDM_VIEWALL;
+
+            if (pni->bUseLParam3)
+                (void)((DISPLAYCALLBACKEX)(pni->fnDisplayCallback))(pni->lParam1, pni->lParam2, pni->lParam3, &pci);
+            else
+                (void)pni->fnDisplayCallback(pni->lParam1, pni->lParam2, &pci);
+
+            g_dwViewState = dwViewState;
+        }
+
+        QueueChildren(hNode);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: IndexSlice()
+    // Desc: Indexes queued nodes for a while. Returns FALSE once none are left.
+    //-----------------------------------------------------------------------------
+    BOOL IndexSlice()
+    {
+        if (s_fFailed)
+            return FALSE;
+
+        if (!s_pIndex)
+        {
+            s_pIndex = IndexCreate();
+            if (!s_pIndex)
+            {
+                s_fFailed = TRUE;
+                return FALSE;
+            }
+        }
+
+        if (!s_fRootsQueued)
+        {
+            s_fRootsQueued = TRUE;
+            for (HCAPNODE hNode = TVGetRoot(); hNode && !s_fFailed; hNode = hNode->pNext)
+                s_fFailed = !QueueNode(hNode);
+        }
+
+        DWORD dwStart = GetTickCount();
+        while (s_iQueue < s_cQueue && !s_fFailed)
+        {
+            IndexNode(s_pQueue[s_iQueue++]);
+
+            if (GetTickCount() - dwStart >= c_searchSliceMs)
+                break;
+        }
+
+        return s_iQueue < s_cQueue && !s_fFailed;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID ShowStatus(UINT cFound)
+    {
+        CHAR szStatus[128];
+        if (cFound > c_maxSearchResults)
+            sprintf_s(szStatus, "%u matches, %u are shown", cFound, c_maxSearchResults);
+        else
+            sprintf_s(szStatus, "%u %s", cFound, (cFound == 1) ? "match" : "matches");
+
+        if (s_fTimer)
+            strcat_s(szStatus, " (still indexing)");
+        else if (s_fFailed)
+            strcat_s(szStatus, " (out of memory, index incomplete)");
+
+        SetDlgItemText(s_hwndFind, IDC_FINDSTATUS, szStatus);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: RunQuery()
+    // Desc: Lists the matches of the Find dialog's query as node path | row
+    //-----------------------------------------------------------------------------
+    VOID RunQuery()
+    {
+        HWND hwndList = GetDlgItem(s_hwndFind, IDC_FINDRESULTS);
+        SendMessage(hwndList, WM_SETREDRAW, FALSE, 0);
+        SendMessage(hwndList, LB_RESETCONTENT, 0, 0);
+        s_cResults = 0;
+
+        CHAR szQuery[c_cchSearchQuery] = {};
+        GetDlgItemText(s_hwndFind, IDC_FINDTEXT, szQuery, static_cast<int>(std::size(szQuery)));
+
+        UINT cFound = (s_pIndex) ? IndexQuery(s_pIndex, szQuery, s_pResults, c_maxSearchResults) : 0;
+        s_cResults = (cFound < c_maxSearchResults) ? cFound : c_maxSearchResults;
+
+        for (UINT i = 0; i < s_cResults; ++i)
+        {
+            const CAPNODE* pPath[c_maxSearchPath];
+            UINT cPath = 0;
+            for (auto pNode = static_cast<const CAPNODE*>(s_pResults[i]->pItem); pNode && pNode->pParent; pNode = pNode->pParent)
+            {
+                if (cPath < c_maxSearchPath)
+                    pPath[cPath++] = pNode;
+            }
+
+            CHAR strLine[c_cchSearchText] = {};
+            while (cPath > 0)
+            {
+                strncat_s(strLine, pPath[--cPath]->strText, _TRUNCATE);
+                if (cPath > 0)
+                    strncat_s(strLine, " > ", _TRUNCATE);
+            }
+
+            if (s_pResults[i]->strRow)
+            {
+                strncat_s(strLine, " | ", _TRUNCATE);
+                strncat_s(strLine, s_pResults[i]->strText, _TRUNCATE);
+            }
+
+            auto iItem = SendMessage(hwndList, LB_ADDSTRING, 0, reinterpret_cast<LPARAM>(strLine));
+            if (iItem >= 0)
+                SendMessage(hwndList, LB_SETITEMDATA, static_cast<WPARAM>(iItem), static_cast<LPARAM>(i));
+        }
+
+        SendMessage(hwndList, WM_SETREDRAW, TRUE, 0);
+        InvalidateRect(hwndList, nullptr, TRUE);
+
+        ShowStatus(cFound);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: GoToResult()
+    // Desc: Selects the node of the selected match, and its row
+    //-----------------------------------------------------------------------------
+    VOID GoToResult()
+    {
+        HWND hwndList = GetDlgItem(s_hwndFind, IDC_FINDRESULTS);
+        auto iItem = SendMessage(hwndList, LB_GETCURSEL, 0, 0);
+        if (iItem < 0)
+            return;
+
+        auto iResult = static_cast<UINT>(SendMessage(hwndList, LB_GETITEMDATA, static_cast<WPARAM>(iItem), 0));
+        if (iResult >= s_cResults)
+            return;
+
+        const SEARCHHIT* pHit = s_pResults[iResult];
+        auto hNode = static_cast<HCAPNODE>(pHit->pItem);
+        if (!hNode->hItem)
+            return;
+
+        // Selecting the node fills the ListView
+        TreeView_SelectItem(g_hwndTV, hNode->hItem);
+        TreeView_EnsureVisible(g_hwndTV, hNode->hItem);
+
+        if (!pHit->strRow)
+            return;
+
+        // Rows hidden by the current view aren't there
+        int cItems = ListView_GetItemCount(g_hwndLV);
+        for (int i = 0; i < cItems; ++i)
+        {
+            CHAR szBuff[c_cchRowCell];
+            if (strcmp(LVRowsCellText(i, 0, szBuff), pHit->strRow) == 0)
+            {
+                ListView_SetItemState(g_hwndLV, -1, 0, LVIS_SELECTED | LVIS_FOCUSED);
+                ListView_SetItemState(g_hwndLV, i, LVIS_SELECTED | LVIS_FOCUSED, LVIS_SELECTED | LVIS_FOCUSED);
+                ListView_EnsureVisible(g_hwndLV, i, FALSE);
+                break;
+            }
+        }
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID CALLBACK IndexTimerProc(HWND hWnd, UINT /*msg*/, UINT_PTR idEvent, DWORD /*dwTime*/)
+    {
+        if (IndexSlice())
+            return;
+
+        KillTimer(hWnd, idEvent);
+        s_fTimer = FALSE;
+
+        // Show what was found while the index was being built
+        if (s_hwndFind)
+            RunQuery();
+    }
+
+
+    //-----------------------------------------------------------------------------
+    INT_PTR CALLBACK FindDlgProc(HWND hDlg, UINT msg, WPARAM wParam, LPARAM /*lParam*/)
+    {
+        switch (msg)
+        {
+        case WM_INITDIALOG:
+            s_hwndFind = hDlg;
+            SendDlgItemMessage(hDlg, IDC_FINDTEXT, EM_LIMITTEXT, c_cchSearchQuery - 1, 0);
+            SendDlgItemMessage(hDlg, IDC_FINDRESULTS, LB_SETHORIZONTALEXTENT, 4096, 0);
+            ShowStatus(0);
+            return TRUE;
+
+        case WM_COMMAND:
+            switch (LOWORD(wParam))
+            {
+            case IDC_FINDTEXT:
+                if (HIWORD(wParam) == EN_CHANGE)
+                    RunQuery();
+                return TRUE;
+
+            case IDC_FINDRESULTS:
+                if (HIWORD(wParam) == LBN_DBLCLK)
+                    GoToResult();
+                return TRUE;
+
+            case IDOK:
+                if (SendDlgItemMessage(hDlg, IDC_FINDRESULTS, LB_GETCURSEL, 0, 0) < 0)
+                    SendDlgItemMessage(hDlg, IDC_FINDRESULTS, LB_SETCURSEL, 0, 0);
+                GoToResult();
+                return TRUE;
+
+            case IDCANCEL:
+                DestroyWindow(hDlg);
+                return TRUE;
+            }
+            break;
+
+        case WM_DESTROY:
+            s_hwndFind = nullptr;
+            s_cResults = 0;
+            break;
+        }
+
+        return FALSE;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: SearchStart()
+// Desc: Starts indexing the tree while the viewer is idle
+//-----------------------------------------------------------------------------
+VOID SearchStart()
+{
+    if (s_fTimer || s_fFailed || !g_hwndMain)
+        return;
+
+    s_fTimer = (SetTimer(g_hwndMain, c_idSearchTimer, c_searchTimerMs, IndexTimerProc) != 0);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: SearchReset()
+// Desc: Drops the index, as the nodes are about to be freed
+//-----------------------------------------------------------------------------
+VOID SearchReset()
+{
+    BOOL fStarted = (s_pIndex != nullptr);
+
+    if (s_fTimer)
+    {
+        KillTimer(g_hwndMain, c_idSearchTimer);
+        s_fTimer = FALSE;
+    }
+
+    if (s_hwndFind)
+    {
+        SendDlgItemMessage(s_hwndFind, IDC_FINDRESULTS, LB_RESETCONTENT, 0, 0);
+        s_cResults = 0;
+    }
+
+    IndexDestroy(s_pIndex);
+    s_pIndex = nullptr;
+    s_fFailed = FALSE;
+    s_fRootsQueued = FALSE;
+
+    delete[] s_pQueue;
+    s_pQueue = nullptr;
+    s_iQueue = 0;
+    s_cQueue = 0;
+    s_cMaxQueue = 0;
+
+    // The next tree is indexed from its roots
+    if (fStarted)
+        SearchStart();
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: SearchNodeExpanded()
+// Desc: Queues the children of a lazy node that was already indexed
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+VOID SearchNodeExpanded(HCAPNODE hNode)
+{
+    if (!hNode->fIndexed || !s_pIndex || s_fFailed)
+        return;
+
+    QueueChildren(hNode);
+    SearchStart();
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: SearchShowDialog()
+// Desc: Opens the modeless Find dialog, or brings it to the front
+//-----------------------------------------------------------------------------
+VOID SearchShowDialog(HWND hWnd)
+{
+    if (!s_hwndFind)
+        CreateDialog(g_hInstance, MAKEINTRESOURCE(IDD_FIND), hWnd, FindDlgProc);
+
+    if (s_hwndFind)
+    {
+        ShowWindow(s_hwndFind, SW_SHOW);
+        SetFocus(GetDlgItem(s_hwndFind, IDC_FINDTEXT));
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+BOOL SearchIsDialogMessage(MSG* pMsg)
+{
+    return s_hwndFind && IsDialogMessage(s_hwndFind, pMsg);
+}
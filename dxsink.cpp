@@ -0,0 +1,182 @@
+//-----------------------------------------------------------------------------
+// Name: dxsink.cpp
+//
+// Desc: DirectX Capabilities Viewer buffered output
+//
+//       The text, JSON, snapshot, trace and recording writers go through an
+//       OUTPUTSINK, which coalesces their many small writes into
+//       c_cbSinkBuffer blocks for a file or any other SINKWRITE.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+namespace
+{
+    // Longest run of non-ASCII text converted at once
+    constexpr size_t c_cchWideRun = 1024;
+
+    BOOL SinkWriteFile(void* pContext, const void* pData, DWORD cbData)
+    {
+        DWORD cbWritten = 0;
+        return WriteFile(static_cast<HANDLE>(pContext), pData, cbData, &cbWritten, nullptr)
+            && (cbWritten == cbData);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: SinkInit()
+// Desc: Sets up a sink that hands buffered output to fnWrite
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+VOID SinkInit(OUTPUTSINK* pSink, SINKWRITE fnWrite, void* pContext)
+{
+    pSink->fnWrite = fnWrite;
+    pSink->pContext = pContext;
+    pSink->fFailed = FALSE;
+    pSink->cbUsed = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: SinkInitFile()
+// Desc: Sets up a sink that writes to a file handle
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+VOID SinkInitFile(OUTPUTSINK* pSink, HANDLE hFile)
+{
+    SinkInit(pSink, SinkWriteFile, hFile);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: SinkWrite()
+// Desc: Appends data to the sink, flushing whenever the buffer fills
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+VOID SinkWrite(OUTPUTSINK* pSink, const void* pData, size_t cbData)
+{
+    auto pb = static_cast<const CHAR*>(pData);
+    while (cbData > 0)
+    {
+        if (pSink->cbUsed == c_cbSinkBuffer)
+            SinkFlush(pSink);
+
+        size_t cbCopy = c_cbSinkBuffer - pSink->cbUsed;
+        if (cbCopy > cbData)
+            cbCopy = cbData;
+
+        memcpy(pSink->buffer + pSink->cbUsed, pb, cbCopy);
+        pSink->cbUsed += static_cast<DWORD>(cbCopy);
+        pb += cbCopy;
+        cbData -= cbCopy;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: SinkFill()
+// Desc: Appends cch copies of ch (used for column padding)
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+VOID SinkFill(OUTPUTSINK* pSink, CHAR ch, size_t cch)
+{
+    while (cch > 0)
+    {
+        if (pSink->cbUsed == c_cbSinkBuffer)
+            SinkFlush(pSink);
+
+        size_t cchFill = c_cbSinkBuffer - pSink->cbUsed;
+        if (cchFill > cch)
+            cchFill = cch;
+
+        memset(pSink->buffer + pSink->cbUsed, ch, cchFill);
+        pSink->cbUsed += static_cast<DWORD>(cchFill);
+        cch -= cchFill;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: SinkFlush()
+// Desc: Hands any buffered output to the sink's writer. Returns FALSE if any
+//       write so far has failed.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+BOOL SinkFlush(OUTPUTSINK* pSink)
+{
+    if (!pSink)
+        return FALSE;
+
+    if (pSink->cbUsed > 0)
+    {
+        if (!pSink->fFailed && !pSink->fnWrite(pSink->pContext, pSink->buffer, pSink->cbUsed))
+            pSink->fFailed = TRUE;
+
+        pSink->cbUsed = 0;
+    }
+
+    return !pSink->fFailed;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: SinkWriteJsonString()
+// Desc: Writes a quoted string. Text is in the ANSI code page, so anything
+//       outside of ASCII is written as \u escapes to keep the file valid.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+VOID SinkWriteJsonString(OUTPUTSINK* pSink, const CHAR* pch, size_t cch)
+{
+    SinkWrite(pSink, "\"", 1);
+
+    while (cch > 0)
+    {
+        CHAR ch = *pch;
+        CHAR szEsc[8];
+
+        if (ch == '"' || ch == '\\')
+        {
+            szEsc[0] = '\\';
+            szEsc[1] = ch;
+            SinkWrite(pSink, szEsc, 2);
+        }
+        else if (static_cast<BYTE>(ch) < 0x20)
+        {
+            sprintf_s(szEsc, "\\u%04x", static_cast<BYTE>(ch));
+            SinkWrite(pSink, szEsc, strlen(szEsc));
+        }
+        else if (static_cast<BYTE>(ch) >= 0x80)
+        {
+            // Convert the run of non-ASCII characters in one go
+            size_t cchRun = 1;
+            while (cchRun < cch && cchRun < c_cchWideRun && static_cast<BYTE>(pch[cchRun]) >= 0x80)
+                ++cchRun;
+
+            WCHAR wsz[c_cchWideRun];
+            int cwch = MultiByteToWideChar(CP_ACP, 0, pch, static_cast<int>(cchRun), wsz, static_cast<int>(std::size(wsz)));
+            for (int i = 0; i < cwch; ++i)
+            {
+                sprintf_s(szEsc, "\\u%04x", static_cast<UINT>(wsz[i]));
+                SinkWrite(pSink, szEsc, strlen(szEsc));
+            }
+
+            pch += cchRun;
+            cch -= cchRun;
+            continue;
+        }
+        else
+        {
+            SinkWrite(pSink, &ch, 1);
+        }
+
+        ++pch;
+        --cch;
+    }
+
+    SinkWrite(pSink, "\"", 1);
+}
@@ -0,0 +1,270 @@
+//-----------------------------------------------------------------------------
+// Name: dxstats.cpp
+//
+// Desc: DirectX Capabilities Viewer driver call statistics
+//
+//       Most probes quietly treat a failed call as "not supported". To see
+//       how many driver calls ran, how long they took and how they failed,
+//       the probes pass the result of each call to StatsAdd(). The counts
+//       are shown by the "Diagnostics" node, and so are also written by
+//       the print and JSON exports.
+//
+//       The probes run on several threads at once, so the counters are only
+//       updated with interlocked operations. The failures of each API are
+//       kept by HRESULT in a few slots, claimed with a compare-exchange; any
+//       further HRESULTs are counted together. Each API's counters have a
+//       cache line of their own.
+//
+//       The counts differ from run to run, so the Diagnostics node is left out
+//       of snapshots. Otherwise two snapshots of the same machine would never
+//       compare equal with --diff.
+//
+//       The "Tree Memory" node shows what the capability tree takes: its
+//       nodes and payloads, which would each be a heap allocation of their
+//       own, against the chunks the arena actually allocated.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+namespace
+{
+    constexpr UINT c_cApiFailures = 6;
+
+    const CHAR* const c_strApiNames[API_COUNT] =
+    {
+        "D3D12CreateDevice",
+        "D3D11CreateDevice",
+        "D3D10CreateDevice",
+        "D3D10CreateDevice1",
+        "CheckFeatureSupport",
+        "CheckFormatSupport",
+        "CheckMultisampleQualityLevels",
+        "IDirect3D9::GetDeviceCaps",
+        "IDirect3D9::CheckDeviceType",
+        "IDirect3D9::CheckDeviceFormat",
+        "IDirect3D9::CheckDeviceMultiSampleType",
+        "IDirect3D9::CheckDepthStencilMatch",
+        "DirectDrawCreateEx",
+        "IDirectDraw7::GetCaps",
+    };
+
+    struct APIFAILURE
+    {
+        volatile LONG   hr;             // S_OK while the slot is free
+        volatile LONG   cCount;
+    };
+
+    struct alignas(64) APISTATS
+    {
+        volatile LONG   cCalls;
+        volatile LONG   cFailures;
+        volatile LONG   cOtherFailures; // HRESULTs that found no free slot
+        volatile LONG64 qpcTotal;
+        APIFAILURE      failures[c_cApiFailures];
+    };
+
+    APISTATS s_stats[API_COUNT] = {};
+
+
+    //-----------------------------------------------------------------------------
+    VOID AddFailure(APISTATS* pStats, HRESULT hr)
+    {
+        InterlockedIncrement(&pStats->cFailures);
+
+        for (APIFAILURE& failure : pStats->failures)
+        {
+            LONG hrSlot = InterlockedCompareExchange(&failure.hr, hr, S_OK);
+            if (hrSlot == S_OK || hrSlot == hr)
+            {
+                InterlockedIncrement(&failure.cCount);
+                return;
+            }
+        }
+
+        InterlockedIncrement(&pStats->cOtherFailures);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    DWORD Microseconds(LONGLONG qpc)
+    {
+        LARGE_INTEGER freq = {};
+        QueryPerformanceFrequency(&freq);
+        if (freq.QuadPart <= 0)
+            return 0;
+
+        double us = static_cast<double>(qpc) * 1000000.0 / static_cast<double>(freq.QuadPart);
+        return (us >= static_cast<double>(MAXDWORD)) ? MAXDWORD : static_cast<DWORD>(us);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: DisplayFailures()
+    // Desc: Lists the failed calls by API and HRESULT
+    //-----------------------------------------------------------------------------
+    HRESULT DisplayFailures(LPARAM /*lParam1*/, LPARAM /*lParam2*/, _In_opt_ PRINTCBINFO* pPrintInfo)
+    {
+        EmitColumn(pPrintInfo, 0, "API", 40);
+        EmitColumn(pPrintInfo, 1, "HRESULT", 12);
+        EmitColumn(pPrintInfo, 2, "Count", 10);
+
+        for (UINT api = 0; api < API_COUNT; ++api)
+        {
+            const APISTATS& stats = s_stats[api];
+            for (const APIFAILURE& failure : stats.failures)
+            {
+                if (failure.hr == S_OK)
+                    break;
+
+                const ROWCELL cells[3] =
+                {
+                    { CELL_TEXT, c_strApiNames[api], 0 },
+                    { CELL_HEX, nullptr, static_cast<DWORD>(failure.hr) },
+                    { CELL_UINT, nullptr, static_cast<DWORD>(failure.cCount) },
+                };
+                if (FAILED(EmitRow(pPrintInfo, 3, cells)))
+                    return E_FAIL;
+            }
+
+            if (stats.cOtherFailures > 0)
+            {
+                const ROWCELL cells[3] =
+                {
+                    { CELL_TEXT, c_strApiNames[api], 0 },
+                    { CELL_TEXT, "Other", 0 },
+                    { CELL_UINT, nullptr, static_cast<DWORD>(stats.cOtherFailures) },
+                };
+                if (FAILED(EmitRow(pPrintInfo, 3, cells)))
+                    return E_FAIL;
+            }
+        }
+
+        return S_OK;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    DWORD ClampSize(size_t cb)
+    {
+        return (cb >= MAXDWORD) ? MAXDWORD : static_cast<DWORD>(cb);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: DisplayTreeMemory()
+    // Desc: Lists the allocations of the tree as it is now
+    //-----------------------------------------------------------------------------
+    HRESULT DisplayTreeMemory(LPARAM /*lParam1*/, LPARAM /*lParam2*/, _In_opt_ PRINTCBINFO* pPrintInfo)
+    {
+        EmitColumn(pPrintInfo, 0, "Name", 24);
+        EmitColumn(pPrintInfo, 1, "Value", 12);
+
+        const NODEARENA* pArena = TVGetArena();
+        const struct
+        {
+            const CHAR* strName;
+            DWORD       dwValue;
+        } c_values[] =
+        {
+            { "Nodes", pArena->cNodes },
+            { "Payloads", pArena->cAllocs - pArena->cNodes },
+            { "Heap allocations", pArena->cChunks },
+            { "Bytes used", ClampSize(pArena->cbUsed) },
+            { "Bytes allocated", ClampSize(pArena->cbReserved) },
+        };
+
+        for (const auto& value : c_values)
+        {
+            const ROWCELL cells[2] =
+            {
+                { CELL_TEXT, value.strName, 0 },
+                { CELL_UINT, nullptr, value.dwValue },
+            };
+            if (FAILED(EmitRow(pPrintInfo, 2, cells)))
+                return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: DisplayStats()
+    // Desc: Lists the calls, failures and total time of each API called so far
+    //-----------------------------------------------------------------------------
+    HRESULT DisplayStats(LPARAM /*lParam1*/, LPARAM /*lParam2*/, _In_opt_ PRINTCBINFO* pPrintInfo)
+    {
+        EmitColumn(pPrintInfo, 0, "API", 40);
+        EmitColumn(pPrintInfo, 1, "Calls", 10);
+        EmitColumn(pPrintInfo, 2, "Failed", 10);
+        EmitColumn(pPrintInfo, 3, "Time (us)", 12);
+
+        for (UINT api = 0; api < API_COUNT; ++api)
+        {
+            APISTATS& stats = s_stats[api];
+            if (stats.cCalls == 0)
+                continue;
+
+            // Not torn by a probe adding to it, on 32-bit too
+            LONG64 qpcTotal = InterlockedCompareExchange64(&stats.qpcTotal, 0, 0);
+
+            const ROWCELL cells[4] =
+            {
+                { CELL_TEXT, c_strApiNames[api], 0 },
+                { CELL_UINT, nullptr, static_cast<DWORD>(stats.cCalls) },
+                { CELL_UINT, nullptr, static_cast<DWORD>(stats.cFailures) },
+                { CELL_UINT, nullptr, Microseconds(qpcTotal) },
+            };
+            if (FAILED(EmitRow(pPrintInfo, 4, cells)))
+                return E_FAIL;
+        }
+
+        return S_OK;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: StatsAdd()
+// Desc: Counts a driver call that started at qpcStart (see TraceNow()) and
+//       has just returned hr. Gives back hr.
+//-----------------------------------------------------------------------------
+HRESULT StatsAdd(APIID api, LONGLONG qpcStart, HRESULT hr)
+{
+    LONGLONG qpcEnd = TraceNow();
+
+    APISTATS* pStats = &s_stats[api];
+    InterlockedIncrement(&pStats->cCalls);
+    InterlockedExchangeAdd64(&pStats->qpcTotal, qpcEnd - qpcStart);
+    if (FAILED(hr))
+        AddFailure(pStats, hr);
+
+    return hr;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: StatsFillTree()
+// Desc: Adds the "Diagnostics" node, which shows the counts as they are when
+//       it is displayed
+//-----------------------------------------------------------------------------
+VOID StatsFillTree()
+{
+    HCAPNODE hTree = TVAddNode(nullptr, "Diagnostics", TRUE, IDI_DIRECTX, DisplayStats, 0, 0);
+    if (!hTree)
+        return;
+
+    hTree->fNoSnapshot = TRUE;
+
+    HCAPNODE hNode = TVAddNode(hTree, "Failures", FALSE, IDI_CAPS, DisplayFailures, 0, 0);
+    if (hNode)
+        hNode->fNoSnapshot = TRUE;
+
+    hNode = TVAddNode(hTree, "Tree Memory", FALSE, IDI_CAPS, DisplayTreeMemory, 0, 0);
+    if (hNode)
+        hNode->fNoSnapshot = TRUE;
+}
@@ -0,0 +1,550 @@
+//-----------------------------------------------------------------------------
+// Name: dxtables.cpp
+//
+// Desc: DirectX Capabilities Viewer feature level and format tables
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+#ifdef USING_DIRECTX_HEADERS
+#include <directx/d3d12.h>
+#else
+#include <d3d12.h>
+#endif
+
+#include <d3d10_1.h>
+#include <d3d11.h>
+
+#include "dxtables.h"
+
+extern const char c_szYes[];
+extern const char c_szNo[];
+extern const char c_szNA[];
+
+namespace
+{
+    constexpr FLLIMITS c_flLimits12 =
+    {
+        XTOSTRING(D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION),
+        XTOSTRING(D3D12_REQ_TEXTURECUBE_DIMENSION),
+        XTOSTRING(D3D12_REQ_TEXTURE3D_U_V_OR_W_DIMENSION),
+        XTOSTRING(D3D12_REQ_FILTERING_HW_ADDRESSABLE_RESOURCE_DIMENSION),
+        XTOSTRING(D3D12_REQ_MAXANISOTROPY),
+        "4294967296",
+        XTOSTRING(D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT),
+        XTOSTRING(D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT),
+    };
+
+    constexpr FLLIMITS c_flLimits11 =
+    {
+        XTOSTRING(D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION),
+        XTOSTRING(D3D11_REQ_TEXTURECUBE_DIMENSION),
+        XTOSTRING(D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION),
+        XTOSTRING(D3D11_REQ_FILTERING_HW_ADDRESSABLE_RESOURCE_DIMENSION),
+        XTOSTRING(D3D11_REQ_MAXANISOTROPY),
+        "4294967296",
+        XTOSTRING(D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT),
+        XTOSTRING(D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT),
+    };
+
+    constexpr FLLIMITS c_flLimits10_1 =
+    {
+        XTOSTRING(D3D10_REQ_TEXTURE2D_U_OR_V_DIMENSION),
+        XTOSTRING(D3D10_REQ_TEXTURECUBE_DIMENSION),
+        XTOSTRING(D3D10_REQ_TEXTURE3D_U_V_OR_W_DIMENSION),
+        XTOSTRING(D3D10_REQ_FILTERING_HW_ADDRESSABLE_RESOURCE_DIMENSION),
+        XTOSTRING(D3D10_REQ_MAXANISOTROPY),
+        "4294967296",
+        XTOSTRING(D3D10_1_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT),
+        XTOSTRING(D3D10_SIMULTANEOUS_RENDER_TARGET_COUNT),
+    };
+
+    constexpr FLLIMITS c_flLimits10 =
+    {
+        XTOSTRING(D3D10_REQ_TEXTURE2D_U_OR_V_DIMENSION),
+        XTOSTRING(D3D10_REQ_TEXTURECUBE_DIMENSION),
+        XTOSTRING(D3D10_REQ_TEXTURE3D_U_V_OR_W_DIMENSION),
+        XTOSTRING(D3D10_REQ_FILTERING_HW_ADDRESSABLE_RESOURCE_DIMENSION),
+        XTOSTRING(D3D10_REQ_MAXANISOTROPY),
+        "4294967296",
+        XTOSTRING(D3D10_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT),
+        XTOSTRING(D3D10_SIMULTANEOUS_RENDER_TARGET_COUNT),
+    };
+
+    constexpr FLLIMITS c_flLimits9_3 =
+    {
+        XTOSTRING2(D3D_FL9_3_REQ_TEXTURE2D_U_OR_V_DIMENSION),
+        XTOSTRING2(D3D_FL9_3_REQ_TEXTURECUBE_DIMENSION),
+        XTOSTRING2(D3D_FL9_1_REQ_TEXTURE3D_U_V_OR_W_DIMENSION),
+        XTOSTRING2(D3D_FL9_3_MAX_TEXTURE_REPEAT),
+        XTOSTRING(D3D11_REQ_MAXANISOTROPY),
+        XTOSTRING2(D3D_FL9_2_IA_PRIMITIVE_MAX_COUNT),
+        XTOSTRING(D3D10_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT),
+        XTOSTRING2(D3D_FL9_3_SIMULTANEOUS_RENDER_TARGET_COUNT),
+    };
+
+    constexpr FLLIMITS c_flLimits9_2 =
+    {
+        XTOSTRING2(D3D_FL9_1_REQ_TEXTURE2D_U_OR_V_DIMENSION),
+        XTOSTRING2(D3D_FL9_1_REQ_TEXTURECUBE_DIMENSION),
+        XTOSTRING2(D3D_FL9_1_REQ_TEXTURE3D_U_V_OR_W_DIMENSION),
+        XTOSTRING2(D3D_FL9_2_MAX_TEXTURE_REPEAT),
+        XTOSTRING(D3D11_REQ_MAXANISOTROPY),
+        XTOSTRING2(D3D_FL9_2_IA_PRIMITIVE_MAX_COUNT),
+        XTOSTRING(D3D10_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT),
+        XTOSTRING2(D3D_FL9_1_SIMULTANEOUS_RENDER_TARGET_COUNT),
+    };
+
+    constexpr FLLIMITS c_flLimits9_1 =
+    {
+        XTOSTRING2(D3D_FL9_1_REQ_TEXTURE2D_U_OR_V_DIMENSION),
+        XTOSTRING2(D3D_FL9_1_REQ_TEXTURECUBE_DIMENSION),
+        XTOSTRING2(D3D_FL9_1_REQ_TEXTURE3D_U_V_OR_W_DIMENSION),
+        XTOSTRING2(D3D_FL9_1_MAX_TEXTURE_REPEAT),
+        XTOSTRING2(D3D_FL9_1_DEFAULT_MAX_ANISOTROPY),
+        XTOSTRING2(D3D_FL9_1_IA_PRIMITIVE_MAX_COUNT),
+        XTOSTRING(D3D10_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT),
+        XTOSTRING2(D3D_FL9_1_SIMULTANEOUS_RENDER_TARGET_COUNT),
+    };
+
+    // Same order as g_featureLevels
+    constexpr FLDESC c_flDescs[] =
+    {
+        { D3D_FEATURE_LEVEL_12_2, &c_flLimits12, nullptr, c_szNo,
+          c_szYes, c_szYes, c_szYes, c_szYes, c_szYes,
+          XTOSTRING(D3D12_UAV_SLOT_COUNT), c_szYes, "16", "Full", c_szYes, c_szYes, false },
+
+        { D3D_FEATURE_LEVEL_12_1, &c_flLimits12, nullptr, c_szNo,
+          c_szYes, c_szYes, c_szYes, c_szYes, c_szYes,
+          XTOSTRING(D3D12_UAV_SLOT_COUNT), c_szYes, "16", "Full", c_szYes, c_szYes, false },
+
+        { D3D_FEATURE_LEVEL_12_0, &c_flLimits12, nullptr, c_szNo,
+          c_szYes, c_szYes, c_szYes, c_szYes, c_szYes,
+          XTOSTRING(D3D12_UAV_SLOT_COUNT), c_szYes, "16", "Full", c_szYes, c_szYes, false },
+
+        { D3D_FEATURE_LEVEL_11_1, &c_flLimits11, "5.0", "Yes (CS 5.0)",
+          c_szYes, c_szYes, c_szYes, c_szYes, c_szYes,
+          XTOSTRING(D3D11_1_UAV_SLOT_COUNT), c_szYes, "16", "Full", c_szYes, c_szYes, false },
+
+        { D3D_FEATURE_LEVEL_11_0, &c_flLimits11, "5.0", "Yes (CS 5.0)",
+          c_szYes, c_szYes, c_szNo, c_szNA, c_szNA,
+          nullptr, nullptr, nullptr, nullptr, c_szNo, c_szYes, false },
+
+        { D3D_FEATURE_LEVEL_10_1, &c_flLimits10_1, "4.x", c_szNo,
+          nullptr, nullptr, c_szNo, c_szNA, c_szNA,
+          nullptr, nullptr, nullptr, nullptr, c_szNo, c_szYes, false },
+
+        { D3D_FEATURE_LEVEL_10_0, &c_flLimits10, "4.0", c_szNo,
+          nullptr, nullptr, c_szNo, c_szNA, c_szNA,
+          nullptr, nullptr, nullptr, nullptr, c_szNo, c_szYes, false },
+
+        { D3D_FEATURE_LEVEL_9_3, &c_flLimits9_3, "2.0 (4_0_level_9_3) [vs_2_a/ps_2_b]", c_szNA,
+          c_szYes, nullptr, c_szNo, c_szNA, c_szNA,
+          nullptr, nullptr, nullptr, nullptr, c_szNo, c_szYes, true },
+
+        { D3D_FEATURE_LEVEL_9_2, &c_flLimits9_2, "2.0 (4_0_level_9_1)", c_szNA,
+          c_szYes, nullptr, c_szNo, c_szNA, c_szNA,
+          nullptr, nullptr, nullptr, nullptr, c_szNo, c_szNo, true },
+
+        { D3D_FEATURE_LEVEL_9_1, &c_flLimits9_1, "2.0 (4_0_level_9_1)", c_szNA,
+          c_szYes, nullptr, c_szNo, c_szNA, c_szNA,
+          nullptr, nullptr, nullptr, nullptr, c_szNo, c_szNo, true },
+    };
+
+    static_assert(std::size(c_flDescs) == std::size(g_featureLevels), "c_flDescs must cover every feature level");
+
+    constexpr bool IsFLDescComplete()
+    {
+        for (size_t i = 0; i < std::size(c_flDescs); ++i)
+        {
+            if (!c_flDescs[i].pLimits || (i > 0 && c_flDescs[i].fl >= c_flDescs[i - 1].fl))
+                return false;
+        }
+        return true;
+    }
+
+    static_assert(IsFLDescComplete(), "c_flDescs must be sorted like g_featureLevels, with limits for each level");
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: FeatureLevelMask()
+//-----------------------------------------------------------------------------
+DWORD FeatureLevelMask(D3D_FEATURE_LEVEL fl)
+{
+    switch (fl)
+    {
+    case D3D_FEATURE_LEVEL_9_1:  return FLMASK_9_1;
+    case D3D_FEATURE_LEVEL_9_2:  return FLMASK_9_2;
+    case D3D_FEATURE_LEVEL_9_3:  return FLMASK_9_3;
+    case D3D_FEATURE_LEVEL_10_0: return FLMASK_10_0;
+    case D3D_FEATURE_LEVEL_10_1: return FLMASK_10_1;
+    case D3D_FEATURE_LEVEL_11_0: return FLMASK_11_0;
+    case D3D_FEATURE_LEVEL_11_1: return FLMASK_11_1;
+    case D3D_FEATURE_LEVEL_12_0: return FLMASK_12_0;
+    case D3D_FEATURE_LEVEL_12_1: return FLMASK_12_1;
+    default: return 0;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: DetectFeatureLevels()
+// Desc: Finds the highest level and the supported-level mask for a
+//       descending list of feature levels. The first probe asks for the
+//       whole list and lets the runtime pick the highest level. Some devices
+//       skip levels below that, so each lower level is then probed by
+//       itself. If the runtime answers with a level that isn't in the list,
+//       every level is probed by itself. *pnProbes receives the number of
+//       probe calls made.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DetectFeatureLevels(const D3D_FEATURE_LEVEL* pLevels, UINT nLevels,
+    LPFLPROBE fnProbe, void* pContext,
+    D3D_FEATURE_LEVEL* pflHigh, DWORD* pflMask, UINT* pnProbes)
+{
+    *pflHigh = (D3D_FEATURE_LEVEL)0;
+    *pflMask = 0;
+    *pnProbes = 0;
+
+    if (!nLevels)
+        return E_INVALIDARG;
+
+    D3D_FEATURE_LEVEL fl = (D3D_FEATURE_LEVEL)0;
+    HRESULT hr = fnProbe(pContext, pLevels, nLevels, &fl);
+    ++*pnProbes;
+
+    if (hr == E_INVALIDARG)
+    {
+        // Older runtimes refuse the whole list when it contains a level they
+        // don't know. Bisect for the longest tail of the list they accept.
+        UINT lo = 1;
+        UINT hi = nLevels;
+        while (lo < hi)
+        {
+            UINT mid = lo + (hi - lo) / 2;
+            D3D_FEATURE_LEVEL flMid = (D3D_FEATURE_LEVEL)0;
+            HRESULT hrMid = fnProbe(pContext, pLevels + mid, nLevels - mid, &flMid);
+            ++*pnProbes;
+
+            if (hrMid == E_INVALIDARG)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+                hr = hrMid;
+                fl = flMid;
+            }
+        }
+    }
+
+    if (FAILED(hr))
+        return hr;
+
+    UINT iNext = 0;
+    while (iNext < nLevels && pLevels[iNext] != fl)
+        ++iNext;
+
+    if (iNext < nLevels)
+    {
+        *pflHigh = fl;
+        *pflMask = FeatureLevelMask(fl);
+        ++iNext;
+    }
+    else
+    {
+        iNext = 0;
+    }
+
+    for (UINT i = iNext; i < nLevels; ++i)
+    {
+        D3D_FEATURE_LEVEL flLevel = (D3D_FEATURE_LEVEL)0;
+        hr = fnProbe(pContext, &pLevels[i], 1, &flLevel);
+        ++*pnProbes;
+
+        if (SUCCEEDED(hr))
+        {
+            *pflMask |= FeatureLevelMask(pLevels[i]);
+            if (!*pflHigh)
+                *pflHigh = pLevels[i];
+        }
+    }
+
+    return (*pflHigh) ? S_OK : DXGI_ERROR_UNSUPPORTED;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: FindFLDesc()
+// Desc: Gives back the requirements of a level, nullptr if it isn't in
+//       g_featureLevels
+//-----------------------------------------------------------------------------
+const FLDESC* FindFLDesc(D3D_FEATURE_LEVEL fl)
+{
+    for (const FLDESC& desc : c_flDescs)
+    {
+        if (desc.fl == fl)
+            return &desc;
+    }
+
+    return nullptr;
+}
+
+
+namespace
+{
+    //-----------------------------------------------------------------------------
+    // Name: c_formatDescs
+    // Desc: Name and metadata of every DXGI_FORMAT this viewer knows, in enum
+    //       order. c_formatIndex maps an enum value straight to its entry,
+    //       and c_formatNameIndex a name.
+    //-----------------------------------------------------------------------------
+#define FMTDESC(a, bpp, flags) { a, TEXT(#a), bpp, flags }
+
+    constexpr FORMATDESC c_formatDescs[] =
+    {
+        FMTDESC(DXGI_FORMAT_R32G32B32A32_TYPELESS,      128, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_R32G32B32A32_FLOAT,         128, 0),
+        FMTDESC(DXGI_FORMAT_R32G32B32A32_UINT,          128, 0),
+        FMTDESC(DXGI_FORMAT_R32G32B32A32_SINT,          128, 0),
+        FMTDESC(DXGI_FORMAT_R32G32B32_TYPELESS,          96, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_R32G32B32_FLOAT,             96, 0),
+        FMTDESC(DXGI_FORMAT_R32G32B32_UINT,              96, 0),
+        FMTDESC(DXGI_FORMAT_R32G32B32_SINT,              96, 0),
+        FMTDESC(DXGI_FORMAT_R16G16B16A16_TYPELESS,       64, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_R16G16B16A16_FLOAT,          64, 0),
+        FMTDESC(DXGI_FORMAT_R16G16B16A16_UNORM,          64, 0),
+        FMTDESC(DXGI_FORMAT_R16G16B16A16_UINT,           64, 0),
+        FMTDESC(DXGI_FORMAT_R16G16B16A16_SNORM,          64, 0),
+        FMTDESC(DXGI_FORMAT_R16G16B16A16_SINT,           64, 0),
+        FMTDESC(DXGI_FORMAT_R32G32_TYPELESS,             64, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_R32G32_FLOAT,                64, 0),
+        FMTDESC(DXGI_FORMAT_R32G32_UINT,                 64, 0),
+        FMTDESC(DXGI_FORMAT_R32G32_SINT,                 64, 0),
+        FMTDESC(DXGI_FORMAT_R32G8X24_TYPELESS,           64, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_D32_FLOAT_S8X24_UINT,        64, FMT_DEPTH),
+        FMTDESC(DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS,    64, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_X32_TYPELESS_G8X24_UINT,     64, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_R10G10B10A2_TYPELESS,        32, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_R10G10B10A2_UNORM,           32, 0),
+        FMTDESC(DXGI_FORMAT_R10G10B10A2_UINT,            32, 0),
+        FMTDESC(DXGI_FORMAT_R11G11B10_FLOAT,             32, 0),
+        FMTDESC(DXGI_FORMAT_R8G8B8A8_TYPELESS,           32, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_R8G8B8A8_UNORM,              32, 0),
+        FMTDESC(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,         32, 0),
+        FMTDESC(DXGI_FORMAT_R8G8B8A8_UINT,               32, 0),
+        FMTDESC(DXGI_FORMAT_R8G8B8A8_SNORM,              32, 0),
+        FMTDESC(DXGI_FORMAT_R8G8B8A8_SINT,               32, 0),
+        FMTDESC(DXGI_FORMAT_R16G16_TYPELESS,             32, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_R16G16_FLOAT,                32, 0),
+        FMTDESC(DXGI_FORMAT_R16G16_UNORM,                32, 0),
+        FMTDESC(DXGI_FORMAT_R16G16_UINT,                 32, 0),
+        FMTDESC(DXGI_FORMAT_R16G16_SNORM,                32, 0),
+        FMTDESC(DXGI_FORMAT_R16G16_SINT,                 32, 0),
+        FMTDESC(DXGI_FORMAT_R32_TYPELESS,                32, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_D32_FLOAT,                   32, FMT_DEPTH),
+        FMTDESC(DXGI_FORMAT_R32_FLOAT,                   32, 0),
+        FMTDESC(DXGI_FORMAT_R32_UINT,                    32, 0),
+        FMTDESC(DXGI_FORMAT_R32_SINT,                    32, 0),
+        FMTDESC(DXGI_FORMAT_R24G8_TYPELESS,              32, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_D24_UNORM_S8_UINT,           32, FMT_DEPTH),
+        FMTDESC(DXGI_FORMAT_R24_UNORM_X8_TYPELESS,       32, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_X24_TYPELESS_G8_UINT,        32, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_R8G8_TYPELESS,               16, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_R8G8_UNORM,                  16, 0),
+        FMTDESC(DXGI_FORMAT_R8G8_UINT,                   16, 0),
+        FMTDESC(DXGI_FORMAT_R8G8_SNORM,                  16, 0),
+        FMTDESC(DXGI_FORMAT_R8G8_SINT,                   16, 0),
+        FMTDESC(DXGI_FORMAT_R16_TYPELESS,                16, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_R16_FLOAT,                   16, 0),
+        FMTDESC(DXGI_FORMAT_D16_UNORM,                   16, FMT_DEPTH),
+        FMTDESC(DXGI_FORMAT_R16_UNORM,                   16, 0),
+        FMTDESC(DXGI_FORMAT_R16_UINT,                    16, 0),
+        FMTDESC(DXGI_FORMAT_R16_SNORM,                   16, 0),
+        FMTDESC(DXGI_FORMAT_R16_SINT,                    16, 0),
+        FMTDESC(DXGI_FORMAT_R8_TYPELESS,                  8, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_R8_UNORM,                     8, 0),
+        FMTDESC(DXGI_FORMAT_R8_UINT,                      8, 0),
+        FMTDESC(DXGI_FORMAT_R8_SNORM,                     8, 0),
+        FMTDESC(DXGI_FORMAT_R8_SINT,                      8, 0),
+        FMTDESC(DXGI_FORMAT_A8_UNORM,                     8, 0),
+        FMTDESC(DXGI_FORMAT_R1_UNORM,                     1, 0),
+        FMTDESC(DXGI_FORMAT_R9G9B9E5_SHAREDEXP,          32, 0),
+        FMTDESC(DXGI_FORMAT_R8G8_B8G8_UNORM,             16, 0),
+        FMTDESC(DXGI_FORMAT_G8R8_G8B8_UNORM,             16, 0),
+        FMTDESC(DXGI_FORMAT_BC1_TYPELESS,                 4, FMT_TYPELESS | FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC1_UNORM,                    4, FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC1_UNORM_SRGB,               4, FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC2_TYPELESS,                 8, FMT_TYPELESS | FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC2_UNORM,                    8, FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC2_UNORM_SRGB,               8, FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC3_TYPELESS,                 8, FMT_TYPELESS | FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC3_UNORM,                    8, FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC3_UNORM_SRGB,               8, FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC4_TYPELESS,                 4, FMT_TYPELESS | FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC4_UNORM,                    4, FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC4_SNORM,                    4, FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC5_TYPELESS,                 8, FMT_TYPELESS | FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC5_UNORM,                    8, FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC5_SNORM,                    8, FMT_BC),
+        FMTDESC(DXGI_FORMAT_B5G6R5_UNORM,                16, 0),
+        FMTDESC(DXGI_FORMAT_B5G5R5A1_UNORM,              16, 0),
+        FMTDESC(DXGI_FORMAT_B8G8R8A8_UNORM,              32, 0),
+        FMTDESC(DXGI_FORMAT_B8G8R8X8_UNORM,              32, 0),
+        FMTDESC(DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM,  32, 0),
+        FMTDESC(DXGI_FORMAT_B8G8R8A8_TYPELESS,           32, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_B8G8R8A8_UNORM_SRGB,         32, 0),
+        FMTDESC(DXGI_FORMAT_B8G8R8X8_TYPELESS,           32, FMT_TYPELESS),
+        FMTDESC(DXGI_FORMAT_B8G8R8X8_UNORM_SRGB,         32, 0),
+        FMTDESC(DXGI_FORMAT_BC6H_TYPELESS,                8, FMT_TYPELESS | FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC6H_UF16,                    8, FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC6H_SF16,                    8, FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC7_TYPELESS,                 8, FMT_TYPELESS | FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC7_UNORM,                    8, FMT_BC),
+        FMTDESC(DXGI_FORMAT_BC7_UNORM_SRGB,               8, FMT_BC),
+        FMTDESC(DXGI_FORMAT_AYUV,                        32, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_Y410,                        32, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_Y416,                        64, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_NV12,                        12, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_P010,                        24, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_P016,                        24, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_420_OPAQUE,                  12, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_YUY2,                        16, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_Y210,                        32, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_Y216,                        32, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_NV11,                        12, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_AI44,                         8, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_IA44,                         8, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_P8,                           8, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_A8P8,                        16, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_B4G4R4A4_UNORM,              16, 0),
+        FMTDESC(DXGI_FORMAT_P208,                        16, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_V208,                        16, FMT_VIDEO),
+        FMTDESC(DXGI_FORMAT_V408,                        24, FMT_VIDEO),
+    };
+
+#undef FMTDESC
+
+    // Entry + 1 for each DXGI_FORMAT value, 0 if unknown
+    struct FORMATINDEX
+    {
+        BYTE entry[c_cFormatSupport];
+    };
+
+    constexpr FORMATINDEX MakeFormatIndex()
+    {
+        FORMATINDEX index = {};
+        for (size_t i = 0; i < std::size(c_formatDescs); ++i)
+        {
+            index.entry[c_formatDescs[i].format] = static_cast<BYTE>(i + 1);
+        }
+        return index;
+    }
+
+    constexpr bool IsFormatDescSorted()
+    {
+        for (size_t i = 1; i < std::size(c_formatDescs); ++i)
+        {
+            if (c_formatDescs[i].format <= c_formatDescs[i - 1].format)
+                return false;
+        }
+        return true;
+    }
+
+    static_assert(IsFormatDescSorted(), "c_formatDescs must be in enum order without duplicates");
+    static_assert(c_formatDescs[std::size(c_formatDescs) - 1].format == c_cFormatSupport - 1,
+        "c_cFormatSupport must cover the last entry of c_formatDescs");
+    static_assert(std::size(c_formatDescs) < 255, "FORMATINDEX entries are BYTEs");
+
+    constexpr FORMATINDEX c_formatIndex = MakeFormatIndex();
+
+    // FNV-1a of a format name
+    constexpr DWORD HashFormatName(const TCHAR* strName)
+    {
+        DWORD dwHash = 2166136261u;
+        for (; *strName; ++strName)
+        {
+            dwHash ^= static_cast<BYTE>(*strName);
+            dwHash *= 16777619u;
+        }
+        return dwHash;
+    }
+
+    // Entry + 1 for each slot of a hash table of the names, 0 if empty.
+    // Collisions take the next free slot.
+    constexpr UINT c_cFormatNameSlots = 256;
+
+    struct FORMATNAMEINDEX
+    {
+        BYTE slot[c_cFormatNameSlots];
+    };
+
+    constexpr FORMATNAMEINDEX MakeFormatNameIndex()
+    {
+        FORMATNAMEINDEX index = {};
+        for (size_t i = 0; i < std::size(c_formatDescs); ++i)
+        {
+            UINT slot = HashFormatName(c_formatDescs[i].name) & (c_cFormatNameSlots - 1);
+            while (index.slot[slot])
+                slot = (slot + 1) & (c_cFormatNameSlots - 1);
+            index.slot[slot] = static_cast<BYTE>(i + 1);
+        }
+        return index;
+    }
+
+    static_assert(std::size(c_formatDescs) * 2 <= c_cFormatNameSlots, "FORMATNAMEINDEX must stay at most half full");
+
+    constexpr FORMATNAMEINDEX c_formatNameIndex = MakeFormatNameIndex();
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: GetFormatDesc()
+// Desc: Gives back the metadata of a format, nullptr if the viewer doesn't
+//       know it
+//-----------------------------------------------------------------------------
+const FORMATDESC* GetFormatDesc(DXGI_FORMAT format)
+{
+    const UINT fmt = static_cast<UINT>(format);
+    if (fmt >= c_cFormatSupport || !c_formatIndex.entry[fmt])
+        return nullptr;
+
+    return &c_formatDescs[c_formatIndex.entry[fmt] - 1];
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: FormatName()
+//-----------------------------------------------------------------------------
+const TCHAR* FormatName(DXGI_FORMAT format)
+{
+    const FORMATDESC* pDesc = GetFormatDesc(format);
+    return (pDesc) ? pDesc->name : TEXT("DXGI_FORMAT_UNKNOWN");
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: FindFormat()
+// Desc: Gives back the format of a name FormatName() returns,
+//       DXGI_FORMAT_UNKNOWN for any other
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+DXGI_FORMAT FindFormat(const TCHAR* strName)
+{
+    UINT slot = HashFormatName(strName) & (c_cFormatNameSlots - 1);
+    while (c_formatNameIndex.slot[slot])
+    {
+        const FORMATDESC& desc = c_formatDescs[c_formatNameIndex.slot[slot] - 1];
+        if (_tcscmp(desc.name, strName) == 0)
+            return desc.format;
+        slot = (slot + 1) & (c_cFormatNameSlots - 1);
+    }
+
+    return DXGI_FORMAT_UNKNOWN;
+}
@@ -0,0 +1,153 @@
+//-----------------------------------------------------------------------------
+// Name: dxtables.h
+//
+// Desc: DirectX Capabilities Viewer feature level and format tables
+//
+//       The parts of the DXGI viewer that don't need a device. Feature level
+//       detection is given its probe as a callback, so dxgi.cpp runs it
+//       against the runtime and dxtest.cpp against fake devices.
+//
+//       Include after dxview.h.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include <Windows.h>
+
+#ifdef USING_DIRECTX_HEADERS
+#include <directx/d3dcommon.h>
+#include <directx/dxgiformat.h>
+#else
+#include <D3Dcommon.h>
+#include <dxgiformat.h>
+#endif
+
+#include <cstdint>
+
+// This mask is only needed for Direct3D 10.x/11 where some devices had 'holes' in the feature support.
+enum FLMASK : uint32_t
+{
+    FLMASK_9_1 = 0x1,
+    FLMASK_9_2 = 0x2,
+    FLMASK_9_3 = 0x4,
+    FLMASK_10_0 = 0x8,
+    FLMASK_10_1 = 0x10,
+    FLMASK_11_0 = 0x20,
+    FLMASK_11_1 = 0x40,
+    FLMASK_12_0 = 0x80,
+    FLMASK_12_1 = 0x100,
+};
+
+#if !defined(NTDDI_WIN10_FE) && !defined(USING_D3D12_AGILITY_SDK)
+#define D3D_FEATURE_LEVEL_12_2 static_cast<D3D_FEATURE_LEVEL>(0xc200)
+#endif
+
+// Highest first, as the runtimes take them
+constexpr D3D_FEATURE_LEVEL g_featureLevels[] =
+{
+    D3D_FEATURE_LEVEL_12_2,
+    D3D_FEATURE_LEVEL_12_1,
+    D3D_FEATURE_LEVEL_12_0,
+    D3D_FEATURE_LEVEL_11_1,
+    D3D_FEATURE_LEVEL_11_0,
+    D3D_FEATURE_LEVEL_10_1,
+    D3D_FEATURE_LEVEL_10_0,
+    D3D_FEATURE_LEVEL_9_3,
+    D3D_FEATURE_LEVEL_9_2,
+    D3D_FEATURE_LEVEL_9_1
+};
+
+// Checks whether any level in pLevels can be created, returning the highest in *pfl
+using LPFLPROBE = HRESULT(*)(void* pContext, const D3D_FEATURE_LEVEL* pLevels, UINT nLevels, D3D_FEATURE_LEVEL* pfl);
+
+// Name and value of a constant as text, e.g. "D3D11_REQ_MAXANISOTROPY( 16 )"
+#define XTOSTRING(a) #a TOSTRING(a)
+#define TOSTRING(a) #a
+
+#define XTOSTRING2(a) #a TOSTRING2(a)
+#define TOSTRING2(a) "( " #a " )"
+
+
+//-----------------------------------------------------------------------------
+// Name: FLDESC
+// Desc: What each feature level requires, independent of the device.
+//       D3D_FeatureLevel() starts from these values and only queries the
+//       device for the optional features and tiers.
+//-----------------------------------------------------------------------------
+struct FLLIMITS
+{
+    const char* maxTexDim;
+    const char* maxCubeDim;
+    const char* maxVolDim;
+    const char* maxTexRepeat;
+    const char* maxAnisotropy;
+    const char* maxPrimCount;
+    const char* maxInputSlots;
+    const char* mrt;
+};
+
+struct FLDESC
+{
+    D3D_FEATURE_LEVEL   fl;
+    const FLLIMITS*     pLimits;
+    const char*         shaderModel;    // nullptr if the device reports it
+    const char*         computeShader;
+    const char*         extFormats;
+    const char*         x2_10BitFormat;
+    const char*         logic_ops;
+    const char*         cb_partial;
+    const char*         cb_offsetting;
+    const char*         uavSlots;
+    const char*         uavEveryStage;
+    const char*         uavOnlyRender;
+    const char*         nonpow2;
+    const char*         bpp16;
+    const char*         instancing;
+    bool                _10level9;
+};
+
+
+//-----------------------------------------------------------------------------
+// Name: FORMATDESC
+// Desc: Name and metadata of a DXGI_FORMAT this viewer knows
+//-----------------------------------------------------------------------------
+enum FORMATFLAGS : BYTE
+{
+    FMT_TYPELESS = 0x1,
+    FMT_BC = 0x2,
+    FMT_VIDEO = 0x4,
+    FMT_DEPTH = 0x8,
+};
+
+struct FORMATDESC
+{
+    DXGI_FORMAT     format;
+    const TCHAR*    name;
+    BYTE            bitsPerPixel;   // Average for planar and block-compressed formats
+    BYTE            flags;          // FORMATFLAGS
+};
+
+// One past the highest format value the viewer knows
+constexpr UINT c_cFormatSupport = DXGI_FORMAT_V408 + 1;
+
+
+//-----------------------------------------------------------------------------
+// Feature level functions
+//-----------------------------------------------------------------------------
+DWORD   FeatureLevelMask(D3D_FEATURE_LEVEL fl);
+HRESULT DetectFeatureLevels(_In_reads_(nLevels) const D3D_FEATURE_LEVEL* pLevels, UINT nLevels,
+                            _In_ LPFLPROBE fnProbe, _In_opt_ void* pContext,
+                            _Out_ D3D_FEATURE_LEVEL* pflHigh, _Out_ DWORD* pflMask, _Out_ UINT* pnProbes);
+const FLDESC* FindFLDesc(D3D_FEATURE_LEVEL fl);
+
+
+//-----------------------------------------------------------------------------
+// Format functions
+//-----------------------------------------------------------------------------
+const FORMATDESC* GetFormatDesc(DXGI_FORMAT format);
+const TCHAR* FormatName(DXGI_FORMAT format);
+DXGI_FORMAT FindFormat(_In_z_ const TCHAR* strName);
@@ -0,0 +1,823 @@
+//-----------------------------------------------------------------------------
+// Name: dxtest.cpp
+//
+// Desc: DirectX Capabilities Viewer unit tests
+//
+//       A console program run by ctest. It links the viewer's modules that
+//       need neither a window nor a DirectX device, and drives them with
+//       fakes. Prints each failed check and exits with 1 if there was one.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+#include <cstdarg>
+#include <cwchar>
+
+#include <dxgi.h>
+#include <d3d11.h>
+
+#include "dxtables.h"
+
+namespace
+{
+    UINT s_cChecks = 0;
+    UINT s_cFailures = 0;
+
+    VOID Check(bool fOK, const CHAR* strExpr, int line)
+    {
+        ++s_cChecks;
+        if (!fOK)
+        {
+            ++s_cFailures;
+            printf("dxtest.cpp(%d): check failed: %s\n", line, strExpr);
+        }
+    }
+}
+
+#define CHECK(expr) Check(!!(expr), #expr, __LINE__)
+
+
+//-----------------------------------------------------------------------------
+// What the linked modules take from the rest of the viewer. There is no
+// window, and rows only go to emitters.
+//-----------------------------------------------------------------------------
+extern const char c_szYes[] = "Yes";
+extern const char c_szNo[] = "No";
+extern const char c_szNA[] = "n/a";
+
+HWND    g_hwndLV = nullptr;
+DWORD   g_dwViewState = IDM_VIEWALL;
+DWORD   g_dwView9Ex = 0;
+
+HRESULT Int2Str(LPTSTR strDest, UINT nDestLen, DWORD i)
+{
+    return (sprintf_s(strDest, nDestLen, "%lu", i) < 0) ? E_FAIL : S_OK;
+}
+
+VOID LVAddColumn(HWND, int, const CHAR*, int) {}
+HRESULT PrintLine(int, int, LPCTSTR, size_t, PRINTCBINFO*) { return E_NOTIMPL; }
+HRESULT PrintNextLine(PRINTCBINFO*) { return E_NOTIMPL; }
+HRESULT PrintStringValueLine(const CHAR*, const CHAR*, PRINTCBINFO*) { return E_NOTIMPL; }
+HRESULT PrintStringLine(const CHAR*, PRINTCBINFO*) { return E_NOTIMPL; }
+VOID SearchReset() {}
+VOID SearchNodeExpanded(HCAPNODE) {}
+VOID DXG_ExpandRenderFormats(HCAPNODE, LPARAM, LPARAM, LPARAM) {}
+VOID DXG_ExpandMultiSample(HCAPNODE, LPARAM, LPARAM, LPARAM) {}
+
+// From dxmock.cpp, as dxgi.cpp declares them
+HRESULT WINAPI MockCreateDXGIFactory1(REFIID riid, void** ppFactory);
+HRESULT WINAPI MockD3D11CreateDevice(IDXGIAdapter* pAdapter, D3D_DRIVER_TYPE driverType, HMODULE hSoftware,
+    UINT flags, const D3D_FEATURE_LEVEL* pFeatureLevels, UINT featureLevels, UINT sdkVersion,
+    ID3D11Device** ppDevice, D3D_FEATURE_LEVEL* pFeatureLevel, ID3D11DeviceContext** ppImmediateContext);
+
+
+//-----------------------------------------------------------------------------
+// Feature level detection
+//-----------------------------------------------------------------------------
+namespace
+{
+    // A device as D3D11CreateDevice() sees it
+    struct FAKEDEVICE
+    {
+        DWORD               flMask;     // Levels the device supports
+        D3D_FEATURE_LEVEL   flMaxKnown; // Highest level the runtime knows
+        D3D_FEATURE_LEVEL   flAnswer;   // Given back by every successful probe, if set
+        UINT                cProbes;
+    };
+
+    HRESULT FakeProbe(void* pContext, const D3D_FEATURE_LEVEL* pLevels, UINT nLevels, D3D_FEATURE_LEVEL* pfl)
+    {
+        auto pDevice = static_cast<FAKEDEVICE*>(pContext);
+        ++pDevice->cProbes;
+
+        for (UINT i = 0; i < nLevels; ++i)
+        {
+            if (pLevels[i] > pDevice->flMaxKnown)
+                return E_INVALIDARG;
+        }
+
+        for (UINT i = 0; i < nLevels; ++i)
+        {
+            if (pDevice->flMask & FeatureLevelMask(pLevels[i]))
+            {
+                *pfl = (pDevice->flAnswer) ? pDevice->flAnswer : pLevels[i];
+                return S_FALSE;
+            }
+        }
+
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: TestDetectFeatureLevels()
+    // Desc: Runs the detection on every set of supported levels, including
+    //       ones with holes, and for runtimes that know fewer levels
+    //-----------------------------------------------------------------------------
+    VOID TestDetectFeatureLevels()
+    {
+        // The list ProbeAdapter() passes, without 12.2
+        const D3D_FEATURE_LEVEL* pLevels = &g_featureLevels[1];
+        const UINT nLevels = static_cast<UINT>(std::size(g_featureLevels) - 1);
+
+        DWORD flAll = 0;
+        for (UINT i = 0; i < nLevels; ++i)
+        {
+            DWORD flBit = FeatureLevelMask(pLevels[i]);
+            CHECK(flBit != 0 && !(flAll & flBit));
+            flAll |= flBit;
+        }
+        CHECK(FeatureLevelMask(D3D_FEATURE_LEVEL_12_2) == 0);
+
+        for (UINT iKnown = 0; iKnown < nLevels; ++iKnown)
+        {
+            for (DWORD flMask = 0; flMask <= flAll; ++flMask)
+            {
+                DWORD flExpected = 0;
+                D3D_FEATURE_LEVEL flHighExpected = (D3D_FEATURE_LEVEL)0;
+                for (UINT i = iKnown; i < nLevels; ++i)
+                {
+                    if (flMask & FeatureLevelMask(pLevels[i]))
+                    {
+                        flExpected |= FeatureLevelMask(pLevels[i]);
+                        if (!flHighExpected)
+                            flHighExpected = pLevels[i];
+                    }
+                }
+
+                FAKEDEVICE device = { flMask, pLevels[iKnown], (D3D_FEATURE_LEVEL)0, 0 };
+                D3D_FEATURE_LEVEL flHigh = (D3D_FEATURE_LEVEL)0;
+                DWORD flFound = 0;
+                UINT nProbes = 0;
+                HRESULT hr = DetectFeatureLevels(pLevels, nLevels, FakeProbe, &device, &flHigh, &flFound, &nProbes);
+
+                CHECK(SUCCEEDED(hr) == (flExpected != 0));
+                CHECK(flHigh == flHighExpected);
+                CHECK(flFound == flExpected);
+                CHECK(nProbes == device.cProbes);
+
+                // The whole list, the bisection for the known levels, then
+                // each level below the highest
+                CHECK(nProbes <= 1 + 4 + nLevels);
+            }
+        }
+
+        // An answer that isn't in the list: every level is probed by itself
+        FAKEDEVICE device = { FLMASK_11_0 | FLMASK_10_0 | FLMASK_9_1, D3D_FEATURE_LEVEL_12_1, D3D_FEATURE_LEVEL_12_2, 0 };
+        D3D_FEATURE_LEVEL flHigh = (D3D_FEATURE_LEVEL)0;
+        DWORD flFound = 0;
+        UINT nProbes = 0;
+        CHECK(SUCCEEDED(DetectFeatureLevels(pLevels, nLevels, FakeProbe, &device, &flHigh, &flFound, &nProbes)));
+        CHECK(flHigh == D3D_FEATURE_LEVEL_11_0);
+        CHECK(flFound == (FLMASK_11_0 | FLMASK_10_0 | FLMASK_9_1));
+        CHECK(nProbes == 1 + nLevels);
+
+        device = { FLMASK_11_0, D3D_FEATURE_LEVEL_12_1, (D3D_FEATURE_LEVEL)0, 0 };
+        CHECK(DetectFeatureLevels(pLevels, 0, FakeProbe, &device, &flHigh, &flFound, &nProbes) == E_INVALIDARG);
+        CHECK(nProbes == 0 && device.cProbes == 0 && flHigh == 0 && flFound == 0);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: TestFLDescs()
+    // Desc: Checks that c_flDescs has what D3D_FeatureLevel() takes from it
+    //       for every level, and that the limits are the headers' values
+    //-----------------------------------------------------------------------------
+    VOID TestFLDescs()
+    {
+        for (D3D_FEATURE_LEVEL fl : g_featureLevels)
+        {
+            const FLDESC* pDesc = FindFLDesc(fl);
+            CHECK(pDesc && pDesc->fl == fl);
+            if (!pDesc)
+                continue;
+
+            const FLLIMITS* pLimits = pDesc->pLimits;
+            CHECK(pLimits != nullptr);
+            if (pLimits)
+            {
+                for (const char* str : { pLimits->maxTexDim, pLimits->maxCubeDim, pLimits->maxVolDim, pLimits->maxTexRepeat,
+                                         pLimits->maxAnisotropy, pLimits->maxPrimCount, pLimits->maxInputSlots, pLimits->mrt })
+                {
+                    CHECK(str && *str);
+                }
+            }
+
+            // Shown as they are, the others are filled in from the device
+            CHECK(pDesc->computeShader && pDesc->logic_ops && pDesc->cb_partial && pDesc->cb_offsetting
+                && pDesc->bpp16 && pDesc->instancing);
+
+            // Only Direct3D 12 devices report their shader model
+            CHECK(!pDesc->shaderModel == (fl >= D3D_FEATURE_LEVEL_12_0));
+            CHECK(!pDesc->uavSlots == (fl < D3D_FEATURE_LEVEL_11_1));
+            CHECK(pDesc->_10level9 == (fl < D3D_FEATURE_LEVEL_10_0));
+        }
+
+        const struct
+        {
+            D3D_FEATURE_LEVEL   fl;
+            const char*         maxTexDim;
+        } c_texDims[] =
+        {
+            { D3D_FEATURE_LEVEL_12_2, "( 16384 )" },
+            { D3D_FEATURE_LEVEL_11_0, "( 16384 )" },
+            { D3D_FEATURE_LEVEL_10_1, "( 8192 )" },
+            { D3D_FEATURE_LEVEL_10_0, "( 8192 )" },
+            { D3D_FEATURE_LEVEL_9_3, "( 4096 )" },
+            { D3D_FEATURE_LEVEL_9_2, "( 2048 )" },
+            { D3D_FEATURE_LEVEL_9_1, "( 2048 )" },
+        };
+
+        for (const auto& texDim : c_texDims)
+        {
+            const FLDESC* pDesc = FindFLDesc(texDim.fl);
+            CHECK(pDesc && strstr(pDesc->pLimits->maxTexDim, texDim.maxTexDim));
+        }
+
+        CHECK(FindFLDesc(static_cast<D3D_FEATURE_LEVEL>(0xa200)) == nullptr);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Formats
+//-----------------------------------------------------------------------------
+namespace
+{
+    //-----------------------------------------------------------------------------
+    // Name: TestFormatNames()
+    // Desc: Maps every known format to its name and back
+    //-----------------------------------------------------------------------------
+    VOID TestFormatNames()
+    {
+        UINT cFormats = 0;
+        for (UINT fmt = 0; fmt < c_cFormatSupport; ++fmt)
+        {
+            const auto format = static_cast<DXGI_FORMAT>(fmt);
+            const FORMATDESC* pDesc = GetFormatDesc(format);
+            if (!pDesc)
+            {
+                CHECK(_tcscmp(FormatName(format), TEXT("DXGI_FORMAT_UNKNOWN")) == 0);
+                continue;
+            }
+
+            ++cFormats;
+            CHECK(pDesc->format == format);
+            CHECK(_tcsncmp(pDesc->name, TEXT("DXGI_FORMAT_"), 12) == 0);
+            CHECK(FindFormat(FormatName(format)) == format);
+        }
+        CHECK(cFormats == 118);
+        CHECK(GetFormatDesc(static_cast<DXGI_FORMAT>(c_cFormatSupport)) == nullptr);
+
+        for (const TCHAR* strName : { TEXT(""), TEXT("DXGI_FORMAT_UNKNOWN"), TEXT("DXGI_FORMAT_R8G8B8A8_UNORM_"),
+                                      TEXT("DXGI_FORMAT_R8G8B8A8_UNOR"), TEXT("dxgi_format_r8g8b8a8_unorm"), TEXT("28") })
+        {
+            CHECK(FindFormat(strName) == DXGI_FORMAT_UNKNOWN);
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Output sink
+//-----------------------------------------------------------------------------
+namespace
+{
+    // What a SINKWRITE was handed
+    struct SINKLOG
+    {
+        CHAR*   pData;
+        size_t  cbMax;
+        size_t  cbData;
+        UINT    cWrites;
+        UINT    cFailAfter;     // Writes that succeed before the writer fails, 0 for all
+    };
+
+    BOOL LogWrite(void* pContext, const void* pData, DWORD cbData)
+    {
+        auto pLog = static_cast<SINKLOG*>(pContext);
+        ++pLog->cWrites;
+        if (pLog->cFailAfter && pLog->cWrites > pLog->cFailAfter)
+            return FALSE;
+        if (cbData > c_cbSinkBuffer || pLog->cbData + cbData > pLog->cbMax)
+            return FALSE;
+
+        memcpy(pLog->pData + pLog->cbData, pData, cbData);
+        pLog->cbData += cbData;
+        return TRUE;
+    }
+
+    // Blocks handed on for cb bytes of output, before the final flush
+    UINT FullBlocks(size_t cb)
+    {
+        return (cb) ? static_cast<UINT>((cb - 1) / c_cbSinkBuffer) : 0;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: TestSink()
+    // Desc: Checks that output is handed on in whole buffers, unchanged, and
+    //       that a failed write drops the rest
+    //-----------------------------------------------------------------------------
+    VOID TestSink()
+    {
+        constexpr size_t cbMax = 4 * c_cbSinkBuffer;
+
+        auto pSink = new (std::nothrow) OUTPUTSINK;
+        auto pExpected = new (std::nothrow) CHAR[cbMax];
+        auto pData = new (std::nothrow) CHAR[cbMax];
+        if (!pSink || !pExpected || !pData)
+        {
+            CHECK(!"out of memory");
+            delete pSink;
+            delete[] pExpected;
+            delete[] pData;
+            return;
+        }
+
+        // Lines as PrintLine() writes them: padding, text, then a line break
+        SINKLOG log = { pData, cbMax, 0, 0, 0 };
+        SinkInit(pSink, LogWrite, &log);
+        CHECK(SinkFlush(pSink) && log.cWrites == 0);
+
+        size_t cbExpected = 0;
+        bool fBuffered = true;
+        for (UINT iLine = 0; cbExpected + 256 < 3 * c_cbSinkBuffer + c_cbSinkBuffer / 2; ++iLine)
+        {
+            const size_t cchPad = iLine % 37;
+            SinkFill(pSink, ' ', cchPad);
+            memset(pExpected + cbExpected, ' ', cchPad);
+            cbExpected += cchPad;
+
+            CHAR szLine[32];
+            int cch = sprintf_s(szLine, "Line %u\r\n", iLine);
+            SinkWrite(pSink, szLine, static_cast<size_t>(cch));
+            memcpy(pExpected + cbExpected, szLine, static_cast<size_t>(cch));
+            cbExpected += static_cast<size_t>(cch);
+
+            fBuffered = fBuffered && (log.cWrites == FullBlocks(cbExpected));
+        }
+        CHECK(fBuffered);
+        CHECK(log.cbData == log.cWrites * c_cbSinkBuffer);
+
+        CHECK(SinkFlush(pSink));
+        CHECK(log.cWrites == FullBlocks(cbExpected) + 1);
+        CHECK(log.cbData == cbExpected && memcmp(pData, pExpected, cbExpected) == 0);
+        CHECK(SinkFlush(pSink) && log.cWrites == FullBlocks(cbExpected) + 1);
+
+        // A write larger than the buffer is split into whole buffers
+        log = { pData, cbMax, 0, 0, 0 };
+        SinkInit(pSink, LogWrite, &log);
+        SinkWrite(pSink, pExpected, 2 * c_cbSinkBuffer + 5);
+        CHECK(log.cWrites == 2);
+        CHECK(SinkFlush(pSink) && log.cWrites == 3);
+        CHECK(log.cbData == 2 * c_cbSinkBuffer + 5 && memcmp(pData, pExpected, log.cbData) == 0);
+
+        // Once the writer fails, nothing else is handed to it
+        log = { pData, cbMax, 0, 0, 1 };
+        SinkInit(pSink, LogWrite, &log);
+        SinkWrite(pSink, pExpected, 3 * c_cbSinkBuffer);
+        CHECK(log.cWrites == 2 && pSink->fFailed);
+        CHECK(!SinkFlush(pSink) && log.cWrites == 2);
+        SinkFill(pSink, ' ', 10);
+        CHECK(!SinkFlush(pSink) && log.cWrites == 2 && log.cbData == c_cbSinkBuffer);
+        CHECK(!SinkFlush(nullptr));
+
+        // JSON strings are quoted and escaped
+        log = { pData, cbMax, 0, 0, 0 };
+        SinkInit(pSink, LogWrite, &log);
+        const CHAR szText[] = "a\"b\\c\td";
+        SinkWriteJsonString(pSink, szText, strlen(szText));
+        CHECK(SinkFlush(pSink));
+        const CHAR szJson[] = "\"a\\\"b\\\\c\\u0009d\"";
+        CHECK(log.cbData == strlen(szJson) && memcmp(pData, szJson, log.cbData) == 0);
+
+        delete pSink;
+        delete[] pExpected;
+        delete[] pData;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Probe tracing
+//-----------------------------------------------------------------------------
+namespace
+{
+    // Reads a file the tests wrote, with a NUL appended, nullptr if it
+    // can't. Free with delete[].
+    CHAR* ReadTextFile(LPCSTR szPath, DWORD* pcbRead = nullptr)
+    {
+        HANDLE hFile = CreateFile(szPath, GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (hFile == INVALID_HANDLE_VALUE)
+            return nullptr;
+
+        LARGE_INTEGER fileSize = {};
+        DWORD cbRead = 0;
+        CHAR* pText = nullptr;
+        if (GetFileSizeEx(hFile, &fileSize) && fileSize.HighPart == 0 && fileSize.LowPart < MAXDWORD)
+        {
+            pText = new (std::nothrow) CHAR[fileSize.LowPart + 1];
+            if (pText && (!ReadFile(hFile, pText, fileSize.LowPart, &cbRead, nullptr) || cbRead != fileSize.LowPart))
+            {
+                delete[] pText;
+                pText = nullptr;
+            }
+        }
+        CloseHandle(hFile);
+
+        if (pText)
+            pText[cbRead] = '\0';
+        if (pcbRead)
+            *pcbRead = (pText) ? cbRead : 0;
+        return pText;
+    }
+
+    UINT CountText(const CHAR* strText, const CHAR* strFind)
+    {
+        UINT cFound = 0;
+        for (const CHAR* pch = strstr(strText, strFind); pch; pch = strstr(pch + 1, strFind))
+            ++cFound;
+        return cFound;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: TestTrace()
+    // Desc: Overfills the calling thread's ring, and checks that the file
+    //       holds the newest events and the number dropped
+    //-----------------------------------------------------------------------------
+    VOID TestTrace()
+    {
+        constexpr UINT c_cTraceEvents = 16 * 1024;  // As in dxtrace.cpp
+        constexpr UINT c_cDropped = 100;
+        const CHAR szPath[] = "dxtest.trace.json";
+
+        CHECK(!TraceWrite(szPath));
+
+        TraceStart();
+        CHECK(g_fTrace);
+
+        for (UINT i = 0; i < c_cDropped; ++i)
+        {
+            TRACESCOPE scope("Old");
+        }
+        for (UINT i = 0; i < c_cTraceEvents - 1; ++i)
+        {
+            TRACESCOPE scope("New", (i & 1) ? "odd" : nullptr);
+        }
+        TraceAdd("Quote\"d", "Tab\t", TraceNow());
+
+        CHECK(TraceWrite(szPath));
+        CHECK(!g_fTrace);
+        CHECK(!TraceWrite(szPath));
+
+        CHAR* pText = ReadTextFile(szPath);
+        CHECK(pText != nullptr);
+        if (pText)
+        {
+            CHECK(strncmp(pText, "{\"traceEvents\":[", 16) == 0);
+            CHECK(CountText(pText, "\"thread_name\"") == 1);
+            CHECK(CountText(pText, "\"ph\":\"X\"") == c_cTraceEvents);
+            CHECK(CountText(pText, "{\"name\":\"Old\"") == 0);
+            CHECK(CountText(pText, "{\"name\":\"New\"") == c_cTraceEvents - 1);
+            CHECK(CountText(pText, "\"args\":{\"detail\":\"odd\"}") == (c_cTraceEvents - 1) / 2);
+            CHECK(CountText(pText, "{\"name\":\"Quote\\\"d\"") == 1);
+            CHECK(CountText(pText, "\"detail\":\"Tab\\u0009\"") == 1);
+            CHECK(CountText(pText, "\"otherData\":{\"dropped\":\"100\"}}") == 1);
+            delete[] pText;
+        }
+        DeleteFile(szPath);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Capability tree and snapshots
+//-----------------------------------------------------------------------------
+namespace
+{
+    constexpr UINT c_cManyNodes = 3000;
+
+    // Payload of a test node, from TVAlloc()
+    struct TESTCAPS
+    {
+        DWORD   dwValue;
+        BOOL    fSupported;
+    };
+
+    HRESULT DisplayTestCaps(LPARAM lParam1, LPARAM /*lParam2*/, PRINTCBINFO* pPrintInfo)
+    {
+        auto pCaps = reinterpret_cast<const TESTCAPS*>(lParam1);
+        EmitValueRow(pPrintInfo, "Value", pCaps->dwValue);
+        return EmitYesNoRow(pPrintInfo, "Supported", pCaps->fSupported);
+    }
+
+    HCAPNODE AddTestNode(HCAPNODE hParent, LPCSTR strText, DWORD dwValue, BOOL fSupported)
+    {
+        auto pCaps = static_cast<TESTCAPS*>(TVAlloc(sizeof(TESTCAPS)));
+        if (!pCaps)
+            return nullptr;
+
+        pCaps->dwValue = dwValue;
+        pCaps->fSupported = fSupported;
+        return TVAddNode(hParent, strText, FALSE, IDI_CAPS, DisplayTestCaps, reinterpret_cast<LPARAM>(pCaps), 0);
+    }
+
+    VOID ExpandTestNode(HCAPNODE hParent, LPARAM lParam1, LPARAM /*lParam2*/, LPARAM /*lParam3*/)
+    {
+        for (LPARAM i = 0; i < lParam1; ++i)
+            AddTestNode(hParent, "Expanded", static_cast<DWORD>(i), TRUE);
+    }
+
+    // Text of a snapshot walk, or of what it should give
+    struct TESTLOG
+    {
+        CHAR*   pText;
+        size_t  cchMax;
+        size_t  cch;
+    };
+
+    VOID LogAppend(TESTLOG* pLog, const CHAR* strFormat, ...)
+    {
+        va_list args;
+        va_start(args, strFormat);
+        int cch = vsnprintf(pLog->pText + pLog->cch, pLog->cchMax - pLog->cch, strFormat, args);
+        va_end(args);
+
+        if (cch > 0)
+        {
+            pLog->cch += static_cast<size_t>(cch);
+            if (pLog->cch >= pLog->cchMax)
+                pLog->cch = pLog->cchMax - 1;
+        }
+    }
+
+    VOID LogNode(void* pContext, UINT depth, const CHAR* strText)
+    {
+        LogAppend(static_cast<TESTLOG*>(pContext), "%u %s\n", depth, strText);
+    }
+
+    HRESULT LogColumn(void* /*pContext*/, int /*iCol*/, const CHAR* /*strName*/, int /*width*/)
+    {
+        return S_OK;
+    }
+
+    HRESULT LogRow(void* pContext, UINT cCells, const ROWCELL* pCells)
+    {
+        auto pLog = static_cast<TESTLOG*>(pContext);
+        LogAppend(pLog, " ");
+        for (UINT i = 0; i < cCells; ++i)
+        {
+            CHAR szBuff[c_cchRowCell];
+            LogAppend(pLog, " %s", RowCellText(&pCells[i], szBuff));
+        }
+        LogAppend(pLog, "\n");
+        return S_OK;
+    }
+
+    VOID LogTestCaps(TESTLOG* pLog, UINT depth, const CHAR* strText, DWORD dwValue, BOOL fSupported)
+    {
+        LogAppend(pLog, "%u %s\n  Value %lu\n  Supported %s\n", depth, strText, dwValue,
+            (fSupported) ? c_szYes : c_szNo);
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: TestSnapshot()
+    // Desc: Builds a tree in the node arena, saves it as a snapshot, walks
+    //       it, and checks that a tree read back from it saves the same file
+    //-----------------------------------------------------------------------------
+    VOID TestSnapshot()
+    {
+        const CHAR szPath[] = "dxtest.snapshot";
+        const CHAR szPath2[] = "dxtest2.snapshot";
+        constexpr size_t cchLog = 512 * 1024;
+
+        TESTLOG expected = { new (std::nothrow) CHAR[cchLog], cchLog, 0 };
+        TESTLOG walked = { new (std::nothrow) CHAR[cchLog], cchLog, 0 };
+        if (!expected.pText || !walked.pText)
+        {
+            CHECK(!"out of memory");
+            delete[] expected.pText;
+            delete[] walked.pText;
+            return;
+        }
+        *expected.pText = *walked.pText = '\0';
+
+        HCAPNODE hRoot = TVAddNode(nullptr, "Root", TRUE, IDI_DIRECTX, nullptr, 0, 0);
+        AddTestNode(hRoot, "First", 1, TRUE);
+        HCAPNODE hSecond = AddTestNode(hRoot, "Second", 2, FALSE);
+        AddTestNode(hSecond, "Grandchild", 3, TRUE);
+        TVExpandNode(hSecond);
+
+        // Left out of the snapshot, with its child
+        HCAPNODE hSkipped = TVAddNode(hRoot, "Skipped", TRUE, IDI_CAPS, nullptr, 0, 0);
+        if (hSkipped)
+            hSkipped->fNoSnapshot = TRUE;
+        AddTestNode(hSkipped, "Skipped child", 4, TRUE);
+
+        TVAddLazyNode(hRoot, "Lazy", IDI_CAPS, ExpandTestNode, 2, 0, 0);
+        HCAPNODE hMany = TVAddNode(nullptr, "Many", TRUE, IDI_DIRECTX, nullptr, 0, 0);
+        for (UINT i = 0; i < c_cManyNodes; ++i)
+            AddTestNode(hMany, "Item", i, i & 1);
+
+        // Nodes and payloads share the chunks
+        const NODEARENA* pArena = TVGetArena();
+        const DWORD cNodes = 8 + c_cManyNodes;
+        CHECK(pArena->cNodes == cNodes);
+        CHECK(pArena->cAllocs == cNodes + 4 + c_cManyNodes);
+        CHECK(pArena->cChunks > 1 && pArena->cbUsed > cNodes * sizeof(CAPNODE) && pArena->cbUsed <= pArena->cbReserved);
+
+        LogAppend(&expected, "0 Root\n");
+        LogTestCaps(&expected, 1, "First", 1, TRUE);
+        LogTestCaps(&expected, 1, "Second", 2, FALSE);
+        LogTestCaps(&expected, 2, "Grandchild", 3, TRUE);
+        LogAppend(&expected, "1 Lazy\n");
+        LogTestCaps(&expected, 2, "Expanded", 0, TRUE);
+        LogTestCaps(&expected, 2, "Expanded", 1, TRUE);
+        LogAppend(&expected, "0 Many\n");
+        for (UINT i = 0; i < c_cManyNodes; ++i)
+            LogTestCaps(&expected, 1, "Item", i, i & 1);
+
+        // Saving expands the lazy node
+        CHECK(CacheSaveSnapshot(szPath));
+        CHECK(pArena->cNodes == cNodes + 2);
+
+        const SNAPSHOTWALKER walker = { LogNode, { LogColumn, LogRow, &walked } };
+        CHECK(CacheWalkSnapshot(szPath, &walker));
+        CHECK(walked.cch == expected.cch && strcmp(walked.pText, expected.pText) == 0);
+
+        TVFreeNodes();
+        CHECK(!TVGetRoot());
+        CHECK(pArena->cNodes == 0 && pArena->cAllocs == 0 && pArena->cChunks == 0 && pArena->cbReserved == 0);
+
+        // Read back, the nodes point into the snapshot instead of payloads
+        CHECK(CacheOpenSnapshot(szPath));
+        CHECK(pArena->cNodes == cNodes && pArena->cAllocs == cNodes);
+        hRoot = TVGetRoot();
+        CHECK(hRoot && strcmp(hRoot->strText, "Root") == 0 && hRoot->pNext && !hRoot->pNext->pNext);
+        hSecond = (hRoot && hRoot->pFirstChild) ? hRoot->pFirstChild->pNext : nullptr;
+        CHECK(hSecond && strcmp(hSecond->strText, "Second") == 0 && hSecond->fExpanded);
+
+        CHECK(CacheSaveSnapshot(szPath2));
+        DWORD cb = 0;
+        DWORD cb2 = 0;
+        CHAR* pFile = ReadTextFile(szPath, &cb);
+        CHAR* pFile2 = ReadTextFile(szPath2, &cb2);
+        CHECK(pFile && pFile2 && cb > 0 && cb == cb2 && memcmp(pFile, pFile2, cb) == 0);
+        delete[] pFile;
+        delete[] pFile2;
+
+        TVFreeNodes();
+        CacheFree();
+
+        walked.cch = 0;
+        CHECK(!CacheWalkSnapshot("dxtest.missing", &walker) && walked.cch == 0);
+
+        DeleteFile(szPath);
+        DeleteFile(szPath2);
+        delete[] expected.pText;
+        delete[] walked.pText;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Mock devices
+//-----------------------------------------------------------------------------
+namespace
+{
+    // Names, comments, blanks, a repeated setting and a recorded answer.
+    // The recorded answers for formats 87 (DXGI_FORMAT_B8G8R8A8_UNORM) and 3
+    // take precedence over their settings.
+    const CHAR c_szMockFile[] =
+        "# Test adapter\r\n"
+        "adapters = 1\r\n"
+        "\r\n"
+        "adapter0.description =\tTest adapter   # Trimmed\r\n"
+        "adapter0.vendorid = 0x1234\r\n"
+        "adapter0.vendorid = 0x10de\r\n"
+        "adapter0.d3d11.featurelevel = 0xa100\r\n"
+        "adapter0.d3d11.format.DXGI_FORMAT_R8G8B8A8_UNORM = 0x6bb5e002\r\n"
+        "adapter0.d3d11.format.DXGI_FORMAT_B8G8R8A8_UNORM = 0x1\r\n"
+        "adapter0.d3d11.format.DXGI_FORMAT_NOT_A_FORMAT = 0x1\r\n"
+        "adapter0.d3d11.format.2 = 0x8\r\n"
+        "adapter0.d3d11.format.3 = 0x8\r\n"
+        "adapter0.d3d11.CheckFormatSupport.87 = 0x00000000 02000000\r\n"
+        "adapter0.d3d11.CheckFormatSupport.3 = 0x80004005";
+
+    BOOL WriteTextFile(LPCSTR szPath, const CHAR* strText)
+    {
+        HANDLE hFile = CreateFile(szPath, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (hFile == INVALID_HANDLE_VALUE)
+            return FALSE;
+
+        DWORD cbText = static_cast<DWORD>(strlen(strText));
+        DWORD cbWritten = 0;
+        BOOL fOK = WriteFile(hFile, strText, cbText, &cbWritten, nullptr) && cbWritten == cbText;
+        CloseHandle(hFile);
+        return fOK;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: TestMock()
+    // Desc: Loads a mock file and queries its adapter through the entry points
+    //       the probes use. Recording isn't tested, as it wraps the real
+    //       runtimes and whatever adapters the machine has.
+    //-----------------------------------------------------------------------------
+    VOID TestMock()
+    {
+        const CHAR szPath[] = "dxtest.mock.txt";
+
+        IDXGIFactory1* pFactory = nullptr;
+        CHECK(!MockIsActive());
+        CHECK(!MockStart(szPath));
+        CHECK(MockCreateDXGIFactory1(IID_PPV_ARGS(&pFactory)) == DXGI_ERROR_UNSUPPORTED);
+
+        CHECK(WriteTextFile(szPath, c_szMockFile));
+        CHECK(MockStart(szPath));
+        CHECK(MockIsActive());
+        CHECK(!MockIsRecording());
+        CHECK(!MockStart(szPath));
+        DeleteFile(szPath);
+
+        CHECK(SUCCEEDED(MockCreateDXGIFactory1(IID_PPV_ARGS(&pFactory))));
+        if (!pFactory)
+        {
+            MockStop();
+            return;
+        }
+
+        IDXGIAdapter1* pAdapter = nullptr;
+        CHECK(pFactory->EnumAdapters1(1, &pAdapter) == DXGI_ERROR_NOT_FOUND);
+        CHECK(pAdapter == nullptr);
+        CHECK(pFactory->EnumAdapters1(0, &pAdapter) == S_OK);
+        if (pAdapter)
+        {
+            DXGI_ADAPTER_DESC1 desc = {};
+            CHECK(pAdapter->GetDesc1(&desc) == S_OK);
+            CHECK(wcscmp(desc.Description, L"Test adapter") == 0);
+            CHECK(desc.VendorId == 0x10de);
+            CHECK(desc.DeviceId == 0);
+
+            D3D_FEATURE_LEVEL fl = D3D_FEATURE_LEVEL_9_1;
+            CHECK(MockD3D11CreateDevice(pAdapter, D3D_DRIVER_TYPE_UNKNOWN, nullptr, 0,
+                g_featureLevels, static_cast<UINT>(std::size(g_featureLevels)), D3D11_SDK_VERSION,
+                nullptr, &fl, nullptr) == S_FALSE);
+            CHECK(fl == D3D_FEATURE_LEVEL_10_1);
+            CHECK(MockD3D11CreateDevice(pAdapter, D3D_DRIVER_TYPE_UNKNOWN, nullptr, 0,
+                g_featureLevels, 3, D3D11_SDK_VERSION, nullptr, &fl, nullptr) == DXGI_ERROR_UNSUPPORTED);
+
+            ID3D11Device* pDevice = nullptr;
+            CHECK(MockD3D11CreateDevice(pAdapter, D3D_DRIVER_TYPE_UNKNOWN, nullptr, 0,
+                nullptr, 0, D3D11_SDK_VERSION, &pDevice, &fl, nullptr) == S_OK);
+            CHECK(fl == D3D_FEATURE_LEVEL_10_1);
+            if (pDevice)
+            {
+                CHECK(pDevice->GetFeatureLevel() == D3D_FEATURE_LEVEL_10_1);
+
+                UINT support = 0;
+                CHECK(pDevice->CheckFormatSupport(DXGI_FORMAT_R8G8B8A8_UNORM, &support) == S_OK);
+                CHECK(support == 0x6bb5e002);
+                CHECK(pDevice->CheckFormatSupport(DXGI_FORMAT_B8G8R8A8_UNORM, &support) == S_OK);
+                CHECK(support == 2);
+                CHECK(pDevice->CheckFormatSupport(DXGI_FORMAT_R32G32B32A32_FLOAT, &support) == S_OK);
+                CHECK(support == 8);
+                CHECK(pDevice->CheckFormatSupport(DXGI_FORMAT_R32G32B32A32_UINT, &support) == E_FAIL);
+                CHECK(pDevice->CheckFormatSupport(DXGI_FORMAT_R16_UNORM, &support) == E_FAIL);
+                CHECK(support == 0);
+                pDevice->Release();
+            }
+            pAdapter->Release();
+        }
+        pFactory->Release();
+
+        MockStop();
+        CHECK(!MockIsActive());
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: main()
+//-----------------------------------------------------------------------------
+int __cdecl main()
+{
+    TestDetectFeatureLevels();
+    TestFLDescs();
+    TestFormatNames();
+    TestSink();
+    TestTrace();
+    TestSnapshot();
+    TestMock();
+
+    printf("%u checks, %u failed\n", s_cChecks, s_cFailures);
+    return (s_cFailures) ? 1 : 0;
+}
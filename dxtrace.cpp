@@ -0,0 +1,244 @@
+//-----------------------------------------------------------------------------
+// Name: dxtrace.cpp
+//
+// Desc: DirectX Capabilities Viewer probe tracing
+//
+//       With "--trace <file>" every TRACESCOPE records how long its scope
+//       took, and the events are written to the file on exit in the Chrome
+//       trace event format, for chrome://tracing or ui.perfetto.dev.
+//
+//       Each thread appends to a ring buffer of its own, so recording takes
+//       no lock; once a buffer is full the oldest events are overwritten.
+//       Buffers are linked into a global list when first used and outlive
+//       their thread, so those of finished pool threads can still be
+//       written. Names are not copied and must be string literals or other
+//       static text.
+//
+//       When tracing is off a marker only tests g_fTrace.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+BOOL g_fTrace = FALSE;
+
+namespace
+{
+    constexpr DWORD c_cTraceEvents = 16 * 1024;     // Per thread, a power of 2
+
+    struct TRACEEVENT
+    {
+        const CHAR* strName;
+        const CHAR* strDetail;
+        LONGLONG    qpcStart;
+        LONGLONG    qpcEnd;
+    };
+
+    struct TRACEBUFFER
+    {
+        TRACEBUFFER*    pNext;
+        DWORD           dwThreadId;
+        DWORD           cEvents;        // Ever added, the ring holds the last c_cTraceEvents
+        TRACEEVENT      events[c_cTraceEvents];
+    };
+
+    TRACEBUFFER* volatile s_pBuffers = nullptr;
+    thread_local TRACEBUFFER* t_pBuffer = nullptr;
+    thread_local BOOL t_fNoBuffer = FALSE;
+
+    LONGLONG    s_qpcBase = 0;
+    double      s_usPerTick = 0.0;
+    DWORD       s_dwMainThread = 0;
+
+
+    //-----------------------------------------------------------------------------
+    // Name: GetBuffer()
+    // Desc: Gives back the calling thread's buffer, allocating it on first use
+    //-----------------------------------------------------------------------------
+    TRACEBUFFER* GetBuffer()
+    {
+        if (t_pBuffer || t_fNoBuffer)
+            return t_pBuffer;
+
+        auto pBuffer = new (std::nothrow) TRACEBUFFER;
+        if (!pBuffer)
+        {
+            t_fNoBuffer = TRUE;
+            return nullptr;
+        }
+
+        pBuffer->dwThreadId = GetCurrentThreadId();
+        pBuffer->cEvents = 0;
+
+        TRACEBUFFER* pHead;
+        do
+        {
+            pHead = s_pBuffers;
+            pBuffer->pNext = pHead;
+        } while (InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(&s_pBuffers), pBuffer, pHead) != pHead);
+
+        t_pBuffer = pBuffer;
+        return pBuffer;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID TraceWriteText(OUTPUTSINK* pSink, const CHAR* str)
+    {
+        SinkWrite(pSink, str, strlen(str));
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: WriteEvents()
+    // Desc: Writes the events of one thread as complete ("X") events
+    //-----------------------------------------------------------------------------
+    VOID WriteEvents(OUTPUTSINK* pSink, const TRACEBUFFER* pBuffer, BOOL* pfFirst)
+    {
+        CHAR szBuff[128];
+        sprintf_s(szBuff, "%s\r\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+            (*pfFirst) ? "" : ",", pBuffer->dwThreadId,
+            (pBuffer->dwThreadId == s_dwMainThread) ? "UI" : "Worker");
+        TraceWriteText(pSink, szBuff);
+        *pfFirst = FALSE;
+
+        DWORD cEvents = pBuffer->cEvents;
+        DWORD iFirst = (cEvents > c_cTraceEvents) ? cEvents - c_cTraceEvents : 0;
+        for (DWORD i = iFirst; i != cEvents; ++i)
+        {
+            const TRACEEVENT& event = pBuffer->events[i & (c_cTraceEvents - 1)];
+
+            TraceWriteText(pSink, ",\r\n{\"name\":");
+            SinkWriteJsonString(pSink, event.strName, strlen(event.strName));
+
+            sprintf_s(szBuff, ",\"cat\":\"probe\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f",
+                pBuffer->dwThreadId,
+                static_cast<double>(event.qpcStart - s_qpcBase) * s_usPerTick,
+                static_cast<double>(event.qpcEnd - event.qpcStart) * s_usPerTick);
+            TraceWriteText(pSink, szBuff);
+
+            if (event.strDetail)
+            {
+                TraceWriteText(pSink, ",\"args\":{\"detail\":");
+                SinkWriteJsonString(pSink, event.strDetail, strlen(event.strDetail));
+                TraceWriteText(pSink, "}");
+            }
+
+            TraceWriteText(pSink, "}");
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TraceStart()
+// Desc: Turns the trace markers on. Call before any thread is started.
+//-----------------------------------------------------------------------------
+VOID TraceStart()
+{
+    LARGE_INTEGER freq = {};
+    LARGE_INTEGER now = {};
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+
+    s_qpcBase = now.QuadPart;
+    s_usPerTick = (freq.QuadPart > 0) ? 1000000.0 / static_cast<double>(freq.QuadPart) : 0.0;
+    s_dwMainThread = GetCurrentThreadId();
+    g_fTrace = TRUE;
+}
+
+
+//-----------------------------------------------------------------------------
+LONGLONG TraceNow()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TraceAdd()
+// Desc: Records a scope that started at qpcStart and ends now
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+VOID TraceAdd(const CHAR* strName, const CHAR* strDetail, LONGLONG qpcStart)
+{
+    LONGLONG qpcEnd = TraceNow();
+
+    TRACEBUFFER* pBuffer = GetBuffer();
+    if (!pBuffer)
+        return;
+
+    TRACEEVENT& event = pBuffer->events[pBuffer->cEvents & (c_cTraceEvents - 1)];
+    event.strName = strName;
+    event.strDetail = strDetail;
+    event.qpcStart = qpcStart;
+    event.qpcEnd = qpcEnd;
+    ++pBuffer->cEvents;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TraceWrite()
+// Desc: Turns tracing off, writes the events of all threads to szPath and
+//       frees them. Call once no thread is probing anymore.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+BOOL TraceWrite(LPCSTR szPath)
+{
+    if (!g_fTrace)
+        return FALSE;
+
+    g_fTrace = FALSE;
+
+    TRACEBUFFER* pBuffers = static_cast<TRACEBUFFER*>(InterlockedExchangePointer(reinterpret_cast<PVOID volatile*>(&s_pBuffers), nullptr));
+
+    BOOL fOK = FALSE;
+    auto pSink = new (std::nothrow) OUTPUTSINK;
+    if (pSink)
+    {
+        HANDLE hFile = CreateFile(szPath, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (hFile != INVALID_HANDLE_VALUE)
+        {
+            SinkInitFile(pSink, hFile);
+
+            DWORD cDropped = 0;
+            BOOL fFirst = TRUE;
+            TraceWriteText(pSink, "{\"traceEvents\":[");
+            for (const TRACEBUFFER* pBuffer = pBuffers; pBuffer; pBuffer = pBuffer->pNext)
+            {
+                WriteEvents(pSink, pBuffer, &fFirst);
+                if (pBuffer->cEvents > c_cTraceEvents)
+                    cDropped += pBuffer->cEvents - c_cTraceEvents;
+            }
+
+            CHAR szBuff[96];
+            sprintf_s(szBuff, "\r\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":\"%lu\"}}\r\n", cDropped);
+            TraceWriteText(pSink, szBuff);
+
+            fOK = SinkFlush(pSink);
+            CloseHandle(hFile);
+
+            if (!fOK)
+                DeleteFile(szPath);
+        }
+
+        delete pSink;
+    }
+
+    // The threads that own the buffers are gone or no longer tracing
+    while (pBuffers)
+    {
+        TRACEBUFFER* pNext = pBuffers->pNext;
+        delete pBuffers;
+        pBuffers = pNext;
+    }
+    t_pBuffer = nullptr;
+
+    return fOK;
+}
@@ -0,0 +1,556 @@
+//-----------------------------------------------------------------------------
+// Name: dxtree.cpp
+//
+// Desc: DirectX Capabilities Viewer Capability Tree
+//
+//       The *_FillTree functions build an in-memory tree of CAPNODEs. The
+//       TreeView control is only a view of it: TVBindView() mirrors the
+//       model into the control, and nodes added later (lazy expansion) are
+//       mirrored as they are created. Export walks the model directly.
+//
+//       A worker thread can build sections of the tree out of view, between
+//       TVBeginStage() and TVEndStage(). The UI thread then shows them in
+//       place of their placeholders with TVSpliceStage().
+//
+//       The D3D9 formats alone make for tens of thousands of nodes, so nodes
+//       and the payloads their lParams point to (TVAlloc) are carved out of
+//       large chunks rather than allocated one by one. Nothing is freed
+//       until the whole tree is, in TVFreeNodes(). Each stage has an arena of
+//       its own, as its thread builds it, whose chunks join the tree's when
+//       the stage is spliced in.
+//
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// https://go.microsoft.com/fwlink/?linkid=2136896
+//-----------------------------------------------------------------------------
+#include "dxview.h"
+
+struct NODECHUNK
+{
+    NODECHUNK*  pNext;
+    size_t      cb;             // Of data
+    size_t      cbUsed;
+    alignas(8) BYTE data[1];
+};
+
+namespace
+{
+    constexpr size_t c_cbNodeChunk = 64 * 1024 - 64;
+    constexpr size_t c_cbNodeAlign = 8;
+
+    CAPNODE     g_capRoot = {};         // Sentinel, top-level nodes are its children
+    NODEARENA   g_arena = {};           // Holds the nodes under g_capRoot
+    HWND        g_hwndBound = nullptr;  // TreeView the model is mirrored into
+
+    thread_local CAPSTAGE* t_pStage = nullptr;  // Takes this thread's top-level nodes, if set
+
+
+    //-----------------------------------------------------------------------------
+    CAPNODE* TopRoot()
+    {
+        return (t_pStage) ? &t_pStage->root : &g_capRoot;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: ArenaAlloc()
+    // Desc: Gives back cb zeroed bytes from the arena. Blocks too large to
+    //       share a chunk get one of their own, behind the one being filled.
+    //-----------------------------------------------------------------------------
+    void* ArenaAlloc(NODEARENA* pArena, size_t cb)
+    {
+        cb = (cb + c_cbNodeAlign - 1) & ~(c_cbNodeAlign - 1);
+
+        NODECHUNK* pChunk = pArena->pChunks;
+        if (!pChunk || pChunk->cb - pChunk->cbUsed < cb)
+        {
+            size_t cbData = (cb > c_cbNodeChunk / 4) ? cb : c_cbNodeChunk;
+            auto pb = new (std::nothrow) BYTE[offsetof(NODECHUNK, data) + cbData];
+            if (!pb)
+                return nullptr;
+
+            pChunk = reinterpret_cast<NODECHUNK*>(pb);
+            pChunk->cb = cbData;
+            pChunk->cbUsed = 0;
+
+            if (cbData == c_cbNodeChunk || !pArena->pChunks)
+            {
+                pChunk->pNext = pArena->pChunks;
+                pArena->pChunks = pChunk;
+            }
+            else
+            {
+                pChunk->pNext = pArena->pChunks->pNext;
+                pArena->pChunks->pNext = pChunk;
+            }
+
+            ++pArena->cChunks;
+            pArena->cbReserved += cbData;
+        }
+
+        void* pv = pChunk->data + pChunk->cbUsed;
+        pChunk->cbUsed += cb;
+        memset(pv, 0, cb);
+
+        ++pArena->cAllocs;
+        pArena->cbUsed += cb;
+        return pv;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID ArenaFree(NODEARENA* pArena)
+    {
+        NODECHUNK* pChunk = pArena->pChunks;
+        while (pChunk)
+        {
+            NODECHUNK* pNext = pChunk->pNext;
+            delete[] reinterpret_cast<BYTE*>(pChunk);
+            pChunk = pNext;
+        }
+        *pArena = {};
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: ArenaMerge()
+    // Desc: Moves the chunks of pFrom to pTo, behind the one pTo is filling
+    //-----------------------------------------------------------------------------
+    VOID ArenaMerge(NODEARENA* pTo, NODEARENA* pFrom)
+    {
+        NODECHUNK* pFirst = pFrom->pChunks;
+        if (!pFirst)
+            return;
+
+        if (pTo->pChunks)
+        {
+            NODECHUNK* pLast = pFirst;
+            while (pLast->pNext)
+                pLast = pLast->pNext;
+
+            pLast->pNext = pTo->pChunks->pNext;
+            pTo->pChunks->pNext = pFirst;
+        }
+        else
+        {
+            pTo->pChunks = pFirst;
+        }
+
+        pTo->cNodes += pFrom->cNodes;
+        pTo->cAllocs += pFrom->cAllocs;
+        pTo->cChunks += pFrom->cChunks;
+        pTo->cbUsed += pFrom->cbUsed;
+        pTo->cbReserved += pFrom->cbReserved;
+        *pFrom = {};
+    }
+
+
+    //-----------------------------------------------------------------------------
+    NODEARENA* CurrentArena()
+    {
+        return (t_pStage) ? &t_pStage->arena : &g_arena;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: NewNode()
+    // Desc: Allocates a node and links it as the last child of hParent
+    //-----------------------------------------------------------------------------
+    CAPNODE* NewNode(HCAPNODE hParent, LPCSTR strText, BOOL fKids, int iImage)
+    {
+        if (!strText)
+            strText = "";
+
+        size_t cchText = strlen(strText);
+        NODEARENA* pArena = CurrentArena();
+        auto pNode = static_cast<CAPNODE*>(ArenaAlloc(pArena, sizeof(CAPNODE) + cchText));
+        if (!pNode)
+            return nullptr;
+        ++pArena->cNodes;
+
+        strcpy_s(pNode->strText, cchText + 1, strText);
+        pNode->iImage = iImage;
+        pNode->fKids = fKids;
+
+        CAPNODE* pParent = (hParent) ? hParent : TopRoot();
+        pNode->pParent = pParent;
+        if (pParent->pLastChild)
+            pParent->pLastChild->pNext = pNode;
+        else
+            pParent->pFirstChild = pNode;
+        pParent->pLastChild = pNode;
+
+        return pNode;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: InsertViewItem()
+    // Desc: Mirrors one node into the bound TreeView
+    //-----------------------------------------------------------------------------
+    VOID InsertViewItem(CAPNODE* pNode, HTREEITEM hInsertAfter = TVI_LAST)
+    {
+        TV_INSERTSTRUCT tvi = {};
+        tvi.hParent = (pNode->pParent == &g_capRoot) ? TVI_ROOT : pNode->pParent->hItem;
+        tvi.hInsertAfter = hInsertAfter;
+        tvi.item.mask = TVIF_TEXT | TVIF_IMAGE | TVIF_SELECTEDIMAGE |
+            TVIF_PARAM | TVIF_CHILDREN;
+        tvi.item.iImage = pNode->iImage - IDI_FIRSTIMAGE;
+        tvi.item.iSelectedImage = pNode->iImage - IDI_FIRSTIMAGE;
+        tvi.item.lParam = (LPARAM)pNode;
+        tvi.item.cChildren = pNode->fKids;
+        tvi.item.pszText = pNode->strText;
+
+        pNode->hItem = TreeView_InsertItem(g_hwndBound, &tvi);
+        if (!pNode->hItem)
+            return;
+
+        if (pNode->ni.fnExpandCallback)
+        {
+            // Placeholder child, removed when the node is expanded
+            TV_INSERTSTRUCT tvp = {};
+            tvp.hParent = pNode->hItem;
+            tvp.hInsertAfter = TVI_LAST;
+            tvp.item.mask = TVIF_TEXT | TVIF_PARAM;
+            tvp.item.lParam = 0;
+            tvp.item.pszText = (LPSTR)"";
+            (void)TreeView_InsertItem(g_hwndBound, &tvp);
+        }
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: AddNode()
+    // Desc: Adds a node to the model, and to the view if its parent is shown
+    //-----------------------------------------------------------------------------
+    CAPNODE* AddNode(HCAPNODE hParent, LPCSTR strText, BOOL fKids, int iImage,
+        const NODEINFO& ni)
+    {
+        CAPNODE* pNode = NewNode(hParent, strText, fKids, iImage);
+        if (!pNode)
+            return nullptr;
+
+        pNode->ni = ni;
+
+        if (g_hwndBound && (pNode->pParent == &g_capRoot || pNode->pParent->hItem))
+            InsertViewItem(pNode);
+
+        return pNode;
+    }
+
+
+    //-----------------------------------------------------------------------------
+    VOID BindSubtree(CAPNODE* pNode)
+    {
+        for (; pNode; pNode = pNode->pNext)
+        {
+            InsertViewItem(pNode);
+            if (!pNode->hItem)
+                continue;
+
+            BindSubtree(pNode->pFirstChild);
+
+            if (pNode->fExpanded)
+                TreeView_Expand(g_hwndBound, pNode->hItem, TVE_EXPAND);
+        }
+    }
+
+}
+
+
+//-----------------------------------------------------------------------------
+HCAPNODE TVAddNode(HCAPNODE hParent, LPCSTR strText, BOOL fKids,
+    int iImage, DISPLAYCALLBACK fnDisplayCallback, LPARAM lParam1,
+    LPARAM lParam2)
+{
+    NODEINFO ni = {};
+    ni.bUseLParam3 = FALSE;
+    ni.lParam1 = lParam1;
+    ni.lParam2 = lParam2;
+    ni.lParam3 = 0;
+    ni.fnDisplayCallback = fnDisplayCallback;
+
+    return AddNode(hParent, strText, fKids, iImage, ni);
+}
+
+
+//-----------------------------------------------------------------------------
+HCAPNODE TVAddNodeEx(HCAPNODE hParent, LPCSTR strText, BOOL fKids,
+    int iImage, DISPLAYCALLBACKEX fnDisplayCallback, LPARAM lParam1,
+    LPARAM lParam2, LPARAM lParam3)
+{
+    NODEINFO ni = {};
+    ni.bUseLParam3 = TRUE;
+    ni.lParam1 = lParam1;
+    ni.lParam2 = lParam2;
+    ni.lParam3 = lParam3;
+    ni.fnDisplayCallback = reinterpret_cast<DISPLAYCALLBACK>(fnDisplayCallback);
+
+    return AddNode(hParent, strText, fKids, iImage, ni);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TVAddLazyNode()
+// Desc: Adds a node whose children are only created the first time it is
+//       expanded. lParam1..3 are passed through to the expand callback.
+//-----------------------------------------------------------------------------
+HCAPNODE TVAddLazyNode(HCAPNODE hParent, LPCSTR strText, int iImage,
+    EXPANDCALLBACK fnExpandCallback, LPARAM lParam1, LPARAM lParam2,
+    LPARAM lParam3)
+{
+    NODEINFO ni = {};
+    ni.bUseLParam3 = TRUE;
+    ni.lParam1 = lParam1;
+    ni.lParam2 = lParam2;
+    ni.lParam3 = lParam3;
+    ni.fnDisplayCallback = nullptr;
+    ni.fnExpandCallback = fnExpandCallback;
+
+    return AddNode(hParent, strText, TRUE, iImage, ni);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TVExpandLazyNode()
+// Desc: Populates a node added with TVAddLazyNode. Used both by the
+//       TVN_ITEMEXPANDING handler and by the print/export tree walk.
+//-----------------------------------------------------------------------------
+VOID TVExpandLazyNode(HCAPNODE hNode)
+{
+    if (!hNode || !hNode->ni.fnExpandCallback)
+        return;
+
+    // Only ever expand once
+    EXPANDCALLBACK fnExpandCallback = hNode->ni.fnExpandCallback;
+    hNode->ni.fnExpandCallback = nullptr;
+
+    if (g_hwndBound && hNode->hItem)
+    {
+        HTREEITEM hPlaceholder = TreeView_GetChild(g_hwndBound, hNode->hItem);
+        if (hPlaceholder)
+            TreeView_DeleteItem(g_hwndBound, hPlaceholder);
+    }
+
+    fnExpandCallback(hNode, hNode->ni.lParam1, hNode->ni.lParam2, hNode->ni.lParam3);
+    SearchNodeExpanded(hNode);
+
+    if (!hNode->pFirstChild)
+    {
+        // Nothing to show, so drop the expand button
+        hNode->fKids = FALSE;
+
+        if (g_hwndBound && hNode->hItem)
+        {
+            TV_ITEM tvi = {};
+            tvi.mask = TVIF_CHILDREN;
+            tvi.hItem = hNode->hItem;
+            tvi.cChildren = 0;
+            TreeView_SetItem(g_hwndBound, &tvi);
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TVExpandNode()
+// Desc: Marks a node as initially expanded in the view
+//-----------------------------------------------------------------------------
+VOID TVExpandNode(HCAPNODE hNode)
+{
+    if (!hNode)
+        return;
+
+    hNode->fExpanded = TRUE;
+
+    if (g_hwndBound && hNode->hItem)
+        TreeView_Expand(g_hwndBound, hNode->hItem, TVE_EXPAND);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TVGetRoot()
+// Desc: Returns the first top-level node of the model
+//-----------------------------------------------------------------------------
+HCAPNODE TVGetRoot()
+{
+    return TopRoot()->pFirstChild;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TVGetNode()
+// Desc: Returns the model node a TreeView item is bound to
+//-----------------------------------------------------------------------------
+HCAPNODE TVGetNode(HWND hwndTV, HTREEITEM hItem)
+{
+    if (!hItem)
+        return nullptr;
+
+    TV_ITEM tvi = {};
+    tvi.mask = TVIF_PARAM;
+    tvi.hItem = hItem;
+    if (!TreeView_GetItem(hwndTV, &tvi))
+        return nullptr;
+
+    return reinterpret_cast<HCAPNODE>(tvi.lParam);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TVBindView()
+// Desc: Mirrors the whole model into a TreeView control
+//-----------------------------------------------------------------------------
+VOID TVBindView(HWND hwndTV)
+{
+    g_hwndBound = hwndTV;
+
+    if (g_hwndBound)
+        BindSubtree(g_capRoot.pFirstChild);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TVBeginStage()
+// Desc: Top-level nodes the calling thread adds, and TVGetRoot(), use pStage
+//       instead of the root until TVEndStage(). Staged nodes aren't shown,
+//       and they and TVAlloc() blocks come from the stage's arena.
+//-----------------------------------------------------------------------------
+VOID TVBeginStage(CAPSTAGE* pStage)
+{
+    t_pStage = pStage;
+}
+
+
+//-----------------------------------------------------------------------------
+VOID TVEndStage()
+{
+    t_pStage = nullptr;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TVSpliceStage()
+// Desc: Replaces hPlaceholder, a top-level node, with the nodes staged in
+//       pStage and shows them. pStage is left empty, so a second call only
+//       removes its placeholder.
+//-----------------------------------------------------------------------------
+VOID TVSpliceStage(HCAPNODE hPlaceholder, CAPSTAGE* pStage)
+{
+    CAPNODE* pPrev = nullptr;
+    CAPNODE* pNode = g_capRoot.pFirstChild;
+    for (; pNode && pNode != hPlaceholder; pNode = pNode->pNext)
+        pPrev = pNode;
+
+    if (!pNode)
+        return;
+
+    CAPNODE* pNext = hPlaceholder->pNext;
+    CAPNODE* pFirst = pStage->root.pFirstChild;
+    CAPNODE* pLast = pStage->root.pLastChild;
+    pStage->root.pFirstChild = nullptr;
+    pStage->root.pLastChild = nullptr;
+    ArenaMerge(&g_arena, &pStage->arena);
+
+    if (pFirst)
+    {
+        for (pNode = pFirst; pNode; pNode = pNode->pNext)
+            pNode->pParent = &g_capRoot;
+        pLast->pNext = pNext;
+    }
+    else
+    {
+        pFirst = pNext;
+        pLast = pPrev;
+    }
+
+    if (pPrev)
+        pPrev->pNext = pFirst;
+    else
+        g_capRoot.pFirstChild = pFirst;
+    if (!pNext)
+        g_capRoot.pLastChild = pLast;
+
+    if (g_hwndBound)
+    {
+        // The first node takes over the placeholder's selection
+        BOOL fSelected = hPlaceholder->hItem && TreeView_GetSelection(g_hwndBound) == hPlaceholder->hItem;
+
+        HTREEITEM hAfter = (hPlaceholder->hItem) ? hPlaceholder->hItem : TVI_LAST;
+        for (pNode = (pPrev) ? pPrev->pNext : g_capRoot.pFirstChild; pNode != pNext; pNode = pNode->pNext)
+        {
+            InsertViewItem(pNode, hAfter);
+            if (!pNode->hItem)
+                continue;
+
+            hAfter = pNode->hItem;
+            BindSubtree(pNode->pFirstChild);
+
+            if (pNode->fExpanded)
+                TreeView_Expand(g_hwndBound, pNode->hItem, TVE_EXPAND);
+
+            if (fSelected)
+            {
+                TreeView_SelectItem(g_hwndBound, pNode->hItem);
+                fSelected = FALSE;
+            }
+        }
+
+        if (hPlaceholder->hItem)
+            TreeView_DeleteItem(g_hwndBound, hPlaceholder->hItem);
+    }
+
+    // The placeholder's memory goes with the tree's
+    hPlaceholder->pNext = nullptr;
+    hPlaceholder->hItem = nullptr;
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TVFreeStage()
+// Desc: Releases the nodes and blocks of a stage that was never spliced in
+//-----------------------------------------------------------------------------
+VOID TVFreeStage(CAPSTAGE* pStage)
+{
+    pStage->root.pFirstChild = nullptr;
+    pStage->root.pLastChild = nullptr;
+    ArenaFree(&pStage->arena);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TVFreeNodes()
+// Desc: Releases the model and the TVAlloc() blocks. The view must already
+//       be gone or unbound.
+//-----------------------------------------------------------------------------
+VOID TVFreeNodes()
+{
+    g_hwndBound = nullptr;
+    SearchReset();
+    LVRowsReset();
+
+    g_capRoot = {};
+    ArenaFree(&g_arena);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TVAlloc()
+// Desc: Allocates a zeroed block for a node's lParam to point to. It is
+//       freed with the tree, or with the stage being built.
+//-----------------------------------------------------------------------------
+void* TVAlloc(size_t cb)
+{
+    return ArenaAlloc(CurrentArena(), cb);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name: TVGetArena()
+// Desc: Gives back the memory counts of the tree, staged sections excluded
+//-----------------------------------------------------------------------------
+const NODEARENA* TVGetArena()
+{
+    return &g_arena;
+}
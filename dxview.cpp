@@ -21,9 +21,6 @@
 
 constexpr size_t c_maxPasteBuffer = 200;
 constexpr size_t c_maxPrintLine = 128;
-constexpr int c_tabStop = 52;
-
-static_assert(c_tabStop >= c_DefNameLength, "print stop should be at least as long as the default name");
 
 HINSTANCE   g_hInstance = nullptr;
 HWND        g_hwndMain = nullptr;
@@ -50,6 +47,7 @@ extern BOOL g_PrintToFile;
 extern TCHAR  g_PrintToFilePath[MAX_PATH];
 CHAR        g_szClip[c_maxPasteBuffer];
 TCHAR       g_helpPath[MAX_PATH] = {};
+TCHAR       g_OpenSnapshotPath[MAX_PATH] = {}; // Offline: show this snapshot, probe nothing
 
 //-----------------------------------------------------------------------------
 // Local function prototypes
@@ -61,10 +59,12 @@ VOID    DXView_OnCommand( HWND hwnd, WPARAM wParam );
 VOID    DXView_OnSize( HWND hwnd );
 VOID    DXView_OnTreeSelect( HWND hwndTV, NM_TREEVIEW* ptv );
 VOID    DXView_OnListViewDblClick( HWND hwndLV, NM_LISTVIEW* plv );
+VOID    DXView_OnListViewGetDispInfo( NMLVDISPINFO* pdi );
 VOID    DXView_Cleanup();
 BOOL    DXView_InitImageList();
 BOOL    DXView_OnPrint( HWND hWindow, HWND hTreeView, BOOL bPrintAll );
 BOOL    DXView_OnFile( HWND hWindow, HWND hTreeWnd,BOOL bPrintAll );
+BOOL    DXView_OnJson( HWND hWindow, LPCTSTR strPath );
 VOID    CreateCopyMenu( VOID );
 
 
@@ -73,9 +73,9 @@ VOID    CreateCopyMenu( VOID );
 // External function prototypes
 //-----------------------------------------------------------------------------
 
-VOID DXGI_FillTree( HWND hwndTV );
-VOID DXG_FillTree( HWND hwndTV );
-VOID DD_FillTree( HWND hwndTV );
+VOID DXGI_FillTree();
+VOID DXG_FillTree();
+VOID DD_FillTree();
 
 VOID DXGI_Init();
 VOID DXG_Init();
@@ -87,6 +87,9 @@ VOID DD_CleanUp();
 
 BOOL DXG_Is9Ex();
 
+VOID DXGI_GetCacheKey();
+VOID DXG_GetCacheKey();
+
 
 
 //-----------------------------------------------------------------------------
@@ -127,6 +130,9 @@ HRESULT Int2Str( _Out_z_cap_(nDestLen) LPTSTR strDest, UINT nDestLen, DWORD i )
 _Use_decl_annotations_
 HRESULT PrintStringValueLine(const char * szText, const char * szText2, PRINTCBINFO *lpInfo)
 {
+    if( lpInfo->pEmitter )
+        return EmitTextRow( lpInfo, szText, szText2 );
+
     // Calculate Name and Value column x offsets
     int xName   = (lpInfo->dwCurrIndent * DEF_TAB_SIZE * lpInfo->dwCharWidth);
     int xVal    = xName + (c_tabStop * lpInfo->dwCharWidth);
@@ -159,6 +165,9 @@ HRESULT PrintStringValueLine(const char * szText, const char * szText2, PRINTCBI
 _Use_decl_annotations_
 HRESULT PrintValueLine(const char * szText, DWORD dwValue, PRINTCBINFO *lpInfo)
 {
+    if( lpInfo->pEmitter )
+        return EmitValueRow( lpInfo, szText, dwValue );
+
     char  szBuff[c_maxPrintLine];
     Int2Str(szBuff, c_maxPrintLine, dwValue);
     return PrintStringValueLine( szText, szBuff, lpInfo );
@@ -169,6 +178,9 @@ HRESULT PrintValueLine(const char * szText, DWORD dwValue, PRINTCBINFO *lpInfo)
 _Use_decl_annotations_
 HRESULT PrintHexValueLine(const char * szText, DWORD dwValue, PRINTCBINFO *lpInfo)
 {
+    if( lpInfo->pEmitter )
+        return EmitHexRow( lpInfo, szText, dwValue );
+
     char  szBuff[c_maxPrintLine];
     sprintf_s( szBuff, sizeof(szBuff), "0x%08x", dwValue );
     return PrintStringValueLine( szText, szBuff, lpInfo );
@@ -179,6 +191,9 @@ HRESULT PrintHexValueLine(const char * szText, DWORD dwValue, PRINTCBINFO *lpInf
 _Use_decl_annotations_
 HRESULT PrintStringLine(const char * szText, PRINTCBINFO *lpInfo)
 {
+    if( lpInfo->pEmitter )
+        return EmitNoteRow( lpInfo, szText );
+
     // Calculate Name and Value column x offsets
     int xName   = (lpInfo->dwCurrIndent * DEF_TAB_SIZE * lpInfo->dwCharWidth);
     int yLine   = (lpInfo->dwCurrLine * lpInfo->dwLineHeight);
@@ -199,6 +214,46 @@ HRESULT PrintStringLine(const char * szText, PRINTCBINFO *lpInfo)
 }
 
 
+//-----------------------------------------------------------------------------
+// Name: NextArg()
+// Desc: Copies the next, possibly quoted, command line token to pszArg and
+//       returns the command line past it. pszArg is empty at the end.
+//-----------------------------------------------------------------------------
+TCHAR* NextArg(TCHAR* pszCmdLine, _Out_writes_(cchArg) TCHAR* pszArg, size_t cchArg)
+{
+    // Skip past any white space preceeding the token.
+    while (*pszCmdLine && (*pszCmdLine <= TEXT(' ')))
+        pszCmdLine++;
+
+    size_t cch = 0;
+    if (*pszCmdLine == TEXT('"'))  // Check for and handle quoted token
+    {
+        pszCmdLine++;
+        // Scan, and copy, subsequent characters until  another
+        // double-quote or a null is encountered
+        for (; *pszCmdLine && (*pszCmdLine != TEXT('"')); pszCmdLine++)
+        {
+            if (cch + 1 < cchArg)
+                pszArg[cch++] = *pszCmdLine;
+        }
+        // If we stopped on a double-quote (usual case), skip over it.
+        if (*pszCmdLine == TEXT('"'))
+            pszCmdLine++;
+    }
+    else    // Token wasn't quoted
+    {
+        for (; *pszCmdLine > TEXT(' '); pszCmdLine++)
+        {
+            if (cch + 1 < cchArg)
+                pszArg[cch++] = *pszCmdLine;
+        }
+    }
+    pszArg[cch] = TEXT('\0');
+
+    return pszCmdLine;
+}
+
+
 //-----------------------------------------------------------------------------
 // Name: WinMain
 //-----------------------------------------------------------------------------
@@ -208,15 +263,116 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE /*hPrevInstance*
     g_hInstance = hInstance; // Store instance handle in our global variable
     g_PrintToFilePath[0] = TEXT('\0');
 
+    // "--json <file>" saves the whole tree as JSON rather than text,
+    // "--snapshot <file>" saves it as a snapshot that "--open <file>" shows
+    // later, possibly on another machine. "--diff <old> <new> <file>" writes
+    // the differences between two snapshots to the file, and "--fleet <dir>
+    // <file>" a support matrix of all snapshots in a directory, as JSON with
+    // "--json". "--trace <file>" writes a timeline of the probes to the file
+    // on exit, see dxtrace.cpp. "--mock <file>" probes the mock devices
+    // described in the file, and "--record <file>" writes the answers of the
+    // real DXGI 1.1 adapters and outputs, Direct3D 11 hardware devices and
+    // Direct3D 9 to the file on exit, for "--mock" to replay. The rest of
+    // the tree is shown as usual but not recorded; see dxmock.cpp. Any other
+    // token is the file to save the whole tree to.
+    BOOL fJson = FALSE;
+    BOOL fSnapshot = FALSE;
+    TCHAR szDiffOld[MAX_PATH] = {};
+    TCHAR szDiffNew[MAX_PATH] = {};
+    TCHAR szFleetDir[MAX_PATH] = {};
+    TCHAR szTracePath[MAX_PATH] = {};
+    TCHAR szMockPath[MAX_PATH] = {};
+    TCHAR szRecordPath[MAX_PATH] = {};
+    TCHAR szArg[MAX_PATH];
+    TCHAR* pszCmdLine = NextArg(GetCommandLine(), szArg, MAX_PATH); // Skip past program name
+    for (;;)
+    {
+        pszCmdLine = NextArg(pszCmdLine, szArg, MAX_PATH);
+        if (!*szArg)
+            break;
+
+        if (_tcsicmp(szArg, TEXT("--json")) == 0)
+            fJson = TRUE;
+        else if (_tcsicmp(szArg, TEXT("--snapshot")) == 0)
+            fSnapshot = TRUE;
+        else if (_tcsicmp(szArg, TEXT("--open")) == 0)
+            pszCmdLine = NextArg(pszCmdLine, g_OpenSnapshotPath, MAX_PATH);
+        else if (_tcsicmp(szArg, TEXT("--diff")) == 0)
+        {
+            pszCmdLine = NextArg(pszCmdLine, szDiffOld, MAX_PATH);
+            pszCmdLine = NextArg(pszCmdLine, szDiffNew, MAX_PATH);
+        }
+        else if (_tcsicmp(szArg, TEXT("--fleet")) == 0)
+            pszCmdLine = NextArg(pszCmdLine, szFleetDir, MAX_PATH);
+        else if (_tcsicmp(szArg, TEXT("--trace")) == 0)
+            pszCmdLine = NextArg(pszCmdLine, szTracePath, MAX_PATH);
+        else if (_tcsicmp(szArg, TEXT("--mock")) == 0)
+            pszCmdLine = NextArg(pszCmdLine, szMockPath, MAX_PATH);
+        else if (_tcsicmp(szArg, TEXT("--record")) == 0)
+            pszCmdLine = NextArg(pszCmdLine, szRecordPath, MAX_PATH);
+        else
+            _tcscpy_s(g_PrintToFilePath, MAX_PATH, szArg);
+    }
+
+    // Comparing snapshots needs neither DirectX nor a window. Like diff, the
+    // exit code is 0 if they match, 1 if they differ and 2 on failure.
+    if (*szDiffOld)
+    {
+        HRESULT hrDiff = CacheDiffSnapshots(szDiffOld, szDiffNew, g_PrintToFilePath, fJson);
+        return (FAILED(hrDiff)) ? 2 : (hrDiff == S_FALSE) ? 1 : 0;
+    }
+
+    // Exit code 1 means some files in the directory weren't snapshots
+    if (*szFleetDir)
+    {
+        HRESULT hrFleet = FleetAggregate(szFleetDir, g_PrintToFilePath, fJson);
+        return (FAILED(hrFleet)) ? 2 : (hrFleet == S_FALSE) ? 1 : 0;
+    }
+
+    if (*szTracePath)
+        TraceStart();
+
     // Initialize COM
     HRESULT hr = CoInitializeEx(nullptr, COINITBASE_MULTITHREADED);
     if (FAILED(hr))
         return 1;
 
-    // Init various DX components
-    DXGI_Init();
-    DXG_Init();
-    DD_Init();
+    CHAR szTitle[MAX_PATH + 64];
+    strcpy_s(szTitle, sizeof(szTitle), g_strTitle);
+
+    if (*g_OpenSnapshotPath)
+    {
+        // Offline viewer: the tree comes from a saved snapshot, and none of
+        // the DirectX runtimes are loaded
+        if (!CacheOpenSnapshot(g_OpenSnapshotPath))
+        {
+            if (!*g_PrintToFilePath)
+                MessageBox(nullptr, "Unable to open the snapshot file.", g_strTitle, MB_OK | MB_ICONERROR);
+            CoUninitialize();
+            return 1;
+        }
+
+        sprintf_s(szTitle, sizeof(szTitle), "%s - %s", g_strTitle, g_OpenSnapshotPath);
+    }
+    else
+    {
+        if (*szMockPath && !MockStart(szMockPath))
+        {
+            if (!*g_PrintToFilePath)
+                MessageBox(nullptr, "Unable to open the mock device file.", g_strTitle, MB_OK | MB_ICONERROR);
+            CoUninitialize();
+            return 1;
+        }
+
+        if (!*szMockPath && *szRecordPath && !MockRecordStart())
+            *szRecordPath = TEXT('\0');
+
+        // Init various DX components
+        TRACESCOPE trace("DirectX init");
+        DXGI_Init();
+        DXG_Init();
+        DD_Init();
+    }
 
     // Register window class
     WNDCLASS  wc;
@@ -233,7 +389,7 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE /*hPrevInstance*
     RegisterClass(&wc);
 
     // Create a main window for this application instance.
-    g_hwndMain = CreateWindowEx(0, g_strClassName, g_strTitle, WS_OVERLAPPEDWINDOW,
+    g_hwndMain = CreateWindowEx(0, g_strClassName, szTitle, WS_OVERLAPPEDWINDOW,
         CW_USEDEFAULT, CW_USEDEFAULT, DXView_WIDTH, DXView_HEIGHT,
         nullptr, nullptr, hInstance, nullptr);
 
@@ -244,50 +400,18 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE /*hPrevInstance*
         return -1;
     }
 
-    TCHAR* pszCmdLine = GetCommandLine();
-    // Skip past program name (first token in command line).
-    if (*pszCmdLine == TEXT('"'))  // Check for and handle quoted program name
-    {
-        pszCmdLine++;
-        // Scan, and skip over, subsequent characters until  another
-        // double-quote or a null is encountered
-        while (*pszCmdLine && (*pszCmdLine != TEXT('"')))
-            pszCmdLine++;
-        // If we stopped on a double-quote (usual case), skip over it.
-        if (*pszCmdLine == TEXT('"'))
-            pszCmdLine++;
-    }
-    else    // First token wasn't a quote
-    {
-        while (*pszCmdLine > TEXT(' '))
-            pszCmdLine++;
-    }
-
-    // Skip past any white space preceeding the next token.
-    while (*pszCmdLine && (*pszCmdLine <= TEXT(' ')))
-        pszCmdLine++;
-
-    // Treat the rest of the command line as a filename to save the whole tree to
-    TCHAR* pstrSave = g_PrintToFilePath;
-    if (*pszCmdLine == TEXT('"'))  // Check for and handle quoted program name
+    BOOL fFailed = FALSE;
+    if (fJson)
     {
-        pszCmdLine++;
-        // Scan, and copy, subsequent characters until  another
-        // double-quote or a null is encountered
-        while (*pszCmdLine && (*pszCmdLine != TEXT('"')))
-            *pstrSave++ = *pszCmdLine++;
-        // If we stopped on a double-quote (usual case), skip over it.
-        if (*pszCmdLine == TEXT('"'))
-            pszCmdLine++;
+        fFailed = !DXView_OnJson(g_hwndMain, g_PrintToFilePath);
+        PostMessage(g_hwndMain, WM_CLOSE, 0, 0);
     }
-    else    // First token wasn't a quote
+    else if (fSnapshot)
     {
-        while (*pszCmdLine > TEXT(' '))
-            *pstrSave++ = *pszCmdLine++;
+        fFailed = !CacheSaveSnapshot(g_PrintToFilePath);
+        PostMessage(g_hwndMain, WM_CLOSE, 0, 0);
     }
-    *pstrSave = TEXT('\0');
-
-    if (strlen(g_PrintToFilePath) > 0)
+    else if (strlen(g_PrintToFilePath) > 0)
     {
         PostMessage(g_hwndMain, WM_COMMAND, IDM_PRINTWHOLETREETOFILE, 0);
         PostMessage(g_hwndMain, WM_CLOSE, 0, 0);
@@ -296,19 +420,35 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE /*hPrevInstance*
     {
         // Make the window visible; update its client area; and return "success"
         ShowWindow(g_hwndMain, SW_MAXIMIZE /*nCmdShow*/);
+
+        // Build the search index while the viewer is idle, once the tree
+        // is complete
+        if (!ProbeIsBusy())
+            SearchStart();
     }
 
     // Message pump
     MSG msg;
     while (GetMessage(&msg, nullptr, 0, 0))
     {
+        if (SearchIsDialogMessage(&msg))
+            continue;
+
         TranslateMessage(&msg);
         DispatchMessage(&msg);
     }
 
+    if (*szTracePath)
+        TraceWrite(szTracePath);
+
+    // The windows are gone, and with them the mock objects
+    if (*szRecordPath && !MockRecordWrite(szRecordPath))
+        fFailed = TRUE;
+    MockStop();
+
     CoUninitialize();
 
-    return (int)msg.wParam;
+    return (fFailed) ? 1 : (int)msg.wParam;
 }
 
 
@@ -360,6 +500,12 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
         {
             if (((NMHDR*)lParam)->code == TVN_SELCHANGED)
                 DXView_OnTreeSelect(g_hwndTV, (NM_TREEVIEW*)lParam);
+            else if (((NMHDR*)lParam)->code == TVN_ITEMEXPANDING)
+            {
+                NM_TREEVIEW* ptv = (NM_TREEVIEW*)lParam;
+                if (ptv->action & TVE_EXPAND)
+                    TVExpandLazyNode(reinterpret_cast<HCAPNODE>(ptv->itemNew.lParam));
+            }
             else if (((NMHDR*)lParam)->code == NM_RCLICK)
             {
                 NMHDR* pnmhdr = (NMHDR*)lParam;
@@ -388,7 +534,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 
         if (((NMHDR*)lParam)->hwndFrom == g_hwndLV)
         {
-            if (((NMHDR*)lParam)->code == NM_RDBLCLK)
+            if (((NMHDR*)lParam)->code == LVN_GETDISPINFO)
+                DXView_OnListViewGetDispInfo((NMLVDISPINFO*)lParam);
+            else if (((NMHDR*)lParam)->code == NM_RDBLCLK)
                 DXView_OnListViewDblClick(g_hwndLV, (NM_LISTVIEW*)lParam);
             else if (((NMHDR*)lParam)->code == NM_RCLICK)
             {
@@ -417,6 +565,10 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
         SetFocus(g_hwndTV);
         break;
 
+    case WM_PROBEBATCH:
+        ProbeOnBatch(hWnd, lParam);
+        break;
+
     case WM_COMMAND:  // message: command from application menu
         DXView_OnCommand(hWnd, wParam);
         break;
@@ -500,7 +652,7 @@ BOOL DXView_OnCreate(HWND hWnd)
 
     // Create the list view window.
     g_hwndLV = CreateWindowEx(WS_EX_CLIENTEDGE, WC_LISTVIEW, "",
-        WS_VISIBLE | WS_CHILD | LVS_REPORT | LVS_SHOWSELALWAYS | LVS_SINGLESEL,
+        WS_VISIBLE | WS_CHILD | LVS_REPORT | LVS_SHOWSELALWAYS | LVS_SINGLESEL | LVS_OWNERDATA,
         0, 0, 0, 0, hWnd, (HMENU)IDC_LV, g_hInstance, nullptr);
     ListView_SetExtendedListViewStyleEx(g_hwndLV, LVS_EX_FULLROWSELECT, LVS_EX_FULLROWSELECT);
 
@@ -513,11 +665,32 @@ BOOL DXView_OnCreate(HWND hWnd)
     // create our image list.
     DXView_InitImageList();
 
-    // Add DXStuff stuff to the tree
-    // view.
-    DXGI_FillTree(g_hwndTV);
-    DXG_FillTree(g_hwndTV);
-    DD_FillTree(g_hwndTV);
+    // Build the capability tree, then show it in the tree view. The DXGI and
+    // Direct3D 9 sections come from the snapshot cache while the adapters and
+    // drivers are unchanged; DirectDraw is always probed live. An opened
+    // snapshot was already loaded by WinMain. The interactive viewer probes
+    // in the background, so the window shows up at once; saving to a file
+    // needs the whole tree first.
+    BOOL fProbing = !*g_OpenSnapshotPath && !*g_PrintToFilePath && ProbeStart(hWnd);
+    if (!*g_OpenSnapshotPath && !fProbing)
+    {
+        DXGI_GetCacheKey();
+        DXG_GetCacheKey();
+        if (!CacheLoad())
+        {
+            DXGI_FillTree();
+            DXG_FillTree();
+            CacheSave();
+        }
+        DD_FillTree();
+    }
+
+    // Counts of the driver calls made so far, including those still to come
+    // from the background probes
+    if (!*g_OpenSnapshotPath)
+        StatsFillTree();
+
+    TVBindView(g_hwndTV);
 
     TreeView_SelectItem(g_hwndTV, TreeView_GetRoot(g_hwndTV));
 
@@ -526,11 +699,11 @@ BOOL DXView_OnCreate(HWND hWnd)
 
 
 //-----------------------------------------------------------------------------
-void AddCapsToTV(HTREEITEM hRoot, CAPDEFS* pcds, LPARAM lParam1)
+void AddCapsToTV(HCAPNODE hRoot, CAPDEFS* pcds, LPARAM lParam1)
 {
     BOOL  bRoot = TRUE; // the first one is always a root
 
-    HTREEITEM hParent[20];
+    HCAPNODE hParent[20];
     hParent[0] = hRoot;
 
     int   level = 0;
@@ -553,7 +726,7 @@ void AddCapsToTV(HTREEITEM hRoot, CAPDEFS* pcds, LPARAM lParam1)
 
         if (name[0] && (level >= 0 && level < 20))
         {
-            HTREEITEM hTree = TVAddNode(hParent[level], name, bRoot, IDI_CAPS,
+            HCAPNODE hTree = TVAddNode(hParent[level], name, bRoot, IDI_CAPS,
                 pcds->fnDisplayCallback, lParam1,
                 pcds->lParam2);
 
@@ -573,9 +746,12 @@ void AddCapsToTV(HTREEITEM hRoot, CAPDEFS* pcds, LPARAM lParam1)
 
 
 //-----------------------------------------------------------------------------
-// AddMoreCapsToLV is like AddCapsToLV, except it doesn't add the
-// column headers like AddCapsToLV does.
-void AddMoreCapsToLV(CAPDEF* pcd, LPVOID pv)
+// Name: EmitCaps()
+// Desc: Emits one row per CAPDEF entry. The flag selects how the value is
+//       formatted; any other flag is a capability bit shown as Yes/No.
+//-----------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT EmitCaps(CAPDEF* pcd, LPVOID pv, PRINTCBINFO* pInfo)
 {
     TCHAR szBuff[64];
 
@@ -589,74 +765,66 @@ void AddMoreCapsToLV(CAPDEF* pcd, LPVOID pv)
 
         auto dwValue = *reinterpret_cast<DWORD*>(static_cast<BYTE*>(pv) + pcd->dwOffset);
 
+        HRESULT hr = S_OK;
         switch (pcd->dwFlag)
         {
         case 0:
-            LVAddText(g_hwndLV, 0, "%s", pcd->strName);
-            Int2Str(szBuff, 64, dwValue);
-            LVAddText(g_hwndLV, 1, "%s", szBuff);
+            hr = EmitValueRow(pInfo, pcd->strName, dwValue);
             break;
         case 0xFFFFFFFF:	// Hex
-            LVAddText(g_hwndLV, 0, "%s", pcd->strName);
-            LVAddText(g_hwndLV, 1, "0x%08X", dwValue);
+            sprintf_s(szBuff, sizeof(szBuff), "0x%08X", dwValue);
+            hr = EmitTextRow(pInfo, pcd->strName, szBuff);
             break;
         case 0xEFFFFFFF:	// Shader Version
-            LVAddText(g_hwndLV, 0, "%s", pcd->strName);
-            LVAddText(g_hwndLV, 1, "%d.%0d", D3DSHADER_VERSION_MAJOR(dwValue), D3DSHADER_VERSION_MINOR(dwValue));
+            sprintf_s(szBuff, sizeof(szBuff), "%u.%0u", D3DSHADER_VERSION_MAJOR(dwValue), D3DSHADER_VERSION_MINOR(dwValue));
+            hr = EmitTextRow(pInfo, pcd->strName, szBuff);
             break;
         case 0xBFFFFFFF:	// FLOAT Support for new DX6 "D3DVALUE" values in D3DDeviceDesc
         {
-            LVAddText(g_hwndLV, 0, "%s", pcd->strName);
             auto fValue = *reinterpret_cast<float*>(static_cast<BYTE*>(pv) + pcd->dwOffset);
-            LVAddText(g_hwndLV, 1, "%G", fValue);
+            sprintf_s(szBuff, sizeof(szBuff), "%G", fValue);
+            hr = EmitTextRow(pInfo, pcd->strName, szBuff);
             break;
         }
         case 0x7FFFFFFF:	// HEX Support for new DX6 "WORD" values in D3DDeviceDesc
-            LVAddText(g_hwndLV, 0, "%s", pcd->strName);
             dwValue = *reinterpret_cast<WORD*>(static_cast<BYTE*>(pv) + pcd->dwOffset);
-            LVAddText(g_hwndLV, 1, "0x%04X", dwValue);
+            sprintf_s(szBuff, sizeof(szBuff), "0x%04X", dwValue);
+            hr = EmitTextRow(pInfo, pcd->strName, szBuff);
             break;
         case 0x3FFFFFFF:	// VAL Support for new DX6 "WORD" values in D3DDeviceDesc
-            LVAddText(g_hwndLV, 0, "%s", pcd->strName);
             dwValue = *reinterpret_cast<WORD*>(static_cast<BYTE*>(pv) + pcd->dwOffset);
-            Int2Str(szBuff, 64, dwValue);
-            LVAddText(g_hwndLV, 1, "%s", szBuff);
+            hr = EmitValueRow(pInfo, pcd->strName, dwValue);
             break;
         case 0x1FFFFFFF:	// "-1 == unlimited"
-            LVAddText(g_hwndLV, 0, "%s", pcd->strName);
             if (dwValue == 0xFFFFFFFF)
-            {
-                LVAddText(g_hwndLV, 1, "Unlimited");
-            }
+                hr = EmitTextRow(pInfo, pcd->strName, "Unlimited");
             else
-            {
-                Int2Str(szBuff, 64, dwValue);
-                LVAddText(g_hwndLV, 1, "%s", szBuff);
-            }
+                hr = EmitValueRow(pInfo, pcd->strName, dwValue);
             break;
         case 0x0fffffff:    // Mask with 0xffff
-        {
-            LVAddText(g_hwndLV, 0, pcd->strName);
-            dwValue = (*reinterpret_cast<DWORD*>(static_cast<BYTE*>(pv) + pcd->dwOffset)) & 0xffff;
-            Int2Str(szBuff, 64, dwValue);
-            LVAddText(g_hwndLV, 1, "%s", szBuff);
-        }
-        break;
+            hr = EmitValueRow(pInfo, pcd->strName, dwValue & 0xffff);
+            break;
         default:
-            if (pcd->dwFlag & dwValue)
-            {
-                LVAddText(g_hwndLV, 0, pcd->strName);
-                LVAddText(g_hwndLV, 1, c_szYes);
-            }
-            else if (g_dwViewState == IDM_VIEWALL)
-            {
-                LVAddText(g_hwndLV, 0, pcd->strName);
-                LVAddText(g_hwndLV, 1, c_szNo);
-            }
+            hr = EmitYesNoRow(pInfo, pcd->strName, (pcd->dwFlag & dwValue) != 0);
             break;
         }
+
+        if (FAILED(hr))
+            return hr;
+
         pcd++;  // Get next Cap bit definition
     }
+
+    return S_OK;
+}
+
+
+//-----------------------------------------------------------------------------
+// AddMoreCapsToLV is like AddCapsToLV, except it doesn't add the
+// column headers like AddCapsToLV does.
+void AddMoreCapsToLV(CAPDEF* pcd, LPVOID pv)
+{
+    EmitCaps(pcd, pv, nullptr);
 }
 
 
@@ -681,187 +849,11 @@ VOID AddCapsToLV(CAPDEF *pcd, LPVOID pv)
 _Use_decl_annotations_
 HRESULT PrintCapsToDC(CAPDEF* pcd, LPVOID pv, PRINTCBINFO* lpInfo)
 {
-    DWORD cchLen;
-    TCHAR szValue[100];
-
     // Check Parameters
     if ((!pcd) || (!lpInfo))
         return E_FAIL;
 
-    // Calculate Name and Value column x offsets
-    int xName = (lpInfo->dwCurrIndent * DEF_TAB_SIZE * lpInfo->dwCharWidth);
-    int xVal = xName + (c_tabStop * lpInfo->dwCharWidth);
-
-    while (pcd->strName && *pcd->strName)
-    {
-        if (!g_dwView9Ex && (pcd->dwCapsFlags & DXV_9EXCAP))
-        {
-            pcd++;  // Get next Cap bit definition
-            continue;
-        }
-
-        auto dwValue = *reinterpret_cast<DWORD*>(static_cast<BYTE*>(pv) + pcd->dwOffset);
-        int yLine = lpInfo->dwCurrLine * lpInfo->dwLineHeight;
-
-        if (pcd->dwFlag)
-        {
-            switch (pcd->dwFlag)
-            {
-            case 0xFFFFFFFF:	// Hex
-                // Print name
-                cchLen = static_cast<DWORD>(_tcslen(pcd->strName));
-                if (FAILED(PrintLine(xName, yLine, pcd->strName, cchLen, lpInfo)))
-                    return E_FAIL;
-                // Print value in hex
-                sprintf_s(szValue, sizeof(szValue), "0x%08X", dwValue);
-                if (FAILED(PrintLine(xVal, yLine, szValue, strlen(szValue), lpInfo)))
-                    return E_FAIL;
-                // Advance to next line on page
-                if (FAILED(PrintNextLine(lpInfo)))
-                    return E_FAIL;
-                break;
-
-            case 0xEFFFFFFF:	// Shader Version
-                // Print name
-                cchLen = static_cast<DWORD>(_tcslen(pcd->strName));
-                if (FAILED(PrintLine(xName, yLine, pcd->strName, cchLen, lpInfo)))
-                    return E_FAIL;
-                // Print version
-                sprintf_s(szValue, sizeof(szValue), "%u.%0u", D3DSHADER_VERSION_MAJOR(dwValue), D3DSHADER_VERSION_MINOR(dwValue));
-                if (FAILED(PrintLine(xVal, yLine, szValue, strlen(szValue), lpInfo)))
-                    return E_FAIL;
-                // Advance to next line on page
-                if (FAILED(PrintNextLine(lpInfo)))
-                    return E_FAIL;
-                break;
-
-            case 0xBFFFFFFF:	// FLOAT Support for new DX6 "D3DVALUE" values in D3DDeviceDesc
-            {
-                // Print name
-                cchLen = static_cast<DWORD>(_tcslen(pcd->strName));
-                if (FAILED(PrintLine(xName, yLine, pcd->strName, cchLen, lpInfo)))
-                    return E_FAIL;
-                // Print value
-                auto fValue = *reinterpret_cast<float*>(static_cast<BYTE*>(pv) + pcd->dwOffset);
-                sprintf_s(szValue, sizeof(szValue), "%G", fValue);
-                if (FAILED(PrintLine(xVal, yLine, szValue, strlen(szValue), lpInfo)))
-                    return E_FAIL;
-                // Advance to next line on page
-                if (FAILED(PrintNextLine(lpInfo)))
-                    return E_FAIL;
-                break;
-            }
-
-            case 0x7FFFFFFF:	// HEX Support for new DX6 "WORD" values in D3DDeviceDesc
-                // Print name
-                cchLen = static_cast<DWORD>(_tcslen(pcd->strName));
-                if (FAILED(PrintLine(xName, yLine, pcd->strName, cchLen, lpInfo)))
-                    return E_FAIL;
-                // Print value
-                dwValue = *reinterpret_cast<WORD*>(static_cast<BYTE*>(pv) + pcd->dwOffset);
-                sprintf_s(szValue, sizeof(szValue), "0x%04X", dwValue);
-                if (FAILED(PrintLine(xVal, yLine, szValue, strlen(szValue), lpInfo)))
-                    return E_FAIL;
-                // Advance to next line on page
-                if (FAILED(PrintNextLine(lpInfo)))
-                    return E_FAIL;
-                break;
-
-            case 0x3FFFFFFF:	// VAL Support for new DX6 "WORD" values in D3DDeviceDesc
-                // Print name
-                cchLen = static_cast<DWORD>(_tcslen(pcd->strName));
-                if (FAILED(PrintLine(xName, yLine, pcd->strName, cchLen, lpInfo)))
-                    return E_FAIL;
-                // Print value
-                dwValue = *reinterpret_cast<WORD*>(static_cast<BYTE*>(pv) + pcd->dwOffset);
-                *szValue = 0;
-                Int2Str(szValue, 100, dwValue);
-                if (FAILED(PrintLine(xVal, yLine, szValue, strlen(szValue), lpInfo)))
-                    return E_FAIL;
-                // Advance to next line on page
-                if (FAILED(PrintNextLine(lpInfo)))
-                    return E_FAIL;
-                break;
-
-            case 0x1FFFFFFF:	// "-1 == unlimited"
-                // Print name
-                cchLen = static_cast<DWORD>(_tcslen(pcd->strName));
-                if (FAILED(PrintLine(xName, yLine, pcd->strName, cchLen, lpInfo)))
-                    return E_FAIL;
-                // Print value
-                *szValue = 0;
-                if (dwValue == 0xFFFFFFFF)
-                    strcpy_s(szValue, sizeof(szValue), "Unlimited");
-                else
-                    Int2Str(szValue, 100, dwValue);
-                if (FAILED(PrintLine(xVal, yLine, szValue, strlen(szValue), lpInfo)))
-                    return E_FAIL;
-                // Advance to next line on page
-                if (FAILED(PrintNextLine(lpInfo)))
-                    return E_FAIL;
-                break;
-
-            default:
-                if (pcd->dwFlag & dwValue)
-                {
-                    // Print Name
-                    cchLen = static_cast<DWORD>(_tcslen(pcd->strName));
-                    if (FAILED(PrintLine(xName, yLine, pcd->strName, cchLen, lpInfo)))
-                        return E_FAIL;
-
-                    // Print Yes in value column
-                    cchLen = static_cast<DWORD>(_tcslen(c_szYes));
-                    if (FAILED(PrintLine(xVal, yLine, c_szYes, cchLen, lpInfo)))
-                        return E_FAIL;
-
-                    // Advance to next line on page
-                    if (FAILED(PrintNextLine(lpInfo)))
-                        return E_FAIL;
-                }
-                else if (g_dwViewState == IDM_VIEWALL)
-                {
-                    // Print name
-                    cchLen = static_cast<DWORD>(_tcslen(pcd->strName));
-                    if (FAILED(PrintLine(xName, yLine, pcd->strName, cchLen, lpInfo)))
-                        return E_FAIL;
-
-                    // Print No in value column
-                    cchLen = static_cast<DWORD>(_tcslen(c_szNo));
-                    if (FAILED(PrintLine(xVal, yLine, c_szNo, cchLen, lpInfo)))
-                        return E_FAIL;
-
-                    // Advance to next line on page
-                    if (FAILED(PrintNextLine(lpInfo)))
-                        return E_FAIL;
-                }
-                break;
-            }
-        }
-        else
-        {
-            char    szBuff[c_maxPrintLine];
-
-            // Print name
-            sprintf_s(szBuff, sizeof(szBuff), pcd->strName, "test");
-            cchLen = static_cast<DWORD>(_tcslen(pcd->strName));
-            if (FAILED(PrintLine(xName, yLine, szBuff, cchLen, lpInfo)))
-                return E_FAIL;
-
-            // Print value
-            Int2Str(szBuff, c_maxPrintLine, dwValue);
-            cchLen = static_cast<DWORD>(_tcslen(szBuff));
-            if (FAILED(PrintLine(xVal, yLine, szBuff, cchLen, lpInfo)))
-                return E_FAIL;
-
-            // Advance to next line on page
-            if (FAILED(PrintNextLine(lpInfo)))
-                return E_FAIL;
-        }
-
-        pcd++;  // Get next Cap bit definition
-    }
-
-    return S_OK;
+    return EmitCaps(pcd, pv, lpInfo);
 }
 
 
@@ -872,22 +864,21 @@ void DXView_OnTreeSelect(HWND /*hwndTV*/, NM_TREEVIEW* ptv)
     LVDeleteAllItems(g_hwndLV);
     LVAddColumn(g_hwndLV, 0, "", 0);
 
-    NODEINFO* pni = nullptr;
+    HCAPNODE hNode = nullptr;
     if (!ptv)
     {
-        TV_ITEM tvi = {};
-        // get lParam of current tree node
-        tvi.hItem = TreeView_GetSelection(g_hwndTV);
-        tvi.mask = TVIF_PARAM;
-        TreeView_GetItem(g_hwndTV, &tvi);
-        pni = (NODEINFO*)tvi.lParam;
+        // get model node of current tree item
+        hNode = TVGetNode(g_hwndTV, TreeView_GetSelection(g_hwndTV));
     }
     else
     {
-        pni = (NODEINFO*)ptv->itemNew.lParam;
+        hNode = reinterpret_cast<HCAPNODE>(ptv->itemNew.lParam);
     }
 
-    if (pni && pni->fnDisplayCallback)
+    NODEINFO* pni = (hNode) ? &hNode->ni : nullptr;
+
+    // Rows kept from an earlier selection are shown as they are
+    if (!LVRowsSelect(hNode) && pni && pni->fnDisplayCallback)
     {
         if (pni->bUseLParam3)
             ((DISPLAYCALLBACKEX)(pni->fnDisplayCallback))(pni->lParam1, pni->lParam2, pni->lParam3, nullptr);
@@ -895,6 +886,7 @@ void DXView_OnTreeSelect(HWND /*hwndTV*/, NM_TREEVIEW* ptv)
             pni->fnDisplayCallback(pni->lParam1, pni->lParam2, nullptr);
     }
 
+    ListView_SetItemCountEx(g_hwndLV, static_cast<int>(LVRowsCommit()), LVSICF_NOINVALIDATEALL);
     ListView_SetItemState(g_hwndLV, 0, LVIS_SELECTED | LVIS_FOCUSED, LVIS_SELECTED | LVIS_FOCUSED);
 
     SendMessage(g_hwndLV, WM_SETREDRAW, TRUE, 0);
@@ -902,6 +894,19 @@ void DXView_OnTreeSelect(HWND /*hwndTV*/, NM_TREEVIEW* ptv)
 }
 
 
+//-----------------------------------------------------------------------------
+void DXView_OnListViewGetDispInfo(NMLVDISPINFO* pdi)
+{
+    if (!(pdi->item.mask & LVIF_TEXT) || !pdi->item.pszText || pdi->item.cchTextMax <= 0)
+        return;
+
+    // The text is copied out of the rows captured by the display callback
+    CHAR szBuff[c_cchRowCell];
+    strncpy_s(pdi->item.pszText, static_cast<size_t>(pdi->item.cchTextMax),
+        LVRowsCellText(pdi->item.iItem, pdi->item.iSubItem, szBuff), _TRUNCATE);
+}
+
+
 //-----------------------------------------------------------------------------
 void DXView_OnListViewDblClick(HWND hwndLV, NM_LISTVIEW *plv)
 {
@@ -976,6 +981,10 @@ void DXView_OnCommand(HWND hWnd, WPARAM wParam)
     }
     break;
 
+    case IDM_FIND:
+        SearchShowDialog(hWnd);
+        break;
+
     case IDM_ABOUT:
         DialogBox(g_hInstance, "About", hWnd, (DLGPROC)About);
         break;
@@ -990,6 +999,11 @@ void DXView_OnCommand(HWND hWnd, WPARAM wParam)
 //-----------------------------------------------------------------------------
 void DXView_Cleanup()
 {
+    ProbeWait(g_hwndMain);
+    TVFreeNodes();
+    LVRowsReset();
+    CacheFree();
+
     DXGI_CleanUp();
 
     DXG_CleanUp();
@@ -1164,101 +1178,8 @@ void LVAddColumn(HWND hwndLV, int i, const char* name, int width)
 }
 
 
-//-----------------------------------------------------------------------------
-int LVAddText(HWND hwndLV, int col, const char* sz, ...)
-{
-    va_list vl;
-    va_start(vl, sz);
-
-    char    ach[c_maxPrintLine];
-    vsprintf_s(ach, sizeof(ach), sz, vl);
-    ach[c_maxPrintLine - 1] = '\0';
-
-    LV_ITEM lvi = {};
-    lvi.mask = LVIF_TEXT;
-    lvi.pszText = ach;
-
-    if (col == 0)
-    {
-        lvi.iItem = 0x7FFF;
-        lvi.iSubItem = 0;
-        va_end(vl);
-        return ListView_InsertItem(hwndLV, &lvi);
-    }
-    else
-    {
-        lvi.iItem = ListView_GetItemCount(hwndLV) - 1;
-        lvi.iSubItem = col;
-        va_end(vl);
-        return ListView_SetItem(hwndLV, &lvi);
-    }
-}
-
-
 //-----------------------------------------------------------------------------
 void LVDeleteAllItems(HWND hwndLV)
 {
     ListView_DeleteAllItems(hwndLV);
 }
-
-
-//-----------------------------------------------------------------------------
-HTREEITEM TVAddNode(HTREEITEM hParent, LPCSTR strText, BOOL fKids,
-    int iImage, DISPLAYCALLBACK fnDisplayCallback, LPARAM lParam1,
-    LPARAM lParam2)
-{
-    auto pni = reinterpret_cast<NODEINFO*>(LocalAlloc(LPTR, sizeof(NODEINFO)));
-    if (!pni)
-        return nullptr;
-
-    pni->bUseLParam3 = FALSE;
-    pni->lParam1 = lParam1;
-    pni->lParam2 = lParam2;
-    pni->lParam3 = 0;
-    pni->fnDisplayCallback = fnDisplayCallback;
-
-    // Add Node to treeview
-    TV_INSERTSTRUCT tvi = {};
-    tvi.hParent = hParent;
-    tvi.hInsertAfter = TVI_LAST;
-    tvi.item.mask = TVIF_TEXT | TVIF_IMAGE | TVIF_SELECTEDIMAGE |
-        TVIF_PARAM | TVIF_CHILDREN;
-    tvi.item.iImage = iImage - IDI_FIRSTIMAGE;
-    tvi.item.iSelectedImage = iImage - IDI_FIRSTIMAGE;
-    tvi.item.lParam = (LPARAM)pni;
-    tvi.item.cChildren = fKids;
-    tvi.item.pszText = (LPSTR)strText;
-
-    return TreeView_InsertItem(g_hwndTV, &tvi);
-}
-
-
-//-----------------------------------------------------------------------------
-HTREEITEM TVAddNodeEx(HTREEITEM hParent, LPCSTR strText, BOOL fKids,
-    int iImage, DISPLAYCALLBACKEX fnDisplayCallback, LPARAM lParam1,
-    LPARAM lParam2, LPARAM lParam3)
-{
-    auto pni = reinterpret_cast<NODEINFO*>(LocalAlloc(LPTR, sizeof(NODEINFO)));
-    if (!pni)
-        return nullptr;
-
-    pni->bUseLParam3 = TRUE;
-    pni->lParam1 = lParam1;
-    pni->lParam2 = lParam2;
-    pni->lParam3 = lParam3;
-    pni->fnDisplayCallback = reinterpret_cast<DISPLAYCALLBACK>(fnDisplayCallback);
-
-    // Add Node to treeview
-    TV_INSERTSTRUCT tvi = {};
-    tvi.hParent = hParent;
-    tvi.hInsertAfter = TVI_LAST;
-    tvi.item.mask = TVIF_TEXT | TVIF_IMAGE | TVIF_SELECTEDIMAGE |
-        TVIF_PARAM | TVIF_CHILDREN;
-    tvi.item.iImage = iImage - IDI_FIRSTIMAGE;
-    tvi.item.iSelectedImage = iImage - IDI_FIRSTIMAGE;
-    tvi.item.lParam = (LPARAM)pni;
-    tvi.item.cChildren = fKids;
-    tvi.item.pszText = (LPSTR)strText;
-
-    return TreeView_InsertItem(g_hwndTV, &tvi);
-}
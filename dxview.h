@@ -29,10 +29,15 @@
 #define DEF_TAB_SIZE    3
 
 constexpr int c_DefNameLength = 50;
+constexpr int c_tabStop = 52;           // Value column of name/value lines in text output, past the indent
+
+static_assert(c_tabStop >= c_DefNameLength, "print stop should be at least as long as the default name");
 
 #define IDC_LV          0x2000       // Child controls
 #define IDC_TV          0x2003
 
+#define WM_PROBEBATCH   (WM_APP + 1) // lParam is a batch of probed nodes, see dxprobe.cpp
+
 #define IDI_FIRSTIMAGE  IDI_DIRECTX  // Imagelist first and last icons
 #define IDI_LASTIMAGE   IDI_CAPSOPEN
 
@@ -44,11 +49,18 @@ constexpr int c_DefNameLength = 50;
 //-----------------------------------------------------------------------------
 // Structs and typedefs
 //-----------------------------------------------------------------------------
+struct CAPNODE;
+using HCAPNODE = CAPNODE*;
+
+struct ROWEMITTER;
+
+constexpr UINT c_maxEmitColumns = 8;
+
 struct PRINTCBINFO
 {
     HDC         hdcPrint;       // In:      Printer DC
     HWND        hTreeWnd;       // In:      tree window
-    HTREEITEM   hCurrTree;      // In:      current tree item handle
+    HCAPNODE    hCurrTree;      // In:      current tree node
     DWORD       dwCharWidth;    // In:      average char width
     DWORD       dwLineHeight;   // In:      max line height
     DWORD       dwCurrLine;     // In/Out:  curr line position on page
@@ -56,10 +68,59 @@ struct PRINTCBINFO
     DWORD       dwLinesPerPage; // In:      maximum lines per page
     DWORD       dwCurrIndent;   // In:      Current tab setting
     BOOL        fStartPage;     // In/Out:  need to a start new page ?!?
+    const ROWEMITTER* pEmitter; // In:      receives rows instead of the printer, if set
+    DWORD       dwColWidth[c_maxEmitColumns]; // In/Out: column widths from EmitColumn (chars)
+    BOOL        fAvailOnly;     // In:      leave out "No" rows, as the ListView does in the View Available state
+};
+
+// Row emitter. Display callbacks describe each row once with the Emit*
+// functions and the backend renders it: the ListView when the PRINTCBINFO is
+// null, pEmitter when set, otherwise the printer or text file.
+enum ROWCELLTYPE : UINT
+{
+    CELL_TEXT,
+    CELL_UINT,
+    CELL_HEX,
+    CELL_BOOL,
+};
+
+struct ROWCELL
+{
+    ROWCELLTYPE type;
+    const CHAR* str;            // CELL_TEXT
+    DWORD       dwValue;        // CELL_UINT, CELL_HEX, CELL_BOOL
+};
+
+struct ROWEMITTER
+{
+    HRESULT (*fnColumn)(void* pContext, int iCol, const CHAR* strName, int width);
+    HRESULT (*fnRow)(void* pContext, UINT cCells, const ROWCELL* pCells);
+    void*   pContext;
+};
+
+// Rows captured by the in-memory backend, see RowListInit()
+struct ROWCHUNK;
+
+struct ROWRECORD
+{
+    ROWRECORD*  pNext;
+    UINT        cCells;
+    ROWCELL     cells[1];       // Followed by the text of the CELL_TEXT cells
 };
 
+struct ROWLIST
+{
+    ROWRECORD*  pFirst;
+    ROWRECORD*  pLast;
+    UINT        cRows;
+    ROWCHUNK*   pChunks;        // Hold the records, the first one is being filled
+};
+
+constexpr size_t c_cchRowCell = 128;    // Buffer for the text form of a cell
+
 using DISPLAYCALLBACK = HRESULT(*)(LPARAM lParam1, LPARAM lParam2, _In_opt_ PRINTCBINFO* pPrintInfo);
 using DISPLAYCALLBACKEX = HRESULT(*)(LPARAM lParam1, LPARAM lParam2, LPARAM lParam3, _In_opt_ PRINTCBINFO* pPrintInfo);
+using EXPANDCALLBACK = VOID(*)(HCAPNODE hParent, LPARAM lParam1, LPARAM lParam2, LPARAM lParam3);
 
 struct NODEINFO
 {
@@ -68,8 +129,120 @@ struct NODEINFO
     LPARAM          lParam1;
     LPARAM          lParam2;
     LPARAM          lParam3;
+    EXPANDCALLBACK  fnExpandCallback;   // Lazy nodes: fills in children on first expand
+};
+
+// Capability tree node (see dxtree.cpp). The TreeView item lParam points here.
+struct CAPNODE
+{
+    NODEINFO    ni;
+    CAPNODE*    pParent;
+    CAPNODE*    pFirstChild;
+    CAPNODE*    pLastChild;
+    CAPNODE*    pNext;
+    HTREEITEM   hItem;          // Bound TreeView item, nullptr if not in the view
+    int         iImage;
+    BOOL        fKids;
+    BOOL        fExpanded;
+    BOOL        fIndexed;       // Added to the search index, see dxsearch.cpp
+    BOOL        fNoSnapshot;    // State of this run rather than of the machine, left out of snapshots with its subtree
+    CHAR        strText[1];
+};
+
+// Memory of the nodes and their payloads, freed with the tree (see dxtree.cpp)
+struct NODECHUNK;
+
+struct NODEARENA
+{
+    NODECHUNK*  pChunks;        // The first one is being filled
+    DWORD       cNodes;
+    DWORD       cAllocs;        // Nodes and payloads
+    DWORD       cChunks;
+    size_t      cbUsed;
+    size_t      cbReserved;
+};
+
+// A section of the tree built out of view, see TVBeginStage()
+struct CAPSTAGE
+{
+    CAPNODE     root;           // The section's top-level nodes are its children
+    NODEARENA   arena;
+};
+
+// Buffered output. Writes are coalesced and handed to fnWrite in large blocks.
+using SINKWRITE = BOOL(*)(void* pContext, const void* pData, DWORD cbData);
+
+constexpr DWORD c_cbSinkBuffer = 64 * 1024;
+
+struct OUTPUTSINK
+{
+    SINKWRITE   fnWrite;
+    void*       pContext;
+    BOOL        fFailed;        // fnWrite failed, later output is dropped
+    DWORD       cbUsed;
+    CHAR        buffer[c_cbSinkBuffer];
+};
+
+// Snapshot walk, see CacheWalkSnapshot(). fnNode is called with rows.pContext.
+struct SNAPSHOTWALKER
+{
+    VOID        (*fnNode)(void* pContext, UINT depth, const CHAR* strText);
+    ROWEMITTER  rows;           // Rows of the node last passed to fnNode
+};
+
+// Probe trace marker, see dxtrace.cpp. Records the time spent in its scope
+// when tracing is on. Names are kept by pointer and must be static text.
+extern BOOL g_fTrace;
+
+LONGLONG TraceNow();
+VOID    TraceAdd(_In_z_ const CHAR* strName, _In_opt_z_ const CHAR* strDetail, LONGLONG qpcStart);
+
+struct TRACESCOPE
+{
+    explicit TRACESCOPE(_In_z_ const CHAR* strText, _In_opt_z_ const CHAR* strInfo = nullptr)
+        : strName(strText), strDetail(strInfo), qpcStart((g_fTrace) ? TraceNow() : 0) {}
+    ~TRACESCOPE() { if (qpcStart) TraceAdd(strName, strDetail, qpcStart); }
+
+    TRACESCOPE(const TRACESCOPE&) = delete;
+    TRACESCOPE& operator=(const TRACESCOPE&) = delete;
+
+    const CHAR* strName;
+    const CHAR* strDetail;
+    LONGLONG    qpcStart;
+};
+
+// Driver calls counted by StatsAdd(), see dxstats.cpp
+enum APIID : UINT
+{
+    API_D3D12CREATEDEVICE,
+    API_D3D11CREATEDEVICE,
+    API_D3D10CREATEDEVICE,
+    API_D3D10CREATEDEVICE1,
+    API_CHECKFEATURESUPPORT,
+    API_CHECKFORMATSUPPORT,
+    API_CHECKMULTISAMPLEQUALITYLEVELS,
+    API_D3D9GETDEVICECAPS,
+    API_D3D9CHECKDEVICETYPE,
+    API_D3D9CHECKDEVICEFORMAT,
+    API_D3D9CHECKDEVICEMULTISAMPLETYPE,
+    API_D3D9CHECKDEPTHSTENCILMATCH,
+    API_DIRECTDRAWCREATEEX,
+    API_DDGETCAPS,
+    API_COUNT
+};
+
+// Text found by the search index, see IndexQuery()
+struct SEARCHHIT
+{
+    void*       pItem;          // Owner of the text, e.g. a HCAPNODE
+    const CHAR* strRow;         // First cell of the row, nullptr for node names
+    const CHAR* strText;
+    DWORD       iHit;           // Order in which texts were added
+    DWORD       dwQuery;        // Last query that visited the hit
 };
 
+struct SEARCHINDEX;
+
 #define DXV_9EXCAP (1<<0)
 
 struct CAPDEF
@@ -109,18 +282,33 @@ struct LOCALAPP
 // DXView treeview/listview helper functions
 //-----------------------------------------------------------------------------
 VOID    LVAddColumn( HWND hwndLV, int i, const CHAR* strName, int width );
-int     LVAddText( HWND hwndLV, int col, const CHAR* str, ... );
 VOID    LVDeleteAllItems( HWND hwndLV );
-HTREEITEM TVAddNode(HTREEITEM hParent, LPCSTR strText, BOOL bKids, int iImage,
-                    DISPLAYCALLBACK Callback, LPARAM lParam1, LPARAM lParam2 );
-HTREEITEM TVAddNodeEx(HTREEITEM hParent, LPCSTR strText, BOOL bKids, int iImage,
-                        DISPLAYCALLBACKEX Callback, LPARAM lParam1, LPARAM lParam2,
-                        LPARAM lParam3 );
-VOID    AddCapsToTV( HTREEITEM hParent, CAPDEFS *pcds, LPARAM lParam1 );
+HCAPNODE TVAddNode(HCAPNODE hParent, LPCSTR strText, BOOL bKids, int iImage,
+                   DISPLAYCALLBACK Callback, LPARAM lParam1, LPARAM lParam2 );
+HCAPNODE TVAddNodeEx(HCAPNODE hParent, LPCSTR strText, BOOL bKids, int iImage,
+                     DISPLAYCALLBACKEX Callback, LPARAM lParam1, LPARAM lParam2,
+                     LPARAM lParam3 );
+HCAPNODE TVAddLazyNode(HCAPNODE hParent, LPCSTR strText, int iImage,
+                       EXPANDCALLBACK Callback, LPARAM lParam1, LPARAM lParam2,
+                       LPARAM lParam3 );
+VOID    TVExpandLazyNode( HCAPNODE hNode );
+VOID    TVExpandNode( HCAPNODE hNode );
+HCAPNODE TVGetRoot();
+HCAPNODE TVGetNode( HWND hwndTV, HTREEITEM hItem );
+VOID    TVBindView( HWND hwndTV );
+VOID    TVFreeNodes();
+VOID    TVBeginStage( CAPSTAGE* pStage );
+VOID    TVEndStage();
+VOID    TVSpliceStage( HCAPNODE hPlaceholder, CAPSTAGE* pStage );
+VOID    TVFreeStage( CAPSTAGE* pStage );
+_Ret_maybenull_ void* TVAlloc( size_t cb );
+const NODEARENA* TVGetArena();
+VOID    AddCapsToTV( HCAPNODE hParent, CAPDEFS *pcds, LPARAM lParam1 );
 VOID    AddColsToLV();
 VOID    AddCapsToLV( CAPDEF* pcd, VOID* pv );
 VOID    AddMoreCapsToLV( CAPDEF* pcd, VOID* pv );
 HRESULT PrintCapsToDC( CAPDEF* pcd, VOID* pv, _In_ PRINTCBINFO* pInfo );
+HRESULT EmitCaps( _In_ CAPDEF* pcd, _In_ VOID* pv, _In_opt_ PRINTCBINFO* pInfo );
 
 // Printer Helper functions
 HRESULT PrintLine(int x, int y, _In_count_(cchBuff) LPCTSTR lpszBuff, size_t cchBuff, _In_ PRINTCBINFO* pci);
@@ -130,6 +318,96 @@ HRESULT PrintHexValueLine(_In_z_ const CHAR* szText, DWORD dwValue, _In_ PRINTCB
 HRESULT PrintStringValueLine(_In_z_ const CHAR* szText, const CHAR* szText2, _In_ PRINTCBINFO* lpInfo);
 HRESULT PrintStringLine(_In_z_ const CHAR* szText, _In_ PRINTCBINFO* lpInfo);
 
+// Row emitter functions
+HRESULT EmitColumn(_In_opt_ PRINTCBINFO* pInfo, int iCol, _In_z_ const CHAR* strName, int width);
+HRESULT EmitRow(_In_opt_ PRINTCBINFO* pInfo, UINT cCells, _In_reads_(cCells) const ROWCELL* pCells);
+HRESULT EmitTextRow(_In_opt_ PRINTCBINFO* pInfo, _In_z_ const CHAR* strName, _In_z_ const CHAR* strValue);
+HRESULT EmitValueRow(_In_opt_ PRINTCBINFO* pInfo, _In_z_ const CHAR* strName, DWORD dwValue);
+HRESULT EmitHexRow(_In_opt_ PRINTCBINFO* pInfo, _In_z_ const CHAR* strName, DWORD dwValue);
+HRESULT EmitYesNoRow(_In_opt_ PRINTCBINFO* pInfo, _In_z_ const CHAR* strName, BOOL bValue);
+HRESULT EmitLineRow(_In_opt_ PRINTCBINFO* pInfo, _In_z_ const CHAR* strName, _In_z_ const CHAR* strValue);
+HRESULT EmitNoteRow(_In_opt_ PRINTCBINFO* pInfo, _In_z_ const CHAR* strText);
+VOID    RowListInit(_Out_ ROWEMITTER* pEmitter, _Out_ ROWLIST* pList);
+HRESULT RowListReplay(_In_ const ROWLIST* pList, _In_opt_ PRINTCBINFO* pInfo);
+VOID    RowListFree(_Inout_ ROWLIST* pList);
+const CHAR* RowCellText(_In_ const ROWCELL* pCell, _Out_writes_(c_cchRowCell) CHAR* szBuff);
+VOID    LVRowsReset();
+BOOL    LVRowsSelect(_In_opt_ HCAPNODE hNode);
+UINT    LVRowsCommit();
+const CHAR* LVRowsCellText(int iRow, int iCol, _Out_writes_(c_cchRowCell) CHAR* szBuff);
+
+// Output sink functions
+VOID    SinkInit(_Out_ OUTPUTSINK* pSink, SINKWRITE fnWrite, void* pContext);
+VOID    SinkInitFile(_Out_ OUTPUTSINK* pSink, HANDLE hFile);
+VOID    SinkWrite(_Inout_ OUTPUTSINK* pSink, _In_reads_bytes_(cbData) const void* pData, size_t cbData);
+VOID    SinkFill(_Inout_ OUTPUTSINK* pSink, CHAR ch, size_t cch);
+BOOL    SinkFlush(_Inout_ OUTPUTSINK* pSink);
+VOID    SinkWriteJsonString(_Inout_ OUTPUTSINK* pSink, _In_reads_(cch) const CHAR* pch, size_t cch);
+
+// Snapshot cache functions
+VOID    CacheKeyAdd(_In_reads_bytes_(cbData) const void* pData, size_t cbData);
+BOOL    CacheLoad();
+VOID    CacheSave();
+VOID    CacheFree();
+BOOL    CacheOpenSnapshot(_In_z_ LPCSTR szPath);
+BOOL    CacheSaveSnapshot(_In_z_ LPCSTR szPath);
+BOOL    CacheWalkSnapshot(_In_z_ LPCSTR szPath, _In_ const SNAPSHOTWALKER* pWalker);
+HRESULT CacheDiffSnapshots(_In_z_ LPCSTR szOld, _In_z_ LPCSTR szNew, _In_z_ LPCSTR szReport, BOOL fJson);
+
+// Text log reader functions
+BOOL    LogWalkFile(_In_z_ LPCSTR szPath, _In_ const SNAPSHOTWALKER* pWalker);
+
+// Background probing functions
+BOOL    ProbeStart(HWND hWnd);
+VOID    ProbeOnBatch(HWND hWnd, LPARAM lParam);
+BOOL    ProbeIsBusy();
+VOID    ProbeWait(HWND hWnd);
+
+// Probe tracing functions
+VOID    TraceStart();
+BOOL    TraceWrite(_In_z_ LPCSTR szPath);
+
+// Mock device functions
+BOOL    MockStart(_In_z_ LPCSTR szPath);
+BOOL    MockRecordStart();
+BOOL    MockRecordWrite(_In_z_ LPCSTR szPath);
+BOOL    MockIsActive();
+BOOL    MockIsRecording();
+VOID    MockStop();
+
+// Driver call statistics functions
+HRESULT StatsAdd(APIID api, LONGLONG qpcStart, HRESULT hr);
+VOID    StatsFillTree();
+
+// Calls a driver entry point and counts the call
+template<typename FN, typename... ARGS>
+HRESULT StatsCall(APIID api, FN pfn, ARGS... args)
+{
+    LONGLONG qpcStart = TraceNow();
+    HRESULT hr = pfn(args...);
+    return StatsAdd(api, qpcStart, hr);
+}
+
+// Search index functions
+SEARCHINDEX* IndexCreate();
+VOID    IndexDestroy(_In_opt_ SEARCHINDEX* pIndex);
+BOOL    IndexAdd(_Inout_ SEARCHINDEX* pIndex, _In_opt_ void* pItem, _In_opt_z_ const CHAR* strRow, _In_z_ const CHAR* strText);
+UINT    IndexQuery(_Inout_ SEARCHINDEX* pIndex, _In_z_ LPCSTR szQuery, _Out_writes_to_(cMaxHits, return) const SEARCHHIT** ppHits, UINT cMaxHits);
+
+// Capability tree search functions
+VOID    SearchStart();
+VOID    SearchReset();
+VOID    SearchNodeExpanded(_In_ HCAPNODE hNode);
+VOID    SearchShowDialog(HWND hWnd);
+BOOL    SearchIsDialogMessage(_In_ MSG* pMsg);
+
+// Fleet aggregation functions
+HRESULT FleetAggregate(_In_z_ LPCSTR szDir, _In_z_ LPCSTR szReport, BOOL fJson);
+
+// JSON export helper functions (PrintLine/PrintNextLine forward here in JSON mode)
+HRESULT JsonAddCell(_In_count_(cchBuff) LPCTSTR lpszBuff, size_t cchBuff);
+HRESULT JsonEndRow();
+
 
 //-----------------------------------------------------------------------------
 // DXView external variables
@@ -137,3 +415,4 @@ HRESULT PrintStringLine(_In_z_ const CHAR* szText, _In_ PRINTCBINFO* lpInfo);
 extern HINSTANCE g_hInstance;
 extern HWND      g_hwndMain;
 extern HWND      g_hwndLV;        // List view
+extern BOOL      g_PrintToJson;
@@ -11,7 +11,11 @@
 #define IDI_CAPSOPEN                    102
 #define IDC_VERSION                     103
 #define IDC_WARNING                     104
+#define IDC_FINDTEXT                    105
+#define IDC_FINDRESULTS                 106
+#define IDC_FINDSTATUS                  107
 #define IDD_ABORTPRINTDLG               1001
+#define IDD_FIND                        1002
 #define IDM_EXIT                        40001
 #define IDM_ABOUT                       40002
 #define IDM_VIEWAVAIL                   40003
@@ -22,6 +26,7 @@
 #define IDM_PRINTSUBTREETOFILE          40008
 #define IDM_COPY                        40009
 #define IDM_VIEW9EX	                40010
+#define IDM_FIND                        40011
 
 // Next default values for new objects
 //